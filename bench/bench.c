@@ -0,0 +1,959 @@
+/**
+ * @file bench.c
+ * @brief Micro- and end-to-end benchmarks (make bench)
+ * @version 1.0
+ * @date 2024
+ *
+ * Every benchmark is calibrated until one sample takes at least the
+ * minimum time, then sampled several times. Results go to stdout as JSON
+ * (or CSV) with ns/op, passwords/s and MB/s so runs can be compared by
+ * scripts; nothing else is written to stdout.
+ */
+
+#include "config.h"
+#include "password.h"
+#include "pattern.h"
+#include "security.h"
+#include "file_ops.h"
+#include "audit.h"
+#include "utils.h"
+#include "selftest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <process.h>
+    #define bench_getpid _getpid
+#else
+    #include <time.h>
+    #include <unistd.h>
+    #define bench_getpid getpid
+#endif
+
+#define BENCH_DEFAULT_MIN_TIME_MS 200   /* Minimum duration of one sample */
+#define BENCH_DEFAULT_REPEAT 5          /* Samples per benchmark */
+#define BENCH_DEFAULT_COUNT 100000      /* Passwords per end-to-end run */
+#define BENCH_FILE_ENTRIES 1000         /* Passwords in the save/load fixtures */
+#define BENCH_FIXTURE_LENGTH 16         /* Length of the fixture passwords */
+#define BENCH_MAX_ITERATIONS (UINT64_C(1) << 40)
+
+/**
+ * @brief Output formats
+ */
+typedef enum {
+    BENCH_FORMAT_JSON,
+    BENCH_FORMAT_CSV
+} BenchFormat;
+
+/**
+ * @brief Work done by the timed iterations
+ */
+typedef struct {
+    uint64_t passwords;         /* Passwords produced or consumed */
+    uint64_t bytes;             /* Bytes produced or consumed */
+} BenchCounters;
+
+struct BenchCase;
+typedef bool (*BenchFunc)(const struct BenchCase *bench, uint64_t iterations,
+                          BenchCounters *counters);
+
+/**
+ * @brief One benchmark
+ */
+typedef struct BenchCase {
+    const char *name;
+    const char *group;          /* "micro" or "e2e" */
+    BenchFunc run;
+    size_t size;                /* Length, buffer size or entry count */
+    int variant;                /* Charset, format or test input */
+} BenchCase;
+
+/**
+ * @brief Run settings
+ */
+typedef struct {
+    const char *filter;
+    unsigned int min_time_ms;
+    unsigned int repeat;
+    size_t count;
+    size_t threads;
+    BenchFormat format;
+    bool list;
+    bool self_test;
+} BenchSettings;
+
+/**
+ * @brief Shared fixtures, built once before the first benchmark
+ */
+static struct {
+    BenchSettings settings;
+    char dir[512];
+    char scratch[600];                          /* Output of the save benchmarks */
+    char files[EXPORT_FORMAT_JSON + 1][600];    /* One fixture per export format */
+    char e2e_input[600];                        /* Plain file of settings.count passwords */
+    char e2e_output[600];
+    PasswordBatch batch;                        /* BENCH_FILE_ENTRIES fixture passwords */
+    PasswordResult *results;                    /* Views of batch for the array APIs */
+    PasswordOptions options;
+    volatile uint64_t sink;                     /* Keeps results observable */
+} bench;
+
+/**
+ * @brief Charset variants for the generation benchmarks
+ */
+enum {
+    BENCH_CHARSET_ALL,
+    BENCH_CHARSET_ALNUM,
+    BENCH_CHARSET_LOWER,
+    BENCH_CHARSET_FILTERED
+};
+
+/**
+ * @brief Inputs for the pattern checks
+ */
+static const char *const bench_inputs[] = {
+    "kX9#mQ2$vL7!pR4@",         /* Nothing to find */
+    "Password123qwerty",        /* Dictionary word and keyboard walk */
+    "aaaa1234abcdzzzz"          /* Repeats and sequences */
+};
+
+/**
+ * @brief Templates for the pattern benchmarks
+ */
+static const char *const bench_patterns[] = {
+    "llUnss",                                       /* Classic class letters */
+    "[0-9A-F]{5}-[0-9A-F]{5}-[0-9A-F]{5}-[0-9A-F]{5}" /* License key */
+};
+
+/**
+ * @brief Monotonic clock in nanoseconds
+ */
+static uint64_t bench_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Build generation options for a charset variant
+ */
+static PasswordOptions bench_options(size_t length, int variant) {
+    PasswordOptions options = password_options_init();
+    options.length = length;
+    
+    switch (variant) {
+        case BENCH_CHARSET_ALNUM:
+            options.charset.special = false;
+            options.min_special = 0;
+            break;
+        case BENCH_CHARSET_LOWER:
+            options.charset.uppercase = false;
+            options.charset.numbers = false;
+            options.charset.special = false;
+            options.min_numbers = 0;
+            options.min_special = 0;
+            break;
+        case BENCH_CHARSET_FILTERED:
+            options.reject_weak = true;
+            options.reject_dictionary = true;
+            break;
+        default:
+            break;
+    }
+    return options;
+}
+
+/**
+ * @brief Size of a file, or 0 if it cannot be read
+ */
+static uint64_t bench_file_size(const char *path) {
+    long size = get_file_size(path);
+    return size > 0 ? (uint64_t)size : 0;
+}
+
+/* ---- Microbenchmarks ---------------------------------------------------- */
+
+/**
+ * @brief get_random_bytes() with a buffer of bench->size bytes
+ */
+static bool bench_random_bytes(const BenchCase *bench_case, uint64_t iterations,
+                               BenchCounters *counters) {
+    unsigned char buffer[4096];
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (!get_random_bytes(buffer, bench_case->size)) {
+            return false;
+        }
+    }
+    
+    bench.sink += buffer[0];
+    counters->bytes += iterations * bench_case->size;
+    return true;
+}
+
+/**
+ * @brief generate_password() with the case's length and charset
+ */
+static bool bench_generate(const BenchCase *bench_case, uint64_t iterations,
+                           BenchCounters *counters) {
+    PasswordOptions options = bench_options(bench_case->size, bench_case->variant);
+    
+    for (uint64_t i = 0; i < iterations; i++) {
+        PasswordResult result = generate_password(&options);
+        if (!result.password) {
+            return false;
+        }
+        bench.sink += (unsigned char)result.password[0];
+        free_password_result(&result);
+    }
+    
+    counters->passwords += iterations;
+    counters->bytes += iterations * bench_case->size;
+    return true;
+}
+
+/**
+ * @brief check_weak_patterns() on one of bench_inputs
+ */
+static bool bench_weak_patterns(const BenchCase *bench_case, uint64_t iterations,
+                                BenchCounters *counters) {
+    const char *input = bench_inputs[bench_case->variant];
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench.sink += check_weak_patterns(input);
+    }
+    
+    counters->passwords += iterations;
+    counters->bytes += iterations * strlen(input);
+    return true;
+}
+
+/**
+ * @brief check_dictionary_words() on one of bench_inputs
+ */
+static bool bench_dictionary_words(const BenchCase *bench_case, uint64_t iterations,
+                                   BenchCounters *counters) {
+    const char *input = bench_inputs[bench_case->variant];
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench.sink += check_dictionary_words(input);
+    }
+    
+    counters->passwords += iterations;
+    counters->bytes += iterations * strlen(input);
+    return true;
+}
+
+/**
+ * @brief calculate_entropy() on one of bench_inputs
+ */
+static bool bench_entropy(const BenchCase *bench_case, uint64_t iterations,
+                          BenchCounters *counters) {
+    const char *input = bench_inputs[bench_case->variant];
+    double total = 0.0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        total += calculate_entropy(input, &bench.options);
+    }
+    
+    bench.sink += (uint64_t)total;
+    counters->passwords += iterations;
+    counters->bytes += iterations * strlen(input);
+    return true;
+}
+
+/**
+ * @brief generate_password_from_pattern(), compiling the template on every call
+ */
+static bool bench_pattern(const BenchCase *bench_case, uint64_t iterations,
+                          BenchCounters *counters) {
+    const char *pattern = bench_patterns[bench_case->variant];
+    
+    for (uint64_t i = 0; i < iterations; i++) {
+        PasswordResult result = generate_password_from_pattern(pattern);
+        if (!result.password) {
+            return false;
+        }
+        bench.sink += (unsigned char)result.password[0];
+        counters->bytes += result.length;
+        free_password_result(&result);
+    }
+    
+    counters->passwords += iterations;
+    return true;
+}
+
+/**
+ * @brief generate_pattern_into() with a template compiled once
+ */
+static bool bench_pattern_compiled(const BenchCase *bench_case, uint64_t iterations,
+                                   BenchCounters *counters) {
+    CompiledPattern pattern;
+    if (!compile_pattern(bench_patterns[bench_case->variant], &pattern)) {
+        return false;
+    }
+    
+    RandomSampler sampler;
+    random_sampler_init(&sampler);
+    char buffer[PATTERN_MAX_LENGTH + 1];
+    bool ok = true;
+    
+    for (uint64_t i = 0; i < iterations && ok; i++) {
+        PasswordResult result;
+        ok = generate_pattern_into(&pattern, &sampler, buffer, &result);
+        bench.sink += (unsigned char)buffer[0];
+    }
+    
+    random_sampler_wipe(&sampler);
+    counters->passwords += iterations;
+    counters->bytes += iterations * pattern.length;
+    return ok;
+}
+
+/**
+ * @brief save_password_to_file() of one fixture password
+ */
+static bool bench_save_single(const BenchCase *bench_case, uint64_t iterations,
+                              BenchCounters *counters) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (!save_password_to_file(&bench.results[0], bench.scratch, false,
+                                   bench_case->variant != 0)) {
+            return false;
+        }
+    }
+    
+    counters->passwords += iterations;
+    counters->bytes += iterations * bench_file_size(bench.scratch);
+    return true;
+}
+
+/**
+ * @brief save_password_batch() of the fixture batch in one export format
+ */
+static bool bench_save_batch(const BenchCase *bench_case, uint64_t iterations,
+                             BenchCounters *counters) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (!save_password_batch(&bench.batch, bench.scratch,
+                                 (ExportFormat)bench_case->variant, false)) {
+            return false;
+        }
+    }
+    
+    counters->passwords += iterations * bench.batch.count;
+    counters->bytes += iterations * bench_file_size(bench.scratch);
+    return true;
+}
+
+/**
+ * @brief save_bulk_passwords_to_file(), save_passwords_to_csv() and save_passwords_to_json()
+ */
+static bool bench_save_results(const BenchCase *bench_case, uint64_t iterations,
+                               BenchCounters *counters) {
+    size_t count = bench.batch.count;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bool saved;
+        switch (bench_case->variant) {
+            case EXPORT_FORMAT_CSV:
+                saved = save_passwords_to_csv(bench.results, count, bench.scratch);
+                break;
+            case EXPORT_FORMAT_JSON:
+                saved = save_passwords_to_json(bench.results, count, bench.scratch);
+                break;
+            default:
+                saved = save_bulk_passwords_to_file(bench.results, count, bench.scratch, false);
+                break;
+        }
+        if (!saved) {
+            return false;
+        }
+    }
+    
+    counters->passwords += iterations * count;
+    counters->bytes += iterations * bench_file_size(bench.scratch);
+    return true;
+}
+
+/**
+ * @brief password_file_open()/password_file_next() over one fixture file
+ */
+static bool bench_parse_file(const BenchCase *bench_case, uint64_t iterations,
+                             BenchCounters *counters) {
+    const char *path = bench.files[bench_case->variant];
+    for (uint64_t i = 0; i < iterations; i++) {
+        PasswordFile file;
+        if (!password_file_open(&file, path, false)) {
+            return false;
+        }
+        
+        PasswordView view;
+        while (password_file_next(&file, &view)) {
+            bench.sink += view.length;
+            counters->passwords++;
+        }
+        password_file_close(&file);
+    }
+    
+    counters->bytes += iterations * bench_file_size(path);
+    return true;
+}
+
+/**
+ * @brief load_passwords_from_file() of one fixture file
+ */
+static bool bench_load_results(const BenchCase *bench_case, uint64_t iterations,
+                               BenchCounters *counters) {
+    const char *path = bench.files[bench_case->variant];
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t count = 0;
+        PasswordResult *results = load_passwords_from_file(path, &count);
+        if (!results) {
+            return false;
+        }
+        counters->passwords += count;
+        free_bulk_passwords(results, count);
+    }
+    
+    counters->bytes += iterations * bench_file_size(path);
+    return true;
+}
+
+/**
+ * @brief load_passwords_into_batch() of one fixture file
+ */
+static bool bench_load_batch(const BenchCase *bench_case, uint64_t iterations,
+                             BenchCounters *counters) {
+    const char *path = bench.files[bench_case->variant];
+    for (uint64_t i = 0; i < iterations; i++) {
+        PasswordBatch batch;
+        if (!load_passwords_into_batch(path, &batch)) {
+            return false;
+        }
+        counters->passwords += batch.count;
+        password_batch_free(&batch);
+    }
+    
+    counters->bytes += iterations * bench_file_size(path);
+    return true;
+}
+
+/* ---- End-to-end runs ---------------------------------------------------- */
+
+/**
+ * @brief Bulk mode: generate and score settings.count passwords in one batch
+ */
+static bool bench_e2e_bulk(const BenchCase *bench_case, uint64_t iterations,
+                           BenchCounters *counters) {
+    PasswordOptions options = bench_options(bench_case->size, BENCH_CHARSET_ALL);
+    size_t count = bench.settings.count;
+    
+    PasswordBatch batch;
+    if (!password_batch_init(&batch, count, options.length)) {
+        return false;
+    }
+    
+    bool ok = true;
+    for (uint64_t i = 0; ok && i < iterations; i++) {
+        GenerationStats stats = {0};
+        password_batch_clear(&batch);
+        ok = password_batch_generate(&batch, &options, count,
+                                     bench.settings.threads, &stats) == count;
+    }
+    
+    password_batch_free(&batch);
+    counters->passwords += iterations * count;
+    counters->bytes += iterations * count * (options.length + 1);
+    return ok;
+}
+
+/**
+ * @brief Stream mode: generate and export settings.count passwords in chunks
+ */
+static bool bench_e2e_stream(const BenchCase *bench_case, uint64_t iterations,
+                             BenchCounters *counters) {
+    PasswordOptions options = bench_options(bench_case->size, BENCH_CHARSET_ALL);
+    size_t total = bench.settings.count;
+    size_t chunk_size = total < STREAM_CHUNK_SIZE ? total : STREAM_CHUNK_SIZE;
+    
+    PasswordBatch chunk;
+    if (!password_batch_init(&chunk, chunk_size, options.length)) {
+        return false;
+    }
+    
+    bool ok = true;
+    for (uint64_t i = 0; ok && i < iterations; i++) {
+        ExportWriter writer;
+        if (!export_writer_begin(&writer, bench.e2e_output, (ExportFormat)bench_case->variant,
+                                 false, total)) {
+            ok = false;
+            break;
+        }
+        
+        GenerationStats stats = {0};
+        for (size_t written = 0; ok && written < total; ) {
+            size_t want = total - written < chunk_size ? total - written : chunk_size;
+            size_t generated = password_batch_generate(&chunk, &options, want,
+                                                       bench.settings.threads, &stats);
+            ok = generated == want && export_writer_write_batch(&writer, &chunk, 0, generated);
+            password_batch_clear(&chunk);
+            written += generated;
+        }
+        
+        if (!export_writer_end(&writer)) {
+            ok = false;
+        }
+        counters->bytes += bench_file_size(bench.e2e_output);
+    }
+    
+    password_batch_free(&chunk);
+    counters->passwords += iterations * total;
+    return ok;
+}
+
+/**
+ * @brief Audit mode: audit a plain file of settings.count passwords
+ */
+static bool bench_e2e_audit(const BenchCase *bench_case, uint64_t iterations,
+                            BenchCounters *counters) {
+    AuditOptions options = audit_options_init();
+    options.threads = bench.settings.threads;
+    
+    for (uint64_t i = 0; i < iterations; i++) {
+        AuditSummary summary;
+        if (!audit_password_file(bench.e2e_input, bench.e2e_output,
+                                 (ExportFormat)bench_case->variant, &options, &summary)) {
+            return false;
+        }
+        counters->passwords += summary.total;
+    }
+    
+    counters->bytes += iterations * bench_file_size(bench.e2e_input);
+    return true;
+}
+
+/**
+ * @brief Every benchmark, in report order
+ */
+static const BenchCase bench_cases[] = {
+    {"random_bytes/16", "micro", bench_random_bytes, 16, 0},
+    {"random_bytes/64", "micro", bench_random_bytes, 64, 0},
+    {"random_bytes/4096", "micro", bench_random_bytes, 4096, 0},
+    
+    {"generate_password/8/all", "micro", bench_generate, 8, BENCH_CHARSET_ALL},
+    {"generate_password/16/all", "micro", bench_generate, 16, BENCH_CHARSET_ALL},
+    {"generate_password/32/all", "micro", bench_generate, 32, BENCH_CHARSET_ALL},
+    {"generate_password/64/all", "micro", bench_generate, 64, BENCH_CHARSET_ALL},
+    {"generate_password/128/all", "micro", bench_generate, 128, BENCH_CHARSET_ALL},
+    {"generate_password/16/alnum", "micro", bench_generate, 16, BENCH_CHARSET_ALNUM},
+    {"generate_password/16/lower", "micro", bench_generate, 16, BENCH_CHARSET_LOWER},
+    {"generate_password/16/filtered", "micro", bench_generate, 16, BENCH_CHARSET_FILTERED},
+    
+    {"generate_password_from_pattern/classes", "micro", bench_pattern, 0, 0},
+    {"generate_password_from_pattern/license", "micro", bench_pattern, 0, 1},
+    {"generate_pattern_into/classes", "micro", bench_pattern_compiled, 0, 0},
+    {"generate_pattern_into/license", "micro", bench_pattern_compiled, 0, 1},
+    
+    {"check_weak_patterns/random", "micro", bench_weak_patterns, 0, 0},
+    {"check_weak_patterns/dictionary", "micro", bench_weak_patterns, 0, 1},
+    {"check_weak_patterns/sequences", "micro", bench_weak_patterns, 0, 2},
+    {"check_dictionary_words/random", "micro", bench_dictionary_words, 0, 0},
+    {"check_dictionary_words/dictionary", "micro", bench_dictionary_words, 0, 1},
+    {"check_dictionary_words/sequences", "micro", bench_dictionary_words, 0, 2},
+    {"calculate_entropy/random", "micro", bench_entropy, 0, 0},
+    {"calculate_entropy/dictionary", "micro", bench_entropy, 0, 1},
+    
+    {"save_password_to_file", "micro", bench_save_single, 0, 0},
+    {"save_password_to_file/metadata", "micro", bench_save_single, 0, 1},
+    {"save_password_batch/plain", "micro", bench_save_batch, 0, EXPORT_FORMAT_PLAIN},
+    {"save_password_batch/text", "micro", bench_save_batch, 0, EXPORT_FORMAT_TEXT},
+    {"save_password_batch/csv", "micro", bench_save_batch, 0, EXPORT_FORMAT_CSV},
+    {"save_password_batch/json", "micro", bench_save_batch, 0, EXPORT_FORMAT_JSON},
+    {"save_bulk_passwords_to_file", "micro", bench_save_results, 0, EXPORT_FORMAT_TEXT},
+    {"save_passwords_to_csv", "micro", bench_save_results, 0, EXPORT_FORMAT_CSV},
+    {"save_passwords_to_json", "micro", bench_save_results, 0, EXPORT_FORMAT_JSON},
+    
+    {"password_file_next/plain", "micro", bench_parse_file, 0, EXPORT_FORMAT_PLAIN},
+    {"password_file_next/text", "micro", bench_parse_file, 0, EXPORT_FORMAT_TEXT},
+    {"password_file_next/csv", "micro", bench_parse_file, 0, EXPORT_FORMAT_CSV},
+    {"password_file_next/json", "micro", bench_parse_file, 0, EXPORT_FORMAT_JSON},
+    {"load_passwords_from_file/text", "micro", bench_load_results, 0, EXPORT_FORMAT_TEXT},
+    {"load_passwords_from_file/csv", "micro", bench_load_results, 0, EXPORT_FORMAT_CSV},
+    {"load_passwords_from_file/json", "micro", bench_load_results, 0, EXPORT_FORMAT_JSON},
+    {"load_passwords_into_batch/text", "micro", bench_load_batch, 0, EXPORT_FORMAT_TEXT},
+    {"load_passwords_into_batch/csv", "micro", bench_load_batch, 0, EXPORT_FORMAT_CSV},
+    {"load_passwords_into_batch/json", "micro", bench_load_batch, 0, EXPORT_FORMAT_JSON},
+    
+    {"bulk/16", "e2e", bench_e2e_bulk, 16, 0},
+    {"bulk/64", "e2e", bench_e2e_bulk, 64, 0},
+    {"stream/16/plain", "e2e", bench_e2e_stream, 16, EXPORT_FORMAT_PLAIN},
+    {"stream/16/csv", "e2e", bench_e2e_stream, 16, EXPORT_FORMAT_CSV},
+    {"stream/16/json", "e2e", bench_e2e_stream, 16, EXPORT_FORMAT_JSON},
+    {"audit/plain", "e2e", bench_e2e_audit, 0, EXPORT_FORMAT_PLAIN},
+    {"audit/csv", "e2e", bench_e2e_audit, 0, EXPORT_FORMAT_CSV}
+};
+
+#define BENCH_CASE_COUNT (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+/**
+ * @brief Create the temporary files the file benchmarks read and write
+ */
+static bool bench_fixtures_init(void) {
+    const char *base = getenv("TMPDIR");
+#ifdef _WIN32
+    if (!base) {
+        base = getenv("TEMP");
+    }
+#endif
+    if (!base || !*base) {
+        base = ".";
+    }
+    
+    snprintf(bench.dir, sizeof(bench.dir), "%s/passgen-bench-%ld", base, (long)bench_getpid());
+    snprintf(bench.scratch, sizeof(bench.scratch), "%s-scratch", bench.dir);
+    snprintf(bench.e2e_input, sizeof(bench.e2e_input), "%s-e2e.txt", bench.dir);
+    snprintf(bench.e2e_output, sizeof(bench.e2e_output), "%s-e2e.out", bench.dir);
+    
+    static const char *const extensions[] = {"plain", "txt", "csv", "json"};
+    for (int format = EXPORT_FORMAT_PLAIN; format <= EXPORT_FORMAT_JSON; format++) {
+        snprintf(bench.files[format], sizeof(bench.files[format]), "%s.%s",
+                 bench.dir, extensions[format]);
+    }
+    
+    bench.options = password_options_init();
+    bench.options.length = BENCH_FIXTURE_LENGTH;
+    
+    GenerationStats stats = {0};
+    if (!password_batch_init(&bench.batch, BENCH_FILE_ENTRIES, BENCH_FIXTURE_LENGTH) ||
+        password_batch_generate(&bench.batch, &bench.options, BENCH_FILE_ENTRIES,
+                                bench.settings.threads, &stats) != BENCH_FILE_ENTRIES) {
+        return false;
+    }
+    score_password_batch(&bench.batch);
+    
+    bench.results = calloc(bench.batch.count, sizeof(PasswordResult));
+    if (!bench.results) {
+        return false;
+    }
+    for (size_t i = 0; i < bench.batch.count; i++) {
+        bench.results[i] = password_batch_view(&bench.batch, i);
+    }
+    
+    for (int format = EXPORT_FORMAT_PLAIN; format <= EXPORT_FORMAT_JSON; format++) {
+        if (!save_password_batch(&bench.batch, bench.files[format], (ExportFormat)format, false)) {
+            return false;
+        }
+    }
+    
+    /* The audit input is streamed so large counts stay in constant memory */
+    bool ok = true;
+    ExportWriter writer;
+    if (!export_writer_begin(&writer, bench.e2e_input, EXPORT_FORMAT_PLAIN, false,
+                             bench.settings.count)) {
+        return false;
+    }
+    for (size_t written = 0; ok && written < bench.settings.count; written += bench.batch.count) {
+        size_t remaining = bench.settings.count - written;
+        size_t end = remaining < bench.batch.count ? remaining : bench.batch.count;
+        ok = export_writer_write_batch(&writer, &bench.batch, 0, end);
+    }
+    return export_writer_end(&writer) && ok;
+}
+
+/**
+ * @brief Remove the temporary files and free the fixtures
+ */
+static void bench_fixtures_cleanup(void) {
+    remove(bench.scratch);
+    remove(bench.e2e_input);
+    remove(bench.e2e_output);
+    for (int format = EXPORT_FORMAT_PLAIN; format <= EXPORT_FORMAT_JSON; format++) {
+        remove(bench.files[format]);
+    }
+    
+    free(bench.results);
+    bench.results = NULL;
+    password_batch_free(&bench.batch);
+}
+
+/**
+ * @brief Measured result of one benchmark
+ */
+typedef struct {
+    uint64_t iterations;        /* Iterations per sample */
+    double ns_per_op;           /* Median over the samples */
+    double min_ns_per_op;
+    double max_ns_per_op;
+    double passwords_per_sec;   /* At the median */
+    double mb_per_sec;          /* At the median, 10^6 bytes */
+} BenchResult;
+
+/**
+ * @brief Order doubles for qsort()
+ */
+static int bench_compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Calibrate and sample one benchmark
+ */
+static bool bench_measure(const BenchCase *bench_case, BenchResult *result) {
+    uint64_t min_time_ns = (uint64_t)bench.settings.min_time_ms * 1000000u;
+    uint64_t iterations = 1;
+    
+    /* Grow the iteration count until one sample lasts long enough */
+    for (;;) {
+        BenchCounters counters = {0};
+        uint64_t start = bench_now_ns();
+        if (!bench_case->run(bench_case, iterations, &counters)) {
+            return false;
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+        
+        if (elapsed >= min_time_ns || iterations >= BENCH_MAX_ITERATIONS) {
+            break;
+        }
+        
+        uint64_t next = elapsed > 0 ?
+                        (uint64_t)((double)iterations * 1.2 * (double)min_time_ns / (double)elapsed) :
+                        iterations * 100;
+        if (next > iterations * 100) {
+            next = iterations * 100;
+        }
+        iterations = next > iterations ? next : iterations + 1;
+    }
+    
+    double samples[64];
+    double passwords[64];
+    double bytes[64];
+    unsigned int repeat = bench.settings.repeat;
+    
+    for (unsigned int i = 0; i < repeat; i++) {
+        BenchCounters counters = {0};
+        uint64_t start = bench_now_ns();
+        if (!bench_case->run(bench_case, iterations, &counters)) {
+            return false;
+        }
+        double elapsed = (double)(bench_now_ns() - start);
+        
+        samples[i] = elapsed / (double)iterations;
+        passwords[i] = (double)counters.passwords / (double)iterations;
+        bytes[i] = (double)counters.bytes / (double)iterations;
+    }
+    
+    double sorted[64];
+    memcpy(sorted, samples, repeat * sizeof(double));
+    qsort(sorted, repeat, sizeof(double), bench_compare_double);
+    
+    result->iterations = iterations;
+    result->ns_per_op = sorted[repeat / 2];
+    result->min_ns_per_op = sorted[0];
+    result->max_ns_per_op = sorted[repeat - 1];
+    
+    /* Work per op can vary (file sizes, loaded counts); use the median sample's */
+    unsigned int median = 0;
+    for (unsigned int i = 0; i < repeat; i++) {
+        if (samples[i] == result->ns_per_op) {
+            median = i;
+            break;
+        }
+    }
+    double seconds = result->ns_per_op / 1e9;
+    result->passwords_per_sec = seconds > 0 ? passwords[median] / seconds : 0.0;
+    result->mb_per_sec = seconds > 0 ? bytes[median] / seconds / 1e6 : 0.0;
+    return true;
+}
+
+/**
+ * @brief Print the document header
+ */
+static void bench_print_header(void) {
+    if (bench.settings.format == BENCH_FORMAT_CSV) {
+        printf("name,group,iterations,ns_per_op,min_ns_per_op,max_ns_per_op,"
+               "passwords_per_sec,mb_per_sec\n");
+        return;
+    }
+    
+    printf("{\n");
+    printf("  \"program\": \"%s\",\n", PROGRAM_NAME);
+    printf("  \"version\": \"%d.%d.%d\",\n", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
+    printf("  \"min_time_ms\": %u,\n", bench.settings.min_time_ms);
+    printf("  \"repeat\": %u,\n", bench.settings.repeat);
+    printf("  \"e2e_count\": %zu,\n", bench.settings.count);
+    printf("  \"threads\": %zu,\n", bench.settings.threads);
+    printf("  \"results\": [");
+}
+
+/**
+ * @brief Print one result
+ */
+static void bench_print_result(const BenchCase *bench_case, const BenchResult *result,
+                               bool first) {
+    if (bench.settings.format == BENCH_FORMAT_CSV) {
+        printf("%s,%s,%llu,%.1f,%.1f,%.1f,%.0f,%.2f\n", bench_case->name, bench_case->group,
+               (unsigned long long)result->iterations, result->ns_per_op,
+               result->min_ns_per_op, result->max_ns_per_op,
+               result->passwords_per_sec, result->mb_per_sec);
+    } else {
+        printf("%s\n    {\"name\": \"%s\", \"group\": \"%s\", \"iterations\": %llu, "
+               "\"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f, \"max_ns_per_op\": %.1f, "
+               "\"passwords_per_sec\": %.0f, \"mb_per_sec\": %.2f}",
+               first ? "" : ",", bench_case->name, bench_case->group,
+               (unsigned long long)result->iterations, result->ns_per_op,
+               result->min_ns_per_op, result->max_ns_per_op,
+               result->passwords_per_sec, result->mb_per_sec);
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Print the document footer
+ */
+static void bench_print_footer(void) {
+    if (bench.settings.format == BENCH_FORMAT_JSON) {
+        printf("\n  ]\n}\n");
+    }
+}
+
+/**
+ * @brief Print usage
+ */
+static void bench_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --filter TEXT     Run benchmarks whose name contains TEXT\n");
+    fprintf(stderr, "  --min-time MS     Minimum duration of one sample (default: %d)\n",
+            BENCH_DEFAULT_MIN_TIME_MS);
+    fprintf(stderr, "  --repeat N        Samples per benchmark (default: %d)\n",
+            BENCH_DEFAULT_REPEAT);
+    fprintf(stderr, "  --count N         Passwords per end-to-end run (default: %d)\n",
+            BENCH_DEFAULT_COUNT);
+    fprintf(stderr, "  --threads N       Worker threads (default: all CPUs)\n");
+    fprintf(stderr, "  --format FORMAT   json or csv (default: json)\n");
+    fprintf(stderr, "  --list            List benchmark names\n");
+    fprintf(stderr, "  --self-test       Run the crypto known-answer checks and exit\n");
+}
+
+/**
+ * @brief Parse the command line
+ */
+static bool bench_parse_args(int argc, char *argv[], BenchSettings *settings) {
+    settings->filter = NULL;
+    settings->min_time_ms = BENCH_DEFAULT_MIN_TIME_MS;
+    settings->repeat = BENCH_DEFAULT_REPEAT;
+    settings->count = BENCH_DEFAULT_COUNT;
+    settings->threads = 0;
+    settings->format = BENCH_FORMAT_JSON;
+    settings->list = false;
+    settings->self_test = false;
+    
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        int number;
+        
+        if (strcmp(arg, "--list") == 0) {
+            settings->list = true;
+            continue;
+        }
+        if (strcmp(arg, "--self-test") == 0) {
+            settings->self_test = true;
+            continue;
+        }
+        if (!value) {
+            return false;
+        }
+        i++;
+        
+        if (strcmp(arg, "--filter") == 0) {
+            settings->filter = value;
+        } else if (strcmp(arg, "--min-time") == 0 && string_to_int(value, &number, 1, 60000)) {
+            settings->min_time_ms = (unsigned int)number;
+        } else if (strcmp(arg, "--repeat") == 0 && string_to_int(value, &number, 1, 64)) {
+            settings->repeat = (unsigned int)number;
+        } else if (strcmp(arg, "--count") == 0 &&
+                   string_to_int(value, &number, 1, MAX_BULK_GENERATE)) {
+            settings->count = (size_t)number;
+        } else if (strcmp(arg, "--threads") == 0 && string_to_int(value, &number, 1, 1024)) {
+            settings->threads = (size_t)number;
+        } else if (strcmp(arg, "--format") == 0 && strcmp(value, "json") == 0) {
+            settings->format = BENCH_FORMAT_JSON;
+        } else if (strcmp(arg, "--format") == 0 && strcmp(value, "csv") == 0) {
+            settings->format = BENCH_FORMAT_CSV;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Benchmark entry point
+ */
+int main(int argc, char *argv[]) {
+    if (!bench_parse_args(argc, argv, &bench.settings)) {
+        bench_usage(argv[0]);
+        return 2;
+    }
+    
+    if (bench.settings.list) {
+        for (size_t i = 0; i < BENCH_CASE_COUNT; i++) {
+            printf("%s\n", bench_cases[i].name);
+        }
+        return 0;
+    }
+    
+    if (!init_secure_random()) {
+        fprintf(stderr, "Failed to initialize the random source\n");
+        return 1;
+    }
+    
+    if (bench.settings.self_test) {
+        bool passed = bench_self_test();
+        cleanup_secure_random();
+        fprintf(stderr, "Self-test %s\n", passed ? "passed" : "failed");
+        return passed ? 0 : 1;
+    }
+    
+    if (!bench_fixtures_init()) {
+        fprintf(stderr, "Failed to create benchmark fixtures in %s*\n", bench.dir);
+        bench_fixtures_cleanup();
+        cleanup_secure_random();
+        return 1;
+    }
+    
+    int status = 0;
+    bool first = true;
+    bench_print_header();
+    
+    for (size_t i = 0; i < BENCH_CASE_COUNT; i++) {
+        const BenchCase *bench_case = &bench_cases[i];
+        if (bench.settings.filter && !strstr(bench_case->name, bench.settings.filter)) {
+            continue;
+        }
+        
+        BenchResult result;
+        if (!bench_measure(bench_case, &result)) {
+            fprintf(stderr, "Benchmark %s failed\n", bench_case->name);
+            status = 1;
+            continue;
+        }
+        
+        bench_print_result(bench_case, &result, first);
+        first = false;
+    }
+    
+    bench_print_footer();
+    bench_fixtures_cleanup();
+    cleanup_secure_random();
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,378 @@
+/**
+ * @file selftest.c
+ * @brief Known-answer checks for the cryptographic primitives (make test)
+ * @version 1.0
+ * @date 2024
+ *
+ * ChaCha20, Poly1305 and the AEAD are checked against the RFC 8439 test
+ * vectors, SipHash-2-4 against the reference implementation's vectors,
+ * and .enc files are round-tripped through the writer and reader with
+ * every kind of tampering the format has to reject. The built-in weak
+ * pattern tables are checked to fit the scan automaton, and the policy
+ * loop is checked to honour or refuse the per-class minimums.
+ */
+
+#include "selftest.h"
+#include "crypto.h"
+#include "encrypted.h"
+#include "security.h"
+#include "password.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define SELFTEST_MAX_VECTOR 256
+#define SELFTEST_CHUNK_SIZE ENCRYPTED_MIN_CHUNK_SIZE
+#define SELFTEST_MAX_FILE (ENCRYPTED_HEADER_SIZE + 4 * (SELFTEST_CHUNK_SIZE + POLY1305_TAG_SIZE))
+
+/* RFC 8439 section 2.8.2 */
+static const char aead_plaintext[] =
+    "Ladies and Gentlemen of the class of '99: If I could offer you only one "
+    "tip for the future, sunscreen would be it.";
+static const char aead_ciphertext[] =
+    "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+    "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+    "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+    "3ff4def08e4b7a9de576d26586cec64b6116";
+
+/**
+ * @brief SipHash-2-4 of bytes 0..size-1 under key 00..0f (reference vectors)
+ */
+static const struct {
+    size_t size;
+    uint64_t hash;
+} siphash_vectors[] = {
+    {0, UINT64_C(0x726fdb47dd0e0e31)},
+    {1, UINT64_C(0x74f839c593dc67fd)},
+    {8, UINT64_C(0x93f5f5799a932462)},
+    {15, UINT64_C(0xa129ca6149be45e5)},
+    {63, UINT64_C(0x958a324ceb064572)}
+};
+
+static int failures;
+
+/**
+ * @brief Record one check
+ */
+static void check(bool passed, const char *name) {
+    if (!passed) {
+        fprintf(stderr, "self-test failed: %s\n", name);
+        failures++;
+    }
+}
+
+/**
+ * @brief Decode a hex string into a buffer of SELFTEST_MAX_VECTOR bytes
+ * @return Number of bytes
+ */
+static size_t from_hex(const char *hex, unsigned char *out) {
+    size_t size = 0;
+    
+    for (; hex[0] && hex[1] && size < SELFTEST_MAX_VECTOR; hex += 2) {
+        unsigned int byte;
+        if (sscanf(hex, "%2x", &byte) != 1) {
+            break;
+        }
+        out[size++] = (unsigned char)byte;
+    }
+    
+    return size;
+}
+
+/**
+ * @brief Fill a buffer with first, first + 1, ...
+ */
+static void fill_sequence(unsigned char *out, size_t size, unsigned int first) {
+    for (size_t i = 0; i < size; i++) {
+        out[i] = (unsigned char)(first + i);
+    }
+}
+
+/**
+ * @brief ChaCha20 block function (RFC 8439 section 2.3.2)
+ */
+static void test_chacha20_block(void) {
+    unsigned char key[CHACHA20_KEY_SIZE];
+    unsigned char nonce[SELFTEST_MAX_VECTOR];
+    unsigned char expected[SELFTEST_MAX_VECTOR];
+    unsigned char block[CHACHA20_BLOCK_SIZE];
+    
+    fill_sequence(key, sizeof(key), 0);
+    from_hex("000000090000004a00000000", nonce);
+    from_hex("10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e"
+             "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e", expected);
+    
+    chacha20_block(key, 1, nonce, block);
+    check(memcmp(block, expected, sizeof(block)) == 0, "chacha20_block (RFC 8439 2.3.2)");
+}
+
+/**
+ * @brief Poly1305 MAC (RFC 8439 section 2.5.2), whole and split across updates
+ */
+static void test_poly1305(void) {
+    static const char message[] = "Cryptographic Forum Research Group";
+    unsigned char key[SELFTEST_MAX_VECTOR];
+    unsigned char expected[SELFTEST_MAX_VECTOR];
+    unsigned char tag[POLY1305_TAG_SIZE];
+    Poly1305 state;
+    
+    from_hex("85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b", key);
+    from_hex("a8061dc1305136c6c22b8baf0c0127a9", expected);
+    
+    poly1305_init(&state, key);
+    poly1305_update(&state, (const unsigned char *)message, sizeof(message) - 1);
+    poly1305_finish(&state, tag);
+    check(memcmp(tag, expected, sizeof(tag)) == 0, "poly1305 (RFC 8439 2.5.2)");
+    
+    poly1305_init(&state, key);
+    for (size_t i = 0; i < sizeof(message) - 1; i += 5) {
+        size_t take = sizeof(message) - 1 - i < 5 ? sizeof(message) - 1 - i : 5;
+        poly1305_update(&state, (const unsigned char *)message + i, take);
+    }
+    poly1305_finish(&state, tag);
+    check(memcmp(tag, expected, sizeof(tag)) == 0, "poly1305 incremental updates");
+}
+
+/**
+ * @brief ChaCha20-Poly1305 (RFC 8439 section 2.8.2), opening and tamper rejection
+ */
+static void test_aead(void) {
+    unsigned char key[CHACHA20_KEY_SIZE];
+    unsigned char nonce[SELFTEST_MAX_VECTOR];
+    unsigned char aad[SELFTEST_MAX_VECTOR];
+    unsigned char expected[SELFTEST_MAX_VECTOR];
+    unsigned char expected_tag[SELFTEST_MAX_VECTOR];
+    unsigned char data[SELFTEST_MAX_VECTOR];
+    unsigned char tag[POLY1305_TAG_SIZE];
+    size_t size = sizeof(aead_plaintext) - 1;
+    
+    fill_sequence(key, sizeof(key), 0x80);
+    from_hex("070000004041424344454647", nonce);
+    size_t aad_size = from_hex("50515253c0c1c2c3c4c5c6c7", aad);
+    from_hex(aead_ciphertext, expected);
+    from_hex("1ae10b594f09e26a7e902ecbd0600691", expected_tag);
+    
+    memcpy(data, aead_plaintext, size);
+    chacha20_poly1305_seal(key, nonce, aad, aad_size, data, size, tag);
+    check(memcmp(data, expected, size) == 0, "chacha20_poly1305_seal ciphertext (RFC 8439 2.8.2)");
+    check(memcmp(tag, expected_tag, sizeof(tag)) == 0, "chacha20_poly1305_seal tag (RFC 8439 2.8.2)");
+    
+    check(chacha20_poly1305_open(key, nonce, aad, aad_size, data, size, tag) &&
+          memcmp(data, aead_plaintext, size) == 0, "chacha20_poly1305_open round trip");
+    
+    /* Any flipped bit in the ciphertext, tag or associated data must be rejected */
+    memcpy(data, expected, size);
+    data[size / 2] ^= 0x01;
+    check(!chacha20_poly1305_open(key, nonce, aad, aad_size, data, size, tag) &&
+          data[size / 2] == (expected[size / 2] ^ 0x01), "chacha20_poly1305_open flipped ciphertext");
+    
+    data[size / 2] ^= 0x01;
+    tag[POLY1305_TAG_SIZE - 1] ^= 0x80;
+    check(!chacha20_poly1305_open(key, nonce, aad, aad_size, data, size, tag),
+          "chacha20_poly1305_open flipped tag");
+    
+    tag[POLY1305_TAG_SIZE - 1] ^= 0x80;
+    aad[0] ^= 0x01;
+    check(!chacha20_poly1305_open(key, nonce, aad, aad_size, data, size, tag),
+          "chacha20_poly1305_open flipped associated data");
+}
+
+/**
+ * @brief SipHash-2-4 reference vectors
+ */
+static void test_siphash(void) {
+    unsigned char key[SIPHASH_KEY_SIZE];
+    unsigned char message[64];
+    
+    fill_sequence(key, sizeof(key), 0);
+    fill_sequence(message, sizeof(message), 0);
+    
+    for (size_t i = 0; i < sizeof(siphash_vectors) / sizeof(siphash_vectors[0]); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "siphash24 (%zu-byte reference vector)",
+                 siphash_vectors[i].size);
+        check(siphash24(key, message, siphash_vectors[i].size) == siphash_vectors[i].hash, name);
+    }
+}
+
+/**
+ * @brief In-memory EncryptedSink
+ */
+typedef struct {
+    unsigned char data[SELFTEST_MAX_FILE];
+    size_t size;
+} SelfTestFile;
+
+static bool selftest_sink(void *context, const unsigned char *data, size_t size) {
+    SelfTestFile *file = (SelfTestFile *)context;
+    
+    if (size > sizeof(file->data) - file->size) {
+        return false;
+    }
+    memcpy(file->data + file->size, data, size);
+    file->size += size;
+    return true;
+}
+
+/**
+ * @brief Decrypt a file image into a scratch buffer
+ * @return true if it authenticated and matched the expected plaintext
+ */
+static bool selftest_decrypts_to(const unsigned char *key, const unsigned char *data, size_t size,
+                                 const unsigned char *plaintext, size_t plaintext_size) {
+    static unsigned char out[SELFTEST_MAX_FILE];
+    
+    return encrypted_plaintext_size(data, size) == plaintext_size &&
+           encrypted_decrypt(key, data, size, out) &&
+           memcmp(out, plaintext, plaintext_size) == 0;
+}
+
+/**
+ * @brief Check that a file image fails to authenticate
+ */
+static bool selftest_rejects(const unsigned char *key, const unsigned char *data, size_t size) {
+    static unsigned char out[SELFTEST_MAX_FILE];
+    
+    return !encrypted_decrypt(key, data, size, out);
+}
+
+/**
+ * @brief Write one .enc image of size plaintext bytes, read it back and tamper with it
+ */
+static void test_encrypted_file(size_t size) {
+    static SelfTestFile file;
+    static unsigned char plaintext[3 * SELFTEST_CHUNK_SIZE];
+    unsigned char key[ENCRYPTED_KEY_SIZE];
+    unsigned char other_key[ENCRYPTED_KEY_SIZE];
+    EncryptedWriter writer;
+    char name[96];
+    
+    fill_sequence(key, sizeof(key), 0x40);
+    memcpy(other_key, key, sizeof(key));
+    other_key[0] ^= 0x01;
+    fill_sequence(plaintext, size, 7);
+    file.size = 0;
+    
+    /* Uneven writes so chunk boundaries fall inside a call */
+    bool ok = encrypted_writer_init(&writer, key, SELFTEST_CHUNK_SIZE, selftest_sink, &file);
+    for (size_t i = 0; ok && i < size; i += 333) {
+        ok = encrypted_writer_write(&writer, plaintext + i, size - i < 333 ? size - i : 333);
+    }
+    ok = ok && encrypted_writer_finish(&writer);
+    encrypted_writer_wipe(&writer);
+    
+    snprintf(name, sizeof(name), ".enc round trip (%zu bytes)", size);
+    check(ok && encrypted_has_header(file.data, file.size) &&
+          selftest_decrypts_to(key, file.data, file.size, plaintext, size), name);
+    if (!ok) {
+        return;
+    }
+    
+    snprintf(name, sizeof(name), ".enc wrong key (%zu bytes)", size);
+    check(selftest_rejects(other_key, file.data, file.size), name);
+    
+    /* A flipped byte anywhere, header included, must fail to authenticate */
+    size_t offsets[] = {9, ENCRYPTED_HEADER_SIZE + 16, ENCRYPTED_HEADER_SIZE, file.size / 2,
+                        file.size - 1};
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        if (offsets[i] >= file.size) {
+            continue;
+        }
+        file.data[offsets[i]] ^= 0x20;
+        snprintf(name, sizeof(name), ".enc flipped byte %zu (%zu bytes)", offsets[i], size);
+        check(selftest_rejects(key, file.data, file.size), name);
+        file.data[offsets[i]] ^= 0x20;
+    }
+    
+    /* Dropping the last chunk leaves a non-final chunk at the end */
+    size_t record = SELFTEST_CHUNK_SIZE + POLY1305_TAG_SIZE;
+    if (file.size > ENCRYPTED_HEADER_SIZE + record) {
+        size_t truncated = ENCRYPTED_HEADER_SIZE +
+                           (file.size - ENCRYPTED_HEADER_SIZE - 1) / record * record;
+        snprintf(name, sizeof(name), ".enc dropped final chunk (%zu bytes)", size);
+        check(selftest_rejects(key, file.data, truncated), name);
+    }
+    
+    snprintf(name, sizeof(name), ".enc truncated tag (%zu bytes)", size);
+    check(selftest_rejects(key, file.data, file.size - 1), name);
+}
+
+/**
+ * @brief Weak-pattern automaton holds every built-in pattern
+ */
+static void test_patterns(void) {
+    static const char dictionary[] = "Sh4d0w!";
+    static const char weak[] = "xzqwertyq";
+    
+    check(security_patterns_complete(), "pattern tables fit the automaton");
+    check(scan_password_patterns(dictionary, sizeof(dictionary) - 1).has_dictionary_word,
+          "dictionary word with case and leet");
+    check(scan_password_patterns(weak, sizeof(weak) - 1).has_weak_pattern,
+          "keyboard pattern");
+}
+
+/**
+ * @brief Per-class minimums: refused when they cannot fit, met when they just fit
+ */
+static void test_policy(void) {
+    PasswordOptions options = password_options_init();
+    CompiledCharset charset;
+    
+    options.length = 8;
+    options.charset.lowercase = true;
+    options.charset.uppercase = true;
+    options.charset.numbers = true;
+    options.charset.special = true;
+    options.charset.avoid_ambiguous = false;
+    options.require_all_types = true;
+    options.min_numbers = 4;
+    options.min_special = 4;
+    
+    check(!validate_options(&options), "impossible minimums refused by validate_options");
+    check(!compile_charset(&options, &charset), "impossible minimums refused by compile_charset");
+    
+    /* 1 + 1 + 3 + 3 fills the length; one attempt forces the repair path */
+    options.min_numbers = 3;
+    options.min_special = 3;
+    options.max_attempts = 1;
+    check(validate_options(&options), "tight minimums accepted");
+    
+    for (int i = 0; i < 64; i++) {
+        PasswordResult result = generate_password(&options);
+        size_t numbers = 0;
+        size_t special = 0;
+        
+        check(result.password != NULL, "tight minimums generate");
+        if (!result.password) {
+            return;
+        }
+        for (size_t j = 0; j < result.length; j++) {
+            numbers += strchr(CHARSET_NUMBERS, result.password[j]) != NULL;
+            special += strchr(CHARSET_SPECIAL, result.password[j]) != NULL;
+        }
+        check(numbers >= 3 && special >= 3, "tight minimums met");
+        free_password_result(&result);
+    }
+}
+
+/**
+ * @brief Run every known-answer and round-trip check
+ */
+bool bench_self_test(void) {
+    failures = 0;
+    
+    test_chacha20_block();
+    test_poly1305();
+    test_aead();
+    test_siphash();
+    test_patterns();
+    test_policy();
+    test_encrypted_file(0);
+    test_encrypted_file(100);
+    test_encrypted_file(SELFTEST_CHUNK_SIZE);
+    test_encrypted_file(2 * SELFTEST_CHUNK_SIZE + SELFTEST_CHUNK_SIZE / 2);
+    
+    return failures == 0;
+}
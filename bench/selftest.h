@@ -0,0 +1,22 @@
+/**
+ * @file selftest.h
+ * @brief Known-answer checks for the cryptographic primitives (make test)
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef SELFTEST_H
+#define SELFTEST_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Run every known-answer and round-trip check
+ * @return true if all checks passed, false otherwise
+ *
+ * Each failure is reported on stderr; the secure random source must be
+ * initialized first.
+ */
+bool bench_self_test(void);
+
+#endif /* SELFTEST_H */
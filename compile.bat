@@ -17,14 +17,27 @@ if not exist bin mkdir binls
 echo Compiling...
 gcc -c src/main.c -o build/main.o -Wall -Wextra -O2
 gcc -c src/password.c -o build/password.o -Wall -Wextra -O2
+gcc -c src/sampler.c -o build/sampler.o -Wall -Wextra -O2
+gcc -c src/crypto.c -o build/crypto.o -Wall -Wextra -O2
+gcc -c src/parallel.c -o build/parallel.o -Wall -Wextra -O2
 gcc -c src/security.c -o build/security.o -Wall -Wextra -O2
+gcc -c src/breach.c -o build/breach.o -Wall -Wextra -O2
+gcc -c src/audit.c -o build/audit.o -Wall -Wextra -O2
+gcc -c src/server.c -o build/server.o -Wall -Wextra -O2
+gcc -c src/stats.c -o build/stats.o -Wall -Wextra -O2
+gcc -c src/passphrase.c -o build/passphrase.o -Wall -Wextra -O2
+gcc -c src/pattern.c -o build/pattern.o -Wall -Wextra -O2
+gcc -c src/dedup.c -o build/dedup.o -Wall -Wextra -O2
+gcc -c src/history.c -o build/history.o -Wall -Wextra -O2
+gcc -c src/encrypted.c -o build/encrypted.o -Wall -Wextra -O2
+gcc -c src/spg_archive.c -o build/spg_archive.o -Wall -Wextra -O2
 gcc -c src/ui.c -o build/ui.o -Wall -Wextra -O2
 gcc -c src/clipboard.c -o build/clipboard.o -Wall -Wextra -O2
 gcc -c src/utils.c -o build/utils.o -Wall -Wextra -O2
 gcc -c src/file_ops.c -o build/file_ops.o -Wall -Wextra -O2
 
 echo Linking...
-gcc build/main.o build/password.o build/security.o build/ui.o build/clipboard.o build/utils.o build/file_ops.o -o bin/passgen.exe -lm
+gcc build/main.o build/password.o build/sampler.o build/crypto.o build/parallel.o build/security.o build/breach.o build/audit.o build/server.o build/stats.o build/passphrase.o build/pattern.o build/dedup.o build/history.o build/encrypted.o build/spg_archive.o build/ui.o build/clipboard.o build/utils.o build/file_ops.o -o bin/passgen.exe -lbcrypt -lm
 
 echo.
 echo Done! Executable created: bin\passgen.exe
@@ -0,0 +1,625 @@
+/**
+ * @file audit.c
+ * @brief Parallel security audit of existing password files implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "audit.h"
+#include "password.h"
+#include "crypto.h"
+#include "parallel.h"
+#include "utils.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/* Chunks in flight: one being read, one being written, the rest assessed */
+#define AUDIT_SLOTS 4
+
+/* Entries a thread assesses per claim */
+#define AUDIT_BLOCK_SIZE 128
+
+/**
+ * @brief Pipeline stage of a slot
+ */
+typedef enum {
+    AUDIT_SLOT_FREE,        /**< Empty, ready for the reader */
+    AUDIT_SLOT_READING,     /**< Being filled by the reader */
+    AUDIT_SLOT_FILLED,      /**< Entries being assessed */
+    AUDIT_SLOT_WRITING      /**< Being written by the writer */
+} AuditSlotState;
+
+/**
+ * @brief One chunk of the file with its per-entry results
+ */
+typedef struct {
+    PasswordBatch batch;    /**< Passwords, scores, levels and entropy */
+    uint64_t *lines;        /**< Source line of each entry */
+    uint64_t *hashes;       /**< Keyed hash of each entry (duplicate detection) */
+    uint8_t *categories;    /**< StrengthCategory of each entry */
+    uint8_t *flags;         /**< AUDIT_FLAG_* bits of each entry */
+    AuditSlotState state;   /**< Pipeline stage */
+    uint64_t sequence;      /**< Chunk number in file order */
+    size_t next;            /**< First entry not yet claimed for assessment */
+    size_t finished;        /**< Entries assessed */
+} AuditSlot;
+
+/**
+ * @brief Set of entry hashes seen so far (open addressing, 0 = empty)
+ */
+typedef struct {
+    uint64_t *table;
+    size_t capacity;
+    size_t used;
+} AuditHashSet;
+
+/**
+ * @brief State shared by every pipeline thread
+ */
+typedef struct {
+    ParallelMutex lock;
+    ParallelCond changed;
+    AuditSlot slots[AUDIT_SLOTS];
+    const AuditOptions *options;
+    unsigned char hash_key[SIPHASH_KEY_SIZE];
+    
+    /* Reader (one thread at a time) */
+    PasswordFile input;
+    bool reading;
+    bool eof;
+    uint64_t read_sequence;
+    uint64_t skipped;
+    
+    /* Writer (one thread at a time, in sequence order) */
+    FILE *output;
+    OutputBuffer out;
+    ExportFormat format;
+    bool writing;
+    uint64_t write_sequence;
+    AuditHashSet seen;
+    AuditSummary *summary;
+    
+    bool failed;
+} AuditPipeline;
+
+/**
+ * @brief Get default audit settings
+ */
+AuditOptions audit_options_init(void) {
+    AuditOptions options;
+    
+    options.threads = 0;
+    options.similarity_threshold = AUDIT_SIMILARITY_THRESHOLD;
+    options.similarity_window = AUDIT_SIMILARITY_WINDOW;
+    
+    return options;
+}
+
+/**
+ * @brief Insert a hash, reporting whether it was already present
+ * @return true if the hash was seen before
+ */
+static bool audit_hash_set_insert(AuditHashSet *set, uint64_t hash, bool *failed) {
+    if (hash == 0) {
+        hash = 1;   /* 0 marks empty slots */
+    }
+    
+    /* Keep the load factor at or below one half */
+    if ((set->used + 1) * 2 > set->capacity) {
+        size_t capacity = set->capacity ? set->capacity * 2 : 4096;
+        uint64_t *table = (uint64_t *)calloc(capacity, sizeof(uint64_t));
+        if (!table) {
+            *failed = true;
+            return false;
+        }
+    
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (set->table[i] != 0) {
+                size_t pos = (size_t)set->table[i] & (capacity - 1);
+                while (table[pos] != 0) {
+                    pos = (pos + 1) & (capacity - 1);
+                }
+                table[pos] = set->table[i];
+            }
+        }
+    
+        free(set->table);
+        set->table = table;
+        set->capacity = capacity;
+    }
+    
+    size_t pos = (size_t)hash & (set->capacity - 1);
+    while (set->table[pos] != 0) {
+        if (set->table[pos] == hash) {
+            return true;
+        }
+        pos = (pos + 1) & (set->capacity - 1);
+    }
+    
+    set->table[pos] = hash;
+    set->used++;
+    return false;
+}
+
+/**
+ * @brief Allocate the per-entry columns of a slot
+ */
+static bool audit_slot_init(AuditSlot *slot) {
+    memset(slot, 0, sizeof(AuditSlot));
+    
+    if (!password_batch_init(&slot->batch, AUDIT_CHUNK_SIZE, MAX_INPUT_LENGTH - 1)) {
+        return false;
+    }
+    
+    slot->lines = (uint64_t *)calloc(AUDIT_CHUNK_SIZE, sizeof(uint64_t));
+    slot->hashes = (uint64_t *)calloc(AUDIT_CHUNK_SIZE, sizeof(uint64_t));
+    slot->categories = (uint8_t *)calloc(AUDIT_CHUNK_SIZE, sizeof(uint8_t));
+    slot->flags = (uint8_t *)calloc(AUDIT_CHUNK_SIZE, sizeof(uint8_t));
+    
+    return slot->lines && slot->hashes && slot->categories && slot->flags;
+}
+
+/**
+ * @brief Release a slot
+ */
+static void audit_slot_free(AuditSlot *slot) {
+    password_batch_free(&slot->batch);
+    free(slot->lines);
+    free(slot->hashes);
+    free(slot->categories);
+    free(slot->flags);
+    memset(slot, 0, sizeof(AuditSlot));
+}
+
+/**
+ * @brief Fill a slot with the next chunk of the input (reader role)
+ * @return true once the input is exhausted
+ */
+static bool audit_read_chunk(AuditPipeline *pipeline, AuditSlot *slot) {
+    PasswordView view;
+    
+    password_batch_clear(&slot->batch);
+    
+    while (slot->batch.count < AUDIT_CHUNK_SIZE) {
+        if (!password_file_next(&pipeline->input, &view)) {
+            return true;
+        }
+        
+        /* Entries too long for a batch slot are reported, not silently lost */
+        if (!password_batch_append(&slot->batch, view.data, view.length)) {
+            fprintf(stderr, "Line %llu: skipped, %zu bytes exceeds the %d-byte audit limit\n",
+                    (unsigned long long)view.line, view.length, MAX_INPUT_LENGTH - 1);
+            pipeline->skipped++;
+            continue;
+        }
+        slot->lines[slot->batch.count - 1] = view.line;
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Assess entries [begin, end) of a slot (worker role)
+ */
+static void audit_assess_block(const AuditPipeline *pipeline, AuditSlot *slot,
+                               size_t begin, size_t end) {
+    const PasswordBatch *batch = &slot->batch;
+    const AuditOptions *options = pipeline->options;
+    
+    for (size_t i = begin; i < end; i++) {
+        const char *password = batch->chars + i * batch->stride;
+        size_t length = batch->lengths[i];
+    
+        SecurityAssessment assessment = assess_password_security(password, length);
+    
+        uint8_t flags = 0;
+        if (assessment.has_weak_pattern) flags |= AUDIT_FLAG_WEAK;
+        if (assessment.has_dictionary_word) flags |= AUDIT_FLAG_DICTIONARY;
+    
+        /* Compare with the entries just before this one in the chunk */
+        if (options->similarity_threshold > 0.0) {
+            size_t first = i > options->similarity_window ? i - options->similarity_window : 0;
+            for (size_t j = first; j < i; j++) {
+                if (are_passwords_similar(password, batch->chars + j * batch->stride,
+                                          options->similarity_threshold)) {
+                    flags |= AUDIT_FLAG_SIMILAR;
+                    break;
+                }
+            }
+        }
+    
+        batch->scores[i] = (uint8_t)assessment.score;
+        batch->levels[i] = get_strength_level(assessment.score);
+        batch->entropy[i] = assessment.entropy;
+        slot->categories[i] = (uint8_t)assessment.category;
+        slot->hashes[i] = siphash24(pipeline->hash_key, password, length);
+        slot->flags[i] = flags;
+    }
+}
+
+/**
+ * @brief Write the document header
+ */
+static void audit_write_header(AuditPipeline *pipeline, const char *input) {
+    OutputBuffer *out = &pipeline->out;
+    char timestamp[64];
+    get_timestamp(timestamp, sizeof(timestamp), NULL);
+    
+    switch (pipeline->format) {
+        case EXPORT_FORMAT_TEXT:
+            output_buffer_puts(out, "=== Password Audit ===\n");
+            output_buffer_printf(out, "Source: %s\n", input);
+            output_buffer_printf(out, "Audited: %s\n", timestamp);
+            output_buffer_puts(out, "======================\n\n");
+            break;
+            
+        case EXPORT_FORMAT_CSV:
+            output_buffer_puts(out, "Line,Length,Score,Strength,Entropy,Weak,Dictionary,Duplicate,Similar\n");
+            break;
+            
+        case EXPORT_FORMAT_JSON:
+            output_buffer_puts(out, "{\n");
+            output_buffer_printf(out, "  \"audited\": \"%s\",\n", timestamp);
+            output_buffer_puts(out, "  \"entries\": [");
+            break;
+            
+        case EXPORT_FORMAT_PLAIN:
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Write a slot's results in file order and fold them into the summary (writer role)
+ * @return false on a write or allocation error
+ */
+static bool audit_write_chunk(AuditPipeline *pipeline, AuditSlot *slot) {
+    const PasswordBatch *batch = &slot->batch;
+    AuditSummary *summary = pipeline->summary;
+    OutputBuffer *out = &pipeline->out;
+    bool failed = false;
+    
+    for (size_t i = 0; i < batch->count; i++) {
+        if (audit_hash_set_insert(&pipeline->seen, slot->hashes[i], &failed)) {
+            slot->flags[i] |= AUDIT_FLAG_DUPLICATE;
+        }
+    
+        uint8_t flags = slot->flags[i];
+        StrengthCategory category = (StrengthCategory)slot->categories[i];
+        const char *strength = get_strength_string(category);
+        size_t bucket = (size_t)(batch->entropy[i] / AUDIT_ENTROPY_BUCKET_BITS);
+        if (bucket >= AUDIT_ENTROPY_BUCKETS) {
+            bucket = AUDIT_ENTROPY_BUCKETS - 1;
+        }
+    
+        summary->total++;
+        summary->strength[category]++;
+        summary->entropy[bucket]++;
+        summary->entropy_sum += batch->entropy[i];
+        summary->score_sum += batch->scores[i];
+        if (flags & AUDIT_FLAG_WEAK) summary->weak++;
+        if (flags & AUDIT_FLAG_DICTIONARY) summary->dictionary++;
+        if (flags & AUDIT_FLAG_DUPLICATE) summary->duplicates++;
+        if (flags & AUDIT_FLAG_SIMILAR) summary->similar++;
+    
+        switch (pipeline->format) {
+            case EXPORT_FORMAT_TEXT:
+                output_buffer_printf(out, "Line %-8llu %3u/100  %-11s %6.1f bits%s%s%s%s\n",
+                                     (unsigned long long)slot->lines[i], (unsigned)batch->scores[i],
+                                     strength, batch->entropy[i],
+                                     (flags & AUDIT_FLAG_WEAK) ? "  weak-pattern" : "",
+                                     (flags & AUDIT_FLAG_DICTIONARY) ? "  dictionary" : "",
+                                     (flags & AUDIT_FLAG_DUPLICATE) ? "  duplicate" : "",
+                                     (flags & AUDIT_FLAG_SIMILAR) ? "  similar" : "");
+                break;
+                
+            case EXPORT_FORMAT_CSV:
+                output_buffer_put_uint(out, slot->lines[i], 1);
+                output_buffer_putc(out, ',');
+                output_buffer_put_uint(out, batch->lengths[i], 1);
+                output_buffer_putc(out, ',');
+                output_buffer_put_uint(out, batch->scores[i], 1);
+                output_buffer_putc(out, ',');
+                output_buffer_puts(out, strength);
+                output_buffer_putc(out, ',');
+                output_buffer_put_fixed(out, batch->entropy[i], 2);
+                output_buffer_puts(out, (flags & AUDIT_FLAG_WEAK) ? ",1" : ",0");
+                output_buffer_puts(out, (flags & AUDIT_FLAG_DICTIONARY) ? ",1" : ",0");
+                output_buffer_puts(out, (flags & AUDIT_FLAG_DUPLICATE) ? ",1" : ",0");
+                output_buffer_puts(out, (flags & AUDIT_FLAG_SIMILAR) ? ",1\n" : ",0\n");
+                break;
+                
+            case EXPORT_FORMAT_JSON:
+                if (summary->total > 1) {
+                    output_buffer_putc(out, ',');
+                }
+                output_buffer_literal(out, "\n    {\"line\": ");
+                output_buffer_put_uint(out, slot->lines[i], 1);
+                output_buffer_literal(out, ", \"length\": ");
+                output_buffer_put_uint(out, batch->lengths[i], 1);
+                output_buffer_literal(out, ", \"score\": ");
+                output_buffer_put_uint(out, batch->scores[i], 1);
+                output_buffer_literal(out, ", \"strength\": \"");
+                output_buffer_puts(out, strength);
+                output_buffer_literal(out, "\", \"entropy\": ");
+                output_buffer_put_fixed(out, batch->entropy[i], 2);
+                output_buffer_literal(out, ", \"weak\": ");
+                output_buffer_puts(out, (flags & AUDIT_FLAG_WEAK) ? "true" : "false");
+                output_buffer_literal(out, ", \"dictionary\": ");
+                output_buffer_puts(out, (flags & AUDIT_FLAG_DICTIONARY) ? "true" : "false");
+                output_buffer_literal(out, ", \"duplicate\": ");
+                output_buffer_puts(out, (flags & AUDIT_FLAG_DUPLICATE) ? "true" : "false");
+                output_buffer_literal(out, ", \"similar\": ");
+                output_buffer_puts(out, (flags & AUDIT_FLAG_SIMILAR) ? "true}" : "false}");
+                break;
+                
+            case EXPORT_FORMAT_PLAIN:
+            default:
+                output_buffer_put_uint(out, slot->lines[i], 1);
+                output_buffer_putc(out, '\t');
+                output_buffer_put_uint(out, batch->scores[i], 1);
+                output_buffer_putc(out, '\t');
+                output_buffer_puts(out, strength);
+                output_buffer_putc(out, '\t');
+                output_buffer_put_fixed(out, batch->entropy[i], 1);
+                output_buffer_putc(out, '\t');
+                output_buffer_put_uint(out, flags, 1);
+                output_buffer_putc(out, '\n');
+                break;
+        }
+    }
+    
+    return !failed && !out->failed;
+}
+
+/**
+ * @brief Write the document footer with the aggregate histograms
+ */
+static void audit_write_footer(AuditPipeline *pipeline) {
+    const AuditSummary *summary = pipeline->summary;
+    OutputBuffer *out = &pipeline->out;
+    
+    switch (pipeline->format) {
+        case EXPORT_FORMAT_TEXT:
+            output_buffer_printf(out, "\nAudited: %llu passwords\n", (unsigned long long)summary->total);
+            for (int i = 0; i < AUDIT_STRENGTH_BUCKETS; i++) {
+                output_buffer_printf(out, "Strength %-11s %llu\n", get_strength_string((StrengthCategory)i),
+                                     (unsigned long long)summary->strength[i]);
+            }
+            output_buffer_printf(out, "Weak patterns: %llu\nDictionary words: %llu\n"
+                                 "Duplicates: %llu\nSimilar: %llu\nSkipped (too long): %llu\n",
+                                 (unsigned long long)summary->weak, (unsigned long long)summary->dictionary,
+                                 (unsigned long long)summary->duplicates, (unsigned long long)summary->similar,
+                                 (unsigned long long)summary->skipped);
+            break;
+    
+        case EXPORT_FORMAT_JSON:
+            output_buffer_printf(out, "%s],\n", summary->total > 0 ? "\n  " : "");
+            output_buffer_printf(out, "  \"summary\": {\n");
+            output_buffer_printf(out, "    \"total\": %llu,\n", (unsigned long long)summary->total);
+            output_buffer_printf(out, "    \"strength\": [");
+            for (int i = 0; i < AUDIT_STRENGTH_BUCKETS; i++) {
+                output_buffer_printf(out, "%s%llu", i ? ", " : "", (unsigned long long)summary->strength[i]);
+            }
+            output_buffer_printf(out, "],\n    \"entropy_buckets\": [");
+            for (int i = 0; i < AUDIT_ENTROPY_BUCKETS; i++) {
+                output_buffer_printf(out, "%s%llu", i ? ", " : "", (unsigned long long)summary->entropy[i]);
+            }
+            output_buffer_printf(out, "],\n");
+            output_buffer_printf(out, "    \"weak\": %llu,\n", (unsigned long long)summary->weak);
+            output_buffer_printf(out, "    \"dictionary\": %llu,\n", (unsigned long long)summary->dictionary);
+            output_buffer_printf(out, "    \"duplicates\": %llu,\n", (unsigned long long)summary->duplicates);
+            output_buffer_printf(out, "    \"similar\": %llu,\n", (unsigned long long)summary->similar);
+            output_buffer_printf(out, "    \"skipped\": %llu\n", (unsigned long long)summary->skipped);
+            output_buffer_printf(out, "  }\n}\n");
+            break;
+    
+        case EXPORT_FORMAT_CSV:
+        case EXPORT_FORMAT_PLAIN:
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Pipeline thread: take the most urgent ready job until the file is done
+ *
+ * Writing beats assessing beats reading, so finished chunks drain first and
+ * slots are recycled quickly. Each role only needs the shared lock to be
+ * claimed, so a single thread can run the whole pipeline on its own.
+ */
+static void audit_worker(void *context, size_t index, size_t count) {
+    AuditPipeline *pipeline = (AuditPipeline *)context;
+    (void)index;
+    (void)count;
+    
+    parallel_mutex_lock(&pipeline->lock);
+    
+    while (!pipeline->failed &&
+           !(pipeline->eof && !pipeline->reading &&
+             pipeline->write_sequence == pipeline->read_sequence)) {
+        AuditSlot *slot = NULL;
+    
+        /* Write the next chunk in file order once every entry is assessed */
+        if (!pipeline->writing) {
+            for (size_t i = 0; i < AUDIT_SLOTS; i++) {
+                AuditSlot *candidate = &pipeline->slots[i];
+                if (candidate->state == AUDIT_SLOT_FILLED &&
+                    candidate->sequence == pipeline->write_sequence &&
+                    candidate->finished == candidate->batch.count) {
+                    slot = candidate;
+                    break;
+                }
+            }
+    
+            if (slot) {
+                slot->state = AUDIT_SLOT_WRITING;
+                pipeline->writing = true;
+                parallel_mutex_unlock(&pipeline->lock);
+    
+                bool written = audit_write_chunk(pipeline, slot);
+                password_batch_clear(&slot->batch);
+    
+                parallel_mutex_lock(&pipeline->lock);
+                if (!written) {
+                    pipeline->failed = true;
+                }
+                slot->state = AUDIT_SLOT_FREE;
+                pipeline->writing = false;
+                pipeline->write_sequence++;
+                parallel_cond_broadcast(&pipeline->changed);
+                continue;
+            }
+        }
+    
+        /* Assess a block of the oldest chunk with unclaimed entries */
+        for (size_t i = 0; i < AUDIT_SLOTS; i++) {
+            AuditSlot *candidate = &pipeline->slots[i];
+            if (candidate->state == AUDIT_SLOT_FILLED && candidate->next < candidate->batch.count &&
+                (!slot || candidate->sequence < slot->sequence)) {
+                slot = candidate;
+            }
+        }
+    
+        if (slot) {
+            size_t begin = slot->next;
+            size_t end = begin + AUDIT_BLOCK_SIZE < slot->batch.count ?
+                         begin + AUDIT_BLOCK_SIZE : slot->batch.count;
+            slot->next = end;
+            parallel_mutex_unlock(&pipeline->lock);
+    
+            audit_assess_block(pipeline, slot, begin, end);
+    
+            parallel_mutex_lock(&pipeline->lock);
+            slot->finished += end - begin;
+            if (slot->finished == slot->batch.count) {
+                parallel_cond_broadcast(&pipeline->changed);
+            }
+            continue;
+        }
+    
+        /* Read the next chunk into a free slot */
+        if (!pipeline->reading && !pipeline->eof) {
+            for (size_t i = 0; i < AUDIT_SLOTS; i++) {
+                if (pipeline->slots[i].state == AUDIT_SLOT_FREE) {
+                    slot = &pipeline->slots[i];
+                    break;
+                }
+            }
+    
+            if (slot) {
+                slot->state = AUDIT_SLOT_READING;
+                pipeline->reading = true;
+                parallel_mutex_unlock(&pipeline->lock);
+    
+                bool eof = audit_read_chunk(pipeline, slot);
+    
+                parallel_mutex_lock(&pipeline->lock);
+                pipeline->reading = false;
+                pipeline->eof = eof;
+                if (slot->batch.count > 0) {
+                    slot->sequence = pipeline->read_sequence++;
+                    slot->next = 0;
+                    slot->finished = 0;
+                    slot->state = AUDIT_SLOT_FILLED;
+                } else {
+                    slot->state = AUDIT_SLOT_FREE;
+                }
+                parallel_cond_broadcast(&pipeline->changed);
+                continue;
+            }
+        }
+    
+        parallel_cond_wait(&pipeline->changed, &pipeline->lock);
+    }
+    
+    parallel_cond_broadcast(&pipeline->changed);
+    parallel_mutex_unlock(&pipeline->lock);
+}
+
+/**
+ * @brief Audit every password in a password file
+ */
+bool audit_password_file(const char *input, const char *output, ExportFormat format,
+                         const AuditOptions *options, AuditSummary *summary) {
+    if (!input || !summary) {
+        return false;
+    }
+    
+    memset(summary, 0, sizeof(AuditSummary));
+    
+    AuditOptions defaults = audit_options_init();
+    if (!options) {
+        options = &defaults;
+    }
+    
+    AuditPipeline *pipeline = (AuditPipeline *)calloc(1, sizeof(AuditPipeline));
+    if (!pipeline) {
+        return false;
+    }
+    
+    pipeline->options = options;
+    pipeline->summary = summary;
+    pipeline->format = format;
+    
+    if (!password_file_open(&pipeline->input, input, false)) {
+        free(pipeline);
+        return false;
+    }
+    
+    if (!output || strcmp(output, "-") == 0) {
+        pipeline->output = stdout;
+    } else {
+        pipeline->output = fopen(output, "w");
+        if (!pipeline->output) {
+            fprintf(stderr, "Error opening file %s: %s\n", output, strerror(errno));
+            password_file_close(&pipeline->input);
+            free(pipeline);
+            return false;
+        }
+    }
+    
+    bool ok = get_random_bytes(pipeline->hash_key, sizeof(pipeline->hash_key)) &&
+              output_buffer_init(&pipeline->out, pipeline->output);
+    for (size_t i = 0; ok && i < AUDIT_SLOTS; i++) {
+        ok = audit_slot_init(&pipeline->slots[i]);
+    }
+    
+    if (ok) {
+        parallel_mutex_init(&pipeline->lock);
+        parallel_cond_init(&pipeline->changed);
+    
+        audit_write_header(pipeline, input);
+        ok = parallel_run(options->threads, audit_worker, pipeline) && !pipeline->failed;
+        summary->skipped = pipeline->skipped;
+        if (ok) {
+            audit_write_footer(pipeline);
+        }
+    
+        parallel_cond_destroy(&pipeline->changed);
+        parallel_mutex_destroy(&pipeline->lock);
+    }
+    
+    if (pipeline->out.data && !output_buffer_free(&pipeline->out)) {
+        ok = false;
+    }
+    if (fflush(pipeline->output) != 0 || ferror(pipeline->output)) {
+        ok = false;
+    }
+    if (pipeline->output != stdout) {
+        fclose(pipeline->output);
+    }
+    password_file_close(&pipeline->input);
+    
+    for (size_t i = 0; i < AUDIT_SLOTS; i++) {
+        audit_slot_free(&pipeline->slots[i]);
+    }
+    free(pipeline->seen.table);
+    secure_clear(pipeline->hash_key, sizeof(pipeline->hash_key));
+    free(pipeline);
+    
+    return ok;
+}
\ No newline at end of file
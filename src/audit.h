@@ -0,0 +1,85 @@
+/**
+ * @file audit.h
+ * @brief Parallel security audit of existing password files
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef AUDIT_H
+#define AUDIT_H
+
+#include "file_ops.h"
+#include "security.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Entry flags reported by the audit
+ */
+#define AUDIT_FLAG_WEAK       0x01  /**< Contains a weak pattern */
+#define AUDIT_FLAG_DICTIONARY 0x02  /**< Contains a dictionary or breached word */
+#define AUDIT_FLAG_DUPLICATE  0x04  /**< Same as an earlier entry */
+#define AUDIT_FLAG_SIMILAR    0x08  /**< Close to one of the entries just before it */
+
+/**
+ * @brief Entropy histogram layout (bucket i covers [i * 16, (i + 1) * 16) bits)
+ */
+#define AUDIT_ENTROPY_BUCKET_BITS 16
+#define AUDIT_ENTROPY_BUCKETS 9     /**< Last bucket collects 128 bits and above */
+
+/**
+ * @brief Number of strength categories counted in the histogram
+ */
+#define AUDIT_STRENGTH_BUCKETS (STRENGTH_VERY_STRONG + 1)
+
+/**
+ * @brief Audit settings
+ */
+typedef struct {
+    size_t threads;                 /**< Threads in the pipeline (0 = one per processor) */
+    double similarity_threshold;    /**< Similarity that flags neighbours (0 = off) */
+    size_t similarity_window;       /**< Preceding entries each entry is compared with */
+} AuditOptions;
+
+/**
+ * @brief Aggregate audit results
+ */
+typedef struct {
+    uint64_t total;                                 /**< Entries audited */
+    uint64_t strength[AUDIT_STRENGTH_BUCKETS];      /**< Entries per StrengthCategory */
+    uint64_t entropy[AUDIT_ENTROPY_BUCKETS];        /**< Entries per entropy bucket */
+    uint64_t weak;                                  /**< Entries with weak patterns */
+    uint64_t dictionary;                            /**< Entries with dictionary words */
+    uint64_t duplicates;                            /**< Repeats of earlier entries */
+    uint64_t similar;                               /**< Entries close to a neighbour */
+    uint64_t skipped;                               /**< Entries too long to audit (MAX_INPUT_LENGTH bytes or more) */
+    double entropy_sum;                             /**< Sum of entropy (for the mean) */
+    uint64_t score_sum;                             /**< Sum of scores (for the mean) */
+} AuditSummary;
+
+/**
+ * @brief Get default audit settings
+ * @return AuditOptions with defaults from config.h
+ */
+AuditOptions audit_options_init(void);
+
+/**
+ * @brief Audit every password in a text, CSV or JSON password file
+ * @param input File to audit
+ * @param output File for per-entry results (NULL or "-" for stdout)
+ * @param format Format of the per-entry results
+ * @param options Audit settings (NULL = defaults)
+ * @param summary Pointer to store the aggregate results
+ * @return true if the whole file was audited and written, false otherwise
+ *
+ * The file is mapped and parsed in one pass (see password_file_open()),
+ * AUDIT_CHUNK_SIZE entries at a time, into a small ring of locked batches. Every pipeline thread takes whichever job is ready:
+ * writing the oldest finished chunk, assessing a block of a filled chunk,
+ * or reading the next chunk into a free slot. Results are written in file
+ * order. Entries are identified by line number; passwords are not echoed.
+ */
+bool audit_password_file(const char *input, const char *output, ExportFormat format,
+                         const AuditOptions *options, AuditSummary *summary);
+
+#endif /* AUDIT_H */
\ No newline at end of file
@@ -0,0 +1,797 @@
+/**
+ * @file breach.c
+ * @brief Memory-mapped breached-password index implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "breach.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+/* Hashes sorted in memory per run of the index builder (plus as much sort scratch) */
+#define BUILD_RUN_ENTRIES ((size_t)1 << 22)
+
+/* Hashes read ahead from each run while the builder merges them */
+#define BUILD_MERGE_BLOCK 1024
+
+/* Suffix of the builder's temporary run file */
+#define BUILD_RUNS_SUFFIX ".runs"
+
+/* Process-wide breach list, set once at startup */
+static BreachIndex active_index;
+static bool active_index_open = false;
+
+/**
+ * @brief Sort hashes with a 4-pass LSD radix sort (16 bits per pass)
+ */
+static bool radix_sort_u64(uint64_t *values, size_t count) {
+    uint64_t *scratch = (uint64_t *)malloc(count * sizeof(uint64_t));
+    size_t *offsets = (size_t *)malloc(65536 * sizeof(size_t));
+    
+    if (!scratch || !offsets) {
+        free(scratch);
+        free(offsets);
+        return false;
+    }
+    
+    uint64_t *src = values;
+    uint64_t *dst = scratch;
+    
+    for (int shift = 0; shift < 64; shift += 16) {
+        memset(offsets, 0, 65536 * sizeof(size_t));
+        
+        for (size_t i = 0; i < count; i++) {
+            offsets[(src[i] >> shift) & 0xFFFF]++;
+        }
+        
+        size_t total = 0;
+        for (size_t d = 0; d < 65536; d++) {
+            size_t n = offsets[d];
+            offsets[d] = total;
+            total += n;
+        }
+        
+        for (size_t i = 0; i < count; i++) {
+            dst[offsets[(src[i] >> shift) & 0xFFFF]++] = src[i];
+        }
+        
+        uint64_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    
+    /* Four passes: the sorted data is back in values */
+    free(scratch);
+    free(offsets);
+    return true;
+}
+
+/**
+ * @brief Choose bucket bits so buckets hold about BREACH_BUCKET_TARGET hashes
+ */
+static uint32_t choose_bucket_bits(uint64_t count) {
+    uint32_t bits = 0;
+    while (bits < 32 && ((uint64_t)BREACH_BUCKET_TARGET << bits) < count) {
+        bits++;
+    }
+    return bits;
+}
+
+/**
+ * @brief Top bucket_bits bits of a hash
+ */
+static uint64_t bucket_of(uint64_t hash, uint32_t bucket_bits) {
+    return bucket_bits == 0 ? 0 : hash >> (64 - bucket_bits);
+}
+
+/**
+ * @brief Seek a stream to a byte offset past 2 GiB
+ */
+static bool seek_to(FILE *file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+/**
+ * @brief Buffered sequential writer of uint64_t values
+ */
+typedef struct {
+    FILE *file;
+    uint64_t block[1024];
+    size_t used;
+    bool failed;
+} ValueWriter;
+
+static void value_writer_init(ValueWriter *writer, FILE *file) {
+    writer->file = file;
+    writer->used = 0;
+    writer->failed = file == NULL;
+}
+
+static bool value_writer_flush(ValueWriter *writer) {
+    if (writer->used > 0 && !writer->failed) {
+        writer->failed = fwrite(writer->block, sizeof(uint64_t), writer->used,
+                                writer->file) != writer->used;
+    }
+    writer->used = 0;
+    return !writer->failed;
+}
+
+static void value_writer_put(ValueWriter *writer, uint64_t value) {
+    writer->block[writer->used++] = value;
+    if (writer->used == sizeof(writer->block) / sizeof(writer->block[0])) {
+        value_writer_flush(writer);
+    }
+}
+
+/**
+ * @brief Sorted stream of distinct hashes an index is written from
+ */
+typedef struct {
+    bool (*rewind)(void *context);                  /* Restart at the smallest hash */
+    bool (*next)(void *context, uint64_t *value);   /* Next hash, false at the end */
+    void *context;
+} HashSource;
+
+/**
+ * @brief Write an index file from a sorted hash stream
+ *
+ * The first pass counts the hashes to size the directory. The second
+ * writes them after a zeroed header and directory, which a second stream
+ * on the same file fills in as each bucket starts, so memory use is
+ * constant whatever the number of hashes.
+ */
+static bool write_index(const char *index_path, BreachIndexHeader *header,
+                        const HashSource *source) {
+    uint64_t value;
+    
+    header->count = 0;
+    if (!source->rewind(source->context)) {
+        return false;
+    }
+    while (source->next(source->context, &value)) {
+        header->count++;
+    }
+    header->bucket_bits = choose_bucket_bits(header->count);
+    uint64_t buckets = (uint64_t)1 << header->bucket_bits;
+    
+    FILE *output = fopen(index_path, "wb");
+    if (!output) {
+        fprintf(stderr, "Error opening file %s: %s\n", index_path, strerror(errno));
+        return false;
+    }
+    
+    /* Reserve the header and directory; flushed so the second stream overwrites them */
+    ValueWriter hashes;
+    value_writer_init(&hashes, output);
+    uint64_t reserved = sizeof(BreachIndexHeader) / sizeof(uint64_t) + buckets + 1;
+    for (uint64_t i = 0; i < reserved; i++) {
+        value_writer_put(&hashes, 0);
+    }
+    bool ok = value_writer_flush(&hashes) && fflush(output) == 0;
+    
+    FILE *directory_file = ok ? fopen(index_path, "r+b") : NULL;
+    ok = directory_file && fwrite(header, sizeof(BreachIndexHeader), 1, directory_file) == 1;
+    ValueWriter directory;
+    value_writer_init(&directory, directory_file);
+    
+    /* Bucket b starts at the number of hashes in buckets before it */
+    uint64_t written = 0;
+    uint64_t next_bucket = 0;
+    ok = ok && source->rewind(source->context);
+    while (ok && source->next(source->context, &value)) {
+        uint64_t bucket = bucket_of(value, header->bucket_bits);
+        for (; next_bucket <= bucket; next_bucket++) {
+            value_writer_put(&directory, written);
+        }
+        value_writer_put(&hashes, value);
+        written++;
+    }
+    for (; next_bucket <= buckets; next_bucket++) {
+        value_writer_put(&directory, written);
+    }
+    
+    ok = ok && written == header->count &&
+         value_writer_flush(&hashes) && value_writer_flush(&directory);
+    if (directory_file) {
+        ok = (fclose(directory_file) == 0) && ok;
+    }
+    ok = (fclose(output) == 0) && ok;
+    return ok;
+}
+
+/**
+ * @brief One sorted run in the builder's run file
+ */
+typedef struct {
+    uint64_t next;              /* Entry offset of the next unread hash */
+    uint64_t end;               /* Entry offset where the run ends */
+    uint64_t *block;            /* Hashes read ahead */
+    size_t position;            /* Next hash in block */
+    size_t used;                /* Hashes in block */
+} RunCursor;
+
+/**
+ * @brief Merge of the builder's sorted runs that skips repeated values
+ */
+typedef struct {
+    FILE *file;                 /* Run file */
+    const uint64_t *run_ends;   /* Entry offset where each run ends */
+    RunCursor *runs;
+    size_t run_count;
+    size_t *heap;               /* Runs with hashes left, smallest head first */
+    size_t heap_size;
+    bool started;
+    uint64_t last;
+    bool failed;                /* A read failed */
+} RunMerge;
+
+static uint64_t run_head(const RunMerge *merge, size_t run) {
+    return merge->runs[run].block[merge->runs[run].position];
+}
+
+/**
+ * @brief Read the next block of a run
+ * @return false if the run is exhausted or the read failed
+ */
+static bool run_refill(RunMerge *merge, RunCursor *run) {
+    uint64_t left = run->end - run->next;
+    size_t take = left < BUILD_MERGE_BLOCK ? (size_t)left : BUILD_MERGE_BLOCK;
+    
+    if (take == 0) {
+        return false;
+    }
+    if (!seek_to(merge->file, run->next * sizeof(uint64_t)) ||
+        fread(run->block, sizeof(uint64_t), take, merge->file) != take) {
+        merge->failed = true;
+        return false;
+    }
+    
+    run->next += take;
+    run->position = 0;
+    run->used = take;
+    return true;
+}
+
+static void run_heap_sift_down(RunMerge *merge, size_t i) {
+    size_t *heap = merge->heap;
+    
+    for (;;) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        
+        if (left < merge->heap_size && run_head(merge, heap[left]) < run_head(merge, heap[smallest])) {
+            smallest = left;
+        }
+        if (right < merge->heap_size && run_head(merge, heap[right]) < run_head(merge, heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        
+        size_t tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static bool run_merge_rewind(void *context) {
+    RunMerge *merge = (RunMerge *)context;
+    
+    merge->heap_size = 0;
+    merge->started = false;
+    for (size_t r = 0; r < merge->run_count; r++) {
+        RunCursor *run = &merge->runs[r];
+        run->next = r == 0 ? 0 : merge->run_ends[r - 1];
+        run->end = merge->run_ends[r];
+        if (run_refill(merge, run)) {
+            merge->heap[merge->heap_size++] = r;
+        }
+    }
+    for (size_t i = merge->heap_size / 2; i-- > 0;) {
+        run_heap_sift_down(merge, i);
+    }
+    
+    return !merge->failed;
+}
+
+static bool run_merge_next(void *context, uint64_t *value) {
+    RunMerge *merge = (RunMerge *)context;
+    
+    while (merge->heap_size > 0) {
+        RunCursor *run = &merge->runs[merge->heap[0]];
+        uint64_t next = run->block[run->position++];
+        
+        if (run->position == run->used && !run_refill(merge, run)) {
+            merge->heap[0] = merge->heap[--merge->heap_size];
+        }
+        run_heap_sift_down(merge, 0);
+        
+        if (!merge->started || next != merge->last) {
+            merge->started = true;
+            merge->last = next;
+            *value = next;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Sort, deduplicate and append one run to the run file
+ * @return true if successful, false otherwise
+ */
+static bool spill_run(FILE *runs, uint64_t *hashes, size_t count, uint64_t **run_ends,
+                      size_t *run_count, size_t *run_capacity) {
+    if (count > 0 && !radix_sort_u64(hashes, count)) {
+        return false;
+    }
+    
+    size_t distinct = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (distinct == 0 || hashes[distinct - 1] != hashes[i]) {
+            hashes[distinct++] = hashes[i];
+        }
+    }
+    
+    if (*run_count == *run_capacity) {
+        size_t capacity = *run_capacity ? 2 * *run_capacity : 16;
+        uint64_t *grown = (uint64_t *)realloc(*run_ends, capacity * sizeof(uint64_t));
+        if (!grown) {
+            return false;
+        }
+        *run_ends = grown;
+        *run_capacity = capacity;
+    }
+    
+    uint64_t start = *run_count == 0 ? 0 : (*run_ends)[*run_count - 1];
+    (*run_ends)[(*run_count)++] = start + distinct;
+    return fwrite(hashes, sizeof(uint64_t), distinct, runs) == distinct;
+}
+
+/**
+ * @brief Build an index file from a wordlist
+ *
+ * Hashes are sorted in runs of at most BUILD_RUN_ENTRIES, spilled to a
+ * temporary file next to the index, and merged from there, so memory use
+ * does not grow with the size of the wordlist.
+ */
+bool breach_index_build(const char *wordlist_path, const char *index_path, uint64_t *count) {
+    if (!wordlist_path || !index_path) {
+        return false;
+    }
+    
+    FILE *input = fopen(wordlist_path, "rb");
+    if (!input) {
+        fprintf(stderr, "Error opening file %s: %s\n", wordlist_path, strerror(errno));
+        return false;
+    }
+    
+    BreachIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BREACH_INDEX_MAGIC, sizeof(header.magic));
+    header.byte_order = BREACH_INDEX_BYTE_ORDER;
+    
+    size_t path_length = strlen(index_path);
+    char *runs_path = (char *)malloc(path_length + sizeof(BUILD_RUNS_SUFFIX));
+    if (!runs_path || !get_random_bytes(header.hash_key, sizeof(header.hash_key))) {
+        free(runs_path);
+        fclose(input);
+        return false;
+    }
+    memcpy(runs_path, index_path, path_length);
+    memcpy(runs_path + path_length, BUILD_RUNS_SUFFIX, sizeof(BUILD_RUNS_SUFFIX));
+    
+    FILE *runs = fopen(runs_path, "w+b");
+    if (!runs) {
+        fprintf(stderr, "Error opening file %s: %s\n", runs_path, strerror(errno));
+        free(runs_path);
+        fclose(input);
+        return false;
+    }
+    
+    size_t capacity = 1 << 16;
+    size_t used = 0;
+    uint64_t *hashes = (uint64_t *)malloc(capacity * sizeof(uint64_t));
+    uint64_t *run_ends = NULL;
+    size_t run_count = 0;
+    size_t run_capacity = 0;
+    char line[1024];
+    bool skipping = false;
+    bool ok = hashes != NULL;
+    
+    while (ok && fgets(line, sizeof(line), input)) {
+        size_t length = strlen(line);
+        bool has_newline = length > 0 && line[length - 1] == '\n';
+        
+        /* Entries longer than the buffer are skipped, not split */
+        if (skipping) {
+            skipping = !has_newline;
+            continue;
+        }
+        if (!has_newline && length == sizeof(line) - 1) {
+            skipping = true;
+            continue;
+        }
+        
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if (length == 0) {
+            continue;
+        }
+        
+        /* Grow up to one run, then sort and spill it */
+        if (used == capacity && capacity < BUILD_RUN_ENTRIES) {
+            uint64_t *grown = (uint64_t *)realloc(hashes, 2 * capacity * sizeof(uint64_t));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            hashes = grown;
+            capacity *= 2;
+        }
+        if (used == capacity) {
+            ok = spill_run(runs, hashes, used, &run_ends, &run_count, &run_capacity);
+            used = 0;
+        }
+        
+        hashes[used++] = siphash24(header.hash_key, line, length);
+    }
+    
+    if (ferror(input)) {
+        fprintf(stderr, "Error reading file %s\n", wordlist_path);
+        ok = false;
+    }
+    fclose(input);
+    
+    if (ok && (used > 0 || run_count == 0)) {
+        ok = spill_run(runs, hashes, used, &run_ends, &run_count, &run_capacity);
+    }
+    free(hashes);
+    
+    RunMerge merge;
+    memset(&merge, 0, sizeof(merge));
+    merge.file = runs;
+    merge.run_ends = run_ends;
+    merge.run_count = run_count;
+    merge.runs = ok ? (RunCursor *)calloc(run_count, sizeof(RunCursor)) : NULL;
+    merge.heap = ok ? (size_t *)calloc(run_count, sizeof(size_t)) : NULL;
+    uint64_t *blocks = ok ? (uint64_t *)malloc(run_count * BUILD_MERGE_BLOCK * sizeof(uint64_t)) : NULL;
+    ok = ok && merge.runs && merge.heap && blocks && fflush(runs) == 0;
+    
+    if (ok) {
+        for (size_t r = 0; r < run_count; r++) {
+            merge.runs[r].block = blocks + r * BUILD_MERGE_BLOCK;
+        }
+        HashSource source = {run_merge_rewind, run_merge_next, &merge};
+        ok = write_index(index_path, &header, &source) && !merge.failed;
+    } else {
+        fprintf(stderr, "Failed to sort breach list entries\n");
+    }
+    
+    free(blocks);
+    free(merge.heap);
+    free(merge.runs);
+    free(run_ends);
+    fclose(runs);
+    remove(runs_path);
+    free(runs_path);
+    
+    if (ok && count) {
+        *count = header.count;
+    }
+    return ok;
+}
+
+/**
+ * @brief Merge of two sorted hash arrays that skips repeated values
+ */
+typedef struct {
+    const uint64_t *a;
+    size_t a_count;
+    size_t a_next;
+    const uint64_t *b;
+    size_t b_count;
+    size_t b_next;
+    bool started;
+    uint64_t last;
+} HashMerge;
+
+static void hash_merge_init(HashMerge *merge, const uint64_t *a, size_t a_count,
+                            const uint64_t *b, size_t b_count) {
+    memset(merge, 0, sizeof(HashMerge));
+    merge->a = a;
+    merge->a_count = a_count;
+    merge->b = b;
+    merge->b_count = b_count;
+}
+
+/**
+ * @brief Take the next distinct value of a merge
+ */
+static bool hash_merge_next(void *context, uint64_t *value) {
+    HashMerge *merge = (HashMerge *)context;
+    
+    while (merge->a_next < merge->a_count || merge->b_next < merge->b_count) {
+        uint64_t next;
+        if (merge->b_next >= merge->b_count ||
+            (merge->a_next < merge->a_count && merge->a[merge->a_next] <= merge->b[merge->b_next])) {
+            next = merge->a[merge->a_next++];
+        } else {
+            next = merge->b[merge->b_next++];
+        }
+        
+        if (!merge->started || next != merge->last) {
+            merge->started = true;
+            merge->last = next;
+            *value = next;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+static bool hash_merge_rewind(void *context) {
+    HashMerge *merge = (HashMerge *)context;
+    hash_merge_init(merge, merge->a, merge->a_count, merge->b, merge->b_count);
+    return true;
+}
+
+/**
+ * @brief Write an index holding the hashes of an open index plus more
+ */
+bool breach_index_merge(const char *index_path, const BreachIndex *base, const uint64_t *hashes,
+                        size_t count, const unsigned char key[SIPHASH_KEY_SIZE], uint64_t *total) {
+    if (!index_path || !key || (count > 0 && !hashes)) {
+        return false;
+    }
+    
+    const uint64_t *base_hashes = base && base->map ? base->hashes : NULL;
+    size_t base_count = base_hashes ? (size_t)base->count : 0;
+    
+    BreachIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BREACH_INDEX_MAGIC, sizeof(header.magic));
+    header.byte_order = BREACH_INDEX_BYTE_ORDER;
+    memcpy(header.hash_key, key, sizeof(header.hash_key));
+    
+    HashMerge merge;
+    hash_merge_init(&merge, base_hashes, base_count, hashes, count);
+    HashSource source = {hash_merge_rewind, hash_merge_next, &merge};
+    bool ok = write_index(index_path, &header, &source);
+    
+    if (ok && total) {
+        *total = header.count;
+    }
+    return ok;
+}
+
+/**
+ * @brief Map an index file read-only
+ */
+bool breach_index_open(BreachIndex *index, const char *path) {
+    if (!index || !path) {
+        return false;
+    }
+    
+    memset(index, 0, sizeof(BreachIndex));
+    
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, 
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(BreachIndexHeader)) {
+        CloseHandle(file);
+        return false;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *map = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!map) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    
+    index->file_handle = file;
+    index->mapping_handle = mapping;
+    index->map_size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(BreachIndexHeader)) {
+        close(fd);
+        return false;
+    }
+    
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    
+    index->map_size = (size_t)st.st_size;
+#endif
+    
+    index->map = (const unsigned char *)map;
+    
+    /* Validate header and layout before trusting any offsets */
+    const BreachIndexHeader *header = (const BreachIndexHeader *)index->map;
+    bool valid = memcmp(header->magic, BREACH_INDEX_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->byte_order == BREACH_INDEX_BYTE_ORDER &&
+                 header->bucket_bits <= 32;
+    
+    if (valid) {
+        uint64_t buckets = (uint64_t)1 << header->bucket_bits;
+        uint64_t expected = sizeof(BreachIndexHeader) + 
+                            (buckets + 1 + header->count) * sizeof(uint64_t);
+        valid = header->count <= index->map_size / sizeof(uint64_t) &&
+                expected == index->map_size;
+        
+        if (valid) {
+            index->directory = (const uint64_t *)(index->map + sizeof(BreachIndexHeader));
+            index->hashes = index->directory + buckets + 1;
+            index->count = header->count;
+            index->bucket_bits = header->bucket_bits;
+            memcpy(index->hash_key, header->hash_key, sizeof(index->hash_key));
+            valid = index->directory[buckets] == header->count;
+        }
+    }
+    
+    if (!valid) {
+        fprintf(stderr, "Invalid breach index: %s\n", path);
+        breach_index_close(index);
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Check whether a password is in an index
+ */
+bool breach_index_contains(const BreachIndex *index, const char *password, size_t length) {
+    if (!index || !index->map || !password || index->count == 0) {
+        return false;
+    }
+    
+    return breach_index_contains_hash(index, siphash24(index->hash_key, password, length));
+}
+
+/**
+ * @brief Check whether a hash made with the index key is in an index
+ */
+bool breach_index_contains_hash(const BreachIndex *index, uint64_t hash) {
+    if (!index || !index->map || index->count == 0) {
+        return false;
+    }
+    
+    uint64_t bucket = bucket_of(hash, index->bucket_bits);
+    uint64_t lo = index->directory[bucket];
+    uint64_t hi = index->directory[bucket + 1];
+    
+    if (lo > hi || hi > index->count) {
+        return false;
+    }
+    
+    /* Buckets are small; binary search within one */
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        uint64_t value = index->hashes[mid];
+        
+        if (value == hash) {
+            return true;
+        } else if (value < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Unmap an index
+ */
+void breach_index_close(BreachIndex *index) {
+    if (!index || !index->map) {
+        return;
+    }
+    
+#ifdef _WIN32
+    UnmapViewOfFile((LPCVOID)index->map);
+    CloseHandle((HANDLE)index->mapping_handle);
+    CloseHandle((HANDLE)index->file_handle);
+#else
+    munmap((void *)index->map, index->map_size);
+#endif
+    
+    memset(index, 0, sizeof(BreachIndex));
+}
+
+/**
+ * @brief Open an index and make it the process-wide breach list
+ */
+bool breach_set_active_index(const char *path) {
+    BreachIndex index;
+    
+    if (!breach_index_open(&index, path)) {
+        return false;
+    }
+    
+    breach_close_active();
+    active_index = index;
+    active_index_open = true;
+    return true;
+}
+
+/**
+ * @brief Check a password against the process-wide breach list
+ */
+bool breach_check_active(const char *password, size_t length) {
+    if (!active_index_open || !password) {
+        return false;
+    }
+    
+    if (breach_index_contains(&active_index, password, length)) {
+        return true;
+    }
+    
+    /* Also try the lowercased form, as the built-in dictionary does */
+    char lower[256];
+    if (length >= sizeof(lower)) {
+        return false;
+    }
+    
+    bool changed = false;
+    for (size_t i = 0; i < length; i++) {
+        lower[i] = (char)tolower((unsigned char)password[i]);
+        changed |= lower[i] != password[i];
+    }
+    
+    bool found = changed && breach_index_contains(&active_index, lower, length);
+    secure_clear(lower, length);
+    return found;
+}
+
+/**
+ * @brief Close the process-wide breach list
+ */
+void breach_close_active(void) {
+    if (active_index_open) {
+        breach_index_close(&active_index);
+        active_index_open = false;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+/**
+ * @file breach.h
+ * @brief Memory-mapped breached-password index
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef BREACH_H
+#define BREACH_H
+
+#include "crypto.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BREACH_INDEX_MAGIC "SPGBIDX1"
+#define BREACH_INDEX_BYTE_ORDER 0x01020304u
+
+/**
+ * @brief Average number of hashes per bucket the builder aims for
+ */
+#define BREACH_BUCKET_TARGET 8
+
+/**
+ * @brief On-disk index header (64 bytes)
+ *
+ * The file is the header, then a directory of (1 << bucket_bits) + 1
+ * uint64_t offsets, then count sorted, distinct uint64_t SipHash values.
+ * Bucket b holds hashes whose top bucket_bits bits equal b, in the range
+ * [directory[b], directory[b + 1]). Values are stored in host byte order.
+ */
+typedef struct {
+    char magic[8];                          /**< BREACH_INDEX_MAGIC */
+    uint32_t byte_order;                    /**< BREACH_INDEX_BYTE_ORDER */
+    uint32_t bucket_bits;                   /**< log2 of bucket count */
+    uint64_t count;                         /**< Number of hashes */
+    unsigned char hash_key[SIPHASH_KEY_SIZE]; /**< SipHash key */
+    uint64_t reserved[3];                   /**< Zero */
+} BreachIndexHeader;
+
+/**
+ * @brief Read-only mapped breach index
+ */
+typedef struct {
+    const unsigned char *map;   /**< Mapped file */
+    size_t map_size;            /**< Mapped size in bytes */
+    const uint64_t *directory;  /**< Bucket start offsets */
+    const uint64_t *hashes;     /**< Sorted hashes */
+    uint64_t count;             /**< Number of hashes */
+    uint32_t bucket_bits;       /**< log2 of bucket count */
+    unsigned char hash_key[SIPHASH_KEY_SIZE]; /**< SipHash key */
+#ifdef _WIN32
+    void *file_handle;          /**< Windows file handle */
+    void *mapping_handle;       /**< Windows mapping handle */
+#endif
+} BreachIndex;
+
+/**
+ * @brief Build an index file from a wordlist (one password per line)
+ * @param wordlist_path Text file to read
+ * @param index_path Index file to write
+ * @param count Pointer to store number of distinct entries (may be NULL)
+ * @return true if successful, false otherwise
+ *
+ * Hashes are sorted in bounded runs spilled to index_path + ".runs",
+ * which is removed afterwards, so memory use does not grow with the
+ * wordlist.
+ */
+bool breach_index_build(const char *wordlist_path, const char *index_path, uint64_t *count);
+
+/**
+ * @brief Write an index holding the hashes of an open index plus more
+ * @param index_path Index file to write (not the file base is mapped from)
+ * @param base Index whose hashes are kept (may be NULL)
+ * @param hashes Further hashes, sorted ascending
+ * @param count Number of further hashes
+ * @param key SipHash key of base and of the further hashes
+ * @param total Pointer to store number of distinct entries written (may be NULL)
+ * @return true if successful, false otherwise
+ *
+ * Both inputs are merged sequentially and the directory is written as
+ * it is filled, so memory use is constant whatever the size of base.
+ */
+bool breach_index_merge(const char *index_path, const BreachIndex *base, const uint64_t *hashes,
+                        size_t count, const unsigned char key[SIPHASH_KEY_SIZE], uint64_t *total);
+
+/**
+ * @brief Map an index file read-only
+ * @param index Index to open
+ * @param path Index file to map
+ * @return true if the file is a valid index, false otherwise
+ */
+bool breach_index_open(BreachIndex *index, const char *path);
+
+/**
+ * @brief Check whether a password is in an index
+ * @param index Open index
+ * @param password Password to look up
+ * @param length Password length
+ * @return true if found, false otherwise
+ */
+bool breach_index_contains(const BreachIndex *index, const char *password, size_t length);
+
+/**
+ * @brief Check whether a hash made with the index key is in an index
+ * @param index Open index
+ * @param hash SipHash of the password under index->hash_key
+ * @return true if found, false otherwise
+ */
+bool breach_index_contains_hash(const BreachIndex *index, uint64_t hash);
+
+/**
+ * @brief Unmap an index
+ * @param index Index to close
+ */
+void breach_index_close(BreachIndex *index);
+
+/**
+ * @brief Open an index and make it the process-wide breach list
+ * @param path Index file to map
+ * @return true if successful, false otherwise
+ *
+ * Call once at startup, before generating or assessing passwords.
+ */
+bool breach_set_active_index(const char *path);
+
+/**
+ * @brief Check a password against the process-wide breach list
+ * @param password Password to look up
+ * @param length Password length
+ * @return true if a breach list is active and contains the password
+ */
+bool breach_check_active(const char *password, size_t length);
+
+/**
+ * @brief Close the process-wide breach list
+ */
+void breach_close_active(void);
+
+#endif /* BREACH_H */
\ No newline at end of file
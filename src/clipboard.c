@@ -6,29 +6,143 @@
  */
 
 #include "clipboard.h"
+#include "crypto.h"
 #include "utils.h"
 #include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef _WIN32
     #include <windows.h>
-#elif defined(__APPLE__)
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <errno.h>
+    #include <pthread.h>
+    #include <sys/wait.h>
+#endif
+
+#if defined(__APPLE__)
     #include <AvailabilityMacros.h>
     #if MAC_OS_X_VERSION_MAX_ALLOWED >= 1050
         #include <Carbon/Carbon.h>
     #endif
-#else
-    /* Linux/Unix clipboard via xclip or xsel */
-    #include <unistd.h>
-    #include <sys/wait.h>
+#elif !defined(_WIN32)
+    /* Linux/Unix clipboard via wl-clipboard, xclip or xsel */
+    #include <spawn.h>
+    
+    extern char **environ;
 #endif
 
 /* Internal clipboard state */
 static bool clipboard_initialized = false;
 static PlatformType current_platform = PLATFORM_UNKNOWN;
 
+/*
+ * Pending auto-clear. Only a keyed hash of the secret is kept, so the timer
+ * can tell whether the clipboard still holds it without storing plaintext.
+ */
+static struct {
+    bool running;           /* Timer thread exists and must be joined */
+    bool pending;           /* Clear has not happened yet */
+    bool cancel;            /* Timer thread should stop early */
+    uint64_t hash;
+    unsigned char key[SIPHASH_KEY_SIZE];
+    uint64_t deadline_ms;
+#ifdef _WIN32
+    HANDLE thread;
+    SRWLOCK lock;
+    CONDITION_VARIABLE wake;
+#else
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    /* Waits on CLOCK_MONOTONIC once wake_ready */
+    bool wake_ready;
+#endif
+} autoclear = {
+#ifdef _WIN32
+    .lock = SRWLOCK_INIT,
+    .wake = CONDITION_VARIABLE_INIT
+#else
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER
+#endif
+};
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+/**
+ * @brief Command-line clipboard tools, in order of preference
+ */
+typedef enum {
+    CLIPBOARD_TOOL_NONE,
+    CLIPBOARD_TOOL_WAYLAND,     /* wl-copy / wl-paste */
+    CLIPBOARD_TOOL_XCLIP,
+    CLIPBOARD_TOOL_XSEL
+} ClipboardTool;
+
+/* Resolved once in clipboard_init() so operations spawn the tool directly */
+static ClipboardTool clipboard_tool = CLIPBOARD_TOOL_NONE;
+static char clipboard_copy_path[MAX_FILENAME_LENGTH];
+static char clipboard_paste_path[MAX_FILENAME_LENGTH];
+
+/**
+ * @brief Find an executable in PATH
+ */
+static bool find_in_path(const char *name, char *path, size_t path_size) {
+    const char *search = getenv("PATH");
+    if (!search || !*search) {
+        search = "/usr/local/bin:/usr/bin:/bin";
+    }
+    
+    while (*search) {
+        const char *end = strchr(search, ':');
+        size_t dir_len = end ? (size_t)(end - search) : strlen(search);
+        
+        if (dir_len > 0) {
+            int written = snprintf(path, path_size, "%.*s/%s", (int)dir_len, search, name);
+            if (written > 0 && (size_t)written < path_size && access(path, X_OK) == 0) {
+                return true;
+            }
+        }
+        
+        if (!end) {
+            break;
+        }
+        search = end + 1;
+    }
+    
+    path[0] = '\0';
+    return false;
+}
+
+/**
+ * @brief Pick the clipboard tool for the running session
+ */
+static ClipboardTool detect_clipboard_tool(void) {
+    const char *wayland = getenv("WAYLAND_DISPLAY");
+    if (wayland && *wayland &&
+        find_in_path("wl-copy", clipboard_copy_path, sizeof(clipboard_copy_path)) &&
+        find_in_path("wl-paste", clipboard_paste_path, sizeof(clipboard_paste_path))) {
+        return CLIPBOARD_TOOL_WAYLAND;
+    }
+    
+    if (find_in_path("xclip", clipboard_copy_path, sizeof(clipboard_copy_path))) {
+        strcpy(clipboard_paste_path, clipboard_copy_path);
+        return CLIPBOARD_TOOL_XCLIP;
+    }
+    
+    if (find_in_path("xsel", clipboard_copy_path, sizeof(clipboard_copy_path))) {
+        strcpy(clipboard_paste_path, clipboard_copy_path);
+        return CLIPBOARD_TOOL_XSEL;
+    }
+    
+    return CLIPBOARD_TOOL_NONE;
+}
+#endif
+
 /**
  * @brief Initialize clipboard system
  */
@@ -44,13 +158,8 @@ bool clipboard_init(void) {
     current_platform = PLATFORM_MACOS;
 #else
     /* Check for Linux/Unix clipboard utilities */
-    if (system("which xclip > /dev/null 2>&1") == 0) {
-        current_platform = PLATFORM_LINUX;
-    } else if (system("which xsel > /dev/null 2>&1") == 0) {
-        current_platform = PLATFORM_LINUX;
-    } else {
-        current_platform = PLATFORM_UNKNOWN;
-    }
+    clipboard_tool = detect_clipboard_tool();
+    current_platform = clipboard_tool != CLIPBOARD_TOOL_NONE ? PLATFORM_LINUX : PLATFORM_UNKNOWN;
 #endif
     
     clipboard_initialized = true;
@@ -248,47 +357,132 @@ ClipboardResult clear_clipboard_mac(void) {
 #endif /* __APPLE__ */
 
 /**
- * @brief Linux/Unix clipboard implementation (using xclip/xsel)
+ * @brief Linux/Unix clipboard implementation (using wl-clipboard, xclip or xsel)
  */
 #if !defined(_WIN32) && !defined(__APPLE__)
 
-ClipboardResult copy_to_clipboard_unix(const char *text) {
-    if (!text || strlen(text) == 0) {
-        return CLIPBOARD_ERROR_EMPTY;
+/**
+ * @brief Run a clipboard tool without a shell, feeding and/or reading its standard streams
+ * @return CLIPBOARD_SUCCESS if the tool exited with status 0
+ */
+static ClipboardResult run_clipboard_tool(const char *path, char *const argv[],
+                                          const char *input, size_t input_len,
+                                          char *output, size_t output_size) {
+    int in_pipe[2] = {-1, -1};
+    int out_pipe[2] = {-1, -1};
+    posix_spawn_file_actions_t actions;
+    
+    if ((input && pipe(in_pipe) != 0) || (output && pipe(out_pipe) != 0)) {
+        if (in_pipe[0] >= 0) {
+            close(in_pipe[0]);
+            close(in_pipe[1]);
+        }
+        return CLIPBOARD_ERROR_OPEN;
+    }
+    
+    posix_spawn_file_actions_init(&actions);
+    if (input) {
+        posix_spawn_file_actions_adddup2(&actions, in_pipe[0], STDIN_FILENO);
+        posix_spawn_file_actions_addclose(&actions, in_pipe[0]);
+        posix_spawn_file_actions_addclose(&actions, in_pipe[1]);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    }
+    if (output) {
+        posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addclose(&actions, out_pipe[0]);
+        posix_spawn_file_actions_addclose(&actions, out_pipe[1]);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    
+    pid_t pid;
+    int spawn_error = posix_spawn(&pid, path, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    
+    if (input) {
+        close(in_pipe[0]);
+    }
+    if (output) {
+        close(out_pipe[1]);
     }
     
-    /* Try xclip first */
-    if (system("which xclip > /dev/null 2>&1") == 0) {
-        /* Use xclip to copy to clipboard */
-        FILE *pipe = popen("xclip -selection clipboard -in", "w");
-        if (!pipe) {
-            return CLIPBOARD_ERROR_OPEN;
+    if (spawn_error != 0) {
+        if (input) {
+            close(in_pipe[1]);
         }
-        
-        fprintf(pipe, "%s", text);
-        int status = pclose(pipe);
-        
-        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-            return CLIPBOARD_SUCCESS;
+        if (output) {
+            close(out_pipe[0]);
         }
+        return CLIPBOARD_ERROR_OPEN;
     }
     
-    /* Try xsel as fallback */
-    if (system("which xsel > /dev/null 2>&1") == 0) {
-        FILE *pipe = popen("xsel --clipboard --input", "w");
-        if (!pipe) {
-            return CLIPBOARD_ERROR_OPEN;
+    bool io_ok = true;
+    if (input) {
+        while (input_len > 0) {
+            ssize_t written = write(in_pipe[1], input, input_len);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                io_ok = false;
+                break;
+            }
+            input += written;
+            input_len -= (size_t)written;
         }
-        
-        fprintf(pipe, "%s", text);
-        int status = pclose(pipe);
-        
-        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-            return CLIPBOARD_SUCCESS;
+        close(in_pipe[1]);
+    }
+    
+    if (output) {
+        size_t used = 0;
+        while (used < output_size - 1) {
+            ssize_t got = read(out_pipe[0], output + used, output_size - 1 - used);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                break;
+            }
+            used += (size_t)got;
         }
+        output[used] = '\0';
+        close(out_pipe[0]);
     }
     
-    return CLIPBOARD_ERROR_PLATFORM;
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return CLIPBOARD_ERROR_UNKNOWN;
+        }
+    }
+    
+    if (io_ok && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        return CLIPBOARD_SUCCESS;
+    }
+    return CLIPBOARD_ERROR_UNKNOWN;
+}
+
+ClipboardResult copy_to_clipboard_unix(const char *text) {
+    if (!text || strlen(text) == 0) {
+        return CLIPBOARD_ERROR_EMPTY;
+    }
+    
+    char *wayland_args[] = {"wl-copy", NULL};
+    char *xclip_args[] = {"xclip", "-selection", "clipboard", "-in", NULL};
+    char *xsel_args[] = {"xsel", "--clipboard", "--input", NULL};
+    
+    switch (clipboard_tool) {
+        case CLIPBOARD_TOOL_WAYLAND:
+            return run_clipboard_tool(clipboard_copy_path, wayland_args, text, strlen(text), NULL, 0);
+        case CLIPBOARD_TOOL_XCLIP:
+            return run_clipboard_tool(clipboard_copy_path, xclip_args, text, strlen(text), NULL, 0);
+        case CLIPBOARD_TOOL_XSEL:
+            return run_clipboard_tool(clipboard_copy_path, xsel_args, text, strlen(text), NULL, 0);
+        default:
+            return CLIPBOARD_ERROR_PLATFORM;
+    }
 }
 
 ClipboardResult get_from_clipboard_unix(char *buffer, size_t buffer_size) {
@@ -296,44 +490,38 @@ ClipboardResult get_from_clipboard_unix(char *buffer, size_t buffer_size) {
         return CLIPBOARD_ERROR_ALLOCATION;
     }
     
-    /* Try xclip first */
-    if (system("which xclip > /dev/null 2>&1") == 0) {
-        FILE *pipe = popen("xclip -selection clipboard -out", "r");
-        if (!pipe) {
-            return CLIPBOARD_ERROR_OPEN;
-        }
-        
-        size_t bytes_read = fread(buffer, 1, buffer_size - 1, pipe);
-        buffer[bytes_read] = '\0';
-        
-        int status = pclose(pipe);
-        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-            return CLIPBOARD_SUCCESS;
-        }
-    }
+    char *wayland_args[] = {"wl-paste", "--no-newline", NULL};
+    char *xclip_args[] = {"xclip", "-selection", "clipboard", "-out", NULL};
+    char *xsel_args[] = {"xsel", "--clipboard", "--output", NULL};
     
-    /* Try xsel as fallback */
-    if (system("which xsel > /dev/null 2>&1") == 0) {
-        FILE *pipe = popen("xsel --clipboard --output", "r");
-        if (!pipe) {
-            return CLIPBOARD_ERROR_OPEN;
-        }
-        
-        size_t bytes_read = fread(buffer, 1, buffer_size - 1, pipe);
-        buffer[bytes_read] = '\0';
-        
-        int status = pclose(pipe);
-        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-            return CLIPBOARD_SUCCESS;
-        }
+    switch (clipboard_tool) {
+        case CLIPBOARD_TOOL_WAYLAND:
+            return run_clipboard_tool(clipboard_paste_path, wayland_args, NULL, 0, buffer, buffer_size);
+        case CLIPBOARD_TOOL_XCLIP:
+            return run_clipboard_tool(clipboard_paste_path, xclip_args, NULL, 0, buffer, buffer_size);
+        case CLIPBOARD_TOOL_XSEL:
+            return run_clipboard_tool(clipboard_paste_path, xsel_args, NULL, 0, buffer, buffer_size);
+        default:
+            return CLIPBOARD_ERROR_PLATFORM;
     }
-    
-    return CLIPBOARD_ERROR_PLATFORM;
 }
 
 ClipboardResult clear_clipboard_unix(void) {
-    /* Clear by copying empty string */
-    return copy_to_clipboard_unix("");
+    char *wayland_args[] = {"wl-copy", "--clear", NULL};
+    char *xclip_args[] = {"xclip", "-selection", "clipboard", "-in", NULL};
+    char *xsel_args[] = {"xsel", "--clipboard", "--clear", NULL};
+    
+    switch (clipboard_tool) {
+        case CLIPBOARD_TOOL_WAYLAND:
+            return run_clipboard_tool(clipboard_copy_path, wayland_args, NULL, 0, NULL, 0);
+        case CLIPBOARD_TOOL_XCLIP:
+            /* Owning the selection with empty input clears it */
+            return run_clipboard_tool(clipboard_copy_path, xclip_args, "", 0, NULL, 0);
+        case CLIPBOARD_TOOL_XSEL:
+            return run_clipboard_tool(clipboard_copy_path, xsel_args, NULL, 0, NULL, 0);
+        default:
+            return CLIPBOARD_ERROR_PLATFORM;
+    }
 }
 
 #endif /* Linux/Unix */
@@ -433,6 +621,268 @@ ClipboardResult clear_clipboard(void) {
     }
 }
 
+/**
+ * @brief Monotonic clock used for auto-clear deadlines, in milliseconds
+ *
+ * Wall-clock steps (NTP, manual changes) must not move the clear.
+ */
+static uint64_t autoclear_now_ms(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000u + (uint64_t)now.tv_nsec / 1000000u;
+#endif
+}
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+/**
+ * @brief Switch the timer condition variable to CLOCK_MONOTONIC
+ * @return true on success
+ *
+ * Called with no timer thread running. macOS has no
+ * pthread_condattr_setclock() and waits with a relative timeout instead.
+ */
+static bool autoclear_init_wake(void) {
+    if (autoclear.wake_ready) {
+        return true;
+    }
+    
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) {
+        return false;
+    }
+    
+    bool ok = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0;
+    if (ok) {
+        pthread_cond_destroy(&autoclear.wake);
+        ok = pthread_cond_init(&autoclear.wake, &attr) == 0;
+    }
+    pthread_condattr_destroy(&attr);
+    
+    autoclear.wake_ready = ok;
+    return ok;
+}
+#endif
+
+/**
+ * @brief Check whether the clipboard still holds the secret with this hash
+ */
+static bool clipboard_holds_secret(uint64_t hash, const unsigned char key[SIPHASH_KEY_SIZE]) {
+    char buffer[MAX_INPUT_LENGTH];
+    if (get_from_clipboard(buffer, sizeof(buffer)) != CLIPBOARD_SUCCESS) {
+        return false;
+    }
+    
+    bool ours = siphash24(key, buffer, strlen(buffer)) == hash;
+    secure_clear(buffer, sizeof(buffer));
+    return ours;
+}
+
+/**
+ * @brief Auto-clear timer thread: wait for the deadline or cancellation
+ */
+#ifdef _WIN32
+static DWORD WINAPI autoclear_thread(LPVOID arg) {
+#else
+static void *autoclear_thread(void *arg) {
+#endif
+    (void)arg;
+    
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&autoclear.lock);
+#else
+    pthread_mutex_lock(&autoclear.lock);
+#endif
+    
+    while (!autoclear.cancel) {
+        uint64_t now = autoclear_now_ms();
+        if (now >= autoclear.deadline_ms) {
+            break;
+        }
+#ifdef _WIN32
+        uint64_t wait = autoclear.deadline_ms - now;
+        SleepConditionVariableSRW(&autoclear.wake, &autoclear.lock,
+                                  wait > 0x7FFFFFFFu ? 0x7FFFFFFFu : (DWORD)wait, 0);
+#elif defined(__APPLE__)
+        uint64_t wait = autoclear.deadline_ms - now;
+        struct timespec timeout;
+        timeout.tv_sec = (time_t)(wait / 1000u);
+        timeout.tv_nsec = (long)(wait % 1000u) * 1000000L;
+        pthread_cond_timedwait_relative_np(&autoclear.wake, &autoclear.lock, &timeout);
+#else
+        struct timespec deadline;
+        deadline.tv_sec = (time_t)(autoclear.deadline_ms / 1000u);
+        deadline.tv_nsec = (long)(autoclear.deadline_ms % 1000u) * 1000000L;
+        pthread_cond_timedwait(&autoclear.wake, &autoclear.lock, &deadline);
+#endif
+    }
+    
+    bool due = !autoclear.cancel;
+    uint64_t hash = autoclear.hash;
+    unsigned char key[SIPHASH_KEY_SIZE];
+    memcpy(key, autoclear.key, sizeof(key));
+    
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&autoclear.lock);
+#else
+    pthread_mutex_unlock(&autoclear.lock);
+#endif
+    
+    if (due) {
+        if (clipboard_holds_secret(hash, key)) {
+            clear_clipboard();
+        }
+        
+#ifdef _WIN32
+        AcquireSRWLockExclusive(&autoclear.lock);
+        autoclear.pending = false;
+        ReleaseSRWLockExclusive(&autoclear.lock);
+#else
+        pthread_mutex_lock(&autoclear.lock);
+        autoclear.pending = false;
+        pthread_mutex_unlock(&autoclear.lock);
+#endif
+    }
+    
+    secure_clear(key, sizeof(key));
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Stop the timer thread
+ * @param remaining_ms Pointer to store the time left (may be NULL)
+ * @return true if the clear had not happened yet
+ */
+static bool autoclear_stop(uint64_t *remaining_ms) {
+    if (!autoclear.running) {
+        return false;
+    }
+    
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&autoclear.lock);
+    autoclear.cancel = true;
+    WakeAllConditionVariable(&autoclear.wake);
+    ReleaseSRWLockExclusive(&autoclear.lock);
+    
+    WaitForSingleObject(autoclear.thread, INFINITE);
+    CloseHandle(autoclear.thread);
+#else
+    pthread_mutex_lock(&autoclear.lock);
+    autoclear.cancel = true;
+    pthread_cond_broadcast(&autoclear.wake);
+    pthread_mutex_unlock(&autoclear.lock);
+    
+    pthread_join(autoclear.thread, NULL);
+#endif
+    
+    autoclear.running = false;
+    bool pending = autoclear.pending;
+    autoclear.pending = false;
+    
+    if (remaining_ms) {
+        uint64_t now = autoclear_now_ms();
+        *remaining_ms = autoclear.deadline_ms > now ? autoclear.deadline_ms - now : 0;
+    }
+    return pending;
+}
+
+#ifndef _WIN32
+/**
+ * @brief Hand a pending clear to a detached process that outlives this one
+ */
+static void autoclear_detach(uint64_t remaining_ms) {
+    pid_t child = fork();
+    if (child < 0) {
+        return;
+    }
+    
+    if (child == 0) {
+        /* New session, then orphan the timer so nobody has to reap it */
+        setsid();
+        if (fork() == 0) {
+            int null_fd = open("/dev/null", O_RDWR);
+            if (null_fd >= 0) {
+                dup2(null_fd, STDIN_FILENO);
+                dup2(null_fd, STDOUT_FILENO);
+                dup2(null_fd, STDERR_FILENO);
+                if (null_fd > STDERR_FILENO) {
+                    close(null_fd);
+                }
+            }
+            
+            while (remaining_ms > 0) {
+                unsigned int step = remaining_ms > 60000u ? 60000u : (unsigned int)remaining_ms;
+                sleep_ms(step);
+                remaining_ms -= step;
+            }
+            
+            if (clipboard_holds_secret(autoclear.hash, autoclear.key)) {
+                clear_clipboard();
+            }
+            _exit(0);
+        }
+        _exit(0);
+    }
+    
+    while (waitpid(child, NULL, 0) < 0 && errno == EINTR) {
+    }
+}
+#endif
+
+/**
+ * @brief Clear the clipboard after a delay if it still holds the given text
+ */
+ClipboardResult clipboard_schedule_clear(const char *text, int seconds) {
+    if (!text || seconds < 0) {
+        return CLIPBOARD_ERROR_EMPTY;
+    }
+    
+    if (!clipboard_initialized) {
+        clipboard_init();
+    }
+    
+    /* A newer secret replaces any pending one */
+    autoclear_stop(NULL);
+    if (seconds == 0) {
+        return CLIPBOARD_SUCCESS;
+    }
+    
+#if !defined(_WIN32) && !defined(__APPLE__)
+    if (!autoclear_init_wake()) {
+        return CLIPBOARD_ERROR_UNKNOWN;
+    }
+#endif
+    
+    if (!get_random_bytes(autoclear.key, sizeof(autoclear.key))) {
+        return CLIPBOARD_ERROR_UNKNOWN;
+    }
+    autoclear.hash = siphash24(autoclear.key, text, strlen(text));
+    autoclear.deadline_ms = autoclear_now_ms() + (uint64_t)seconds * 1000u;
+    autoclear.cancel = false;
+    autoclear.pending = true;
+    
+#ifdef _WIN32
+    autoclear.thread = CreateThread(NULL, 0, autoclear_thread, NULL, 0, NULL);
+    autoclear.running = autoclear.thread != NULL;
+#else
+    autoclear.running = pthread_create(&autoclear.thread, NULL, autoclear_thread, NULL) == 0;
+#endif
+    
+    if (!autoclear.running) {
+        autoclear.pending = false;
+        secure_clear(autoclear.key, sizeof(autoclear.key));
+        return CLIPBOARD_ERROR_UNKNOWN;
+    }
+    
+    return CLIPBOARD_SUCCESS;
+}
+
 /**
  * @brief Copy with auto-clear after specified seconds
  */
@@ -446,17 +896,7 @@ ClipboardResult copy_with_autoclear(const char *text, int seconds) {
         return result;
     }
     
-    if (seconds > 0) {
-        /* Note: In a real implementation, you'd want to use a separate thread
-           or process for the auto-clear timer. For simplicity, we'll just
-           note that auto-clear should be implemented. */
-        printf("%sNote: Password copied to clipboard%s\n", 
-               COLOR_BRIGHT_YELLOW, COLOR_RESET);
-        printf("%sAuto-clear after %d seconds (not implemented in console)%s\n",
-               COLOR_BRIGHT_YELLOW, seconds, COLOR_RESET);
-    }
-    
-    return CLIPBOARD_SUCCESS;
+    return clipboard_schedule_clear(text, seconds);
 }
 
 /**
@@ -485,7 +925,18 @@ const char *get_clipboard_result_string(ClipboardResult result) {
  * @brief Cleanup clipboard system resources
  */
 void clipboard_cleanup(void) {
-    /* Currently no cleanup needed, but function exists for future use */
+    /* Cancel the timer; on POSIX a clear that is still due outlives the program */
+    uint64_t remaining_ms = 0;
+    if (autoclear_stop(&remaining_ms)) {
+#ifndef _WIN32
+        autoclear_detach(remaining_ms);
+#endif
+    }
+    secure_clear(autoclear.key, sizeof(autoclear.key));
+    
+#if !defined(_WIN32) && !defined(__APPLE__)
+    clipboard_tool = CLIPBOARD_TOOL_NONE;
+#endif
     clipboard_initialized = false;
 }
 
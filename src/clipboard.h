@@ -67,6 +67,19 @@ ClipboardResult clear_clipboard(void);
  */
 ClipboardResult copy_with_autoclear(const char *text, int seconds);
 
+/**
+ * @brief Clear the clipboard after a delay if it still holds the given text
+ * @param text Text that was copied (only a keyed hash of it is kept)
+ * @param seconds Seconds before the clear (0 = cancel a pending clear)
+ * @return ClipboardResult indicating success or error
+ *
+ * The timer runs on a background thread and never blocks the caller. If
+ * the clear is still pending at clipboard_cleanup(), the timer is
+ * cancelled; on POSIX systems the rest of the wait is handed to a detached
+ * child process so it still happens after the program exits.
+ */
+ClipboardResult clipboard_schedule_clear(const char *text, int seconds);
+
 /**
  * @brief Get current platform type
  * @return PlatformType enum value
@@ -81,7 +94,11 @@ PlatformType get_current_platform(void);
 const char *get_clipboard_result_string(ClipboardResult result);
 
 /**
- * @brief Cleanup clipboard system resources
+ * @brief Cleanup clipboard system resources (cancels the auto-clear timer)
+ *
+ * On POSIX systems a pending clear forks a process that keeps a copy of
+ * this address space until the delay is over, so wipe keys and other
+ * secrets before calling this.
  */
 void clipboard_cleanup(void);
 
@@ -37,7 +37,7 @@
  * @brief File paths and extensions
  */
 #define CONFIG_FILENAME "securepassgen.conf"
-#define HISTORY_FILENAME "passwords_history.txt"
+#define HISTORY_FILENAME "passwords_history.idx"
 #define BACKUP_EXTENSION ".bak"
 #define ENCRYPTED_EXTENSION ".enc"
 
@@ -47,6 +47,7 @@
 #define MIN_ENTROPY_BITS 40
 #define MAX_ENTROPY_BITS 256
 #define GPU_GUESSES_PER_SECOND 1e9  // 1 billion guesses per second
+#define RANDOM_POOL_SIZE 4096       // Bytes fetched from the OS per refill
 
 /**
  * @brief Color configuration (ANSI codes)
@@ -58,25 +59,31 @@
 #endif
 
 #if ENABLE_COLORS
-    #define COLOR_RESET "\033[0m"
-    #define COLOR_BLACK "\033[30m"
-    #define COLOR_RED "\033[31m"
-    #define COLOR_GREEN "\033[32m"
-    #define COLOR_YELLOW "\033[33m"
-    #define COLOR_BLUE "\033[34m"
-    #define COLOR_MAGENTA "\033[35m"
-    #define COLOR_CYAN "\033[36m"
-    #define COLOR_WHITE "\033[37m"
-    #define COLOR_BRIGHT_BLACK "\033[90m"
-    #define COLOR_BRIGHT_RED "\033[91m"
-    #define COLOR_BRIGHT_GREEN "\033[92m"
-    #define COLOR_BRIGHT_YELLOW "\033[93m"
-    #define COLOR_BRIGHT_BLUE "\033[94m"
-    #define COLOR_BRIGHT_MAGENTA "\033[95m"
-    #define COLOR_BRIGHT_CYAN "\033[96m"
-    #define COLOR_BRIGHT_WHITE "\033[97m"
-    #define BOLD_ON "\033[1m"
-    #define BOLD_OFF "\033[22m"
+    #include <stdbool.h>
+
+    /* Cleared when stdout is not a color terminal or --quiet is given */
+    extern bool color_output;
+    #define COLOR_CODE(code) (color_output ? (code) : "")
+
+    #define COLOR_RESET COLOR_CODE("\033[0m")
+    #define COLOR_BLACK COLOR_CODE("\033[30m")
+    #define COLOR_RED COLOR_CODE("\033[31m")
+    #define COLOR_GREEN COLOR_CODE("\033[32m")
+    #define COLOR_YELLOW COLOR_CODE("\033[33m")
+    #define COLOR_BLUE COLOR_CODE("\033[34m")
+    #define COLOR_MAGENTA COLOR_CODE("\033[35m")
+    #define COLOR_CYAN COLOR_CODE("\033[36m")
+    #define COLOR_WHITE COLOR_CODE("\033[37m")
+    #define COLOR_BRIGHT_BLACK COLOR_CODE("\033[90m")
+    #define COLOR_BRIGHT_RED COLOR_CODE("\033[91m")
+    #define COLOR_BRIGHT_GREEN COLOR_CODE("\033[92m")
+    #define COLOR_BRIGHT_YELLOW COLOR_CODE("\033[93m")
+    #define COLOR_BRIGHT_BLUE COLOR_CODE("\033[94m")
+    #define COLOR_BRIGHT_MAGENTA COLOR_CODE("\033[95m")
+    #define COLOR_BRIGHT_CYAN COLOR_CODE("\033[96m")
+    #define COLOR_BRIGHT_WHITE COLOR_CODE("\033[97m")
+    #define BOLD_ON COLOR_CODE("\033[1m")
+    #define BOLD_OFF COLOR_CODE("\033[22m")
 #else
     #define COLOR_RESET ""
     #define COLOR_BLACK ""
@@ -112,7 +119,33 @@
  * @brief UI constants
  */
 #define PROGRESS_BAR_WIDTH 40
+#define UI_FRAME_INTERVAL_MS 100 // Minimum time between progress frames that only move the spinner
 #define MAX_FILENAME_LENGTH 256
 #define MAX_INPUT_LENGTH 1024
+#define STREAM_CHUNK_SIZE 4096   // Passwords generated per chunk in --stream mode
+#define AUDIT_CHUNK_SIZE 2048    // Passwords read per chunk in --audit mode
+#define OUTPUT_BUFFER_SIZE (256 * 1024) // Bytes buffered by export writers before a write
+#define EXPORT_ASYNC_MIN_ENTRIES 10000 // Exports at least this large write from a background thread
+#define ENCRYPTED_CHUNK_SIZE (64 * 1024) // Plaintext bytes per authenticated chunk of an encrypted file
+#define SECURE_DELETE_CHUNK_SIZE (1024 * 1024) // Bytes overwritten per write by secure_delete_file()
+#define AUDIT_SIMILARITY_THRESHOLD 0.8
+#define AUDIT_SIMILARITY_WINDOW 8
+#define UNIQUE_SIMILARITY_THRESHOLD 0.8 // Similarity to a --unique-against entry that rejects a candidate
+#define UNIQUE_STREAM_MAX_ENTRIES 10000000 // Most passwords --stream --unique remembers (about 11 bytes each)
+
+/**
+ * @brief Server mode limits
+ */
+#define SERVER_MAX_CLIENTS 64           // Connections served at once
+#define SERVER_MAX_COUNT 10000          // Passwords per GEN request
+#define SERVER_LINE_MAX 1024            // Longest request line
+#define SERVER_POLL_INTERVAL_MS 500     // How often the accept loop checks for shutdown
+
+/**
+ * @brief Passphrase defaults
+ */
+#define PASSPHRASE_DEFAULT_WORDS 6          // Words per passphrase
+#define PASSPHRASE_DEFAULT_SEPARATOR "-"    // Text between words
+#define DEFAULT_WORDLIST_INDEX "wordlist.idx" // Output of --build-wordlist without -o
 
 #endif /* CONFIG_H */
\ No newline at end of file
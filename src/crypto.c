@@ -0,0 +1,496 @@
+/**
+ * @file crypto.c
+ * @brief Cryptographic primitives implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "crypto.h"
+#include "utils.h"
+#include <string.h>
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTER_ROUND(a, b, c, d) do { \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8);  \
+    c += d; b ^= c; b = ROTL32(b, 7);  \
+} while (0)
+
+static uint32_t load32_le(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store32_le(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+/**
+ * @brief Load key, counter and nonce into a ChaCha20 input state
+ */
+static void chacha20_setup(uint32_t state[16], const unsigned char key[CHACHA20_KEY_SIZE],
+                           uint32_t counter, const unsigned char nonce[CHACHA20_NONCE_SIZE]) {
+    /* "expand 32-byte k" */
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) {
+        state[4 + i] = load32_le(key + 4 * i);
+    }
+    state[12] = counter;
+    for (int i = 0; i < 3; i++) {
+        state[13 + i] = load32_le(nonce + 4 * i);
+    }
+}
+
+/**
+ * @brief Run the ChaCha20 rounds over an input state, leaving keystream words in x
+ */
+static void chacha20_core(const uint32_t state[16], uint32_t x[16]) {
+    memcpy(x, state, 16 * sizeof(uint32_t));
+    
+    for (int round = 0; round < 10; round++) {
+        /* Column rounds */
+        QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        /* Diagonal rounds */
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+    }
+    
+    for (int i = 0; i < 16; i++) {
+        x[i] += state[i];
+    }
+}
+
+/**
+ * @brief Compute one ChaCha20 keystream block (RFC 8439)
+ */
+void chacha20_block(const unsigned char key[CHACHA20_KEY_SIZE], uint32_t counter,
+                    const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                    unsigned char out[CHACHA20_BLOCK_SIZE]) {
+    uint32_t state[16];
+    uint32_t x[16];
+    
+    chacha20_setup(state, key, counter, nonce);
+    chacha20_core(state, x);
+    for (int i = 0; i < 16; i++) {
+        store32_le(out + 4 * i, x[i]);
+    }
+    
+    secure_clear(state, sizeof(state));
+    secure_clear(x, sizeof(x));
+}
+
+/**
+ * @brief Encrypt or decrypt with the ChaCha20 keystream
+ */
+void chacha20_xor(const unsigned char key[CHACHA20_KEY_SIZE], uint32_t counter,
+                  const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                  const unsigned char *in, unsigned char *out, size_t size) {
+    uint32_t state[16];
+    uint32_t x[16];
+    
+    /* The key schedule is loaded once; only the counter word changes */
+    chacha20_setup(state, key, counter, nonce);
+    
+    /* Whole blocks a word at a time, wiping the keystream only once at the end */
+    while (size >= CHACHA20_BLOCK_SIZE) {
+        chacha20_core(state, x);
+        for (int i = 0; i < 16; i++) {
+            store32_le(out + 4 * i, load32_le(in + 4 * i) ^ x[i]);
+        }
+        state[12]++;
+        in += CHACHA20_BLOCK_SIZE;
+        out += CHACHA20_BLOCK_SIZE;
+        size -= CHACHA20_BLOCK_SIZE;
+    }
+    
+    if (size > 0) {
+        unsigned char block[CHACHA20_BLOCK_SIZE];
+        chacha20_core(state, x);
+        for (int i = 0; i < 16; i++) {
+            store32_le(block + 4 * i, x[i]);
+        }
+        for (size_t i = 0; i < size; i++) {
+            out[i] = in[i] ^ block[i];
+        }
+        secure_clear(block, sizeof(block));
+    }
+    
+    secure_clear(state, sizeof(state));
+    secure_clear(x, sizeof(x));
+}
+
+/**
+ * @brief Start a Poly1305 computation
+ */
+void poly1305_init(Poly1305 *state, const unsigned char key[POLY1305_KEY_SIZE]) {
+    /* r is clamped as the specification requires */
+    state->r[0] = load32_le(key + 0) & 0x3ffffff;
+    state->r[1] = (load32_le(key + 3) >> 2) & 0x3ffff03;
+    state->r[2] = (load32_le(key + 6) >> 4) & 0x3ffc0ff;
+    state->r[3] = (load32_le(key + 9) >> 6) & 0x3f03fff;
+    state->r[4] = (load32_le(key + 12) >> 8) & 0x00fffff;
+    
+    memset(state->h, 0, sizeof(state->h));
+    for (int i = 0; i < 4; i++) {
+        state->pad[i] = load32_le(key + 16 + 4 * i);
+    }
+    state->leftover = 0;
+}
+
+/**
+ * @brief Absorb whole 16-byte blocks (final = the last, already padded block)
+ */
+static void poly1305_blocks(Poly1305 *state, const unsigned char *data, size_t size, bool final) {
+    const uint32_t hibit = final ? 0 : (1u << 24);
+    const uint32_t r0 = state->r[0], r1 = state->r[1], r2 = state->r[2];
+    const uint32_t r3 = state->r[3], r4 = state->r[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = state->h[0], h1 = state->h[1], h2 = state->h[2];
+    uint32_t h3 = state->h[3], h4 = state->h[4];
+    
+    while (size >= 16) {
+        /* h += m, then h *= r modulo 2^130 - 5 */
+        h0 += load32_le(data + 0) & 0x3ffffff;
+        h1 += (load32_le(data + 3) >> 2) & 0x3ffffff;
+        h2 += (load32_le(data + 6) >> 4) & 0x3ffffff;
+        h3 += (load32_le(data + 9) >> 6) & 0x3ffffff;
+        h4 += (load32_le(data + 12) >> 8) | hibit;
+        
+        uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 +
+                      (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+        uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 +
+                      (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+        uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 +
+                      (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+        uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 +
+                      (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+        uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 +
+                      (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+        
+        uint32_t c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+        d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+        d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+        d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+        d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+        h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+        h1 += c;
+        
+        data += 16;
+        size -= 16;
+    }
+    
+    state->h[0] = h0;
+    state->h[1] = h1;
+    state->h[2] = h2;
+    state->h[3] = h3;
+    state->h[4] = h4;
+}
+
+/**
+ * @brief Add message bytes to a Poly1305 computation
+ */
+void poly1305_update(Poly1305 *state, const unsigned char *data, size_t size) {
+    if (state->leftover > 0) {
+        size_t take = 16 - state->leftover;
+        if (take > size) {
+            take = size;
+        }
+        memcpy(state->buffer + state->leftover, data, take);
+        state->leftover += take;
+        data += take;
+        size -= take;
+        if (state->leftover < 16) {
+            return;
+        }
+        poly1305_blocks(state, state->buffer, 16, false);
+        state->leftover = 0;
+    }
+    
+    size_t whole = size & ~(size_t)15;
+    if (whole > 0) {
+        poly1305_blocks(state, data, whole, false);
+        data += whole;
+        size -= whole;
+    }
+    
+    if (size > 0) {
+        memcpy(state->buffer, data, size);
+        state->leftover = size;
+    }
+}
+
+/**
+ * @brief Finish a Poly1305 computation and wipe the state
+ */
+void poly1305_finish(Poly1305 *state, unsigned char tag[POLY1305_TAG_SIZE]) {
+    if (state->leftover > 0) {
+        state->buffer[state->leftover] = 1;
+        memset(state->buffer + state->leftover + 1, 0, 15 - state->leftover);
+        poly1305_blocks(state, state->buffer, 16, true);
+    }
+    
+    uint32_t h0 = state->h[0], h1 = state->h[1], h2 = state->h[2];
+    uint32_t h3 = state->h[3], h4 = state->h[4];
+    uint32_t c;
+    
+    /* Fully carry h */
+    c = h1 >> 26; h1 &= 0x3ffffff;
+    h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+    h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+    h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+    h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+    h1 += c;
+    
+    /* g = h - (2^130 - 5); keep g unless it went negative, without branching */
+    uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+    uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+    uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+    uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+    uint32_t g4 = h4 + c - (1u << 26);
+    
+    uint32_t mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+    
+    /* tag = (h + pad) mod 2^128 */
+    uint32_t w0 = h0 | (h1 << 26);
+    uint32_t w1 = (h1 >> 6) | (h2 << 20);
+    uint32_t w2 = (h2 >> 12) | (h3 << 14);
+    uint32_t w3 = (h3 >> 18) | (h4 << 8);
+    
+    uint64_t f = (uint64_t)w0 + state->pad[0];
+    store32_le(tag + 0, (uint32_t)f);
+    f = (uint64_t)w1 + state->pad[1] + (f >> 32);
+    store32_le(tag + 4, (uint32_t)f);
+    f = (uint64_t)w2 + state->pad[2] + (f >> 32);
+    store32_le(tag + 8, (uint32_t)f);
+    f = (uint64_t)w3 + state->pad[3] + (f >> 32);
+    store32_le(tag + 12, (uint32_t)f);
+    
+    secure_clear(state, sizeof(Poly1305));
+}
+
+/**
+ * @brief Compute the RFC 8439 AEAD tag over associated data and ciphertext
+ */
+static void chacha20_poly1305_tag(const unsigned char key[CHACHA20_KEY_SIZE],
+                                  const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                                  const unsigned char *aad, size_t aad_size,
+                                  const unsigned char *ciphertext, size_t size,
+                                  unsigned char tag[POLY1305_TAG_SIZE]) {
+    static const unsigned char zeros[16] = {0};
+    unsigned char block[CHACHA20_BLOCK_SIZE];
+    unsigned char lengths[16];
+    Poly1305 poly;
+    
+    /* Block 0 of the keystream is the one-time Poly1305 key */
+    chacha20_block(key, 0, nonce, block);
+    poly1305_init(&poly, block);
+    secure_clear(block, sizeof(block));
+    
+    if (aad_size > 0) {
+        poly1305_update(&poly, aad, aad_size);
+        poly1305_update(&poly, zeros, (16 - aad_size % 16) % 16);
+    }
+    poly1305_update(&poly, ciphertext, size);
+    poly1305_update(&poly, zeros, (16 - size % 16) % 16);
+    
+    for (int i = 0; i < 8; i++) {
+        lengths[i] = (unsigned char)((uint64_t)aad_size >> (8 * i));
+        lengths[8 + i] = (unsigned char)((uint64_t)size >> (8 * i));
+    }
+    poly1305_update(&poly, lengths, sizeof(lengths));
+    poly1305_finish(&poly, tag);
+}
+
+/**
+ * @brief Encrypt and authenticate in place with ChaCha20-Poly1305
+ */
+void chacha20_poly1305_seal(const unsigned char key[CHACHA20_KEY_SIZE],
+                            const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                            const unsigned char *aad, size_t aad_size,
+                            unsigned char *data, size_t size,
+                            unsigned char tag[POLY1305_TAG_SIZE]) {
+    chacha20_xor(key, 1, nonce, data, data, size);
+    chacha20_poly1305_tag(key, nonce, aad, aad_size, data, size, tag);
+}
+
+/**
+ * @brief Verify and decrypt in place with ChaCha20-Poly1305
+ */
+bool chacha20_poly1305_open(const unsigned char key[CHACHA20_KEY_SIZE],
+                            const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                            const unsigned char *aad, size_t aad_size,
+                            unsigned char *data, size_t size,
+                            const unsigned char tag[POLY1305_TAG_SIZE]) {
+    unsigned char expected[POLY1305_TAG_SIZE];
+    unsigned char difference = 0;
+    
+    chacha20_poly1305_tag(key, nonce, aad, aad_size, data, size, expected);
+    
+    /* Compare in constant time */
+    for (int i = 0; i < POLY1305_TAG_SIZE; i++) {
+        difference |= (unsigned char)(expected[i] ^ tag[i]);
+    }
+    secure_clear(expected, sizeof(expected));
+    
+    if (difference != 0) {
+        return false;
+    }
+    
+    chacha20_xor(key, 1, nonce, data, data, size);
+    return true;
+}
+
+static uint64_t load64_le(const unsigned char *p) {
+    return (uint64_t)load32_le(p) | ((uint64_t)load32_le(p + 4) << 32);
+}
+
+#define ROTL64(v, n) (((v) << (n)) | ((v) >> (64 - (n))))
+
+#define SIP_ROUND(v0, v1, v2, v3) do { \
+    v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32); \
+    v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                      \
+    v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                      \
+    v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32); \
+} while (0)
+
+/**
+ * @brief Compute SipHash-2-4 of a message
+ */
+uint64_t siphash24(const unsigned char key[SIPHASH_KEY_SIZE], const void *data, size_t size) {
+    const unsigned char *in = (const unsigned char *)data;
+    uint64_t k0 = load64_le(key);
+    uint64_t k1 = load64_le(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+    uint64_t b = (uint64_t)size << 56;
+    size_t blocks = size / 8;
+    
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t m = load64_le(in + 8 * i);
+        v3 ^= m;
+        SIP_ROUND(v0, v1, v2, v3);
+        SIP_ROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    
+    const unsigned char *tail = in + 8 * blocks;
+    switch (size & 7) {
+        case 7: b |= (uint64_t)tail[6] << 48; /* fall through */
+        case 6: b |= (uint64_t)tail[5] << 40; /* fall through */
+        case 5: b |= (uint64_t)tail[4] << 32; /* fall through */
+        case 4: b |= (uint64_t)tail[3] << 24; /* fall through */
+        case 3: b |= (uint64_t)tail[2] << 16; /* fall through */
+        case 2: b |= (uint64_t)tail[1] << 8;  /* fall through */
+        case 1: b |= (uint64_t)tail[0];       break;
+        default: break;
+    }
+    
+    v3 ^= b;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xff;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * @brief Produce a new buffer of output and rotate the key
+ */
+static void chacha_drbg_refill(ChaChaDrbg *drbg) {
+    static const unsigned char zero_nonce[CHACHA20_NONCE_SIZE] = {0};
+    
+    for (uint32_t i = 0; i < CHACHA_DRBG_BLOCKS; i++) {
+        chacha20_block(drbg->key, i, zero_nonce, 
+                       drbg->buffer + i * CHACHA20_BLOCK_SIZE);
+    }
+    
+    /* First 32 bytes become the next key and are never output */
+    memcpy(drbg->key, drbg->buffer, CHACHA20_KEY_SIZE);
+    secure_clear(drbg->buffer, CHACHA20_KEY_SIZE);
+    drbg->position = CHACHA20_KEY_SIZE;
+}
+
+/**
+ * @brief Seed a DRBG from the system CSPRNG
+ */
+bool chacha_drbg_seed(ChaChaDrbg *drbg) {
+    if (!drbg) {
+        return false;
+    }
+    
+    if (!get_random_bytes(drbg->key, sizeof(drbg->key))) {
+        return false;
+    }
+    
+    drbg->position = sizeof(drbg->buffer);
+    return true;
+}
+
+/**
+ * @brief Generate random bytes from a DRBG
+ */
+bool chacha_drbg_generate(ChaChaDrbg *drbg, unsigned char *buffer, size_t size) {
+    if (!drbg || !buffer) {
+        return false;
+    }
+    
+    while (size > 0) {
+        if (drbg->position >= sizeof(drbg->buffer)) {
+            chacha_drbg_refill(drbg);
+        }
+        
+        size_t available = sizeof(drbg->buffer) - drbg->position;
+        size_t take = size < available ? size : available;
+        
+        memcpy(buffer, drbg->buffer + drbg->position, take);
+        secure_clear(drbg->buffer + drbg->position, take);
+        
+        drbg->position += take;
+        buffer += take;
+        size -= take;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief RandomFillFunc adapter for chacha_drbg_generate()
+ */
+bool chacha_drbg_fill(void *context, unsigned char *buffer, size_t size) {
+    return chacha_drbg_generate((ChaChaDrbg *)context, buffer, size);
+}
+
+/**
+ * @brief Wipe DRBG state
+ */
+void chacha_drbg_wipe(ChaChaDrbg *drbg) {
+    if (drbg) {
+        secure_clear(drbg, sizeof(ChaChaDrbg));
+        drbg->position = sizeof(drbg->buffer);
+    }
+}
\ No newline at end of file
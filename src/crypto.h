@@ -0,0 +1,170 @@
+/**
+ * @file crypto.h
+ * @brief Cryptographic primitives (ChaCha20, Poly1305 and a ChaCha20-based DRBG)
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef CRYPTO_H
+#define CRYPTO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHACHA20_KEY_SIZE 32
+#define CHACHA20_NONCE_SIZE 12
+#define CHACHA20_BLOCK_SIZE 64
+#define SIPHASH_KEY_SIZE 16
+#define POLY1305_KEY_SIZE 32
+#define POLY1305_TAG_SIZE 16
+
+/**
+ * @brief Keystream blocks produced per DRBG refill
+ */
+#define CHACHA_DRBG_BLOCKS 8
+
+/**
+ * @brief ChaCha20 deterministic random bit generator state
+ *
+ * Uses fast key erasure: every refill derives a fresh key from the
+ * keystream before handing out any output, so earlier output cannot be
+ * recovered from a later state.
+ */
+typedef struct {
+    unsigned char key[CHACHA20_KEY_SIZE];   /**< Current key */
+    unsigned char buffer[CHACHA_DRBG_BLOCKS * CHACHA20_BLOCK_SIZE]; /**< Pending output */
+    size_t position;                        /**< Next unused byte in buffer */
+} ChaChaDrbg;
+
+/**
+ * @brief Incremental Poly1305 state
+ */
+typedef struct {
+    uint32_t r[5];                      /**< Clamped key, 26-bit limbs */
+    uint32_t h[5];                      /**< Accumulator, 26-bit limbs */
+    uint32_t pad[4];                    /**< Second key half */
+    unsigned char buffer[16];           /**< Partial block */
+    size_t leftover;                    /**< Bytes in buffer */
+} Poly1305;
+
+/**
+ * @brief Compute one ChaCha20 keystream block (RFC 8439)
+ * @param key 256-bit key
+ * @param counter Block counter
+ * @param nonce 96-bit nonce
+ * @param out Buffer for the 64-byte block
+ */
+void chacha20_block(const unsigned char key[CHACHA20_KEY_SIZE], uint32_t counter,
+                    const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                    unsigned char out[CHACHA20_BLOCK_SIZE]);
+
+/**
+ * @brief Encrypt or decrypt with the ChaCha20 keystream (RFC 8439)
+ * @param key 256-bit key
+ * @param counter Counter of the first block
+ * @param nonce 96-bit nonce
+ * @param in Input bytes
+ * @param out Output bytes (may equal in)
+ * @param size Number of bytes
+ */
+void chacha20_xor(const unsigned char key[CHACHA20_KEY_SIZE], uint32_t counter,
+                  const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                  const unsigned char *in, unsigned char *out, size_t size);
+
+/**
+ * @brief Start a Poly1305 computation
+ * @param state State to initialize
+ * @param key One-time 256-bit key
+ */
+void poly1305_init(Poly1305 *state, const unsigned char key[POLY1305_KEY_SIZE]);
+
+/**
+ * @brief Add message bytes to a Poly1305 computation
+ * @param state Initialized state
+ * @param data Message bytes
+ * @param size Number of bytes
+ */
+void poly1305_update(Poly1305 *state, const unsigned char *data, size_t size);
+
+/**
+ * @brief Finish a Poly1305 computation and wipe the state
+ * @param state Initialized state
+ * @param tag Buffer for the 16-byte tag
+ */
+void poly1305_finish(Poly1305 *state, unsigned char tag[POLY1305_TAG_SIZE]);
+
+/**
+ * @brief Encrypt and authenticate in place with ChaCha20-Poly1305 (RFC 8439)
+ * @param key 256-bit key
+ * @param nonce 96-bit nonce (never reuse one under the same key)
+ * @param aad Associated data authenticated but not encrypted (may be NULL)
+ * @param aad_size Bytes of associated data
+ * @param data Plaintext, replaced by the ciphertext
+ * @param size Number of bytes
+ * @param tag Buffer for the 16-byte tag
+ */
+void chacha20_poly1305_seal(const unsigned char key[CHACHA20_KEY_SIZE],
+                            const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                            const unsigned char *aad, size_t aad_size,
+                            unsigned char *data, size_t size,
+                            unsigned char tag[POLY1305_TAG_SIZE]);
+
+/**
+ * @brief Verify and decrypt in place with ChaCha20-Poly1305 (RFC 8439)
+ * @param key 256-bit key
+ * @param nonce 96-bit nonce
+ * @param aad Associated data (may be NULL)
+ * @param aad_size Bytes of associated data
+ * @param data Ciphertext, replaced by the plaintext if the tag matches
+ * @param size Number of bytes
+ * @param tag Tag to verify
+ * @return true if authentic, false otherwise (data is left untouched)
+ */
+bool chacha20_poly1305_open(const unsigned char key[CHACHA20_KEY_SIZE],
+                            const unsigned char nonce[CHACHA20_NONCE_SIZE],
+                            const unsigned char *aad, size_t aad_size,
+                            unsigned char *data, size_t size,
+                            const unsigned char tag[POLY1305_TAG_SIZE]);
+
+/**
+ * @brief Compute SipHash-2-4 of a message
+ * @param key 128-bit key
+ * @param data Message
+ * @param size Message length in bytes
+ * @return 64-bit keyed hash
+ */
+uint64_t siphash24(const unsigned char key[SIPHASH_KEY_SIZE], const void *data, size_t size);
+
+/**
+ * @brief Seed a DRBG from the system CSPRNG
+ * @param drbg DRBG to seed
+ * @return true if successful, false otherwise
+ */
+bool chacha_drbg_seed(ChaChaDrbg *drbg);
+
+/**
+ * @brief Generate random bytes from a DRBG
+ * @param drbg Seeded DRBG
+ * @param buffer Buffer to fill
+ * @param size Number of bytes to generate
+ * @return true if successful, false otherwise
+ */
+bool chacha_drbg_generate(ChaChaDrbg *drbg, unsigned char *buffer, size_t size);
+
+/**
+ * @brief RandomFillFunc adapter for chacha_drbg_generate()
+ * @param context ChaChaDrbg pointer
+ * @param buffer Buffer to fill
+ * @param size Number of bytes to generate
+ * @return true if successful, false otherwise
+ */
+bool chacha_drbg_fill(void *context, unsigned char *buffer, size_t size);
+
+/**
+ * @brief Wipe DRBG state
+ * @param drbg DRBG to wipe
+ */
+void chacha_drbg_wipe(ChaChaDrbg *drbg);
+
+#endif /* CRYPTO_H */
\ No newline at end of file
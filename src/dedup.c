@@ -0,0 +1,338 @@
+/**
+ * @file dedup.c
+ * @brief Exact and near-duplicate detection for password batches implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "dedup.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Map 32 hash bits onto [0, capacity) without a division
+ */
+static size_t slot_of(uint32_t hash, size_t capacity) {
+    return (size_t)(((uint64_t)hash * (uint64_t)capacity) >> 32);
+}
+
+/**
+ * @brief Create an empty set
+ */
+bool unique_set_init(UniqueSet *set, size_t expected) {
+    if (!set) {
+        return false;
+    }
+    
+    memset(set, 0, sizeof(UniqueSet));
+    
+    if (expected > (size_t)UINT32_MAX / 100 * UNIQUE_SET_LOAD_PERCENT) {
+        return false;
+    }
+    
+    size_t capacity = (size_t)(((uint64_t)expected * 100 + UNIQUE_SET_LOAD_PERCENT - 1) /
+                               UNIQUE_SET_LOAD_PERCENT) + 64;
+                               
+    if (!get_random_bytes(set->key, sizeof(set->key))) {
+        return false;
+    }
+    
+    /* All-zero slots are empty; calloc keeps untouched pages unmapped */
+    set->slots = (_Atomic uint64_t *)calloc(capacity, sizeof(uint64_t));
+    if (!set->slots) {
+        secure_clear(set->key, sizeof(set->key));
+        return false;
+    }
+    
+    set->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Hash a password for a set (never 0, which marks empty slots)
+ */
+static uint64_t unique_set_hash(const UniqueSet *set, const char *password, size_t length) {
+    uint64_t hash = siphash24(set->key, password, length);
+    return hash != 0 ? hash : 1;
+}
+
+/**
+ * @brief Insert a password unless it is already present
+ */
+UniqueInsertResult unique_set_insert(UniqueSet *set, const char *password, size_t length) {
+    if (!set || !set->slots || !password) {
+        return UNIQUE_FULL;
+    }
+    
+    uint64_t hash = unique_set_hash(set, password, length);
+    size_t pos = slot_of((uint32_t)(hash >> 32), set->capacity);
+    
+    /* Slots only ever go from empty to a hash, so a relaxed CAS is enough */
+    for (size_t probe = 0; probe < set->capacity; probe++) {
+        uint64_t current = atomic_load_explicit(&set->slots[pos], memory_order_relaxed);
+        
+        if (current == 0) {
+            if (atomic_compare_exchange_strong_explicit(&set->slots[pos], &current, hash,
+                                                        memory_order_relaxed,
+                                                        memory_order_relaxed)) {
+                return UNIQUE_INSERTED;
+            }
+        }
+        if (current == hash) {
+            return UNIQUE_DUPLICATE;
+        }
+        
+        if (++pos == set->capacity) {
+            pos = 0;
+        }
+    }
+    
+    return UNIQUE_FULL;
+}
+
+/**
+ * @brief Check whether a password is in the set
+ */
+bool unique_set_contains(const UniqueSet *set, const char *password, size_t length) {
+    if (!set || !set->slots || !password) {
+        return false;
+    }
+    
+    uint64_t hash = unique_set_hash(set, password, length);
+    size_t pos = slot_of((uint32_t)(hash >> 32), set->capacity);
+    
+    for (size_t probe = 0; probe < set->capacity; probe++) {
+        uint64_t current = atomic_load_explicit(&set->slots[pos], memory_order_relaxed);
+        if (current == hash) {
+            return true;
+        }
+        if (current == 0) {
+            return false;
+        }
+        if (++pos == set->capacity) {
+            pos = 0;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Count the passwords in the set
+ */
+size_t unique_set_count(const UniqueSet *set) {
+    size_t count = 0;
+    
+    if (set && set->slots) {
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (atomic_load_explicit(&set->slots[i], memory_order_relaxed) != 0) {
+                count++;
+            }
+        }
+    }
+    
+    return count;
+}
+
+/**
+ * @brief Release a set
+ */
+void unique_set_destroy(UniqueSet *set) {
+    if (set) {
+        free((void *)set->slots);
+        secure_clear(set->key, sizeof(set->key));
+        memset(set, 0, sizeof(UniqueSet));
+    }
+}
+
+/**
+ * @brief Mark batch entries equal to an earlier entry or a set member
+ */
+size_t unique_set_mark_batch(UniqueSet *set, const PasswordBatch *batch, size_t begin,
+                             size_t end, SecurityAssessment *assessments) {
+    size_t duplicates = 0;
+    
+    if (!set || !batch || !assessments) {
+        return 0;
+    }
+    if (end > batch->count) {
+        end = batch->count;
+    }
+    
+    for (size_t i = begin; i < end; i++) {
+        bool duplicate = unique_set_insert(set, batch->chars + i * batch->stride,
+                                           batch->lengths[i]) == UNIQUE_DUPLICATE;
+        assessments[i - begin].is_duplicate = duplicate;
+        if (duplicate) {
+            duplicates++;
+        }
+    }
+    
+    return duplicates;
+}
+
+/**
+ * @brief Hash the sampled positions of one band
+ */
+static uint64_t band_hash(const NearDuplicateIndex *index, size_t band,
+                          const char *password, size_t length) {
+    unsigned char key[2 + NEAR_DUPLICATE_BAND_POSITIONS];
+    size_t sampled = length < NEAR_DUPLICATE_BAND_POSITIONS ? length : NEAR_DUPLICATE_BAND_POSITIONS;
+    
+    key[0] = (unsigned char)band;
+    key[1] = (unsigned char)length;
+    for (size_t i = 0; i < sampled; i++) {
+        key[2 + i] = (unsigned char)password[index->positions[band][length][i]];
+    }
+    
+    return siphash24(index->key, key, 2 + sampled);
+}
+
+/**
+ * @brief Pick the distinct positions each band samples, for every length
+ */
+static void choose_band_positions(NearDuplicateIndex *index) {
+    for (size_t band = 0; band < NEAR_DUPLICATE_BANDS; band++) {
+        for (size_t length = 1; length <= NEAR_DUPLICATE_MAX_LENGTH; length++) {
+            uint8_t *positions = index->positions[band][length];
+            
+            if (length <= NEAR_DUPLICATE_BAND_POSITIONS) {
+                for (size_t i = 0; i < length; i++) {
+                    positions[i] = (uint8_t)i;
+                }
+                continue;
+            }
+            
+            uint32_t draw = 0;
+            for (size_t i = 0; i < NEAR_DUPLICATE_BAND_POSITIONS; i++) {
+                bool fresh = false;
+                while (!fresh) {
+                    uint32_t seed[3] = { (uint32_t)band, (uint32_t)length, draw++ };
+                    positions[i] = (uint8_t)(siphash24(index->key, seed, sizeof(seed)) % length);
+                    fresh = true;
+                    for (size_t j = 0; j < i; j++) {
+                        if (positions[j] == positions[i]) {
+                            fresh = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Check whether an entry length can be indexed
+ */
+static bool indexable_length(size_t length) {
+    return length > 0 && length <= NEAR_DUPLICATE_MAX_LENGTH;
+}
+
+/**
+ * @brief Index a batch for near-duplicate queries
+ */
+bool near_duplicate_index_build(NearDuplicateIndex *index, const PasswordBatch *entries,
+                                double threshold) {
+    if (!index) {
+        return false;
+    }
+    
+    memset(index, 0, sizeof(NearDuplicateIndex));
+    
+    if (!entries || entries->count >= UINT32_MAX / 2 || threshold <= 0.0 || threshold > 1.0) {
+        return false;
+    }
+    
+    if (!get_random_bytes(index->key, sizeof(index->key))) {
+        return false;
+    }
+    
+    size_t indexed = 0;
+    for (size_t i = 0; i < entries->count; i++) {
+        if (indexable_length(entries->lengths[i])) {
+            indexed++;
+        }
+    }
+    
+    /* Half-empty bands keep probe runs short */
+    index->capacity = indexed * 2 + 1;
+    index->buckets = (uint64_t *)calloc(NEAR_DUPLICATE_BANDS * index->capacity, sizeof(uint64_t));
+    if (!index->buckets) {
+        secure_clear(index->key, sizeof(index->key));
+        return false;
+    }
+    
+    index->entries = entries;
+    index->indexed = indexed;
+    index->threshold = threshold;
+    choose_band_positions(index);
+    
+    for (size_t i = 0; i < entries->count; i++) {
+        const char *password = entries->chars + i * entries->stride;
+        size_t length = entries->lengths[i];
+        if (!indexable_length(length)) {
+            continue;
+        }
+        
+        for (size_t band = 0; band < NEAR_DUPLICATE_BANDS; band++) {
+            uint64_t hash = band_hash(index, band, password, length);
+            uint64_t *table = index->buckets + band * index->capacity;
+            size_t pos = slot_of((uint32_t)hash, index->capacity);
+            
+            while (table[pos] != 0) {
+                if (++pos == index->capacity) {
+                    pos = 0;
+                }
+            }
+            table[pos] = (hash >> 32) << 32 | (uint64_t)(i + 1);
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Find an indexed password similar to a candidate
+ */
+size_t near_duplicate_find(const NearDuplicateIndex *index, const char *password, size_t length) {
+    if (!index || !index->buckets || !password || !indexable_length(length)) {
+        return SIZE_MAX;
+    }
+    
+    const PasswordBatch *entries = index->entries;
+    
+    for (size_t band = 0; band < NEAR_DUPLICATE_BANDS; band++) {
+        uint64_t hash = band_hash(index, band, password, length);
+        uint64_t tag = hash >> 32;
+        const uint64_t *table = index->buckets + band * index->capacity;
+        size_t pos = slot_of((uint32_t)hash, index->capacity);
+        
+        /* Band hits are candidates only; confirm each one exactly */
+        while (table[pos] != 0) {
+            if (table[pos] >> 32 == tag) {
+                size_t entry = (size_t)(table[pos] & UINT32_MAX) - 1;
+                if (entries->lengths[entry] == length &&
+                    are_passwords_similar(password, entries->chars + entry * entries->stride,
+                                          index->threshold)) {
+                    return entry;
+                }
+            }
+            if (++pos == index->capacity) {
+                pos = 0;
+            }
+        }
+    }
+    
+    return SIZE_MAX;
+}
+
+/**
+ * @brief Release an index
+ */
+void near_duplicate_index_destroy(NearDuplicateIndex *index) {
+    if (index) {
+        free(index->buckets);
+        secure_clear(index, sizeof(NearDuplicateIndex));
+    }
+}
\ No newline at end of file
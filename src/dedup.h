@@ -0,0 +1,155 @@
+/**
+ * @file dedup.h
+ * @brief Exact and near-duplicate detection for password batches
+ * @version 1.0
+ * @date 2024
+ *
+ * UniqueSet is a lock-free open-addressing set of keyed 64-bit hashes
+ * that generator threads insert into concurrently. Equal passwords always
+ * hash alike, so a password the set accepts is never equal to one accepted
+ * before; two different passwords sharing a hash (about n^2 / 2^65 for n
+ * entries) only cost a regenerated candidate.
+ *
+ * NearDuplicateIndex finds indexed passwords that are_passwords_similar()
+ * would match without comparing against every entry. Each band hashes the
+ * characters at a few keyed positions, so two passwords agreeing on a
+ * fraction s of their positions share a band with probability
+ * 1 - (1 - s^P)^B; every band hit is confirmed exactly. With the defaults
+ * a pair at 80% similarity is found more than 98% of the time.
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include "password.h"
+#include "security.h"
+#include "crypto.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Largest fill of a UniqueSet, in percent of its slots
+ */
+#define UNIQUE_SET_LOAD_PERCENT 75
+
+/**
+ * @brief Near-duplicate index layout
+ */
+#define NEAR_DUPLICATE_BANDS 8              /**< Independent hash bands */
+#define NEAR_DUPLICATE_BAND_POSITIONS 4     /**< Positions sampled by each band */
+#define NEAR_DUPLICATE_MAX_LENGTH MAX_PASSWORD_LENGTH /**< Longer entries are not indexed */
+
+/**
+ * @brief Outcome of a UniqueSet insertion
+ */
+typedef enum {
+    UNIQUE_INSERTED = 0,    /**< First time the password was seen */
+    UNIQUE_DUPLICATE,       /**< Already in the set */
+    UNIQUE_FULL             /**< No free slot left */
+} UniqueInsertResult;
+
+/**
+ * @brief Concurrent set of password hashes
+ */
+typedef struct UniqueSet {
+    _Atomic uint64_t *slots;                /**< Hashes (0 = empty) */
+    size_t capacity;                        /**< Number of slots */
+    unsigned char key[SIPHASH_KEY_SIZE];    /**< Random SipHash key */
+} UniqueSet;
+
+/**
+ * @brief Index of passwords for near-duplicate queries
+ */
+typedef struct NearDuplicateIndex {
+    const PasswordBatch *entries;           /**< Indexed passwords (borrowed) */
+    uint64_t *buckets;                      /**< Per band: tag << 32 | entry + 1 (0 = empty) */
+    size_t capacity;                        /**< Slots per band */
+    size_t indexed;                         /**< Entries in the index */
+    double threshold;                       /**< Similarity that counts as a match */
+    unsigned char key[SIPHASH_KEY_SIZE];    /**< Random key for positions and hashes */
+    uint8_t positions[NEAR_DUPLICATE_BANDS][NEAR_DUPLICATE_MAX_LENGTH + 1]
+                     [NEAR_DUPLICATE_BAND_POSITIONS]; /**< Sampled positions per band and length */
+} NearDuplicateIndex;
+
+/**
+ * @brief Create an empty set
+ * @param set Set to initialize
+ * @param expected Most passwords that will be inserted
+ * @return true if successful, false otherwise
+ *
+ * The set does not grow; inserting more than expected passwords slows it
+ * down and eventually reports UNIQUE_FULL.
+ */
+bool unique_set_init(UniqueSet *set, size_t expected);
+
+/**
+ * @brief Insert a password unless it is already present
+ * @param set Set to insert into (safe to call from several threads)
+ * @param password Password to insert
+ * @param length Length of the password
+ * @return UNIQUE_INSERTED, UNIQUE_DUPLICATE or UNIQUE_FULL
+ */
+UniqueInsertResult unique_set_insert(UniqueSet *set, const char *password, size_t length);
+
+/**
+ * @brief Check whether a password is in the set
+ * @param set Set to search
+ * @param password Password to look up
+ * @param length Length of the password
+ * @return true if present
+ */
+bool unique_set_contains(const UniqueSet *set, const char *password, size_t length);
+
+/**
+ * @brief Count the passwords in the set
+ * @param set Set to count
+ * @return Number of entries (walks every slot)
+ */
+size_t unique_set_count(const UniqueSet *set);
+
+/**
+ * @brief Release a set
+ * @param set Set to destroy
+ */
+void unique_set_destroy(UniqueSet *set);
+
+/**
+ * @brief Mark batch entries equal to an earlier entry or a set member
+ * @param set Set of passwords seen so far; batch entries are added
+ * @param batch Password batch
+ * @param begin First entry to check
+ * @param end One past the last entry to check
+ * @param assessments Assessments of entries [begin, end) whose is_duplicate is set
+ * @return Number of duplicates found
+ */
+size_t unique_set_mark_batch(UniqueSet *set, const PasswordBatch *batch, size_t begin,
+                             size_t end, SecurityAssessment *assessments);
+
+/**
+ * @brief Index a batch for near-duplicate queries
+ * @param index Index to build
+ * @param entries Passwords to index (must outlive the index)
+ * @param threshold Similarity that counts as a match (0-1)
+ * @return true if successful, false otherwise
+ */
+bool near_duplicate_index_build(NearDuplicateIndex *index, const PasswordBatch *entries,
+                                double threshold);
+
+/**
+ * @brief Find an indexed password similar to a candidate
+ * @param index Built index (safe to query from several threads)
+ * @param password NUL-terminated candidate
+ * @param length Length of the candidate
+ * @return Index of a similar entry in the indexed batch, or SIZE_MAX if none
+ */
+size_t near_duplicate_find(const NearDuplicateIndex *index, const char *password, size_t length);
+
+/**
+ * @brief Release an index
+ * @param index Index to destroy
+ */
+void near_duplicate_index_destroy(NearDuplicateIndex *index);
+
+#endif /* DEDUP_H */
\ No newline at end of file
@@ -0,0 +1,373 @@
+/**
+ * @file encrypted.c
+ * @brief Encrypted password files implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "encrypted.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+/* Header field offsets */
+#define HEADER_CHUNK_SIZE 8
+#define HEADER_NONCE_PREFIX 16
+
+/* Process-wide key set with --key-file */
+static unsigned char active_key[ENCRYPTED_KEY_SIZE];
+static bool active_key_set = false;
+
+static uint32_t load32_le(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Build the nonce of one chunk
+ */
+static void chunk_nonce(const unsigned char *header, uint32_t counter, bool last,
+                        unsigned char nonce[CHACHA20_NONCE_SIZE]) {
+    memcpy(nonce, header + HEADER_NONCE_PREFIX, ENCRYPTED_NONCE_PREFIX_SIZE);
+    nonce[7] = (unsigned char)(counter >> 24);
+    nonce[8] = (unsigned char)(counter >> 16);
+    nonce[9] = (unsigned char)(counter >> 8);
+    nonce[10] = (unsigned char)counter;
+    nonce[11] = last ? 1 : 0;
+}
+
+/**
+ * @brief Start an encrypted file
+ */
+bool encrypted_writer_init(EncryptedWriter *writer, const unsigned char key[ENCRYPTED_KEY_SIZE],
+                           size_t chunk_size, EncryptedSink sink, void *context) {
+    if (!writer) {
+        return false;
+    }
+    
+    memset(writer, 0, sizeof(EncryptedWriter));
+    
+    if (!key || !sink || chunk_size < ENCRYPTED_MIN_CHUNK_SIZE ||
+        chunk_size > ENCRYPTED_MAX_CHUNK_SIZE) {
+        return false;
+    }
+    
+    if (!secure_arena_init(&writer->arena, chunk_size + POLY1305_TAG_SIZE)) {
+        return false;
+    }
+    
+    writer->chunk = (unsigned char *)secure_arena_alloc(&writer->arena,
+                                                        chunk_size + POLY1305_TAG_SIZE, 64);
+    if (!writer->chunk ||
+        !get_random_bytes(writer->header + HEADER_NONCE_PREFIX, ENCRYPTED_NONCE_PREFIX_SIZE)) {
+        secure_arena_destroy(&writer->arena);
+        return false;
+    }
+    
+    memcpy(writer->header, ENCRYPTED_MAGIC, 8);
+    for (int i = 0; i < 4; i++) {
+        writer->header[HEADER_CHUNK_SIZE + i] = (unsigned char)(chunk_size >> (8 * i));
+    }
+    
+    memcpy(writer->key, key, ENCRYPTED_KEY_SIZE);
+    writer->chunk_size = chunk_size;
+    writer->sink = sink;
+    writer->sink_context = context;
+    return true;
+}
+
+/**
+ * @brief Seal the buffered chunk and hand it to the sink
+ */
+static void encrypted_writer_seal(EncryptedWriter *writer, bool last) {
+    unsigned char nonce[CHACHA20_NONCE_SIZE];
+    
+    /* A counter that would wrap must not reuse a nonce */
+    if (writer->failed || (!last && writer->counter == UINT32_MAX)) {
+        writer->failed = true;
+        return;
+    }
+    
+    if (!writer->header_written) {
+        writer->failed = !writer->sink(writer->sink_context, writer->header, ENCRYPTED_HEADER_SIZE);
+        writer->header_written = true;
+    }
+    
+    chunk_nonce(writer->header, writer->counter, last, nonce);
+    chacha20_poly1305_seal(writer->key, nonce, writer->header, ENCRYPTED_HEADER_SIZE,
+                           writer->chunk, writer->used, writer->chunk + writer->used);
+                           
+    if (!writer->failed) {
+        writer->failed = !writer->sink(writer->sink_context, writer->chunk,
+                                       writer->used + POLY1305_TAG_SIZE);
+    }
+    
+    secure_clear(writer->chunk, writer->used + POLY1305_TAG_SIZE);
+    writer->used = 0;
+    writer->counter++;
+}
+
+/**
+ * @brief Encrypt more plaintext
+ */
+bool encrypted_writer_write(EncryptedWriter *writer, const void *data, size_t size) {
+    const unsigned char *in = (const unsigned char *)data;
+    
+    if (!writer || !writer->chunk) {
+        return false;
+    }
+    
+    while (size > 0 && !writer->failed) {
+        if (writer->used == writer->chunk_size) {
+            encrypted_writer_seal(writer, false);
+        }
+        
+        size_t room = writer->chunk_size - writer->used;
+        size_t take = size < room ? size : room;
+        memcpy(writer->chunk + writer->used, in, take);
+        writer->used += take;
+        in += take;
+        size -= take;
+    }
+    
+    return !writer->failed;
+}
+
+/**
+ * @brief Seal the final chunk
+ */
+bool encrypted_writer_finish(EncryptedWriter *writer) {
+    if (!writer || !writer->chunk) {
+        return false;
+    }
+    
+    encrypted_writer_seal(writer, true);
+    return !writer->failed;
+}
+
+/**
+ * @brief Wipe and release a writer
+ */
+void encrypted_writer_wipe(EncryptedWriter *writer) {
+    if (writer) {
+        secure_arena_destroy(&writer->arena);
+        secure_clear(writer, sizeof(EncryptedWriter));
+    }
+}
+
+/**
+ * @brief Check whether data starts with an encrypted file header
+ */
+bool encrypted_has_header(const void *data, size_t size) {
+    return data && size >= ENCRYPTED_HEADER_SIZE && memcmp(data, ENCRYPTED_MAGIC, 8) == 0;
+}
+
+/**
+ * @brief Read and check the chunk size of a header
+ * @return Chunk size, or 0 if the header is invalid
+ */
+static size_t header_chunk_size(const unsigned char *header) {
+    size_t chunk_size = load32_le(header + HEADER_CHUNK_SIZE);
+    
+    if (chunk_size < ENCRYPTED_MIN_CHUNK_SIZE || chunk_size > ENCRYPTED_MAX_CHUNK_SIZE ||
+        load32_le(header + 12) != 0) {
+        return 0;
+    }
+    
+    return chunk_size;
+}
+
+/**
+ * @brief Get the plaintext size of an encrypted file
+ */
+size_t encrypted_plaintext_size(const void *data, size_t size) {
+    if (!encrypted_has_header(data, size)) {
+        return SIZE_MAX;
+    }
+    
+    size_t chunk_size = header_chunk_size((const unsigned char *)data);
+    size_t body = size - ENCRYPTED_HEADER_SIZE;
+    if (chunk_size == 0 || body < POLY1305_TAG_SIZE) {
+        return SIZE_MAX;
+    }
+    
+    /* Every chunk but the last is full, and the last holds at least its tag */
+    size_t record = chunk_size + POLY1305_TAG_SIZE;
+    size_t chunks = (body + record - 1) / record;
+    size_t last = body - (chunks - 1) * record;
+    if (last < POLY1305_TAG_SIZE || (uint64_t)chunks - 1 > UINT32_MAX) {
+        return SIZE_MAX;
+    }
+    
+    return body - chunks * POLY1305_TAG_SIZE;
+}
+
+/**
+ * @brief Verify and decrypt a whole encrypted file
+ */
+bool encrypted_decrypt(const unsigned char key[ENCRYPTED_KEY_SIZE], const void *data,
+                       size_t size, void *plaintext) {
+    size_t remaining = encrypted_plaintext_size(data, size);
+    
+    if (!key || remaining == SIZE_MAX || (remaining > 0 && !plaintext)) {
+        return false;
+    }
+    
+    const unsigned char *header = (const unsigned char *)data;
+    const unsigned char *in = header + ENCRYPTED_HEADER_SIZE;
+    unsigned char *out = (unsigned char *)plaintext;
+    size_t chunk_size = header_chunk_size(header);
+    unsigned char nonce[CHACHA20_NONCE_SIZE];
+    uint32_t counter = 0;
+    
+    for (;;) {
+        bool last = remaining <= chunk_size;
+        size_t take = last ? remaining : chunk_size;
+        
+        /* Copy first so the mapped input is never written to */
+        memcpy(out, in, take);
+        chunk_nonce(header, counter, last, nonce);
+        if (!chacha20_poly1305_open(key, nonce, header, ENCRYPTED_HEADER_SIZE,
+                                    out, take, in + take)) {
+            return false;
+        }
+        
+        if (last) {
+            return true;
+        }
+        
+        in += take + POLY1305_TAG_SIZE;
+        out += take;
+        remaining -= take;
+        counter++;
+    }
+}
+
+/**
+ * @brief Check whether a file name asks for encryption
+ */
+bool encrypted_filename(const char *filename) {
+    if (!filename) {
+        return false;
+    }
+    
+    size_t length = strlen(filename);
+    size_t extension = strlen(ENCRYPTED_EXTENSION);
+    return length > extension && strcmp(filename + length - extension, ENCRYPTED_EXTENSION) == 0;
+}
+
+/**
+ * @brief Decode one hex digit
+ * @return Digit value, or -1 if c is not a hex digit
+ */
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Load the process-wide file key
+ */
+bool encryption_load_key_file(const char *path) {
+    unsigned char text[2 * ENCRYPTED_KEY_SIZE + 8];
+    unsigned char key[ENCRYPTED_KEY_SIZE];
+    bool ok = false;
+    
+    FILE *file = path ? fopen(path, "rb") : NULL;
+    if (!file) {
+        return false;
+    }
+    
+    size_t size = fread(text, 1, sizeof(text), file);
+    fclose(file);
+    
+    if (size == ENCRYPTED_KEY_SIZE) {
+        memcpy(key, text, ENCRYPTED_KEY_SIZE);
+        ok = true;
+    } else {
+        while (size > 0 && isspace(text[size - 1])) {
+            size--;
+        }
+        
+        ok = size == 2 * ENCRYPTED_KEY_SIZE;
+        for (size_t i = 0; ok && i < ENCRYPTED_KEY_SIZE; i++) {
+            int high = hex_value(text[2 * i]);
+            int low = hex_value(text[2 * i + 1]);
+            ok = high >= 0 && low >= 0;
+            key[i] = (unsigned char)(high << 4 | low);
+        }
+    }
+    
+    if (ok) {
+        memcpy(active_key, key, ENCRYPTED_KEY_SIZE);
+        active_key_set = true;
+    }
+    
+    secure_clear(text, sizeof(text));
+    secure_clear(key, sizeof(key));
+    return ok;
+}
+
+/**
+ * @brief Create a key file with a fresh random key
+ */
+bool encryption_generate_key_file(const char *path) {
+    static const char digits[] = "0123456789abcdef";
+    unsigned char key[ENCRYPTED_KEY_SIZE];
+    char text[2 * ENCRYPTED_KEY_SIZE + 1];
+    
+    if (!path || !get_random_bytes(key, sizeof(key))) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < ENCRYPTED_KEY_SIZE; i++) {
+        text[2 * i] = digits[key[i] >> 4];
+        text[2 * i + 1] = digits[key[i] & 15];
+    }
+    text[2 * ENCRYPTED_KEY_SIZE] = '\n';
+    secure_clear(key, sizeof(key));
+    
+    /* Refuse to overwrite: replacing a key makes its files unreadable */
+#ifdef _WIN32
+    FILE *file = fopen(path, "wx");
+#else
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    FILE *file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (fd >= 0 && !file) {
+        close(fd);
+    }
+#endif
+    if (!file) {
+        secure_clear(text, sizeof(text));
+        return false;
+    }
+    
+    bool ok = fwrite(text, 1, sizeof(text), file) == sizeof(text);
+    ok = fclose(file) == 0 && ok;
+    secure_clear(text, sizeof(text));
+    return ok;
+}
+
+/**
+ * @brief Get the process-wide file key
+ */
+const unsigned char *encryption_key(void) {
+    return active_key_set ? active_key : NULL;
+}
+
+/**
+ * @brief Wipe the process-wide file key
+ */
+void encryption_clear_key(void) {
+    secure_clear(active_key, sizeof(active_key));
+    active_key_set = false;
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+/**
+ * @file encrypted.h
+ * @brief Encrypted password files (ChaCha20-Poly1305 in the STREAM construction)
+ * @version 1.0
+ * @date 2024
+ *
+ * An encrypted file is a 32-byte header followed by chunks. Every chunk
+ * but the last holds exactly chunk_size bytes of plaintext; each is sealed
+ * with ChaCha20-Poly1305 under the nonce
+ *
+ *     nonce_prefix (7 bytes) | chunk counter (4 bytes, big endian) | last (1 byte)
+ *
+ * with the header as associated data, and followed by its 16-byte tag.
+ * Reordered, dropped, truncated or appended chunks therefore fail to
+ * authenticate, and memory use is one chunk whatever the file size.
+ */
+
+#ifndef ENCRYPTED_H
+#define ENCRYPTED_H
+
+#include "crypto.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ENCRYPTED_MAGIC "SPGENC01"
+
+/**
+ * @brief Encrypted file layout
+ */
+#define ENCRYPTED_HEADER_SIZE 32                /**< magic, chunk size, reserved, nonce prefix */
+#define ENCRYPTED_KEY_SIZE CHACHA20_KEY_SIZE    /**< 256-bit file key */
+#define ENCRYPTED_NONCE_PREFIX_SIZE 7           /**< Random per-file part of every nonce */
+#define ENCRYPTED_MIN_CHUNK_SIZE 1024           /**< Smallest chunk size a reader accepts */
+#define ENCRYPTED_MAX_CHUNK_SIZE (16u << 20)    /**< Largest chunk size a reader accepts */
+
+/**
+ * @brief Destination of sealed chunks
+ * @param context Caller-supplied context
+ * @param data Bytes to write
+ * @param size Number of bytes
+ * @return true if everything was written, false otherwise
+ */
+typedef bool (*EncryptedSink)(void *context, const unsigned char *data, size_t size);
+
+/**
+ * @brief Incremental encrypted file writer
+ *
+ * Plaintext collects in one locked chunk buffer that is sealed in place.
+ * A full chunk is only sealed once more data arrives, so the final chunk
+ * can carry the last flag.
+ */
+typedef struct EncryptedWriter {
+    unsigned char key[ENCRYPTED_KEY_SIZE];          /**< File key */
+    unsigned char header[ENCRYPTED_HEADER_SIZE];    /**< Header, also each chunk's associated data */
+    SecureArena arena;                              /**< Locked chunk memory */
+    unsigned char *chunk;                           /**< Chunk buffer (chunk_size + tag) */
+    size_t chunk_size;                              /**< Plaintext bytes per chunk */
+    size_t used;                                    /**< Plaintext bytes in the chunk buffer */
+    uint32_t counter;                               /**< Chunks sealed so far */
+    bool header_written;                            /**< Header has gone to the sink */
+    bool failed;                                    /**< The sink failed or the counter ran out */
+    EncryptedSink sink;                             /**< Destination */
+    void *sink_context;                             /**< Context passed to sink */
+} EncryptedWriter;
+
+/**
+ * @brief Start an encrypted file
+ * @param writer Writer to initialize
+ * @param key File key
+ * @param chunk_size Plaintext bytes per chunk (ENCRYPTED_MIN_CHUNK_SIZE to ENCRYPTED_MAX_CHUNK_SIZE)
+ * @param sink Destination of the header and chunks
+ * @param context Context passed to sink
+ * @return true if successful, false otherwise
+ */
+bool encrypted_writer_init(EncryptedWriter *writer, const unsigned char key[ENCRYPTED_KEY_SIZE],
+                           size_t chunk_size, EncryptedSink sink, void *context);
+
+/**
+ * @brief Encrypt more plaintext
+ * @param writer Initialized writer
+ * @param data Plaintext bytes
+ * @param size Number of bytes
+ * @return true if successful, false once anything failed
+ */
+bool encrypted_writer_write(EncryptedWriter *writer, const void *data, size_t size);
+
+/**
+ * @brief Seal the final chunk
+ * @param writer Initialized writer
+ * @return true if the whole file was written, false otherwise
+ */
+bool encrypted_writer_finish(EncryptedWriter *writer);
+
+/**
+ * @brief Wipe and release a writer
+ * @param writer Writer to wipe
+ */
+void encrypted_writer_wipe(EncryptedWriter *writer);
+
+/**
+ * @brief Check whether data starts with an encrypted file header
+ * @param data File contents
+ * @param size Size of the contents
+ * @return true if the magic matches
+ */
+bool encrypted_has_header(const void *data, size_t size);
+
+/**
+ * @brief Get the plaintext size of an encrypted file
+ * @param data File contents
+ * @param size Size of the contents
+ * @return Plaintext size, or SIZE_MAX if the layout is invalid
+ */
+size_t encrypted_plaintext_size(const void *data, size_t size);
+
+/**
+ * @brief Verify and decrypt a whole encrypted file
+ * @param key File key
+ * @param data File contents
+ * @param size Size of the contents
+ * @param plaintext Buffer of encrypted_plaintext_size() bytes
+ * @return true if every chunk authenticated, false otherwise
+ *
+ * Chunks are decrypted straight into plaintext one at a time; on failure
+ * the caller must wipe the partially filled buffer.
+ */
+bool encrypted_decrypt(const unsigned char key[ENCRYPTED_KEY_SIZE], const void *data,
+                       size_t size, void *plaintext);
+
+/**
+ * @brief Check whether a file name asks for encryption
+ * @param filename File name (may be NULL)
+ * @return true if it ends with ENCRYPTED_EXTENSION
+ */
+bool encrypted_filename(const char *filename);
+
+/**
+ * @brief Load the process-wide file key
+ * @param path Key file: 32 raw bytes or 64 hex digits
+ * @return true if a key was loaded, false otherwise
+ */
+bool encryption_load_key_file(const char *path);
+
+/**
+ * @brief Create a key file with a fresh random key
+ * @param path Key file to create (must not exist; readable by the owner only)
+ * @return true if successful, false otherwise
+ */
+bool encryption_generate_key_file(const char *path);
+
+/**
+ * @brief Get the process-wide file key
+ * @return Key, or NULL if none was loaded
+ */
+const unsigned char *encryption_key(void);
+
+/**
+ * @brief Wipe the process-wide file key
+ */
+void encryption_clear_key(void);
+
+#endif /* ENCRYPTED_H */
\ No newline at end of file
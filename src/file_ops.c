@@ -5,7 +5,18 @@
  * @date 2024
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE     /* O_DIRECT and fallocate() */
+#endif
+
+#include "file_ops.h"
 #include "password.h"
+#include "security.h"
+#include "crypto.h"
+#include "stats.h"
+#include "parallel.h"
+#include "encrypted.h"
+#include "spg_archive.h"
 #include "utils.h"
 #include "config.h"
 #include <stdio.h>
@@ -13,414 +24,2281 @@
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <math.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
+#endif
+
+/* Initial buffer size when a file has to be read rather than mapped */
+#define PASSWORD_FILE_READ_CHUNK (1u << 20)
+
+static bool export_results(const PasswordResult *results, size_t count,
+                           const char *filename, ExportFormat format,
+                           bool include_metadata);
+
+/**
+ * @brief Save password to text file
+ */
+bool save_password_to_file(const PasswordResult *result, const char *filename, 
+                          bool append, bool include_metadata) {
+    if (!result || !result->password || !filename) {
+        return false;
+    }
+    
+    /* An authenticated stream cannot be appended to, only rewritten */
+    if (encrypted_filename(filename)) {
+        if (append) {
+            fprintf(stderr, "Error: cannot append to encrypted file %s\n", filename);
+            return false;
+        }
+        return export_results(result, 1, filename, EXPORT_FORMAT_TEXT, include_metadata);
+    }
+    
+    FILE *file = fopen(filename, append ? "a" : "w");
+    if (!file) {
+        fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
+        return false;
+    }
+    
+    if (include_metadata) {
+        char timestamp[64];
+        get_timestamp(timestamp, sizeof(timestamp), NULL);
+        
+        fprintf(file, "=== Password Entry ===\n");
+        fprintf(file, "Date: %s\n", timestamp);
+        fprintf(file, "Password: %s\n", result->password);
+        fprintf(file, "Length: %zu characters\n", result->length);
+        fprintf(file, "Entropy: %.1f bits\n", result->entropy);
+        fprintf(file, "Strength: %s (%d/100)\n", result->strength, result->strength_score);
+        fprintf(file, "=====================\n\n");
+    } else {
+        fprintf(file, "%s\n", result->password);
+    }
+    
+    fclose(file);
+    return true;
+}
+
+/* Two-digit lookup for integer formatting */
+static const char decimal_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Non-zero for bytes a JSON string body has to escape */
+static const unsigned char json_escape_needed[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,     /* '"' */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0      /* '\\' */
+};
+
+/**
+ * @brief Hand a block to the operating system, retrying short writes
+ */
+static bool output_write_raw(OutputBuffer *out, const char *data, size_t size) {
+    StatsTimer timer = stats_begin();
+    uint64_t before = out->written;
+    bool ok = true;
+    
+#ifdef _WIN32
+    if (fwrite(data, 1, size, out->file) != size) {
+        ok = false;
+    } else {
+        out->written += size;
+    }
+#else
+    int fd = fileno(out->file);
+    while (ok && size > 0) {
+        ssize_t got = write(fd, data, size);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        data += got;
+        size -= (size_t)got;
+        out->written += (uint64_t)got;
+    }
+#endif
+    
+    stats_end(STATS_IO, &timer, out->written - before);
+    return ok;
+}
+
+/**
+ * @brief Hand a block to the operating system, encrypting it first if asked to
+ */
+static bool output_write_all(OutputBuffer *out, const char *data, size_t size) {
+    if (out->cipher) {
+        return encrypted_writer_write(out->cipher, data, size);
+    }
+    return output_write_raw(out, data, size);
+}
+
+/**
+ * @brief EncryptedSink writing sealed chunks to an output buffer's stream
+ */
+static bool output_cipher_sink(void *context, const unsigned char *data, size_t size) {
+    return output_write_raw((OutputBuffer *)context, (const char *)data, size);
+}
+
+/**
+ * @brief Background writer behind an asynchronous output buffer
+ *
+ * The caller fills one half while at most one other half is pending or
+ * being written, which bounds both memory and how far generation can run
+ * ahead of the disk.
+ */
+struct OutputWriterThread {
+    ParallelThread thread;
+    ParallelMutex lock;
+    ParallelCond changed;   /**< Signalled when pending or stop changes */
+    char *halves[2];        /**< Alternating buffers */
+    size_t filling;         /**< Half the caller writes into */
+    const char *pending;    /**< Half handed to the writer (NULL = idle) */
+    size_t pending_size;    /**< Bytes in the pending half */
+    bool failed;            /**< A write error occurred */
+    bool stop;              /**< Exit once nothing is pending */
+};
+
+/**
+ * @brief Writer thread: write and wipe each half it is handed
+ */
+static void output_writer_main(void *context, size_t index, size_t count) {
+    OutputBuffer *out = (OutputBuffer *)context;
+    struct OutputWriterThread *async = out->async;
+    (void)index;
+    (void)count;
+    
+    parallel_mutex_lock(&async->lock);
+    for (;;) {
+        while (!async->pending && !async->stop) {
+            parallel_cond_wait(&async->changed, &async->lock);
+        }
+        if (!async->pending) {
+            break;
+        }
+        
+        char *data = (char *)async->pending;
+        size_t size = async->pending_size;
+        bool skip = async->failed;
+        parallel_mutex_unlock(&async->lock);
+        
+        /* Write without the lock so the caller keeps filling the other half */
+        bool ok = skip || output_write_all(out, data, size);
+        secure_clear(data, size);
+        
+        parallel_mutex_lock(&async->lock);
+        if (!ok) {
+            async->failed = true;
+        }
+        async->pending = NULL;
+        parallel_cond_broadcast(&async->changed);
+    }
+    parallel_mutex_unlock(&async->lock);
+}
+
+/**
+ * @brief Hand the filled half to the writer and switch to the other one
+ *
+ * Blocks only while the writer is still busy with the previous half.
+ */
+static void output_async_submit(OutputBuffer *out) {
+    struct OutputWriterThread *async = out->async;
+    
+    if (out->used == 0) {
+        return;
+    }
+    
+    parallel_mutex_lock(&async->lock);
+    while (async->pending) {
+        parallel_cond_wait(&async->changed, &async->lock);
+    }
+    if (async->failed) {
+        out->failed = true;
+    }
+    if (!out->failed) {
+        async->pending = out->data;
+        async->pending_size = out->used;
+        parallel_cond_broadcast(&async->changed);
+    } else {
+        secure_clear(out->data, out->used);
+    }
+    parallel_mutex_unlock(&async->lock);
+    
+    async->filling ^= 1;
+    out->data = async->halves[async->filling];
+    out->used = 0;
+}
+
+/**
+ * @brief Wait until the writer has written everything handed to it
+ */
+static void output_async_drain(OutputBuffer *out) {
+    struct OutputWriterThread *async = out->async;
+    
+    parallel_mutex_lock(&async->lock);
+    while (async->pending) {
+        parallel_cond_wait(&async->changed, &async->lock);
+    }
+    if (async->failed) {
+        out->failed = true;
+    }
+    parallel_mutex_unlock(&async->lock);
+}
+
+/**
+ * @brief Make room in a full buffer
+ */
+static void output_buffer_make_room(OutputBuffer *out) {
+    if (out->async) {
+        output_async_submit(out);
+    } else {
+        output_buffer_flush(out);
+    }
+}
+
+/**
+ * @brief Set up an output buffer in front of a stream
+ */
+bool output_buffer_init(OutputBuffer *out, FILE *file) {
+    if (!out || !file) {
+        return false;
+    }
+    
+    memset(out, 0, sizeof(OutputBuffer));
+    
+    /* Writes bypass stdio from here on, so drain it first */
+    if (fflush(file) != 0) {
+        return false;
+    }
+    
+    if (!secure_arena_init(&out->arena, OUTPUT_BUFFER_SIZE)) {
+        return false;
+    }
+    
+    out->data = (char *)secure_arena_alloc(&out->arena, OUTPUT_BUFFER_SIZE, 64);
+    if (!out->data) {
+        secure_arena_destroy(&out->arena);
+        return false;
+    }
+    
+    out->file = file;
+    out->capacity = OUTPUT_BUFFER_SIZE;
+    return true;
+}
+
+/**
+ * @brief Set up an output buffer drained by a background writer thread
+ */
+bool output_buffer_init_async(OutputBuffer *out, FILE *file) {
+    if (!out || !file) {
+        return false;
+    }
+    
+    memset(out, 0, sizeof(OutputBuffer));
+    
+    if (fflush(file) != 0) {
+        return false;
+    }
+    
+    struct OutputWriterThread *async =
+        (struct OutputWriterThread *)calloc(1, sizeof(struct OutputWriterThread));
+    if (!async) {
+        return output_buffer_init(out, file);
+    }
+    
+    if (!secure_arena_init(&out->arena, 2 * OUTPUT_BUFFER_SIZE)) {
+        free(async);
+        return false;
+    }
+    
+    async->halves[0] = (char *)secure_arena_alloc(&out->arena, OUTPUT_BUFFER_SIZE, 64);
+    async->halves[1] = (char *)secure_arena_alloc(&out->arena, OUTPUT_BUFFER_SIZE, 64);
+    if (!async->halves[0] || !async->halves[1]) {
+        secure_arena_destroy(&out->arena);
+        free(async);
+        return false;
+    }
+    
+    parallel_mutex_init(&async->lock);
+    parallel_cond_init(&async->changed);
+    
+    out->file = file;
+    out->data = async->halves[0];
+    out->capacity = OUTPUT_BUFFER_SIZE;
+    out->async = async;
+    
+    if (!parallel_thread_start(&async->thread, output_writer_main, out)) {
+        /* No thread: keep the first half as an ordinary buffer */
+        parallel_cond_destroy(&async->changed);
+        parallel_mutex_destroy(&async->lock);
+        free(async);
+        out->async = NULL;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Encrypt everything written to an output buffer from now on
+ */
+bool output_buffer_encrypt(OutputBuffer *out, const unsigned char key[ENCRYPTED_KEY_SIZE]) {
+    if (!out || !out->data || !key || out->used > 0 || out->written > 0 || out->cipher) {
+        return false;
+    }
+    
+    EncryptedWriter *cipher = (EncryptedWriter *)calloc(1, sizeof(EncryptedWriter));
+    if (!cipher) {
+        return false;
+    }
+    
+    if (!encrypted_writer_init(cipher, key, ENCRYPTED_CHUNK_SIZE, output_cipher_sink, out)) {
+        free(cipher);
+        return false;
+    }
+    
+    /* The idle writer thread sees this at its first hand-off, under its lock */
+    out->cipher = cipher;
+    return true;
+}
+
+/**
+ * @brief Write everything buffered to the stream
+ */
+bool output_buffer_flush(OutputBuffer *out) {
+    if (!out || !out->data) {
+        return false;
+    }
+    
+    if (out->async) {
+        output_async_submit(out);
+        output_async_drain(out);
+        return !out->failed;
+    }
+    
+    if (out->used > 0 && !out->failed) {
+        out->failed = !output_write_all(out, out->data, out->used);
+    }
+    
+    secure_clear(out->data, out->used);
+    out->used = 0;
+    return !out->failed;
+}
+
+/**
+ * @brief Append raw bytes
+ */
+void output_buffer_write(OutputBuffer *out, const char *data, size_t size) {
+    if (size <= out->capacity - out->used) {
+        memcpy(out->data + out->used, data, size);
+        out->used += size;
+        return;
+    }
+    
+    /* Asynchronous: split the payload across halves so no write blocks here */
+    if (out->async) {
+        while (size > 0) {
+            if (out->used == out->capacity) {
+                output_async_submit(out);
+            }
+            size_t room = out->capacity - out->used;
+            size_t take = size < room ? size : room;
+            memcpy(out->data + out->used, data, take);
+            out->used += take;
+            data += take;
+            size -= take;
+        }
+        return;
+    }
+    
+    if (size < out->capacity / 2) {
+        output_buffer_flush(out);
+        memcpy(out->data, data, size);
+        out->used = size;
+        return;
+    }
+    
+    /* Large payload: buffer and payload leave in one system call */
+#ifdef _WIN32
+    output_buffer_flush(out);
+    if (!out->failed) {
+        out->failed = !output_write_all(out, data, size);
+    }
+#else
+    if (out->cipher) {
+        /* The cipher has to see everything in order */
+        output_buffer_flush(out);
+        if (!out->failed) {
+            out->failed = !output_write_all(out, data, size);
+        }
+        return;
+    }
+    
+    if (!out->failed) {
+        struct iovec iov[2];
+        iov[0].iov_base = out->data;
+        iov[0].iov_len = out->used;
+        iov[1].iov_base = (void *)data;
+        iov[1].iov_len = size;
+        
+        ssize_t got;
+        do {
+            got = writev(fileno(out->file), iov, 2);
+        } while (got < 0 && errno == EINTR);
+        
+        if (got < 0) {
+            out->failed = true;
+        } else {
+            /* Finish whatever a short writev left behind */
+            size_t done = (size_t)got;
+            out->written += (uint64_t)done;
+            if (done < out->used) {
+                out->failed = !output_write_all(out, out->data + done, out->used - done) ||
+                              !output_write_all(out, data, size);
+            } else if (done - out->used < size) {
+                out->failed = !output_write_all(out, data + (done - out->used),
+                                                size - (done - out->used));
+            }
+        }
+    }
+    secure_clear(out->data, out->used);
+    out->used = 0;
+#endif
+}
+
+/**
+ * @brief Append a NUL-terminated string
+ */
+void output_buffer_puts(OutputBuffer *out, const char *text) {
+    output_buffer_write(out, text, strlen(text));
+}
+
+/**
+ * @brief Append a single character
+ */
+void output_buffer_putc(OutputBuffer *out, char c) {
+    if (out->used == out->capacity) {
+        output_buffer_make_room(out);
+    }
+    out->data[out->used++] = c;
+}
+
+/**
+ * @brief Append an unsigned integer in decimal
+ */
+void output_buffer_put_uint(OutputBuffer *out, uint64_t value, int min_digits) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = decimal_pairs[pair + 1];
+        *--p = decimal_pairs[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = (unsigned)value * 2;
+        *--p = decimal_pairs[pair + 1];
+        *--p = decimal_pairs[pair];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    
+    while (end - p < min_digits && p > digits) {
+        *--p = '0';
+    }
+    
+    output_buffer_write(out, p, (size_t)(end - p));
+}
+
+/**
+ * @brief Append a number in fixed-point notation
+ */
+void output_buffer_put_fixed(OutputBuffer *out, double value, int decimals) {
+    static const uint64_t scales[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+    
+    if (decimals < 0) decimals = 0;
+    if (decimals > 9) decimals = 9;
+    
+    /* Out of range for the integer path (or NaN): let printf handle it */
+    uint64_t scale = scales[decimals];
+    if (!(fabs(value) * (double)scale < 0x1p63)) {
+        output_buffer_printf(out, "%.*f", decimals, value);
+        return;
+    }
+    
+    if (value < 0) {
+        output_buffer_putc(out, '-');
+        value = -value;
+    }
+    
+    uint64_t scaled = (uint64_t)(value * (double)scale + 0.5);
+    
+    output_buffer_put_uint(out, scaled / scale, 1);
+    if (decimals > 0) {
+        output_buffer_putc(out, '.');
+        output_buffer_put_uint(out, scaled % scale, decimals);
+    }
+}
+
+/**
+ * @brief Append a CSV field body, doubling embedded quotes
+ */
+void output_buffer_put_csv(OutputBuffer *out, const char *text, size_t length) {
+    const char *end = text + length;
+    
+    /* Copy each quote-free run in one go */
+    while (text < end) {
+        const char *quote = (const char *)memchr(text, '"', (size_t)(end - text));
+        if (!quote) {
+            output_buffer_write(out, text, (size_t)(end - text));
+            return;
+        }
+        output_buffer_write(out, text, (size_t)(quote - text + 1));
+        output_buffer_putc(out, '"');
+        text = quote + 1;
+    }
+}
+
+/**
+ * @brief Append a JSON string body with the required escapes
+ */
+void output_buffer_put_json(OutputBuffer *out, const char *text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    size_t run = 0;
+    
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (!json_escape_needed[c]) {
+            continue;
+        }
+        
+        /* Flush the clean run before this character */
+        output_buffer_write(out, text + run, i - run);
+        run = i + 1;
+        
+        char escape[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t escape_length = 2;
+        switch (c) {
+            case '"':  escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 0x0F];
+                escape_length = 6;
+                break;
+        }
+        output_buffer_write(out, escape, escape_length);
+    }
+    
+    output_buffer_write(out, text + run, length - run);
+}
+
+/**
+ * @brief Append formatted text
+ */
+void output_buffer_printf(OutputBuffer *out, const char *format, ...) {
+    char text[512];
+    va_list args;
+    
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    
+    if (length > 0) {
+        output_buffer_write(out, text, (size_t)length < sizeof(text) ? (size_t)length : sizeof(text) - 1);
+    }
+}
+
+/**
+ * @brief Flush, wipe and release an output buffer
+ */
+bool output_buffer_free(OutputBuffer *out) {
+    if (!out || !out->data) {
+        return false;
+    }
+    
+    bool ok = output_buffer_flush(out);
+    
+    if (out->async) {
+        struct OutputWriterThread *async = out->async;
+        parallel_mutex_lock(&async->lock);
+        async->stop = true;
+        parallel_cond_broadcast(&async->changed);
+        parallel_mutex_unlock(&async->lock);
+        
+        parallel_thread_join(&async->thread);
+        parallel_cond_destroy(&async->changed);
+        parallel_mutex_destroy(&async->lock);
+        free(async);
+        out->async = NULL;
+    }
+    
+    /* Only now is the last chunk known */
+    if (out->cipher) {
+        if (!out->failed && !encrypted_writer_finish(out->cipher)) {
+            out->failed = true;
+            ok = false;
+        }
+        encrypted_writer_wipe(out->cipher);
+        free(out->cipher);
+        out->cipher = NULL;
+    }
+    
+    secure_arena_destroy(&out->arena);
+    out->data = NULL;
+    out->capacity = 0;
+    return ok;
+}
+
+/**
+ * @brief Determine export format from a name
+ */
+bool export_format_from_name(const char *name, ExportFormat *format) {
+    if (!name || !format) {
+        return false;
+    }
+    
+    static const struct {
+        const char *name;
+        ExportFormat format;
+    } names[] = {
+        {"plain", EXPORT_FORMAT_PLAIN},
+        {"text", EXPORT_FORMAT_TEXT},
+        {"txt", EXPORT_FORMAT_TEXT},
+        {"csv", EXPORT_FORMAT_CSV},
+        {"json", EXPORT_FORMAT_JSON},
+        {"spg", EXPORT_FORMAT_SPG},
+    };
+    
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        const char *a = name;
+        const char *b = names[i].name;
+        while (*a && tolower((unsigned char)*a) == *b) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && *b == '\0') {
+            *format = names[i].format;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Determine export format from a file extension
+ */
+ExportFormat export_format_from_filename(const char *filename, ExportFormat fallback) {
+    if (!filename) {
+        return fallback;
+    }
+    
+    /* "list.csv.enc" is an encrypted CSV file */
+    size_t length = strlen(filename);
+    if (encrypted_filename(filename)) {
+        length -= strlen(ENCRYPTED_EXTENSION);
+    }
+    
+    size_t dot = length;
+    while (dot > 0 && filename[dot - 1] != '.') {
+        dot--;
+    }
+    
+    char extension[16];
+    ExportFormat format;
+    size_t extension_length = length - dot;
+    
+    if (dot > 0 && extension_length > 0 && extension_length < sizeof(extension)) {
+        memcpy(extension, filename + dot, extension_length);
+        extension[extension_length] = '\0';
+        if (export_format_from_name(extension, &format)) {
+            return format;
+        }
+    }
+    
+    return fallback;
+}
+
+/**
+ * @brief Start an export document
+ */
+bool export_writer_begin(ExportWriter *writer, const char *filename,
+                         ExportFormat format, bool include_metadata,
+                         size_t expected_count) {
+    if (!writer) {
+        return false;
+    }
+    
+    memset(writer, 0, sizeof(ExportWriter));
+    writer->format = format;
+    writer->include_metadata = include_metadata;
+    
+    bool encrypted = encrypted_filename(filename);
+    if (encrypted && !encryption_key()) {
+        fprintf(stderr, "Error: %s needs an encryption key (use --key-file)\n", filename);
+        return false;
+    }
+    
+    if (!filename || strcmp(filename, "-") == 0) {
+        writer->file = stdout;
+        writer->owns_file = false;
+    } else {
+        writer->file = fopen(filename, encrypted || format == EXPORT_FORMAT_SPG ? "wb" : "w");
+        if (!writer->file) {
+            fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
+            return false;
+        }
+        writer->owns_file = true;
+    }
+    
+    /* Large or open-ended exports keep generating while earlier output is written */
+    bool async = expected_count == 0 || expected_count >= EXPORT_ASYNC_MIN_ENTRIES;
+    bool ready = async ? output_buffer_init_async(&writer->out, writer->file)
+                       : output_buffer_init(&writer->out, writer->file);
+    if (ready && encrypted && !output_buffer_encrypt(&writer->out, encryption_key())) {
+        output_buffer_free(&writer->out);
+        ready = false;
+    }
+    if (!ready) {
+        if (writer->owns_file) {
+            fclose(writer->file);
+        }
+        writer->file = NULL;
+        return false;
+    }
+    
+    get_timestamp(writer->timestamp, sizeof(writer->timestamp), NULL);
+    OutputBuffer *out = &writer->out;
+    
+    switch (format) {
+        case EXPORT_FORMAT_TEXT:
+            output_buffer_puts(out, "=== Password List ===\n");
+            output_buffer_printf(out, "Generated: %s\n", writer->timestamp);
+            if (expected_count > 0) {
+                output_buffer_printf(out, "Count: %zu passwords\n", expected_count);
+            }
+            output_buffer_puts(out, "=====================\n\n");
+            break;
+            
+        case EXPORT_FORMAT_CSV:
+            output_buffer_puts(out, "Index,Timestamp,Password,Length,Entropy,Strength,StrengthScore\n");
+            break;
+            
+        case EXPORT_FORMAT_JSON:
+            output_buffer_puts(out, "{\n");
+            output_buffer_puts(out, "  \"metadata\": {\n");
+            output_buffer_printf(out, "    \"generated\": \"%s\",\n", writer->timestamp);
+            if (expected_count > 0) {
+                output_buffer_printf(out, "    \"count\": %zu,\n", expected_count);
+            }
+            output_buffer_printf(out, "    \"application\": \"%s\"\n", PROGRAM_NAME);
+            output_buffer_puts(out, "  },\n");
+            output_buffer_puts(out, "  \"passwords\": [");
+            break;
+            
+        case EXPORT_FORMAT_SPG: {
+            SpgArchiveHeader header;
+            spg_archive_header_init(&header);
+            output_buffer_write(out, (const char *)&header, sizeof(header));
+            break;
+        }
+            
+        case EXPORT_FORMAT_PLAIN:
+        default:
+            break;
+    }
+    
+    writer->failed = out->failed;
+    return !writer->failed;
+}
+
+/**
+ * @brief Encode one entry in the writer's format
+ */
+static bool export_write_entry(ExportWriter *writer, const char *password, size_t length,
+                               double entropy, int score, uint8_t level, const char *strength) {
+    size_t index = writer->written + 1;
+    OutputBuffer *out = &writer->out;
+    
+    switch (writer->format) {
+        case EXPORT_FORMAT_TEXT:
+            if (writer->include_metadata) {
+                output_buffer_putc(out, '[');
+                output_buffer_put_uint(out, index, 3);
+                output_buffer_literal(out, "] ");
+                output_buffer_write(out, password, length);
+                output_buffer_literal(out, "\n    Length: ");
+                output_buffer_put_uint(out, length, 1);
+                output_buffer_literal(out, ", Entropy: ");
+                output_buffer_put_fixed(out, entropy, 1);
+                output_buffer_literal(out, " bits, Strength: ");
+                output_buffer_puts(out, strength);
+                output_buffer_literal(out, "\n\n");
+            } else {
+                output_buffer_write(out, password, length);
+                output_buffer_putc(out, '\n');
+            }
+            break;
+            
+        case EXPORT_FORMAT_CSV:
+            output_buffer_put_uint(out, index, 1);
+            output_buffer_putc(out, ',');
+            output_buffer_puts(out, writer->timestamp);
+            output_buffer_literal(out, ",\"");
+            output_buffer_put_csv(out, password, length);
+            output_buffer_literal(out, "\",");
+            output_buffer_put_uint(out, length, 1);
+            output_buffer_putc(out, ',');
+            output_buffer_put_fixed(out, entropy, 1);
+            output_buffer_literal(out, ",\"");
+            output_buffer_puts(out, strength);
+            output_buffer_literal(out, "\",");
+            output_buffer_put_uint(out, (uint64_t)(score > 0 ? score : 0), 1);
+            output_buffer_putc(out, '\n');
+            break;
+            
+        case EXPORT_FORMAT_JSON:
+            if (writer->written > 0) {
+                output_buffer_putc(out, ',');
+            }
+            output_buffer_literal(out, "\n    {\n      \"index\": ");
+            output_buffer_put_uint(out, index, 1);
+            output_buffer_literal(out, ",\n      \"password\": \"");
+            output_buffer_put_json(out, password, length);
+            output_buffer_literal(out, "\",\n      \"length\": ");
+            output_buffer_put_uint(out, length, 1);
+            output_buffer_literal(out, ",\n      \"entropy\": ");
+            output_buffer_put_fixed(out, entropy, 1);
+            output_buffer_literal(out, ",\n      \"strength\": \"");
+            output_buffer_puts(out, strength);
+            output_buffer_literal(out, "\",\n      \"strengthScore\": ");
+            output_buffer_put_uint(out, (uint64_t)(score > 0 ? score : 0), 1);
+            output_buffer_literal(out, "\n    }");
+            break;
+            
+        case EXPORT_FORMAT_SPG:
+            /* Only the text goes out now; the tables follow the blob */
+            output_buffer_write(out, password, length);
+            if (!spg_archive_tables_add(&writer->archive, length, entropy, score, level)) {
+                writer->failed = true;
+            }
+            break;
+            
+        case EXPORT_FORMAT_PLAIN:
+        default:
+            output_buffer_write(out, password, length);
+            output_buffer_putc(out, '\n');
+            break;
+    }
+    
+    writer->written++;
+    
+    if (out->failed) {
+        writer->failed = true;
+    }
+    return !writer->failed;
+}
+
+/**
+ * @brief Append one password to an export document
+ */
+bool export_writer_write(ExportWriter *writer, const PasswordResult *result) {
+    if (!writer || !writer->file || !result || !result->password) {
+        return false;
+    }
+    
+    bool known = result->strength && strcmp(result->strength, "Unknown") != 0;
+    uint8_t level = known ? get_strength_level(result->strength_score) : STRENGTH_LEVEL_UNKNOWN;
+    
+    StatsTimer timer = stats_begin();
+    bool written = export_write_entry(writer, result->password, result->length,
+                                      result->entropy, result->strength_score, level,
+                                      known ? result->strength : "Unknown");
+    stats_end(STATS_ENCODE, &timer, 0);
+    return written;
+}
+
+/**
+ * @brief Append a range of batch entries to an export document
+ */
+bool export_writer_write_batch(ExportWriter *writer, const PasswordBatch *batch,
+                               size_t begin, size_t end) {
+    if (!writer || !writer->file || !batch) {
+        return false;
+    }
+    
+    if (end > batch->count) {
+        end = batch->count;
+    }
+    
+    StatsTimer timer = stats_begin();
+    bool written = true;
+    for (size_t i = begin; i < end && written; i++) {
+        written = export_write_entry(writer, batch->chars + i * batch->stride, batch->lengths[i],
+                                     batch->entropy[i], batch->scores[i], batch->levels[i],
+                                     get_strength_level_label(batch->levels[i]));
+    }
+    stats_end(STATS_ENCODE, &timer, 0);
+    
+    return written;
+}
+
+/**
+ * @brief Write the padding, tables and footer that close an SPG archive
+ */
+static void export_write_spg_tables(ExportWriter *writer) {
+    static const char zeros[8] = {0};
+    SpgArchiveTables *tables = &writer->archive;
+    OutputBuffer *out = &writer->out;
+    SpgArchiveFooter footer;
+    
+    output_buffer_write(out, zeros, spg_archive_blob_padding(tables));
+    if (tables->count > 0) {
+        output_buffer_write(out, (const char *)tables->entries,
+                            tables->count * sizeof(SpgArchiveEntry));
+        output_buffer_write(out, (const char *)tables->offsets, (tables->count + 1) * sizeof(uint64_t));
+    } else {
+        output_buffer_write(out, zeros, sizeof(uint64_t));
+    }
+    
+    spg_archive_footer_init(&footer, tables);
+    output_buffer_write(out, (const char *)&footer, sizeof(footer));
+    spg_archive_tables_free(tables);
+}
+
+/**
+ * @brief Finish an export document and release the writer
+ */
+bool export_writer_end(ExportWriter *writer) {
+    if (!writer || !writer->file) {
+        return false;
+    }
+    
+    if (writer->format == EXPORT_FORMAT_JSON) {
+        output_buffer_puts(&writer->out, writer->written > 0 ? "\n  ]\n" : "]\n");
+        output_buffer_puts(&writer->out, "}\n");
+    } else if (writer->format == EXPORT_FORMAT_SPG) {
+        export_write_spg_tables(writer);
+    }
+    
+    if (!output_buffer_free(&writer->out)) {
+        writer->failed = true;
+    }
+    
+    if (fflush(writer->file) != 0 || ferror(writer->file)) {
+        writer->failed = true;
+    }
+    
+    if (writer->owns_file && fclose(writer->file) != 0) {
+        writer->failed = true;
+    }
+    
+    writer->file = NULL;
+    return !writer->failed;
+}
+
+/**
+ * @brief Write a whole result array through an export writer
+ */
+static bool export_results(const PasswordResult *results, size_t count,
+                           const char *filename, ExportFormat format,
+                           bool include_metadata) {
+    if (!results || count == 0 || !filename) {
+        return false;
+    }
+    
+    ExportWriter writer;
+    if (!export_writer_begin(&writer, filename, format, include_metadata, count)) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        if (!export_writer_write(&writer, &results[i])) {
+            break;
+        }
+    }
+    
+    return export_writer_end(&writer);
+}
+
+/**
+ * @brief Save a password batch in the given format
+ */
+bool save_password_batch(const PasswordBatch *batch, const char *filename,
+                         ExportFormat format, bool include_metadata) {
+    if (!batch || batch->count == 0 || !filename) {
+        return false;
+    }
+    
+    ExportWriter writer;
+    if (!export_writer_begin(&writer, filename, format, include_metadata, batch->count)) {
+        return false;
+    }
+    
+    export_writer_write_batch(&writer, batch, 0, batch->count);
+    return export_writer_end(&writer);
+}
+
+/**
+ * @brief Save multiple passwords to file
+ */
+bool save_bulk_passwords_to_file(const PasswordResult *results, size_t count,
+                                const char *filename, bool include_metadata) {
+    return export_results(results, count, filename, EXPORT_FORMAT_TEXT, include_metadata);
+}
+
+/**
+ * @brief Save passwords to CSV file
+ */
+bool save_passwords_to_csv(const PasswordResult *results, size_t count,
+                          const char *filename) {
+    return export_results(results, count, filename, EXPORT_FORMAT_CSV, true);
+}
+
+/**
+ * @brief Save passwords to JSON file
+ */
+bool save_passwords_to_json(const PasswordResult *results, size_t count,
+                           const char *filename) {
+    return export_results(results, count, filename, EXPORT_FORMAT_JSON, true);
+}
+
+/**
+ * @brief Read a stream into a heap buffer in large chunks
+ */
+static char *read_stream(FILE *stream, size_t *size) {
+    size_t capacity = PASSWORD_FILE_READ_CHUNK;
+    size_t used = 0;
+    char *buffer = (char *)malloc(capacity);
+    
+    if (!buffer) {
+        return NULL;
+    }
+    
+    size_t got;
+    while ((got = fread(buffer + used, 1, capacity - used, stream)) > 0) {
+        used += got;
+        
+        if (used == capacity) {
+            /* Grow by copying so the old buffer can be wiped */
+            char *grown = capacity <= SIZE_MAX / 2 ? (char *)malloc(capacity * 2) : NULL;
+            if (!grown) {
+                secure_clear(buffer, used);
+                free(buffer);
+                return NULL;
+            }
+            memcpy(grown, buffer, used);
+            secure_clear(buffer, used);
+            free(buffer);
+            buffer = grown;
+            capacity *= 2;
+        }
+    }
+    
+    if (ferror(stream)) {
+        secure_clear(buffer, used);
+        free(buffer);
+        return NULL;
+    }
+    
+    *size = used;
+    return buffer;
+}
+
+/**
+ * @brief Map a regular file copy-on-write
+ * @return true if mapped (an empty file counts as mapped with no data)
+ */
+static bool map_password_file(PasswordFile *file, const char *filename) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || GetFileType(handle) != FILE_TYPE_DISK ||
+        (unsigned long long)size.QuadPart > SIZE_MAX) {
+        CloseHandle(handle);
+        return false;
+    }
+    
+    if (size.QuadPart == 0) {
+        CloseHandle(handle);
+        file->mapped = true;
+        return true;
+    }
+    
+    /* The view keeps the mapping alive once both handles are closed */
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    void *map = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(handle);
+    if (!map) {
+        return false;
+    }
+    
+    file->size = (size_t)size.QuadPart;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    
+    if (st.st_size == 0) {
+        close(fd);
+        file->mapped = true;
+        return true;
+    }
+    
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    
+    posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    file->size = (size_t)st.st_size;
+#endif
+    
+    file->data = (char *)map;
+    file->mapped = true;
+    return true;
+}
+
+/**
+ * @brief Compare a byte range with a NUL-terminated word, ignoring case
+ */
+static bool range_equals_nocase(const char *data, size_t length, const char *word) {
+    size_t i = 0;
+    for (; i < length && word[i]; i++) {
+        if (tolower((unsigned char)data[i]) != tolower((unsigned char)word[i])) {
+            return false;
+        }
+    }
+    return i == length && word[i] == '\0';
+}
+
+/**
+ * @brief Check whether a byte range starts with a prefix
+ */
+static bool range_has_prefix(const char *data, size_t length, const char *prefix) {
+    size_t prefix_length = strlen(prefix);
+    return length >= prefix_length && memcmp(data, prefix, prefix_length) == 0;
+}
+
+/**
+ * @brief Trim ASCII whitespace from both ends of a byte range
+ */
+static void trim_range(const char **data, size_t *length) {
+    while (*length > 0 && isspace((unsigned char)**data)) {
+        (*data)++;
+        (*length)--;
+    }
+    while (*length > 0 && isspace((unsigned char)(*data)[*length - 1])) {
+        (*length)--;
+    }
+}
+
+/**
+ * @brief Detect the layout from the first bytes and position the parser
+ */
+static void detect_password_file_format(PasswordFile *file) {
+    const char *data = file->data;
+    size_t size = file->size;
+    size_t start = 0;
+    
+    if (file->archive.data) {
+        file->format = EXPORT_FORMAT_SPG;
+        return;
+    }
+    
+    /* Skip a UTF-8 byte order mark */
+    if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        start = 3;
+    }
+    file->position = start;
+    file->format = EXPORT_FORMAT_PLAIN;
+    
+    size_t first = start;
+    while (first < size && isspace((unsigned char)data[first])) {
+        first++;
+    }
+    if (first == size) {
+        return;
+    }
+    
+    if (data[first] == '{' || data[first] == '[') {
+        file->format = EXPORT_FORMAT_JSON;
+        file->json_array = data[first] == '[';
+        return;
+    }
+    
+    const char *eol = (const char *)memchr(data + first, '\n', size - first);
+    size_t line_length = eol ? (size_t)(eol - (data + first)) : size - first;
+    
+    if (range_has_prefix(data + first, line_length, "===")) {
+        file->format = EXPORT_FORMAT_TEXT;
+        return;
+    }
+    
+    /* A CSV header names the password column */
+    if (first == start && memchr(data + first, ',', line_length)) {
+        size_t column = 0;
+        size_t field_start = first;
+        
+        for (size_t i = first; i <= first + line_length; i++) {
+            if (i == first + line_length || data[i] == ',') {
+                const char *field = data + field_start;
+                size_t field_length = i - field_start;
+                trim_range(&field, &field_length);
+                if (field_length >= 2 && field[0] == '"' && field[field_length - 1] == '"') {
+                    field++;
+                    field_length -= 2;
+                }
+                
+                if (range_equals_nocase(field, field_length, "password")) {
+                    file->format = EXPORT_FORMAT_CSV;
+                    file->csv_column = column;
+                    file->position = eol ? (size_t)(eol - data) + 1 : size;
+                    file->line = 2;
+                    return;
+                }
+                
+                column++;
+                field_start = i + 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Replace an encrypted file's contents with its locked plaintext
+ */
+static bool password_file_decrypt(PasswordFile *file, const char *filename) {
+    const unsigned char *key = encryption_key();
+    if (!key) {
+        fprintf(stderr, "Error: %s is encrypted; pass its key with --key-file\n", filename);
+        return false;
+    }
+    
+    size_t size = encrypted_plaintext_size(file->data, file->size);
+    if (size == SIZE_MAX) {
+        fprintf(stderr, "Error: %s is not a valid encrypted file\n", filename);
+        return false;
+    }
+    
+    SecureArena arena;
+    char *plaintext = secure_arena_init(&arena, size + 1) ?
+                      (char *)secure_arena_alloc(&arena, size + 1, 1) : NULL;
+    if (!plaintext) {
+        return false;
+    }
+    
+    if (!encrypted_decrypt(key, file->data, file->size, plaintext)) {
+        fprintf(stderr, "Error: %s failed authentication (wrong key or damaged file)\n", filename);
+        secure_arena_destroy(&arena);
+        return false;
+    }
+    
+    /* Drop the ciphertext; only the locked plaintext is parsed */
+    PasswordFile ciphertext = *file;
+    password_file_close(&ciphertext);
+    
+    file->data = plaintext;
+    file->size = size;
+    file->mapped = false;
+    file->arena = arena;
+    return true;
+}
+
+/**
+ * @brief Open a password file and detect its layout
+ */
+bool password_file_open(PasswordFile *file, const char *filename, bool secure_copy) {
+    if (!file || !filename) {
+        return false;
+    }
+    
+    memset(file, 0, sizeof(PasswordFile));
+    file->line = 1;
+    
+    if (secure_copy || !map_password_file(file, filename)) {
+        FILE *stream = fopen(filename, "rb");
+        if (!stream) {
+            fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
+            return false;
+        }
+        
+        size_t size = 0;
+        StatsTimer timer = stats_begin();
+        char *buffer = read_stream(stream, &size);
+        stats_end(STATS_IO, &timer, size);
+        fclose(stream);
+        if (!buffer) {
+            fprintf(stderr, "Error reading file %s\n", filename);
+            return false;
+        }
+        
+        if (secure_copy && size > 0) {
+            /* Keep the only copy in locked memory */
+            char *copy = secure_arena_init(&file->arena, size) ? 
+                         (char *)secure_arena_alloc(&file->arena, size, 1) : NULL;
+            if (copy) {
+                memcpy(copy, buffer, size);
+            }
+            secure_clear(buffer, size);
+            free(buffer);
+            if (!copy) {
+                secure_arena_destroy(&file->arena);
+                return false;
+            }
+            buffer = copy;
+        }
+        
+        file->data = buffer;
+        file->size = size;
+    }
+    
+    if (encrypted_has_header(file->data, file->size) && !password_file_decrypt(file, filename)) {
+        password_file_close(file);
+        return false;
+    }
+    
+    if (spg_archive_has_header(file->data, file->size) &&
+        !spg_archive_parse(&file->archive, file->data, file->size)) {
+        fprintf(stderr, "Error: %s is not a valid SPG archive\n", filename);
+        password_file_close(file);
+        return false;
+    }
+    
+    detect_password_file_format(file);
+    return true;
+}
+
+/**
+ * @brief Take the next line (without its line ending) from the parser position
+ */
+static bool next_file_line(PasswordFile *file, const char **line, size_t *length) {
+    if (file->position >= file->size) {
+        return false;
+    }
+    
+    const char *start = file->data + file->position;
+    size_t remaining = file->size - file->position;
+    const char *eol = (const char *)memchr(start, '\n', remaining);
+    
+    *line = start;
+    *length = eol ? (size_t)(eol - start) : remaining;
+    file->position += *length + (eol ? 1 : 0);
+    file->line++;
+    
+    if (*length > 0 && start[*length - 1] == '\r') {
+        (*length)--;
+    }
+    return true;
+}
+
+/**
+ * @brief Next password of a text or plain list
+ */
+static bool next_text_password(PasswordFile *file, PasswordView *view) {
+    static const char *metadata_labels[] = {
+        "===", "Generated:", "Count:", "Date:", "Length:", "Entropy:", "Strength:", NULL
+    };
+    
+    const char *line;
+    size_t length;
+    
+    while (next_file_line(file, &line, &length)) {
+        uint64_t line_number = file->line - 1;
+        trim_range(&line, &length);
+        if (length == 0) {
+            continue;
+        }
+        
+        if (file->format == EXPORT_FORMAT_TEXT) {
+            if (range_equals_nocase(line, length, "=== Password Entry ===")) {
+                file->entry_blocks = true;
+            }
+            
+            bool metadata = false;
+            for (size_t i = 0; metadata_labels[i]; i++) {
+                metadata |= range_has_prefix(line, length, metadata_labels[i]);
+            }
+            if (metadata) {
+                continue;
+            }
+            
+            /* "Password: X" entry blocks and "[NNN] X" items numbered in order */
+            if (file->entry_blocks) {
+                if (!range_has_prefix(line, length, "Password: ")) {
+                    continue;
+                }
+                line += 10;
+                length -= 10;
+            } else if (line[0] == '[') {
+                uint64_t index = 0;
+                size_t i = 1;
+                while (i < length && isdigit((unsigned char)line[i]) && index < UINT64_MAX / 10) {
+                    index = index * 10 + (uint64_t)(line[i] - '0');
+                    i++;
+                }
+                if (i > 1 && i + 1 < length && line[i] == ']' && line[i + 1] == ' ' &&
+                    index == file->emitted + 1) {
+                    line += i + 2;
+                    length -= i + 2;
+                }
+            }
+        }
+        
+        file->emitted++;
+        view->data = line;
+        view->length = length;
+        view->line = line_number;
+        return true;
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Next password of a CSV file; quoted fields are unescaped in place
+ */
+static bool next_csv_password(PasswordFile *file, PasswordView *view) {
+    char *data = file->data;
+    size_t size = file->size;
+    
+    while (file->position < size) {
+        uint64_t record_line = file->line;
+        size_t column = 0;
+        bool found = false;
+        
+        while (true) {
+            size_t pos = file->position;
+            size_t field_start, field_end;
+            
+            if (pos < size && data[pos] == '"') {
+                /* Quoted field: "" is a quote, newlines are data */
+                size_t read = pos + 1;
+                size_t write = read;
+                field_start = read;
+                
+                while (read < size) {
+                    if (data[read] == '"') {
+                        if (read + 1 < size && data[read + 1] == '"') {
+                            if (write != read) data[write] = '"';
+                            write++;
+                            read += 2;
+                            continue;
+                        }
+                        read++;
+                        break;
+                    }
+                    if (data[read] == '\n') {
+                        file->line++;
+                    }
+                    if (write != read) data[write] = data[read];
+                    write++;
+                    read++;
+                }
+                
+                field_end = write;
+                while (read < size && data[read] != ',' && data[read] != '\n') {
+                    read++;
+                }
+                pos = read;
+            } else {
+                field_start = pos;
+                while (pos < size && data[pos] != ',' && data[pos] != '\n') {
+                    pos++;
+                }
+                field_end = pos;
+                if (field_end > field_start && data[field_end - 1] == '\r') {
+                    field_end--;
+                }
+            }
+            
+            if (column == file->csv_column) {
+                view->data = data + field_start;
+                view->length = field_end - field_start;
+                found = true;
+            }
+            column++;
+            
+            if (pos < size && data[pos] == ',') {
+                file->position = pos + 1;
+                continue;
+            }
+            
+            file->position = pos < size ? pos + 1 : size;
+            file->line++;
+            break;
+        }
+        
+        if (found && view->length > 0) {
+            view->line = record_line;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Read four hex digits
+ */
+static bool parse_hex4(const char *text, unsigned *value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = text[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9') digit = (unsigned)(c - '0');
+        else if (c >= 'a' && c <= 'f') digit = (unsigned)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') digit = (unsigned)(c - 'A' + 10);
+        else return false;
+        *value = (*value << 4) | digit;
+    }
+    return true;
+}
+
+/**
+ * @brief Decode the JSON string starting at the parser position in place
+ */
+static void parse_json_string(PasswordFile *file, const char **text, size_t *length) {
+    char *data = file->data;
+    size_t size = file->size;
+    size_t read = file->position + 1;
+    size_t write = read;
+    
+    *text = data + read;
+    
+    while (read < size && data[read] != '"') {
+        char c = data[read];
+        
+        if (c != '\\' || read + 1 >= size) {
+            if (c == '\n') file->line++;
+            if (write != read) data[write] = c;
+            write++;
+            read++;
+            continue;
+        }
+        
+        char escape = data[read + 1];
+        read += 2;
+        
+        switch (escape) {
+            case 'b': data[write++] = '\b'; break;
+            case 'f': data[write++] = '\f'; break;
+            case 'n': data[write++] = '\n'; break;
+            case 'r': data[write++] = '\r'; break;
+            case 't': data[write++] = '\t'; break;
+            case 'u': {
+                unsigned code;
+                if (read + 4 > size || !parse_hex4(data + read, &code)) {
+                    data[write++] = 'u';
+                    break;
+                }
+                read += 4;
+                
+                /* Combine a surrogate pair */
+                unsigned low;
+                if (code >= 0xD800 && code <= 0xDBFF && read + 6 <= size &&
+                    data[read] == '\\' && data[read + 1] == 'u' &&
+                    parse_hex4(data + read + 2, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    read += 6;
+                }
+                
+                /* UTF-8 is never longer than the escape it replaces */
+                if (code < 0x80) {
+                    data[write++] = (char)code;
+                } else if (code < 0x800) {
+                    data[write++] = (char)(0xC0 | (code >> 6));
+                    data[write++] = (char)(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    data[write++] = (char)(0xE0 | (code >> 12));
+                    data[write++] = (char)(0x80 | ((code >> 6) & 0x3F));
+                    data[write++] = (char)(0x80 | (code & 0x3F));
+                } else {
+                    data[write++] = (char)(0xF0 | (code >> 18));
+                    data[write++] = (char)(0x80 | ((code >> 12) & 0x3F));
+                    data[write++] = (char)(0x80 | ((code >> 6) & 0x3F));
+                    data[write++] = (char)(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default:    /* \" \\ \/ and anything unknown */
+                data[write++] = escape;
+                break;
+        }
+    }
+    
+    *length = (size_t)(data + write - *text);
+    file->position = read < size ? read + 1 : size;
+}
+
+/**
+ * @brief Skip JSON whitespace, counting lines
+ */
+static void skip_json_whitespace(PasswordFile *file) {
+    while (file->position < file->size && isspace((unsigned char)file->data[file->position])) {
+        if (file->data[file->position] == '\n') {
+            file->line++;
+        }
+        file->position++;
+    }
+}
 
 /**
- * @brief Save password to text file
+ * @brief Next password of a JSON file: "password" members, or the strings of a bare array
  */
-bool save_password_to_file(const PasswordResult *result, const char *filename, 
-                          bool append, bool include_metadata) {
-    if (!result || !result->password || !filename) {
+static bool next_json_password(PasswordFile *file, PasswordView *view) {
+    while (file->position < file->size) {
+        char c = file->data[file->position];
+        
+        if (c != '"') {
+            if (c == '{' || c == '[') file->json_depth++;
+            else if (c == '}' || c == ']') file->json_depth--;
+            else if (c == '\n') file->line++;
+            file->position++;
+            continue;
+        }
+        
+        uint64_t line = file->line;
+        const char *text;
+        size_t length;
+        parse_json_string(file, &text, &length);
+        skip_json_whitespace(file);
+        
+        if (file->position < file->size && file->data[file->position] == ':') {
+            file->position++;
+            if (length != 8 || memcmp(text, "password", 8) != 0) {
+                continue;
+            }
+            
+            skip_json_whitespace(file);
+            if (file->position >= file->size || file->data[file->position] != '"') {
+                continue;
+            }
+            
+            line = file->line;
+            parse_json_string(file, &text, &length);
+        } else if (!file->json_array || file->json_depth != 1) {
+            continue;
+        }
+        
+        if (length > 0) {
+            view->data = text;
+            view->length = length;
+            view->line = line;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Next entry of an SPG archive, straight from its offset table
+ */
+static bool next_spg_password(PasswordFile *file, PasswordView *view) {
+    while (file->emitted < file->archive.count) {
+        size_t index = (size_t)file->emitted++;
+        if (password_file_get(file, index, view, NULL) && view->length > 0) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Get the next password of a file
+ */
+bool password_file_next(PasswordFile *file, PasswordView *view) {
+    if (!file || !view || !file->data) {
         return false;
     }
     
-    FILE *file = fopen(filename, append ? "a" : "w");
-    if (!file) {
-        fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
+    switch (file->format) {
+        case EXPORT_FORMAT_CSV:
+            return next_csv_password(file, view);
+        case EXPORT_FORMAT_JSON:
+            return next_json_password(file, view);
+        case EXPORT_FORMAT_SPG:
+            return next_spg_password(file, view);
+        case EXPORT_FORMAT_TEXT:
+        case EXPORT_FORMAT_PLAIN:
+        default:
+            return next_text_password(file, view);
+    }
+}
+
+/**
+ * @brief Get one entry of an SPG archive by index
+ */
+bool password_file_get(const PasswordFile *file, size_t index, PasswordView *view,
+                       SpgArchiveEntry *entry) {
+    if (!file || !view || file->format != EXPORT_FORMAT_SPG) {
         return false;
     }
     
-    if (include_metadata) {
-        char timestamp[64];
-        get_timestamp(timestamp, sizeof(timestamp), NULL);
-        
-        fprintf(file, "=== Password Entry ===\n");
-        fprintf(file, "Date: %s\n", timestamp);
-        fprintf(file, "Password: %s\n", result->password);
-        fprintf(file, "Length: %zu characters\n", result->length);
-        fprintf(file, "Entropy: %.1f bits\n", result->entropy);
-        fprintf(file, "Strength: %s (%d/100)\n", result->strength, result->strength_score);
-        fprintf(file, "=====================\n\n");
-    } else {
-        fprintf(file, "%s\n", result->password);
+    if (!spg_archive_entry(&file->archive, index, &view->data, &view->length, entry)) {
+        return false;
     }
     
-    fclose(file);
+    view->line = (uint64_t)index + 1;
     return true;
 }
 
 /**
- * @brief Save multiple passwords to file
+ * @brief Release a password file
  */
-bool save_bulk_passwords_to_file(const PasswordResult *results, size_t count,
-                                const char *filename, bool include_metadata) {
-    if (!results || count == 0 || !filename) {
-        return false;
+void password_file_close(PasswordFile *file) {
+    if (!file) {
+        return;
     }
     
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
-        return false;
+    if (file->mapped) {
+        if (file->data) {
+#ifdef _WIN32
+            UnmapViewOfFile(file->data);
+#else
+            munmap(file->data, file->size);
+#endif
+        }
+    } else if (file->arena.base) {
+        secure_arena_destroy(&file->arena);
+    } else if (file->data) {
+        secure_clear(file->data, file->size);
+        free(file->data);
     }
     
-    char timestamp[64];
-    get_timestamp(timestamp, sizeof(timestamp), NULL);
+    memset(file, 0, sizeof(PasswordFile));
+}
+
+/**
+ * @brief Load passwords from file
+ */
+PasswordResult *load_passwords_from_file(const char *filename, size_t *count) {
+    if (!filename || !count) {
+        return NULL;
+    }
     
-    fprintf(file, "=== Password List ===\n");
-    fprintf(file, "Generated: %s\n", timestamp);
-    fprintf(file, "Count: %zu passwords\n", count);
-    fprintf(file, "=====================\n\n");
+    *count = 0;
     
-    for (size_t i = 0; i < count; i++) {
-        if (include_metadata) {
-            fprintf(file, "[%03zu] %s\n", i + 1, results[i].password);
-            fprintf(file, "    Length: %zu, Entropy: %.1f bits, Strength: %s\n\n",
-                   results[i].length, results[i].entropy, results[i].strength);
-        } else {
-            fprintf(file, "%s\n", results[i].password);
+    PasswordFile file;
+    if (!password_file_open(&file, filename, false)) {
+        return NULL;
+    }
+    
+    PasswordResult *results = NULL;
+    size_t capacity = 0;
+    size_t current = 0;
+    PasswordView view;
+    
+    bool ok = true;
+    
+    while (password_file_next(&file, &view)) {
+        if (current == capacity) {
+            size_t grown = capacity ? capacity * 2 : 1024;
+            PasswordResult *resized = (PasswordResult *)realloc(results, grown * sizeof(PasswordResult));
+            if (!resized) {
+                ok = false;
+                break;
+            }
+            results = resized;
+            capacity = grown;
+        }
+        
+        char *password = (char *)malloc(view.length + 1);
+        if (!password) {
+            ok = false;
+            break;
+        }
+        memcpy(password, view.data, view.length);
+        password[view.length] = '\0';
+        
+        /* Store password */
+        memset(&results[current], 0, sizeof(PasswordResult));
+        results[current].password = password;
+        results[current].length = view.length;
+        results[current].entropy = 0.0; /* Will be calculated later if needed */
+        results[current].strength_score = 0;
+        results[current].strength = "Unknown";
+        
+        /* Archives carry the metadata they were written with */
+        SpgArchiveEntry entry;
+        if (password_file_get(&file, (size_t)(view.line - 1), &view, &entry)) {
+            results[current].entropy = entry.entropy;
+            results[current].strength_score = entry.strength_score;
+            results[current].strength = get_strength_level_label(entry.strength_level);
         }
+        current++;
     }
     
-    fclose(file);
-    return true;
+    password_file_close(&file);
+    
+    if (!ok) {
+        fprintf(stderr, "Out of memory after loading %zu passwords from %s\n", current, filename);
+    }
+    
+    if (!ok || current == 0) {
+        free_bulk_passwords(results, current);
+        free(results);
+        return NULL;
+    }
+    
+    *count = current;
+    return results;
 }
 
 /**
- * @brief Save passwords to CSV file
+ * @brief Warn about entries left out of a batch for their length
  */
-bool save_passwords_to_csv(const PasswordResult *results, size_t count,
-                          const char *filename) {
-    if (!results || count == 0 || !filename) {
-        return false;
+static void report_long_entries(const char *filename, size_t skipped) {
+    if (skipped > 0) {
+        fprintf(stderr, "Warning: skipped %zu entries of %s longer than %d bytes\n",
+                skipped, filename, MAX_INPUT_LENGTH);
     }
+}
+
+/**
+ * @brief Copy an SPG archive into a batch, keeping its metadata
+ */
+static bool load_spg_into_batch(const PasswordFile *file, const char *filename,
+                                PasswordBatch *batch) {
+    size_t count = 0;
+    size_t skipped = 0;
+    size_t max_length = 0;
+    PasswordView view;
     
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
-        return false;
+    /* The offset table gives every length without touching the blob */
+    for (size_t i = 0; i < file->archive.count; i++) {
+        if (!password_file_get(file, i, &view, NULL) || view.length == 0) {
+            continue;
+        }
+        if (view.length > MAX_INPUT_LENGTH) {
+            skipped++;
+            continue;
+        }
+        
+        count++;
+        if (view.length > max_length) {
+            max_length = view.length;
+        }
     }
     
-    /* CSV header */
-    fprintf(file, "Index,Timestamp,Password,Length,Entropy,Strength,StrengthScore\n");
+    report_long_entries(filename, skipped);
     
-    char timestamp[64];
+    if (count == 0 || !password_batch_init(batch, count, max_length)) {
+        return false;
+    }
     
-    for (size_t i = 0; i < count; i++) {
-        get_timestamp(timestamp, sizeof(timestamp), NULL);
-        
-        /* Escape password for CSV (handle commas and quotes) */
-        char escaped_password[1024] = {0};
-        size_t dest_index = 0;
-        
-        for (size_t j = 0; results[i].password[j] != '\0' && dest_index < sizeof(escaped_password) - 3; j++) {
-            if (results[i].password[j] == '"') {
-                escaped_password[dest_index++] = '"';
-                escaped_password[dest_index++] = '"';
-            } else if (results[i].password[j] == ',') {
-                escaped_password[dest_index++] = '"';
-                escaped_password[dest_index++] = ',';
-                escaped_password[dest_index++] = '"';
-            } else {
-                escaped_password[dest_index++] = results[i].password[j];
-            }
+    SpgArchiveEntry entry;
+    for (size_t i = 0; i < file->archive.count; i++) {
+        if (!password_file_get(file, i, &view, &entry) || view.length == 0 ||
+            view.length > MAX_INPUT_LENGTH) {
+            continue;
         }
-        escaped_password[dest_index] = '\0';
         
-        fprintf(file, "%zu,%s,\"%s\",%zu,%.1f,\"%s\",%d\n",
-               i + 1, timestamp, escaped_password, 
-               results[i].length, results[i].entropy,
-               results[i].strength, results[i].strength_score);
+        size_t index = batch->count;
+        if (!password_batch_append(batch, view.data, view.length)) {
+            password_batch_free(batch);
+            return false;
+        }
+        batch->entropy[index] = entry.entropy;
+        batch->scores[index] = entry.strength_score;
+        batch->levels[index] = entry.strength_level;
     }
     
-    fclose(file);
     return true;
 }
 
 /**
- * @brief Save passwords to JSON file
+ * @brief Load passwords from file into a password batch
  */
-bool save_passwords_to_json(const PasswordResult *results, size_t count,
-                           const char *filename) {
-    if (!results || count == 0 || !filename) {
+bool load_passwords_into_batch(const char *filename, PasswordBatch *batch) {
+    if (!filename || !batch) {
         return false;
     }
     
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
+    PasswordFile file;
+    if (!password_file_open(&file, filename, false)) {
         return false;
     }
     
-    char timestamp[64];
-    get_timestamp(timestamp, sizeof(timestamp), NULL);
+    if (file.format == EXPORT_FORMAT_SPG) {
+        bool loaded = load_spg_into_batch(&file, filename, batch);
+        password_file_close(&file);
+        return loaded;
+    }
     
-    fprintf(file, "{\n");
-    fprintf(file, "  \"metadata\": {\n");
-    fprintf(file, "    \"generated\": \"%s\",\n", timestamp);
-    fprintf(file, "    \"count\": %zu,\n", count);
-    fprintf(file, "    \"application\": \"SecurePassGen\"\n");
-    fprintf(file, "  },\n");
-    fprintf(file, "  \"passwords\": [\n");
+    /* One parse pass collecting views, then one copy into locked slots */
+    PasswordView *views = NULL;
+    size_t capacity = 0;
+    size_t count = 0;
+    size_t skipped = 0;
+    size_t max_length = 0;
+    PasswordView view;
+    bool ok = true;
     
-    for (size_t i = 0; i < count; i++) {
-        /* Escape password for JSON */
-        char escaped_password[1024] = {0};
-        size_t dest_index = 0;
-        
-        for (size_t j = 0; results[i].password[j] != '\0' && dest_index < sizeof(escaped_password) - 3; j++) {
-            switch (results[i].password[j]) {
-                case '"': 
-                    escaped_password[dest_index++] = '\\';
-                    escaped_password[dest_index++] = '"';
-                    break;
-                case '\\':
-                    escaped_password[dest_index++] = '\\';
-                    escaped_password[dest_index++] = '\\';
-                    break;
-                case '\b':
-                    escaped_password[dest_index++] = '\\';
-                    escaped_password[dest_index++] = 'b';
-                    break;
-                case '\f':
-                    escaped_password[dest_index++] = '\\';
-                    escaped_password[dest_index++] = 'f';
-                    break;
-                case '\n':
-                    escaped_password[dest_index++] = '\\';
-                    escaped_password[dest_index++] = 'n';
-                    break;
-                case '\r':
-                    escaped_password[dest_index++] = '\\';
-                    escaped_password[dest_index++] = 'r';
-                    break;
-                case '\t':
-                    escaped_password[dest_index++] = '\\';
-                    escaped_password[dest_index++] = 't';
-                    break;
-                default:
-                    escaped_password[dest_index++] = results[i].password[j];
-            }
+    while (password_file_next(&file, &view)) {
+        if (view.length > MAX_INPUT_LENGTH) {
+            skipped++;
+            continue;
         }
-        escaped_password[dest_index] = '\0';
         
-        fprintf(file, "    {\n");
-        fprintf(file, "      \"index\": %zu,\n", i + 1);
-        fprintf(file, "      \"password\": \"%s\",\n", escaped_password);
-        fprintf(file, "      \"length\": %zu,\n", results[i].length);
-        fprintf(file, "      \"entropy\": %.1f,\n", results[i].entropy);
-        fprintf(file, "      \"strength\": \"%s\",\n", results[i].strength);
-        fprintf(file, "      \"strengthScore\": %d\n", results[i].strength_score);
+        if (count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 1024;
+            PasswordView *resized = (PasswordView *)realloc(views, grown * sizeof(PasswordView));
+            if (!resized) {
+                ok = false;
+                break;
+            }
+            views = resized;
+            capacity = grown;
+        }
         
-        if (i < count - 1) {
-            fprintf(file, "    },\n");
-        } else {
-            fprintf(file, "    }\n");
+        views[count++] = view;
+        if (view.length > max_length) {
+            max_length = view.length;
         }
     }
     
-    fprintf(file, "  ]\n");
-    fprintf(file, "}\n");
+    if (!ok) {
+        fprintf(stderr, "Out of memory after reading %zu passwords from %s\n", count, filename);
+    }
+    report_long_entries(filename, skipped);
+    
+    bool initialized = ok && count > 0 && password_batch_init(batch, count, max_length);
+    ok = initialized;
     
-    fclose(file);
-    return true;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = password_batch_append(batch, views[i].data, views[i].length);
+    }
+    if (!ok && initialized) {
+        password_batch_free(batch);
+    }
+    
+    free(views);
+    password_file_close(&file);
+    return ok;
 }
 
+/* Overwrite passes, in order; "random" passes write fresh DRBG output */
+static const struct {
+    unsigned char pattern[2];
+    bool random;
+} wipe_passes[] = {
+    {{0x00, 0x00}, false},  /* All zeros */
+    {{0xFF, 0xFF}, false},  /* All ones */
+    {{0xAA, 0x55}, false},  /* Alternating pattern 10101010 01010101 */
+    {{0x55, 0xAA}, false},  /* Alternating pattern 01010101 10101010 */
+    {{0x00, 0x00}, true},   /* Random data */
+    {{0x00, 0x00}, true},   /* Random data */
+    {{0x00, 0x00}, true},   /* Random data */
+    {{0x00, 0x00}, false},  /* Final zeros */
+};
+
+#ifdef _WIN32
+typedef HANDLE WipeFile;
+#else
+typedef int WipeFile;
+#endif
+
 /**
- * @brief Load passwords from file
+ * @brief Open a file for wiping and get its size
  */
-PasswordResult *load_passwords_from_file(const char *filename, size_t *count) {
-    if (!filename || !count) {
-        return NULL;
+static bool wipe_open(const char *filename, WipeFile *file, uint64_t *size) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                                OPEN_EXISTING, FILE_FLAG_WRITE_THROUGH, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
     }
     
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error opening file %s: %s\n", filename, strerror(errno));
-        return NULL;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(handle, &file_size)) {
+        CloseHandle(handle);
+        return false;
     }
     
-    /* First pass: count passwords */
-    size_t password_count = 0;
-    char buffer[1024];
-    
-    while (fgets(buffer, sizeof(buffer), file)) {
-        trim_whitespace(buffer);
-        if (strlen(buffer) > 0 && 
-            !strstr(buffer, "===") && 
-            !strstr(buffer, "Date:") &&
-            !strstr(buffer, "Length:") &&
-            !strstr(buffer, "Entropy:") &&
-            !strstr(buffer, "Strength:") &&
-            !strstr(buffer, "Index,") &&  /* CSV header */
-            !strstr(buffer, "\"index\":")) {  /* JSON */
-            password_count++;
-        }
-    }
-    
-    if (password_count == 0) {
-        fclose(file);
-        *count = 0;
-        return NULL;
+    *file = handle;
+    *size = (uint64_t)file_size.QuadPart;
+    return true;
+#else
+    int fd = -1;
+#ifdef O_DIRECT
+    /* Bypass the page cache where the file system allows it */
+    fd = open(filename, O_WRONLY | O_DIRECT);
+#endif
+    if (fd < 0) {
+        fd = open(filename, O_WRONLY);
     }
-    
-    /* Allocate memory for results */
-    PasswordResult *results = (PasswordResult *)calloc(password_count, sizeof(PasswordResult));
-    if (!results) {
-        fclose(file);
-        *count = 0;
-        return NULL;
+    if (fd < 0) {
+        return false;
     }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    fcntl(fd, F_NOCACHE, 1);
+#endif
     
-    /* Second pass: read passwords */
-    rewind(file);
-    size_t current = 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
     
-    while (fgets(buffer, sizeof(buffer), file) && current < password_count) {
-        trim_whitespace(buffer);
-        
-        /* Skip metadata lines */
-        if (strlen(buffer) == 0 || 
-            strstr(buffer, "===") || 
-            strstr(buffer, "Date:") ||
-            strstr(buffer, "Length:") ||
-            strstr(buffer, "Entropy:") ||
-            strstr(buffer, "Strength:") ||
-            strstr(buffer, "Index,") ||
-            strstr(buffer, "\"index\":")) {
-            continue;
-        }
-        
-        /* Handle JSON password field */
-        if (strstr(buffer, "\"password\":")) {
-            char *start = strstr(buffer, "\"password\": \"");
-            if (start) {
-                start += 13; /* Skip "\"password\": \"" */
-                char *end = strrchr(start, '"');
-                if (end) {
-                    *end = '\0';
-                    strcpy(buffer, start);
-                }
-            }
-        }
+    *file = fd;
+    *size = (uint64_t)st.st_size;
+    return true;
+#endif
+}
+
+/**
+ * @brief Write a buffer at an absolute offset
+ */
+static bool wipe_write_at(WipeFile file, const unsigned char *data, size_t size, uint64_t offset) {
+    while (size > 0) {
+#ifdef _WIN32
+        OVERLAPPED position;
+        memset(&position, 0, sizeof(position));
+        position.Offset = (DWORD)offset;
+        position.OffsetHigh = (DWORD)(offset >> 32);
         
-        /* Handle CSV format */
-        else if (strchr(buffer, ',') && current == 0) {
-            /* Skip CSV header */
-            continue;
+        DWORD request = size > 0x40000000u ? 0x40000000u : (DWORD)size;
+        DWORD written = 0;
+        if (!WriteFile(file, data, request, &written, &position) || written == 0) {
+            return false;
         }
-        else if (strchr(buffer, ',')) {
-            /* Extract password from CSV */
-            char *comma = strchr(buffer, ',');
-            if (comma) {
-                char *password_start = strchr(comma + 1, ',');
-                if (password_start) {
-                    password_start++; /* Skip comma */
-                    
-                    /* Check if password is quoted */
-                    if (*password_start == '"') {
-                        password_start++;
-                        char *password_end = strrchr(password_start, '"');
-                        if (password_end) {
-                            *password_end = '\0';
-                            strcpy(buffer, password_start);
-                        }
-                    } else {
-                        /* Password not quoted, find next comma */
-                        char *next_comma = strchr(password_start, ',');
-                        if (next_comma) {
-                            *next_comma = '\0';
-                            strcpy(buffer, password_start);
-                        }
-                    }
-                }
+#else
+        ssize_t written = pwrite(file, data, size, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+#ifdef O_DIRECT
+            /* Unaligned tail (or a file system without direct I/O support) */
+            int error = errno;
+            int flags = fcntl(file, F_GETFL);
+            if (error == EINVAL && flags >= 0 && (flags & O_DIRECT) &&
+                fcntl(file, F_SETFL, flags & ~O_DIRECT) == 0) {
+                continue;
+            }
+#endif
+            return false;
         }
-        
-        /* Store password */
-        if (strlen(buffer) > 0) {
-            results[current].password = strdup(buffer);
-            results[current].length = strlen(buffer);
-            results[current].entropy = 0.0; /* Will be calculated later if needed */
-            results[current].strength_score = 0;
-            results[current].strength = "Unknown";
-            current++;
+        if (written == 0) {
+            return false;
         }
+#endif
+        data += written;
+        size -= (size_t)written;
+        offset += (uint64_t)written;
     }
     
-    fclose(file);
-    *count = current;
+    return true;
+}
+
+/**
+ * @brief Force everything written so far onto the device
+ */
+static bool wipe_sync(WipeFile file) {
+#ifdef _WIN32
+    return FlushFileBuffers(file) != 0;
+#else
+#ifdef F_FULLFSYNC
+    /* fsync() on macOS does not flush the drive's own cache */
+    if (fcntl(file, F_FULLFSYNC) == 0) {
+        return true;
+    }
+#endif
+    return fsync(file) == 0;
+#endif
+}
+
+/**
+ * @brief Release the file's blocks so the device can discard them
+ * @return true if the platform and file system support it
+ */
+static bool wipe_discard(WipeFile file, uint64_t size) {
+#ifdef _WIN32
+    DWORD returned = 0;
+    FILE_ZERO_DATA_INFORMATION range;
+    range.FileOffset.QuadPart = 0;
+    range.BeyondFinalZero.QuadPart = (LONGLONG)size;
+    return DeviceIoControl(file, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &returned, NULL) &&
+           DeviceIoControl(file, FSCTL_SET_ZERO_DATA, &range, sizeof(range), NULL, 0, &returned, NULL);
+#elif defined(FALLOC_FL_PUNCH_HOLE)
+    return fallocate(file, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, (off_t)size) == 0;
+#elif defined(F_PUNCHHOLE)
+    struct fpunchhole hole;
+    memset(&hole, 0, sizeof(hole));
+    hole.fp_offset = 0;
+    hole.fp_length = (off_t)size;
+    return fcntl(file, F_PUNCHHOLE, &hole) == 0;
+#else
+    (void)file;
+    (void)size;
+    return false;
+#endif
+}
+
+/**
+ * @brief Truncate a wiped file to zero length and close it
+ */
+static bool wipe_close(WipeFile file) {
+#ifdef _WIN32
+    LARGE_INTEGER start;
+    start.QuadPart = 0;
+    bool ok = SetFilePointerEx(file, start, NULL, FILE_BEGIN) && SetEndOfFile(file);
+    return CloseHandle(file) && ok;
+#else
+    bool ok = ftruncate(file, 0) == 0;
+    return close(file) == 0 && ok;
+#endif
+}
+
+/**
+ * @brief Fill a buffer with a repeating two-byte pattern
+ */
+static void wipe_fill_pattern(unsigned char *buffer, size_t size, const unsigned char pattern[2]) {
+    if (pattern[0] == pattern[1]) {
+        memset(buffer, pattern[0], size);
+        return;
+    }
     
-    return results;
+    buffer[0] = pattern[0];
+    buffer[1] = pattern[1];
+    
+    /* Double the filled prefix until the buffer is full */
+    size_t filled = 2;
+    while (filled < size) {
+        size_t copy = filled < size - filled ? filled : size - filled;
+        memcpy(buffer + filled, buffer, copy);
+        filled += copy;
+    }
 }
 
 /**
  * @brief Securely delete file (overwrite multiple times)
  */
-bool secure_delete_file(const char *filename, int passes) {
+bool secure_delete_file(const char *filename, int passes, SecureDeleteMode mode) {
     if (!filename || passes <= 0) {
         return false;
     }
     
-    FILE *file = fopen(filename, "rb+");
-    if (!file) {
+    WipeFile file;
+    uint64_t file_size = 0;
+    if (!wipe_open(filename, &file, &file_size)) {
         /* File doesn't exist or can't be opened */
         return false;
     }
     
-    /* Get file size */
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
+    if (file_size == 0) {
+        wipe_close(file);
+        return remove(filename) == 0;
+    }
+    
+    int max_passes = (int)(sizeof(wipe_passes) / sizeof(wipe_passes[0]));
+    if (passes > max_passes) passes = max_passes;
     
-    if (file_size <= 0) {
-        fclose(file);
-        remove(filename);
-        return true;
+    /* Discard mode: a single random pass, then let the device drop the blocks */
+    int first_pass = 0;
+    if (mode == SECURE_DELETE_DISCARD) {
+        first_pass = 4;
+        passes = first_pass + 1;
     }
     
-    /* Create buffer for overwriting */
-    unsigned char *buffer = (unsigned char *)malloc(file_size);
+    /* One page-aligned chunk, reused for every write (even size keeps patterns in phase) */
+    size_t chunk_size = SECURE_DELETE_CHUNK_SIZE;
+    if (file_size < chunk_size) {
+        chunk_size = (size_t)file_size;
+    }
+    
+    SecureArena arena;
+    ChaChaDrbg drbg;
+    bool have_drbg = false;
+    unsigned char *buffer = NULL;
+    if (secure_arena_init(&arena, chunk_size)) {
+        buffer = (unsigned char *)secure_arena_alloc(&arena, chunk_size, 16);
+    }
     if (!buffer) {
-        fclose(file);
+        wipe_close(file);
+        if (arena.base) {
+            secure_arena_destroy(&arena);
+        }
         return false;
     }
     
-    /* Multiple overwrite passes */
-    const unsigned char patterns[][2] = {
-        {0x00, 0x00},  /* All zeros */
-        {0xFF, 0xFF},  /* All ones */
-        {0xAA, 0x55},  /* Alternating pattern 10101010 01010101 */
-        {0x55, 0xAA},  /* Alternating pattern 01010101 10101010 */
-        {0x92, 0x49},  /* Random pattern */
-        {0x49, 0x24},  /* Another random pattern */
-        {0x24, 0x92},  /* Another random pattern */
-        {0x00, 0x00},  /* Final zeros */
-    };
-    
-    int max_patterns = sizeof(patterns) / sizeof(patterns[0]);
-    if (passes > max_patterns) passes = max_patterns;
-    
-    for (int pass = 0; pass < passes; pass++) {
-        /* Fill buffer with pattern */
-        for (long i = 0; i < file_size; i++) {
-            buffer[i] = patterns[pass % max_patterns][i % 2];
+    bool ok = true;
+    for (int pass = first_pass; pass < passes && ok; pass++) {
+        bool random = wipe_passes[pass].random;
+        if (random && !have_drbg) {
+            ok = have_drbg = chacha_drbg_seed(&drbg);
+        } else if (!random) {
+            wipe_fill_pattern(buffer, chunk_size, wipe_passes[pass].pattern);
         }
         
-        /* Write pattern to file */
-        rewind(file);
-        size_t written = fwrite(buffer, 1, file_size, file);
-        fflush(file);
-        
-        if (written != (size_t)file_size) {
-            free(buffer);
-            fclose(file);
-            return false;
+        for (uint64_t offset = 0; offset < file_size && ok; offset += chunk_size) {
+            size_t size = (size_t)(file_size - offset < chunk_size ? file_size - offset : chunk_size);
+            if (random) {
+                ok = chacha_drbg_generate(&drbg, buffer, size);
+            }
+            ok = ok && wipe_write_at(file, buffer, size, offset);
         }
+        
+        /* Each pass must reach the device before the next one starts */
+        ok = ok && wipe_sync(file);
     }
     
+    if (ok && mode == SECURE_DELETE_DISCARD && wipe_discard(file, file_size)) {
+        ok = wipe_sync(file);
+    }
+    
+    if (have_drbg) {
+        chacha_drbg_wipe(&drbg);
+    }
+    secure_arena_destroy(&arena);
+    
     /* Close and delete file */
-    fclose(file);
-    free(buffer);
+    if (!wipe_close(file) || !ok) {
+        return false;
+    }
     
     /* Remove the file */
     if (remove(filename) != 0) {
@@ -493,22 +2371,19 @@ bool file_contains_sensitive_data(const char *filename) {
     bool sensitive = false;
     
     while (fgets(buffer, sizeof(buffer), file)) {
-        trim_whitespace(buffer);
+        char *line = trim_whitespace(buffer);
+        size_t length = strlen(line);
         
         /* Check for password-like patterns */
-        if (strlen(buffer) >= 8) {
+        if (length >= 8) {
             /* Check for mix of character types */
-            bool has_lower = false;
-            bool has_upper = false;
-            bool has_digit = false;
-            bool has_special = false;
+            CharClassProfile profile;
+            classify_password(line, length, &profile);
             
-            for (size_t i = 0; buffer[i] != '\0'; i++) {
-                if (islower((unsigned char)buffer[i])) has_lower = true;
-                else if (isupper((unsigned char)buffer[i])) has_upper = true;
-                else if (isdigit((unsigned char)buffer[i])) has_digit = true;
-                else has_special = true;
-            }
+            bool has_lower = (profile.present & (1u << CHAR_CLASS_LOWER)) != 0;
+            bool has_upper = (profile.present & (1u << CHAR_CLASS_UPPER)) != 0;
+            bool has_digit = (profile.present & (1u << CHAR_CLASS_NUMBER)) != 0;
+            bool has_special = (profile.present & (1u << CHAR_CLASS_SPECIAL)) != 0;
             
             /* If it looks like a password (mix of types) */
             if ((has_lower && has_upper) || 
@@ -9,7 +9,231 @@
 #define FILE_OPS_H
 
 #include "password.h"
+#include "utils.h"
+#include "encrypted.h"
+#include "spg_archive.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Output formats supported by the export writer
+ */
+typedef enum {
+    EXPORT_FORMAT_PLAIN,    /**< One password per line, nothing else */
+    EXPORT_FORMAT_TEXT,     /**< Password list with header (and optional metadata) */
+    EXPORT_FORMAT_CSV,      /**< Comma-separated values with header row */
+    EXPORT_FORMAT_JSON,     /**< JSON document with metadata and password array */
+    EXPORT_FORMAT_SPG       /**< Binary archive with metadata and offset tables (spg_archive.h) */
+} ExportFormat;
+
+/**
+ * @brief Large user-space output buffer with hand-rolled encoders
+ *
+ * Everything written goes into one locked buffer that is handed to the
+ * operating system in a single write when full; payloads larger than half
+ * the buffer are written together with it in one writev() call. The buffer
+ * is wiped when released, since it holds passwords.
+ *
+ * An encrypted buffer seals everything into an ENCRYPTED_EXTENSION file;
+ * the final chunk is only written by output_buffer_free().
+ *
+ * An asynchronous buffer has two halves and a writer thread: the caller
+ * fills one half while the thread writes the other, so a slow disk or
+ * network share only stalls the caller once both halves are full.
+ */
+typedef struct {
+    FILE *file;             /**< Destination stream */
+    SecureArena arena;      /**< Locked backing memory */
+    char *data;             /**< Buffer start */
+    size_t used;            /**< Bytes waiting to be written */
+    size_t capacity;        /**< Buffer size */
+    uint64_t written;       /**< Bytes handed to the operating system */
+    bool failed;            /**< A write error occurred */
+    struct OutputWriterThread *async; /**< Background writer (NULL = synchronous) */
+    struct EncryptedWriter *cipher; /**< Encrypts before writing (NULL = plaintext) */
+} OutputBuffer;
+
+/**
+ * @brief Set up an output buffer in front of a stream
+ * @param out Buffer to initialize
+ * @param file Destination stream (anything already buffered in it is flushed)
+ * @return true if successful, false otherwise
+ */
+bool output_buffer_init(OutputBuffer *out, FILE *file);
+
+/**
+ * @brief Set up an output buffer drained by a background writer thread
+ * @param out Buffer to initialize
+ * @param file Destination stream (anything already buffered in it is flushed)
+ * @return true if successful, false otherwise
+ *
+ * Falls back to a synchronous buffer if the thread cannot be started.
+ * Only the calling thread may write to the buffer; written is final once
+ * output_buffer_flush() or output_buffer_free() returns.
+ */
+bool output_buffer_init_async(OutputBuffer *out, FILE *file);
+
+/**
+ * @brief Encrypt everything written to an output buffer from now on
+ * @param out Buffer with nothing written to it yet
+ * @param key 256-bit file key
+ * @return true if successful, false otherwise
+ */
+bool output_buffer_encrypt(OutputBuffer *out, const unsigned char key[ENCRYPTED_KEY_SIZE]);
+
+/**
+ * @brief Append raw bytes
+ * @param out Output buffer
+ * @param data Bytes to append
+ * @param size Number of bytes
+ */
+void output_buffer_write(OutputBuffer *out, const char *data, size_t size);
+
+/**
+ * @brief Append a string literal (length known at compile time)
+ */
+#define output_buffer_literal(out, text) output_buffer_write((out), (text), sizeof(text) - 1)
+
+/**
+ * @brief Append a NUL-terminated string
+ * @param out Output buffer
+ * @param text String to append
+ */
+void output_buffer_puts(OutputBuffer *out, const char *text);
+
+/**
+ * @brief Append a single character
+ * @param out Output buffer
+ * @param c Character to append
+ */
+void output_buffer_putc(OutputBuffer *out, char c);
+
+/**
+ * @brief Append an unsigned integer in decimal
+ * @param out Output buffer
+ * @param value Value to append
+ * @param min_digits Pad with leading zeros to this many digits
+ */
+void output_buffer_put_uint(OutputBuffer *out, uint64_t value, int min_digits);
+
+/**
+ * @brief Append a number in fixed-point notation (like "%.Nf", ties away from zero)
+ * @param out Output buffer
+ * @param value Value to append
+ * @param decimals Digits after the point (0-9)
+ */
+void output_buffer_put_fixed(OutputBuffer *out, double value, int decimals);
+
+/**
+ * @brief Append a CSV field body, doubling embedded quotes
+ * @param out Output buffer
+ * @param text Field text
+ * @param length Length of the text
+ */
+void output_buffer_put_csv(OutputBuffer *out, const char *text, size_t length);
+
+/**
+ * @brief Append a JSON string body with the required escapes
+ * @param out Output buffer
+ * @param text String text
+ * @param length Length of the text
+ */
+void output_buffer_put_json(OutputBuffer *out, const char *text, size_t length);
+
+/**
+ * @brief Append formatted text (for headers and other cold paths)
+ * @param out Output buffer
+ * @param format printf-style format
+ */
+void output_buffer_printf(OutputBuffer *out, const char *format, ...);
+
+/**
+ * @brief Write everything buffered to the stream
+ * @param out Output buffer
+ * @return true if every write so far succeeded, false otherwise
+ */
+bool output_buffer_flush(OutputBuffer *out);
+
+/**
+ * @brief Flush, wipe and release an output buffer (the stream stays open)
+ * @param out Output buffer
+ * @return true if every write succeeded, false otherwise
+ */
+bool output_buffer_free(OutputBuffer *out);
+
+/**
+ * @brief Incremental password encoder
+ *
+ * Writes a document one entry at a time so callers can generate, write
+ * and wipe passwords in chunks without holding the whole set in memory.
+ */
+typedef struct {
+    FILE *file;             /**< Destination stream */
+    bool owns_file;         /**< Close file in export_writer_end() */
+    OutputBuffer out;       /**< Encoder buffer in front of file */
+    ExportFormat format;    /**< Output format */
+    bool include_metadata;  /**< Per-entry metadata for text format */
+    size_t written;         /**< Entries written so far */
+    bool failed;            /**< A write error occurred */
+    char timestamp[64];     /**< Timestamp taken when the document began */
+    SpgArchiveTables archive; /**< Tables written at the end of an SPG archive */
+} ExportWriter;
+
+/**
+ * @brief Determine export format from a name ("text", "csv", "json", "plain")
+ * @param name Format name (case-insensitive)
+ * @param format Pointer to store the format
+ * @return true if the name is known, false otherwise
+ */
+bool export_format_from_name(const char *name, ExportFormat *format);
+
+/**
+ * @brief Determine export format from a file extension
+ * @param filename File name (may be NULL)
+ * @param fallback Format used when the extension is not recognized
+ * @return Export format (ENCRYPTED_EXTENSION is skipped: "list.csv.enc" is CSV)
+ */
+ExportFormat export_format_from_filename(const char *filename, ExportFormat fallback);
+
+/**
+ * @brief Start an export document
+ * @param writer Writer to initialize
+ * @param filename File to write to (NULL or "-" for stdout; ENCRYPTED_EXTENSION encrypts)
+ * @param format Output format
+ * @param include_metadata Include per-entry metadata (text format)
+ * @param expected_count Number of entries that will be written (0 = unknown)
+ * @return true if successful, false otherwise
+ */
+bool export_writer_begin(ExportWriter *writer, const char *filename,
+                         ExportFormat format, bool include_metadata,
+                         size_t expected_count);
+
+/**
+ * @brief Append one password to an export document
+ * @param writer Writer started with export_writer_begin()
+ * @param result Password to write
+ * @return true if successful, false otherwise
+ */
+bool export_writer_write(ExportWriter *writer, const PasswordResult *result);
+
+/**
+ * @brief Append a range of batch entries to an export document
+ * @param writer Writer started with export_writer_begin()
+ * @param batch Password batch
+ * @param begin First entry to write
+ * @param end One past the last entry to write
+ * @return true if successful, false otherwise
+ */
+bool export_writer_write_batch(ExportWriter *writer, const PasswordBatch *batch,
+                               size_t begin, size_t end);
+
+/**
+ * @brief Finish an export document and release the writer
+ * @param writer Writer started with export_writer_begin()
+ * @return true if every write succeeded, false otherwise
+ */
+bool export_writer_end(ExportWriter *writer);
 
 /**
  * @brief Save password to text file
@@ -22,6 +246,17 @@
 bool save_password_to_file(const PasswordResult *result, const char *filename, 
                           bool append, bool include_metadata);
 
+/**
+ * @brief Save a password batch in the given format
+ * @param batch Password batch
+ * @param filename File to save to ("-" for stdout)
+ * @param format Output format
+ * @param include_metadata Include per-entry metadata (text format)
+ * @return true if successful, false otherwise
+ */
+bool save_password_batch(const PasswordBatch *batch, const char *filename,
+                         ExportFormat format, bool include_metadata);
+
 /**
  * @brief Save multiple passwords to file
  * @param results Array of password results
@@ -53,21 +288,124 @@ bool save_passwords_to_csv(const PasswordResult *results, size_t count,
 bool save_passwords_to_json(const PasswordResult *results, size_t count,
                            const char *filename);
 
+/**
+ * @brief One password inside a PasswordFile buffer (not NUL-terminated)
+ */
+typedef struct {
+    const char *data;       /**< First byte of the password */
+    size_t length;          /**< Length in bytes */
+    uint64_t line;          /**< Line the password starts on (1-based) */
+} PasswordView;
+
+/**
+ * @brief Password file mapped (or read) into memory for single-pass parsing
+ *
+ * The file is mapped copy-on-write so quoted CSV fields and JSON escapes
+ * can be decoded in place; only pages holding such fields are copied.
+ * Views stay valid until password_file_close().
+ */
+typedef struct {
+    char *data;             /**< File contents */
+    size_t size;            /**< Size of the contents in bytes */
+    ExportFormat format;    /**< Detected layout */
+    bool mapped;            /**< data is a file mapping (else heap or arena) */
+    SecureArena arena;      /**< Locked copy in secure mode */
+    size_t position;        /**< Parser offset */
+    uint64_t line;          /**< Parser line number */
+    size_t csv_column;      /**< Password column of a CSV file */
+    uint64_t emitted;       /**< Passwords returned so far */
+    bool entry_blocks;      /**< Text file holds "Password: " entry blocks */
+    bool json_array;        /**< JSON document is a bare array of strings */
+    int json_depth;         /**< JSON nesting depth at position */
+    SpgArchiveLayout archive; /**< Tables of an SPG archive */
+} PasswordFile;
+
+/**
+ * @brief Open a password file and detect its layout
+ * @param file Structure to initialize
+ * @param filename File to open
+ * @param secure_copy Copy the contents into locked memory instead of mapping
+ * @return true if successful, false otherwise
+ *
+ * Text, CSV and JSON files written by this program are recognized, as are
+ * CSV files with a "password" column, JSON arrays of strings and plain
+ * one-per-line lists. Encrypted files are authenticated and decrypted
+ * into locked memory with the key from encryption_load_key_file().
+ * SPG archives are read through their offset table without parsing.
+ *
+ * Regular files are mapped; pipes, devices and other non-regular files
+ * are read into memory instead. A mapped file must not be truncated
+ * while it is open: touching the lost pages raises SIGBUS.
+ */
+bool password_file_open(PasswordFile *file, const char *filename, bool secure_copy);
+
+/**
+ * @brief Get one entry of an SPG archive by index
+ * @param file File opened with password_file_open() whose format is EXPORT_FORMAT_SPG
+ * @param index Entry index (0 to file->archive.count - 1)
+ * @param view Pointer to store the password view
+ * @param entry Pointer to store the entry's metadata (may be NULL)
+ * @return true if the entry exists, false otherwise
+ */
+bool password_file_get(const PasswordFile *file, size_t index, PasswordView *view,
+                       SpgArchiveEntry *entry);
+
+/**
+ * @brief Get the next password of a file
+ * @param file File opened with password_file_open()
+ * @param view Pointer to store the password view
+ * @return true if a password was found, false at the end of the file
+ */
+bool password_file_next(PasswordFile *file, PasswordView *view);
+
+/**
+ * @brief Release a password file (wiping copied contents)
+ * @param file File opened with password_file_open()
+ */
+void password_file_close(PasswordFile *file);
+
 /**
  * @brief Load passwords from file
  * @param filename File to load from
  * @param count Pointer to store number of passwords loaded
- * @return Array of password results (caller must free), or NULL on error
+ * @return Array of password results (caller must free), or NULL if the file
+ *         could not be read, held no passwords or did not fit in memory
+ *         (partial results are never returned)
  */
 PasswordResult *load_passwords_from_file(const char *filename, size_t *count);
 
+/**
+ * @brief Load passwords from file into a password batch
+ * @param filename File to load from
+ * @param batch Uninitialized batch (free with password_batch_free())
+ * @return true if at least one password was loaded, false otherwise
+ *
+ * Entries longer than MAX_INPUT_LENGTH bytes are left out and counted in
+ * a warning on stderr.
+ */
+bool load_passwords_into_batch(const char *filename, PasswordBatch *batch);
+
+/**
+ * @brief How secure_delete_file() destroys the old contents
+ */
+typedef enum {
+    SECURE_DELETE_OVERWRITE,    /**< Overwrite in several passes, each flushed to the device */
+    SECURE_DELETE_DISCARD       /**< One random pass, then release the blocks (TRIM on SSDs) */
+} SecureDeleteMode;
+
 /**
  * @brief Securely delete file (overwrite multiple times)
  * @param filename File to delete
- * @param passes Number of overwrite passes (3-7 recommended)
+ * @param passes Number of overwrite passes (3-7 recommended, ignored in discard mode)
+ * @param mode Overwrite or discard
  * @return true if successful, false otherwise
+ *
+ * The file is overwritten in place with a fixed-size chunk buffer, using
+ * direct I/O where the file system supports it. On SSDs and copy-on-write
+ * file systems an overwrite may not reach the old blocks, which is what
+ * discard mode is for.
  */
-bool secure_delete_file(const char *filename, int passes);
+bool secure_delete_file(const char *filename, int passes, SecureDeleteMode mode);
 
 /**
  * @brief Create backup of password file
@@ -0,0 +1,551 @@
+/**
+ * @file history.c
+ * @brief Persistent history of issued passwords implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE     /* flock() */
+#elif defined(__APPLE__) && !defined(_DARWIN_C_SOURCE)
+    #define _DARWIN_C_SOURCE
+#endif
+
+#include "history.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/file.h>
+    #include <sys/stat.h>
+#endif
+
+/* Suffix of the segment being written by a compaction */
+#define HISTORY_TEMP_SUFFIX ".tmp"
+
+/**
+ * @brief Hash a password under the history key
+ *
+ * 0 marks an empty set slot, so it is folded into 1.
+ */
+static uint64_t history_hash(const HistoryStore *history, const char *password, size_t length) {
+    uint64_t hash = siphash24(history->key, password, length);
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Copy a path with a suffix appended
+ */
+static char *path_with_suffix(const char *path, const char *suffix) {
+    size_t length = strlen(path);
+    size_t extra = strlen(suffix);
+    char *copy = (char *)malloc(length + extra + 1);
+    if (copy) {
+        memcpy(copy, path, length);
+        memcpy(copy + length, suffix, extra + 1);
+    }
+    return copy;
+}
+
+/**
+ * @brief Open (or create) a log readable by the owner only
+ *
+ * Every write appends, whatever the read position.
+ */
+static FILE *open_log_file(const char *path) {
+#ifdef _WIN32
+    int fd = _open(path, _O_RDWR | _O_APPEND | _O_CREAT | _O_BINARY | _O_NOINHERIT,
+                   _S_IREAD | _S_IWRITE);
+    FILE *file = fd >= 0 ? _fdopen(fd, "a+b") : NULL;
+    if (fd >= 0 && !file) {
+        _close(fd);
+    }
+#else
+    int fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    FILE *file = fd >= 0 ? fdopen(fd, "a+b") : NULL;
+    if (fd >= 0 && !file) {
+        close(fd);
+    }
+#endif
+    return file;
+}
+
+/**
+ * @brief Take the exclusive lock that serializes runs sharing a history
+ *
+ * Held until the log is closed, so another run waits instead of appending
+ * beside this one or compacting under it.
+ */
+static bool lock_log(HistoryStore *history) {
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)_get_osfhandle(_fileno(history->log));
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    if (LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0,
+                   MAXDWORD, MAXDWORD, &overlapped)) {
+        return true;
+    }
+    
+    fprintf(stderr, "Waiting for history %s (in use by another run)\n", history->path);
+    if (!LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped)) {
+        fprintf(stderr, "Failed to lock history %s\n", history->log_path);
+        return false;
+    }
+    return true;
+#else
+    int fd = fileno(history->log);
+    int status = flock(fd, LOCK_EX | LOCK_NB);
+    if (status != 0 && errno == EWOULDBLOCK) {
+        fprintf(stderr, "Waiting for history %s (in use by another run)\n", history->path);
+        do {
+            status = flock(fd, LOCK_EX);
+        } while (status != 0 && errno == EINTR);
+    }
+    
+    if (status != 0) {
+        fprintf(stderr, "Failed to lock history %s: %s\n", history->log_path, strerror(errno));
+        return false;
+    }
+    return true;
+#endif
+}
+
+/**
+ * @brief Write a stream's buffered data through to the disk
+ */
+static bool sync_stream(FILE *file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+/**
+ * @brief Cut a stream's file to a size
+ */
+static bool truncate_stream(FILE *file, uint64_t size) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _chsize_s(_fileno(file), (__int64)size) == 0;
+#else
+    return ftruncate(fileno(file), (off_t)size) == 0;
+#endif
+}
+
+/**
+ * @brief Write a closed file through to the disk and make it readable by the owner only
+ */
+static bool sync_private_file(const char *path) {
+#ifdef _WIN32
+    int fd = _open(path, _O_RDWR | _O_BINARY);
+    bool ok = fd >= 0 && _commit(fd) == 0;
+    if (fd >= 0) {
+        _close(fd);
+    }
+#else
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    bool ok = fd >= 0 && fchmod(fd, 0600) == 0 && fsync(fd) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+    return ok;
+}
+
+/**
+ * @brief Make a rename into the directory of a path durable
+ */
+static bool sync_parent_directory(const char *path) {
+#ifdef _WIN32
+    /* MOVEFILE_WRITE_THROUGH already waited for the rename */
+    (void)path;
+    return true;
+#else
+    const char *slash = strrchr(path, '/');
+    size_t length = slash ? (size_t)(slash - path) : 0;
+    char *directory = (char *)malloc(length + 2);
+    if (!directory) {
+        return false;
+    }
+    
+    if (!slash) {
+        strcpy(directory, ".");
+    } else if (length == 0) {
+        strcpy(directory, "/");
+    } else {
+        memcpy(directory, path, length);
+        directory[length] = '\0';
+    }
+    
+    int fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    free(directory);
+    bool ok = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+    return ok;
+#endif
+}
+
+/**
+ * @brief Check whether the recent set holds a hash
+ */
+static bool recent_contains(const HistoryStore *history, uint64_t hash) {
+    if (!history->recent) {
+        return false;
+    }
+    
+    size_t mask = history->recent_capacity - 1;
+    for (size_t slot = (size_t)hash & mask; history->recent[slot] != 0; slot = (slot + 1) & mask) {
+        if (history->recent[slot] == hash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Put a hash known to be absent into a set's slots
+ */
+static void recent_place(uint64_t *slots, size_t capacity, uint64_t hash) {
+    size_t mask = capacity - 1;
+    size_t slot = (size_t)hash & mask;
+    while (slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = hash;
+}
+
+/**
+ * @brief Add a hash known to be absent to the recent set, growing it at 75% load
+ */
+static bool recent_insert(HistoryStore *history, uint64_t hash) {
+    if ((history->recent_count + 1) * 4 > history->recent_capacity * 3) {
+        size_t capacity = history->recent_capacity ? history->recent_capacity * 2 : 1024;
+        uint64_t *slots = (uint64_t *)calloc(capacity, sizeof(uint64_t));
+        if (!slots) {
+            return false;
+        }
+        
+        for (size_t i = 0; i < history->recent_capacity; i++) {
+            if (history->recent[i] != 0) {
+                recent_place(slots, capacity, history->recent[i]);
+            }
+        }
+        
+        free(history->recent);
+        history->recent = slots;
+        history->recent_capacity = capacity;
+    }
+    
+    recent_place(history->recent, history->recent_capacity, hash);
+    history->recent_count++;
+    return true;
+}
+
+/**
+ * @brief Write the header of an empty log with the history key
+ */
+static bool start_log(HistoryStore *history) {
+    HistoryLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HISTORY_LOG_MAGIC, sizeof(header.magic));
+    header.byte_order = BREACH_INDEX_BYTE_ORDER;
+    memcpy(header.hash_key, history->key, sizeof(header.hash_key));
+    
+    return fwrite(&header, sizeof(header), 1, history->log) == 1 && sync_stream(history->log);
+}
+
+/**
+ * @brief Read a non-empty log into the recent set
+ */
+static bool load_log(HistoryStore *history, bool have_key, uint64_t size) {
+    HistoryLogHeader header;
+    if (fseek(history->log, 0, SEEK_SET) != 0 ||
+        fread(&header, sizeof(header), 1, history->log) != 1 ||
+        memcmp(header.magic, HISTORY_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+        header.byte_order != BREACH_INDEX_BYTE_ORDER) {
+        fprintf(stderr, "Invalid history log: %s\n", history->log_path);
+        return false;
+    }
+    
+    if (have_key && memcmp(header.hash_key, history->key, sizeof(history->key)) != 0) {
+        fprintf(stderr, "History log %s does not belong to %s\n", history->log_path, history->path);
+        return false;
+    }
+    memcpy(history->key, header.hash_key, sizeof(history->key));
+    
+    uint64_t block[4096];
+    uint64_t entries = 0;
+    size_t read;
+    while ((read = fread(block, sizeof(uint64_t), sizeof(block) / sizeof(block[0]), history->log)) > 0) {
+        for (size_t i = 0; i < read; i++) {
+            if (block[i] != 0 && !recent_contains(history, block[i]) &&
+                !recent_insert(history, block[i])) {
+                return false;
+            }
+        }
+        entries += read;
+    }
+    
+    if (ferror(history->log)) {
+        return false;
+    }
+    
+    /* A torn final write leaves a partial hash, cut off before anything is appended */
+    uint64_t valid = sizeof(header) + entries * sizeof(uint64_t);
+    return (valid == size || truncate_stream(history->log, valid)) &&
+           fseek(history->log, 0, SEEK_END) == 0;
+}
+
+/**
+ * @brief Open a history, creating it if it does not exist
+ */
+bool history_open(HistoryStore *history, const char *path) {
+    if (!history || !path) {
+        return false;
+    }
+    
+    memset(history, 0, sizeof(HistoryStore));
+    history->path = path_with_suffix(path, "");
+    history->log_path = path_with_suffix(path, HISTORY_LOG_SUFFIX);
+    if (!history->path || !history->log_path) {
+        history_close(history);
+        return false;
+    }
+    
+    history->log = open_log_file(history->log_path);
+    if (!history->log) {
+        fprintf(stderr, "Error opening file %s: %s\n", history->log_path, strerror(errno));
+        history_close(history);
+        return false;
+    }
+    
+    if (!lock_log(history)) {
+        history_close(history);
+        return false;
+    }
+    
+    /* The segment only exists once something has been compacted; it is
+       opened under the lock so no other run can replace it in between */
+    bool have_key = false;
+    if (file_exists(path)) {
+        if (!breach_index_open(&history->segment, path)) {
+            history_close(history);
+            return false;
+        }
+        memcpy(history->key, history->segment.hash_key, sizeof(history->key));
+        have_key = true;
+    }
+    
+    long size = fseek(history->log, 0, SEEK_END) == 0 ? ftell(history->log) : -1;
+    bool ok;
+    if (size < 0) {
+        ok = false;
+    } else if (size > 0) {
+        ok = load_log(history, have_key, (uint64_t)size);
+    } else {
+        /* New, or created by a run that stopped before writing the header */
+        ok = (have_key || get_random_bytes(history->key, sizeof(history->key))) &&
+             start_log(history);
+    }
+    
+    if (!ok) {
+        history_close(history);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Check whether a password was recorded before
+ */
+bool history_contains(const HistoryStore *history, const char *password, size_t length) {
+    if (!history || !history->path || !password) {
+        return false;
+    }
+    
+    uint64_t hash = history_hash(history, password, length);
+    return recent_contains(history, hash) || breach_index_contains_hash(&history->segment, hash);
+}
+
+/**
+ * @brief Record an issued password
+ */
+bool history_record(HistoryStore *history, const char *password, size_t length) {
+    if (!history || !history->log || !password) {
+        return false;
+    }
+    
+    uint64_t hash = history_hash(history, password, length);
+    if (recent_contains(history, hash) || breach_index_contains_hash(&history->segment, hash)) {
+        return true;
+    }
+    
+    if (!recent_insert(history, hash)) {
+        history->failed = true;
+        return false;
+    }
+    
+    if (fwrite(&hash, sizeof(hash), 1, history->log) != 1) {
+        history->failed = true;
+        return false;
+    }
+    
+    if (history->recent_count >= HISTORY_LOG_MAX_ENTRIES) {
+        return history_compact(history);
+    }
+    return true;
+}
+
+/**
+ * @brief Record every password of a batch
+ */
+bool history_record_batch(HistoryStore *history, const PasswordBatch *batch) {
+    if (!history || !batch) {
+        return false;
+    }
+    
+    bool ok = true;
+    for (size_t i = 0; i < batch->count; i++) {
+        ok = history_record(history, batch->chars + i * batch->stride, batch->lengths[i]) && ok;
+    }
+    return ok;
+}
+
+/**
+ * @brief Order hashes for qsort
+ */
+static int compare_hashes(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/**
+ * @brief Merge the log into a new segment and empty the log
+ */
+bool history_compact(HistoryStore *history) {
+    if (!history || !history->log) {
+        return false;
+    }
+    
+    bool have_segment = history->segment.map != NULL;
+    if (history->recent_count == 0 && have_segment) {
+        return true;
+    }
+    
+    /* Everything merged must already be on disk in the log */
+    if (!sync_stream(history->log)) {
+        history->failed = true;
+        return false;
+    }
+    
+    uint64_t *sorted = (uint64_t *)malloc((history->recent_count + 1) * sizeof(uint64_t));
+    char *temp_path = path_with_suffix(history->path, HISTORY_TEMP_SUFFIX);
+    if (!sorted || !temp_path) {
+        free(sorted);
+        free(temp_path);
+        return false;
+    }
+    
+    size_t count = 0;
+    for (size_t i = 0; i < history->recent_capacity; i++) {
+        if (history->recent[i] != 0) {
+            sorted[count++] = history->recent[i];
+        }
+    }
+    qsort(sorted, count, sizeof(uint64_t), compare_hashes);
+    
+    bool merged = breach_index_merge(temp_path, &history->segment, sorted, count,
+                                     history->key, NULL);
+    free(sorted);
+    
+    /* The new segment reaches the disk before it replaces the old one */
+    merged = merged && sync_private_file(temp_path);
+    
+    /* The old segment must be unmapped before it can be replaced on Windows */
+    breach_index_close(&history->segment);
+    
+#ifdef _WIN32
+    bool renamed = merged && MoveFileExA(temp_path, history->path,
+                                         MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    bool renamed = merged && rename(temp_path, history->path) == 0;
+#endif
+    bool durable = renamed && sync_parent_directory(history->path);
+    
+    if (!renamed) {
+        remove(temp_path);
+    }
+    free(temp_path);
+    
+    if ((renamed || have_segment) && !breach_index_open(&history->segment, history->path)) {
+        history->failed = true;
+        return false;
+    }
+    if (!durable) {
+        fprintf(stderr, "Failed to compact history %s\n", history->path);
+        return false;
+    }
+    
+    /* The merged hashes are durable in the segment now; a crash before this point only repeats them */
+    if (!truncate_stream(history->log, sizeof(HistoryLogHeader)) ||
+        fseek(history->log, 0, SEEK_END) != 0) {
+        history->failed = true;
+        return false;
+    }
+    
+    memset(history->recent, 0, history->recent_capacity * sizeof(uint64_t));
+    history->recent_count = 0;
+    return true;
+}
+
+/**
+ * @brief Count the hashes in a history
+ */
+uint64_t history_count(const HistoryStore *history) {
+    if (!history) {
+        return 0;
+    }
+    return history->segment.count + history->recent_count;
+}
+
+/**
+ * @brief Write out the log and release a history
+ */
+bool history_close(HistoryStore *history) {
+    if (!history) {
+        return false;
+    }
+    
+    bool ok = !history->failed;
+    if (history->log) {
+        ok = sync_stream(history->log) && ok;
+        
+        /* Closing the log releases the lock */
+        ok = fclose(history->log) == 0 && ok;
+    }
+    
+    breach_index_close(&history->segment);
+    free(history->recent);
+    free(history->path);
+    free(history->log_path);
+    memset(history, 0, sizeof(HistoryStore));
+    return ok;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+/**
+ * @file history.h
+ * @brief Persistent history of issued passwords, stored as keyed hashes
+ * @version 1.0
+ * @date 2024
+ *
+ * A history is two files:
+ *
+ *     PATH        compacted segment: a breach index (breach.h) of every
+ *                 hash merged so far, mapped read-only
+ *     PATH.log    append-only log: a HistoryLogHeader, then one uint64_t
+ *                 SipHash per password recorded since the last compaction
+ *
+ * No plaintext is ever written. Both files share one random SipHash key,
+ * so hashes cannot be matched against other files or precomputed tables;
+ * anyone holding the files can still test guesses, so keep them private.
+ *
+ * Lookups probe an in-memory set of the log's hashes and one bucket of
+ * the segment, so they cost the same however long the history grows.
+ * Compaction merges the log into a new segment in one sequential pass,
+ * syncs it and renames it into place before the log is emptied, so an
+ * interrupted compaction or a power loss leaves hashes in both files,
+ * never in neither.
+ *
+ * A run holds an exclusive lock on the log from history_open() to
+ * history_close(); another run sharing the files waits for it, and the
+ * same process must not open one history twice.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "breach.h"
+#include "password.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HISTORY_LOG_MAGIC "SPGHLOG1"
+#define HISTORY_LOG_SUFFIX ".log"
+
+/**
+ * @brief Compaction policy
+ *
+ * The log is merged once it holds HISTORY_LOG_MAX_ENTRIES hashes, so
+ * opening a history reads at most 8 MiB of log and the in-memory set stays
+ * under 32 MiB however large the segment grows. Each compaction rewrites
+ * the segment, a sequential pass of 8 bytes per stored password.
+ */
+#define HISTORY_LOG_MAX_ENTRIES (1u << 20)
+
+/**
+ * @brief Log header (64 bytes)
+ */
+typedef struct {
+    char magic[8];                              /**< HISTORY_LOG_MAGIC */
+    uint32_t byte_order;                        /**< BREACH_INDEX_BYTE_ORDER */
+    uint32_t reserved0;                         /**< Zero */
+    unsigned char hash_key[SIPHASH_KEY_SIZE];   /**< SipHash key, equal to the segment's */
+    uint64_t reserved[4];                       /**< Zero */
+} HistoryLogHeader;
+
+/**
+ * @brief Open history
+ *
+ * Lookups may run from several threads at once, but not while anything
+ * is being recorded.
+ */
+typedef struct HistoryStore {
+    char *path;                                 /**< Segment file */
+    char *log_path;                             /**< Log file */
+    BreachIndex segment;                        /**< Compacted hashes (unmapped until the first compaction) */
+    unsigned char key[SIPHASH_KEY_SIZE];        /**< SipHash key */
+    FILE *log;                                  /**< Log, positioned at its end */
+    uint64_t *recent;                           /**< Open-addressing set of logged hashes (0 = empty) */
+    size_t recent_capacity;                     /**< Slots in recent (a power of two) */
+    size_t recent_count;                        /**< Hashes in recent */
+    bool failed;                                /**< A log write or compaction failed */
+} HistoryStore;
+
+/**
+ * @brief Open a history, creating it if it does not exist
+ * @param history History to initialize
+ * @param path Segment file; the log is path + HISTORY_LOG_SUFFIX
+ * @return true if successful, false otherwise
+ */
+bool history_open(HistoryStore *history, const char *path);
+
+/**
+ * @brief Check whether a password was recorded before
+ * @param history Open history (safe to query from several threads)
+ * @param password Password to look up
+ * @param length Length of the password
+ * @return true if found; a different password sharing a hash (about n / 2^64) also matches
+ */
+bool history_contains(const HistoryStore *history, const char *password, size_t length);
+
+/**
+ * @brief Record an issued password
+ * @param history Open history (no lookups may run concurrently)
+ * @param password Password to record
+ * @param length Length of the password
+ * @return true if the password is in the history afterwards, false on error
+ *
+ * Passwords already present are not logged again. The log is compacted
+ * when it reaches the size given by the compaction policy.
+ */
+bool history_record(HistoryStore *history, const char *password, size_t length);
+
+/**
+ * @brief Record every password of a batch
+ * @param history Open history (no lookups may run concurrently)
+ * @param batch Password batch
+ * @return true if all were recorded, false on error
+ */
+bool history_record_batch(HistoryStore *history, const PasswordBatch *batch);
+
+/**
+ * @brief Merge the log into a new segment and empty the log
+ * @param history Open history
+ * @return true if successful, false otherwise (the history stays usable)
+ */
+bool history_compact(HistoryStore *history);
+
+/**
+ * @brief Count the hashes in a history
+ * @param history Open history
+ * @return Number of recorded passwords
+ */
+uint64_t history_count(const HistoryStore *history);
+
+/**
+ * @brief Write out the log and release a history
+ * @param history History to close
+ * @return true if everything recorded reached the disk, false otherwise
+ */
+bool history_close(HistoryStore *history);
+
+#endif /* HISTORY_H */
\ No newline at end of file
@@ -13,6 +13,15 @@
 #include "ui.h"
 #include "clipboard.h"
 #include "file_ops.h"
+#include "parallel.h"
+#include "breach.h"
+#include "audit.h"
+#include "server.h"
+#include "passphrase.h"
+#include "pattern.h"
+#include "dedup.h"
+#include "history.h"
+#include "encrypted.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -24,6 +33,15 @@ static bool program_running = true;
 static PasswordOptions current_options;
 static UIConfig ui_config;
 
+/* Sets behind --unique and --unique-against, alive for the whole run */
+static UniqueSet unique_set;
+static PasswordBatch unique_history;
+static NearDuplicateIndex near_index;
+
+/* History behind --history; recorded between generation calls, never during one */
+static HistoryStore history_store;
+static bool history_active = false;
+
 /**
  * @brief Get program version information
  */
@@ -63,7 +81,9 @@ void print_help(void) {
            COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  %s-l, --length LEN%s        Password length (8-128, default: 16)\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
-    printf("  %s-c, --count NUM%s         Number of passwords to generate (1-100)\n", 
+    printf("  %s-c, --count NUM%s         Number of passwords to generate (1-%d)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET, MAX_BULK_GENERATE);
+    printf("  %s-t, --threads NUM%s       Worker threads for bulk generation (default: all CPUs)\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  %s-u, --uppercase%s         Include uppercase letters (A-Z)\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
@@ -75,14 +95,57 @@ void print_help(void) {
            COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  %s-a, --avoid-ambiguous%s   Avoid ambiguous characters (l,I,1,O,0)\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
-    printf("  %s-p, --pattern PAT%s       Generate from pattern (e.g., \"llUnss\")\n", 
+    printf("  %s-p, --pattern PAT%s       Generate from a template (e.g., \"U{4}-[0-9A-F]{8}\")\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  %s-o, --output FILE%s       Save passwords to file\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
-    printf("  %s--format FORMAT%s         Output format: text, csv, json (default: text)\n", 
+    printf("  %s--format FORMAT%s         Output format: text, csv, json, spg, plain (default: text)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--stream%s                Generate and write in chunks (constant memory unless --unique)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--key-file FILE%s         Key for encrypted %s files (written and read)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET, ENCRYPTED_EXTENSION);
+    printf("  %s--generate-key FILE%s     Create a new random key file and exit\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--reject-weak%s           Regenerate passwords containing weak patterns\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--reject-dictionary%s     Regenerate passwords containing dictionary words\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--unique%s                Never repeat a password within one run (keeps ~11 bytes each;\n"
+           "                            with --stream, at most %d passwords)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET, UNIQUE_STREAM_MAX_ENTRIES);
+    printf("  %s--unique-against FILE%s   Also reject repeats of, or near matches to, passwords in FILE\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--history[=FILE]%s        Reject and record passwords issued before (default: %s)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET, HISTORY_FILENAME);
+    printf("  %s--compact-history%s       Merge the --history log into its index and exit\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--max-attempts NUM%s      Candidates per password before repairing (default: %d)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET, DEFAULT_MAX_ATTEMPTS);
+    printf("  %s--audit FILE%s            Score every password in a text, CSV, JSON or SPG file\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--serve SOCKET%s          Answer generation requests on a Unix socket\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--stats[=FORMAT]%s        Report stage timings on stderr: table or json\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--breach-index FILE%s     Treat passwords in this breach index as dictionary words\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--build-breach-index LIST%s Compile a wordlist into a breach index (-o FILE)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--passphrase WORDS%s      Generate passphrases of WORDS words (max %d)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET, PASSPHRASE_MAX_WORDS);
+    printf("  %s--wordlist FILE%s         Wordlist index to draw passphrase words from\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--build-wordlist LIST%s   Compile a word or diceware list into a wordlist index (-o FILE)\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--separator TEXT%s        Text between words, sharing no character with them (default: \"%s\")\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET, PASSPHRASE_DEFAULT_SEPARATOR);
+    printf("  %s--capitalize%s            Capitalize each passphrase word\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  %s--copy%s                  Copy password to clipboard\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
+    printf("  %s--clear-after SECONDS%s   Clear the copied password from the clipboard after a delay\n", 
+           COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  %s--entropy%s               Show entropy information\n", 
            COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  %s--strength%s              Show strength assessment\n", 
@@ -175,7 +238,9 @@ void print_examples(void) {
     
     printf("%sFor Pattern-Based:%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  $ %spassgen -p \"llUnss\"%s\n", COLOR_BRIGHT_WHITE, COLOR_RESET);
-    printf("  %s➔ Password matching pattern: lower, lower, Upper, number, special, special%s\n\n", COLOR_CYAN, COLOR_RESET);
+    printf("  %s➔ Password matching pattern: lower, lower, Upper, number, special, special%s\n", COLOR_CYAN, COLOR_RESET);
+    printf("  $ %spassgen -p \"[0-9A-F]{5}-[0-9A-F]{5}-[0-9A-F]{5}\" -c 1000%s\n", COLOR_BRIGHT_WHITE, COLOR_RESET);
+    printf("  %s➔ 1000 license keys from a template compiled once%s\n\n", COLOR_CYAN, COLOR_RESET);
     
     printf("%sFor System Integration:%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
     printf("  $ %spassgen -q -l 20 -c 50 --format csv%s\n", COLOR_BRIGHT_WHITE, COLOR_RESET);
@@ -195,11 +260,14 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
     options->mode = UI_MODE_INTERACTIVE;
     options->pass_opts = password_options_init();
     options->count = 1;
+    options->threads = 0;
     options->copy_to_clipboard = false;
     options->show_help = false;
     options->show_version = false;
     options->show_entropy = false;
     options->quiet_mode = false;
+    options->show_stats = false;
+    options->stats_format = STATS_FORMAT_TABLE;
     
     /* Define long options */
     static struct option long_options[] = {
@@ -209,6 +277,7 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
         {"quiet", no_argument, 0, 'q'},
         {"length", required_argument, 0, 'l'},
         {"count", required_argument, 0, 'c'},
+        {"threads", required_argument, 0, 't'},
         {"uppercase", no_argument, 0, 'u'},
         {"lowercase", no_argument, 0, 'L'},
         {"numbers", no_argument, 0, 'n'},
@@ -217,7 +286,28 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
         {"pattern", required_argument, 0, 'p'},
         {"output", required_argument, 0, 'o'},
         {"format", required_argument, 0, 0},
+        {"stream", no_argument, 0, 0},
+        {"key-file", required_argument, 0, 0},
+        {"generate-key", required_argument, 0, 0},
+        {"reject-weak", no_argument, 0, 0},
+        {"reject-dictionary", no_argument, 0, 0},
+        {"max-attempts", required_argument, 0, 0},
+        {"unique", no_argument, 0, 0},
+        {"unique-against", required_argument, 0, 0},
+        {"history", optional_argument, 0, 0},
+        {"compact-history", no_argument, 0, 0},
+        {"audit", required_argument, 0, 0},
+        {"serve", required_argument, 0, 0},
+        {"stats", optional_argument, 0, 0},
+        {"breach-index", required_argument, 0, 0},
+        {"build-breach-index", required_argument, 0, 0},
+        {"passphrase", required_argument, 0, 0},
+        {"wordlist", required_argument, 0, 0},
+        {"build-wordlist", required_argument, 0, 0},
+        {"separator", required_argument, 0, 0},
+        {"capitalize", no_argument, 0, 0},
         {"copy", no_argument, 0, 0},
+        {"clear-after", required_argument, 0, 0},
         {"entropy", no_argument, 0, 0},
         {"strength", no_argument, 0, 0},
         {"save-config", no_argument, 0, 0},
@@ -227,8 +317,9 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
     
     int opt;
     int option_index = 0;
+    bool interactive_requested = false;
     
-    while ((opt = getopt_long(argc, argv, "hvqil:c:uLnsap:o:", 
+    while ((opt = getopt_long(argc, argv, "hvqil:c:t:uLnsap:o:", 
                               long_options, &option_index)) != -1) {
         switch (opt) {
             case 'h':
@@ -240,7 +331,7 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
                 break;
                 
             case 'i':
-                options->mode = UI_MODE_INTERACTIVE;
+                interactive_requested = true;
                 break;
                 
             case 'q':
@@ -271,6 +362,17 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
                 }
                 break;
                 
+            case 't':
+                {
+                    int threads;
+                    if (string_to_int(optarg, &threads, 1, PARALLEL_MAX_THREADS)) {
+                        options->threads = threads;
+                    } else {
+                        fprintf(stderr, "Invalid thread count: %s. Using all CPUs\n", optarg);
+                    }
+                }
+                break;
+                
             case 'u':
                 options->pass_opts.charset.uppercase = true;
                 break;
@@ -292,8 +394,7 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
                 break;
                 
             case 'p':
-                options->output_file = optarg; /* Temporarily store pattern */
-                /* Pattern mode has special handling */
+                options->pattern = optarg;
                 break;
                 
             case 'o':
@@ -304,13 +405,85 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
                 /* Handle long options without short equivalents */
                 if (strcmp(long_options[option_index].name, "copy") == 0) {
                     options->copy_to_clipboard = true;
+                } else if (strcmp(long_options[option_index].name, "clear-after") == 0) {
+                    int seconds;
+                    if (string_to_int(optarg, &seconds, 0, 86400)) {
+                        options->clear_after = seconds;
+                    } else {
+                        fprintf(stderr, "Invalid clear delay: %s. Clipboard will not be cleared\n", optarg);
+                    }
                 } else if (strcmp(long_options[option_index].name, "entropy") == 0) {
                     options->show_entropy = true;
                 } else if (strcmp(long_options[option_index].name, "strength") == 0) {
                     options->show_entropy = true; /* Strength implies entropy */
                 } else if (strcmp(long_options[option_index].name, "format") == 0) {
-                    /* Format will be handled in output generation */
-                    printf("Format: %s\n", optarg);
+                    if (export_format_from_name(optarg, &options->output_format)) {
+                        options->format_given = true;
+                    } else {
+                        fprintf(stderr, "Invalid format: %s. Using default: text\n", optarg);
+                    }
+                } else if (strcmp(long_options[option_index].name, "stream") == 0) {
+                    options->stream_output = true;
+                } else if (strcmp(long_options[option_index].name, "reject-weak") == 0) {
+                    options->pass_opts.reject_weak = true;
+                } else if (strcmp(long_options[option_index].name, "reject-dictionary") == 0) {
+                    options->pass_opts.reject_dictionary = true;
+                } else if (strcmp(long_options[option_index].name, "max-attempts") == 0) {
+                    int attempts;
+                    if (string_to_int(optarg, &attempts, 1, 1000000)) {
+                        options->pass_opts.max_attempts = (size_t)attempts;
+                    } else {
+                        fprintf(stderr, "Invalid attempt limit: %s. Using default: %d\n", 
+                                optarg, DEFAULT_MAX_ATTEMPTS);
+                    }
+                } else if (strcmp(long_options[option_index].name, "unique") == 0) {
+                    options->unique = true;
+                } else if (strcmp(long_options[option_index].name, "unique-against") == 0) {
+                    options->unique = true;
+                    options->unique_against = optarg;
+                } else if (strcmp(long_options[option_index].name, "history") == 0) {
+                    options->history_file = optarg ? optarg : HISTORY_FILENAME;
+                } else if (strcmp(long_options[option_index].name, "compact-history") == 0) {
+                    options->compact_history = true;
+                } else if (strcmp(long_options[option_index].name, "audit") == 0) {
+                    options->audit_file = optarg;
+                } else if (strcmp(long_options[option_index].name, "serve") == 0) {
+                    options->serve_socket = optarg;
+                } else if (strcmp(long_options[option_index].name, "stats") == 0) {
+                    options->show_stats = true;
+                    if (optarg && !stats_format_from_name(optarg, &options->stats_format)) {
+                        fprintf(stderr, "Invalid stats format: %s. Using default: table\n", optarg);
+                    }
+                } else if (strcmp(long_options[option_index].name, "key-file") == 0) {
+                    options->key_file = optarg;
+                } else if (strcmp(long_options[option_index].name, "generate-key") == 0) {
+                    options->new_key_file = optarg;
+                } else if (strcmp(long_options[option_index].name, "breach-index") == 0) {
+                    options->breach_index = optarg;
+                } else if (strcmp(long_options[option_index].name, "build-breach-index") == 0) {
+                    options->breach_wordlist = optarg;
+                } else if (strcmp(long_options[option_index].name, "passphrase") == 0) {
+                    int words;
+                    if (string_to_int(optarg, &words, 1, PASSPHRASE_MAX_WORDS)) {
+                        options->passphrase_words = words;
+                    } else {
+                        fprintf(stderr, "Invalid word count: %s. Using default: %d\n", 
+                                optarg, PASSPHRASE_DEFAULT_WORDS);
+                        options->passphrase_words = PASSPHRASE_DEFAULT_WORDS;
+                    }
+                } else if (strcmp(long_options[option_index].name, "wordlist") == 0) {
+                    options->wordlist_index = optarg;
+                } else if (strcmp(long_options[option_index].name, "build-wordlist") == 0) {
+                    options->wordlist_source = optarg;
+                } else if (strcmp(long_options[option_index].name, "separator") == 0) {
+                    if (strlen(optarg) < PASSPHRASE_SEPARATOR_MAX) {
+                        options->passphrase_separator = optarg;
+                    } else {
+                        fprintf(stderr, "Separator too long: %s. Using default: \"%s\"\n", 
+                                optarg, PASSPHRASE_DEFAULT_SEPARATOR);
+                    }
+                } else if (strcmp(long_options[option_index].name, "capitalize") == 0) {
+                    options->capitalize_words = true;
                 } else if (strcmp(long_options[option_index].name, "save-config") == 0) {
                     /* Will be handled later */
                 } else if (strcmp(long_options[option_index].name, "load-config") == 0) {
@@ -324,6 +497,13 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
         }
     }
     
+    /* Any generation option selects command line mode unless -i was given */
+    if (interactive_requested) {
+        options->mode = UI_MODE_INTERACTIVE;
+    } else if (argc > 1 && options->mode != UI_MODE_SILENT) {
+        options->mode = UI_MODE_COMMAND_LINE;
+    }
+    
     /* If no character sets specified, use defaults */
     if (!options->pass_opts.charset.lowercase && 
         !options->pass_opts.charset.uppercase &&
@@ -339,6 +519,140 @@ bool parse_command_line(int argc, char *argv[], CommandLineOptions *options) {
     return true;
 }
 
+/**
+ * @brief Set up the sets behind --unique and --unique-against
+ * @return false if a set could not be built
+ *
+ * Passwords from --unique-against seed the exact set and a near-duplicate
+ * index, so candidates repeating or resembling them are redrawn. The set
+ * holds every password of the run, so --stream runs are capped at
+ * UNIQUE_STREAM_MAX_ENTRIES to keep their memory bounded.
+ */
+static bool prepare_uniqueness(CommandLineOptions *options) {
+    if (!options->unique) {
+        return true;
+    }
+    
+    size_t expected = (size_t)options->count;
+    
+    if (options->unique_against) {
+        if (!load_passwords_into_batch(options->unique_against, &unique_history)) {
+            fprintf(stderr, "Failed to load passwords from %s\n", options->unique_against);
+            return false;
+        }
+        if (!near_duplicate_index_build(&near_index, &unique_history, UNIQUE_SIMILARITY_THRESHOLD)) {
+            fprintf(stderr, "Failed to index passwords from %s\n", options->unique_against);
+            return false;
+        }
+        options->pass_opts.near_duplicates = &near_index;
+        expected += unique_history.count;
+    }
+    
+    if (options->stream_output && expected > UNIQUE_STREAM_MAX_ENTRIES) {
+        fprintf(stderr, "--stream --unique remembers every password: at most %d per run, "
+                "--unique-against entries included (got %zu)\n", UNIQUE_STREAM_MAX_ENTRIES, expected);
+        return false;
+    }
+    
+    if (!unique_set_init(&unique_set, expected)) {
+        print_error("Memory allocation failed!");
+        return false;
+    }
+    
+    for (size_t i = 0; i < unique_history.count; i++) {
+        unique_set_insert(&unique_set, unique_history.chars + i * unique_history.stride,
+                          unique_history.lengths[i]);
+    }
+    
+    options->pass_opts.unique = &unique_set;
+    return true;
+}
+
+/**
+ * @brief Release the sets behind --unique and --unique-against
+ */
+static void release_uniqueness(void) {
+    unique_set_destroy(&unique_set);
+    near_duplicate_index_destroy(&near_index);
+    password_batch_free(&unique_history);
+}
+
+/**
+ * @brief Open the history behind --history
+ * @return false if a history was requested but could not be opened
+ */
+static bool prepare_history(CommandLineOptions *options) {
+    if (!options->history_file) {
+        return true;
+    }
+    
+    if (!history_open(&history_store, options->history_file)) {
+        fprintf(stderr, "Failed to open password history %s\n", options->history_file);
+        return false;
+    }
+    
+    history_active = true;
+    options->pass_opts.history = &history_store;
+    return true;
+}
+
+/**
+ * @brief Record issued passwords in the history, if one is open
+ *
+ * Called on the main thread between generation calls, when no worker is
+ * checking candidates against the history.
+ */
+static void record_history(const char *password, size_t length) {
+    if (history_active) {
+        history_record(&history_store, password, length);
+    }
+}
+
+/**
+ * @brief Record every password of a batch in the history, if one is open
+ */
+static void record_history_batch(const PasswordBatch *batch) {
+    if (history_active) {
+        history_record_batch(&history_store, batch);
+    }
+}
+
+/**
+ * @brief Close the history behind --history
+ * @return false if recorded passwords may not have reached the files
+ */
+static bool release_history(const CommandLineOptions *options) {
+    if (!history_active) {
+        return true;
+    }
+    
+    history_active = false;
+    if (!history_close(&history_store)) {
+        fprintf(stderr, "%s❌ Failed to update password history %s%s\n", COLOR_BRIGHT_RED,
+                options->history_file, COLOR_RESET);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Choose the result metadata a run displays or saves
+ * @param options Command line options
+ * @param displayed Results are shown on the terminal
+ * @param format Format results are written in
+ * @return PASSWORD_META_* fields to compute
+ *
+ * Plain output carries only the passwords, so quiet runs piped to stdout
+ * or saved as plain text skip the per-password metadata entirely.
+ */
+static unsigned metadata_for_output(const CommandLineOptions *options, bool displayed,
+                                    ExportFormat format) {
+    if (displayed || options->show_entropy || format != EXPORT_FORMAT_PLAIN) {
+        return options->pass_opts.metadata;
+    }
+    return PASSWORD_META_NONE;
+}
+
 /**
  * @brief Handle single password generation
  */
@@ -348,8 +662,10 @@ void handle_single_password(const CommandLineOptions *options) {
     }
     
     /* Generate password */
-    printf("%sGenerating password...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
-    fflush(stdout);
+    if (!options->quiet_mode) {
+        printf("%sGenerating password...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+        fflush(stdout);
+    }
     
     PasswordResult result = generate_password(&options->pass_opts);
     
@@ -358,7 +674,11 @@ void handle_single_password(const CommandLineOptions *options) {
         return;
     }
     
-    printf("%s✅ Done!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+    record_history(result.password, result.length);
+    
+    if (!options->quiet_mode) {
+        printf("%s✅ Done!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+    }
     
     /* Display password */
     if (!options->quiet_mode) {
@@ -370,12 +690,20 @@ void handle_single_password(const CommandLineOptions *options) {
     
     /* Copy to clipboard if requested */
     if (options->copy_to_clipboard) {
-        printf("%sCopying to clipboard...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
-        fflush(stdout);
+        if (!options->quiet_mode) {
+            printf("%sCopying to clipboard...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+            fflush(stdout);
+        }
         
-        ClipboardResult clip_result = copy_to_clipboard(result.password);
+        ClipboardResult clip_result = copy_with_autoclear(result.password, options->clear_after);
         
-        if (clip_result == CLIPBOARD_SUCCESS) {
+        if (options->quiet_mode) {
+            if (clip_result != CLIPBOARD_SUCCESS) {
+                print_error(get_clipboard_result_string(clip_result));
+            }
+        } else if (clip_result == CLIPBOARD_SUCCESS && options->clear_after > 0) {
+            printf("%s✅ Copied! (clears in %d s)%s\n", COLOR_BRIGHT_GREEN, options->clear_after, COLOR_RESET);
+        } else if (clip_result == CLIPBOARD_SUCCESS) {
             printf("%s✅ Copied!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
         } else {
             printf("%s❌ Failed: %s%s\n", 
@@ -385,13 +713,19 @@ void handle_single_password(const CommandLineOptions *options) {
     
     /* Save to file if requested */
     if (options->output_file) {
-        printf("%sSaving to file...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
-        fflush(stdout);
+        if (!options->quiet_mode) {
+            printf("%sSaving to file...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+            fflush(stdout);
+        }
         
         bool saved = save_password_to_file(&result, options->output_file, 
                                           false, !options->quiet_mode);
         
-        if (saved) {
+        if (options->quiet_mode) {
+            if (!saved) {
+                print_error("Failed to save file");
+            }
+        } else if (saved) {
             printf("%s✅ Saved to: %s%s\n", 
                    COLOR_BRIGHT_GREEN, options->output_file, COLOR_RESET);
         } else {
@@ -417,62 +751,71 @@ void handle_bulk_passwords(const CommandLineOptions *options) {
         return;
     }
     
-    printf("%sGenerating %d passwords...%s ", 
-           COLOR_BRIGHT_YELLOW, options->count, COLOR_RESET);
-    fflush(stdout);
+    if (!options->quiet_mode) {
+        printf("%sGenerating %d passwords...%s ", 
+               COLOR_BRIGHT_YELLOW, options->count, COLOR_RESET);
+        fflush(stdout);
+    }
     
-    /* Allocate memory for results */
-    PasswordResult *results = (PasswordResult *)calloc(options->count, sizeof(PasswordResult));
-    if (!results) {
+    /* One locked arena holds every password in the run */
+    PasswordBatch batch;
+    if (!password_batch_init(&batch, (size_t)options->count, options->pass_opts.length)) {
         print_error("Memory allocation failed!");
         return;
     }
     
+    ExportFormat format = options->format_given ? options->output_format :
+                          export_format_from_filename(options->output_file, EXPORT_FORMAT_TEXT);
+    PasswordOptions pass_opts = options->pass_opts;
+    pass_opts.metadata = metadata_for_output(options, !options->quiet_mode,
+                                             options->output_file ? format : EXPORT_FORMAT_PLAIN);
+    
     /* Generate passwords */
-    size_t generated = generate_bulk_passwords(&options->pass_opts, 
-                                              options->count, results);
+    GenerationStats stats = {0};
+    size_t generated = password_batch_generate(&batch, &pass_opts, 
+                                               (size_t)options->count,
+                                               (size_t)options->threads, &stats);
+    
+    if (!options->quiet_mode) {
+        display_generation_stats(&stats);
+    }
     
     if (generated != (size_t)options->count) {
         printf("%s❌ Generated only %zu/%d passwords%s\n", 
                COLOR_BRIGHT_RED, generated, options->count, COLOR_RESET);
         
-        /* Free what we did generate */
-        free_bulk_passwords(results, generated);
-        free(results);
+        password_batch_free(&batch);
         return;
     }
     
-    printf("%s✅ Done!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+    record_history_batch(&batch);
     
-    /* Display results */
     if (!options->quiet_mode) {
-        display_bulk_results(results, generated, &ui_config);
-    } else {
-        /* Quiet mode: just print passwords */
-        for (size_t i = 0; i < generated; i++) {
-            printf("%s\n", results[i].password);
-        }
+        printf("%s✅ Done!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+    }
+    
+    /* Display results; quiet mode writes just the passwords through one buffered writer */
+    if (!options->quiet_mode) {
+        display_batch_results(&batch, &ui_config);
+    } else if (!save_password_batch(&batch, "-", EXPORT_FORMAT_PLAIN, false)) {
+        print_error("Failed to write passwords");
     }
     
     /* Save to file if requested */
     if (options->output_file) {
-        printf("%sSaving to file...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
-        fflush(stdout);
-        
-        bool saved = false;
-        const char *format = "text"; /* Default format */
-        
-        /* Check for format in filename extension */
-        if (strstr(options->output_file, ".csv")) {
-            saved = save_passwords_to_csv(results, generated, options->output_file);
-        } else if (strstr(options->output_file, ".json")) {
-            saved = save_passwords_to_json(results, generated, options->output_file);
-        } else {
-            saved = save_bulk_passwords_to_file(results, generated, 
-                                               options->output_file, !options->quiet_mode);
+        if (!options->quiet_mode) {
+            printf("%sSaving to file...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+            fflush(stdout);
         }
         
-        if (saved) {
+        bool saved = save_password_batch(&batch, options->output_file, format, 
+                                         !options->quiet_mode);
+        
+        if (options->quiet_mode) {
+            if (!saved) {
+                print_error("Failed to save file");
+            }
+        } else if (saved) {
             printf("%s✅ Saved %zu passwords to: %s%s\n", 
                    COLOR_BRIGHT_GREEN, generated, options->output_file, COLOR_RESET);
         } else {
@@ -481,30 +824,396 @@ void handle_bulk_passwords(const CommandLineOptions *options) {
     }
     
     /* Cleanup */
-    free_bulk_passwords(results, generated);
-    free(results);
+    password_batch_free(&batch);
+}
+
+/**
+ * @brief Handle streaming password generation
+ *
+ * Passwords are generated STREAM_CHUNK_SIZE at a time into one reusable
+ * batch, written through an export writer and wiped before the next chunk, so memory use does not
+ * grow with the count. Status goes to stderr so stdout can be piped.
+ */
+void handle_stream_passwords(const CommandLineOptions *options) {
+    if (!options || options->count <= 0) {
+        return;
+    }
+    
+    /* Without a file, stream plain passwords to stdout */
+    ExportFormat format = options->format_given ? options->output_format :
+                          (options->output_file ?
+                           export_format_from_filename(options->output_file, EXPORT_FORMAT_TEXT) :
+                           EXPORT_FORMAT_PLAIN);
+    
+    size_t total = (size_t)options->count;
+    size_t chunk_size = total < STREAM_CHUNK_SIZE ? total : STREAM_CHUNK_SIZE;
+    
+    PasswordOptions pass_opts = options->pass_opts;
+    pass_opts.metadata = metadata_for_output(options, false, format);
+    
+    /* One locked chunk, refilled in place */
+    PasswordBatch chunk;
+    if (!password_batch_init(&chunk, chunk_size, options->pass_opts.length)) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return;
+    }
+    
+    ExportWriter writer;
+    if (!export_writer_begin(&writer, options->output_file, format, 
+                             !options->quiet_mode, total)) {
+        password_batch_free(&chunk);
+        return;
+    }
+    
+    size_t written = 0;
+    bool ok = true;
+    GenerationStats stats = {0};
+    
+    while (ok && written < total) {
+        size_t want = total - written < chunk_size ? total - written : chunk_size;
+        size_t generated = password_batch_generate(&chunk, &pass_opts, want,
+                                                   (size_t)options->threads, &stats);
+        
+        /* Later chunks are checked against this one */
+        record_history_batch(&chunk);
+        ok = export_writer_write_batch(&writer, &chunk, 0, generated);
+        
+        password_batch_clear(&chunk);
+        written += generated;
+        
+        if (generated != want) {
+            ok = false;
+        }
+    }
+    
+    if (!export_writer_end(&writer)) {
+        ok = false;
+    }
+    
+    password_batch_free(&chunk);
+    
+    if (!options->quiet_mode) {
+        display_generation_stats(&stats);
+    }
+    
+    if (!ok) {
+        fprintf(stderr, "%s❌ Stream stopped after %zu/%zu passwords%s\n", 
+                COLOR_BRIGHT_RED, written, total, COLOR_RESET);
+    } else if (!options->quiet_mode && options->output_file) {
+        fprintf(stderr, "%s✅ Streamed %zu passwords to: %s%s\n", 
+                COLOR_BRIGHT_GREEN, written, options->output_file, COLOR_RESET);
+    }
+}
+
+/**
+ * @brief Handle passphrase generation
+ *
+ * Words are drawn from a wordlist index built with --build-wordlist;
+ * results are displayed, copied and saved like passwords.
+ */
+void handle_passphrase(const CommandLineOptions *options) {
+    if (!options || options->passphrase_words <= 0 || options->count <= 0) {
+        return;
+    }
+    
+    if (!options->wordlist_index) {
+        print_error("--passphrase needs --wordlist FILE (compile one with --build-wordlist)");
+        return;
+    }
+    
+    Wordlist list;
+    if (!wordlist_open(&list, options->wordlist_index)) {
+        fprintf(stderr, "Failed to open wordlist index: %s\n", options->wordlist_index);
+        return;
+    }
+    
+    PassphraseOptions phrase = passphrase_options_init();
+    phrase.words = (size_t)options->passphrase_words;
+    phrase.capitalize = options->capitalize_words;
+    const char *error = NULL;
+    if (options->passphrase_separator &&
+        !passphrase_set_separator(&phrase, options->passphrase_separator)) {
+        error = "Separator must not be empty";
+    }
+    if (!error) {
+        error = passphrase_check_options(&list, &phrase);
+    }
+    if (error) {
+        fprintf(stderr, "%s❌ %s; choose another --separator%s\n", COLOR_BRIGHT_RED, error,
+                COLOR_RESET);
+        wordlist_close(&list);
+        return;
+    }
+    
+    ExportWriter writer;
+    bool exporting = options->output_file != NULL;
+    if (exporting) {
+        ExportFormat format = options->format_given ? options->output_format :
+                              export_format_from_filename(options->output_file, EXPORT_FORMAT_TEXT);
+        if (!export_writer_begin(&writer, options->output_file, format, 
+                                 !options->quiet_mode, (size_t)options->count)) {
+            wordlist_close(&list);
+            return;
+        }
+    }
+    
+    if (!options->quiet_mode && options->count > 1) {
+        printf("%s🔑 %d passphrases (%.1f bits each from %u words):%s\n", COLOR_BRIGHT_YELLOW,
+               options->count, passphrase_entropy(&list, phrase.words), list.count, COLOR_RESET);
+    }
+    
+    RandomSampler sampler;
+    random_sampler_init(&sampler);
+    
+    GenerationStats stats = {0};
+    bool ok = true;
+    int generated = 0;
+    
+    for (int i = 0; ok && i < options->count; i++) {
+        PasswordResult result = generate_passphrase_fresh(&list, &phrase, &sampler,
+                                                          &options->pass_opts, &stats);
+        
+        if (!result.password) {
+            fprintf(stderr, "%s❌ Failed to generate passphrase: %s%s\n", COLOR_BRIGHT_RED,
+                    result.strength ? result.strength : "unknown error", COLOR_RESET);
+            ok = false;
+            break;
+        }
+        
+        record_history(result.password, result.length);
+        
+        if (options->quiet_mode) {
+            printf("%s\n", result.password);
+        } else if (options->count == 1) {
+            display_password_result(&result, &ui_config);
+        } else {
+            printf("  %s%3d.%s %s\n", COLOR_CYAN, i + 1, COLOR_RESET, result.password);
+        }
+        
+        if (exporting && !export_writer_write(&writer, &result)) {
+            ok = false;
+        }
+        
+        /* Only a single passphrase is copied */
+        if (options->count == 1 && options->copy_to_clipboard) {
+            ClipboardResult clip_result = copy_with_autoclear(result.password, options->clear_after);
+            
+            if (clip_result != CLIPBOARD_SUCCESS) {
+                print_error(get_clipboard_result_string(clip_result));
+            } else if (!options->quiet_mode) {
+                printf("%s✅ Copied!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+            }
+        }
+        
+        free_password_result(&result);
+        if (ok) {
+            generated++;
+        }
+    }
+    
+    random_sampler_wipe(&sampler);
+    
+    if (!options->quiet_mode && stats.candidates != stats.generated) {
+        display_generation_stats(&stats);
+    }
+    
+    if (exporting) {
+        if (!export_writer_end(&writer)) {
+            ok = false;
+        }
+        
+        if (!ok) {
+            print_error("Failed to save file");
+        } else if (!options->quiet_mode) {
+            printf("%s✅ Saved %d passphrases to: %s%s\n", 
+                   COLOR_BRIGHT_GREEN, generated, options->output_file, COLOR_RESET);
+        }
+    }
+    
+    wordlist_close(&list);
+}
+
+/**
+ * @brief Handle auditing of an existing password file
+ *
+ * Per-entry results go to the output file (stdout by default) and the
+ * histograms to stderr.
+ */
+bool handle_audit_file(const CommandLineOptions *options) {
+    if (!options || !options->audit_file) {
+        return false;
+    }
+    
+    ExportFormat format = options->format_given ? options->output_format :
+                          export_format_from_filename(options->output_file, EXPORT_FORMAT_TEXT);
+    if (format == EXPORT_FORMAT_SPG) {
+        /* An audit report is not an archive */
+        format = EXPORT_FORMAT_TEXT;
+    }
+    
+    AuditOptions audit_options = audit_options_init();
+    audit_options.threads = (size_t)options->threads;
+    
+    AuditSummary summary;
+    bool ok = audit_password_file(options->audit_file, options->output_file, format,
+                                  &audit_options, &summary);
+    
+    if (!options->quiet_mode) {
+        display_audit_summary(&summary);
+    }
+    
+    if (!ok) {
+        fprintf(stderr, "%s❌ Audit of %s stopped after %llu passwords%s\n", COLOR_BRIGHT_RED,
+                options->audit_file, (unsigned long long)summary.total, COLOR_RESET);
+    }
+    
+    return ok;
+}
+
+/**
+ * @brief Handle --serve
+ *
+ * The command line's generation options become the defaults for requests
+ * that do not override them.
+ */
+bool handle_serve(const CommandLineOptions *options) {
+    if (!options || !options->serve_socket) {
+        return false;
+    }
+    
+#ifdef _WIN32
+    fprintf(stderr, "%s❌ --serve needs Unix domain sockets and is not available on Windows%s\n",
+            COLOR_BRIGHT_RED, COLOR_RESET);
+    return false;
+#else
+    ServerOptions server_options = server_options_init(options->serve_socket);
+    server_options.defaults = options->pass_opts;
+    server_options.verbose = !options->quiet_mode;
+    
+    if (!validate_options(&server_options.defaults)) {
+        fprintf(stderr, "%s❌ Invalid default password options for --serve%s\n",
+                COLOR_BRIGHT_RED, COLOR_RESET);
+        return false;
+    }
+    
+    return run_server(&server_options);
+#endif
+}
+
+/**
+ * @brief Generate a batch of passwords from a compiled template
+ */
+static void handle_pattern_batch(const char *pattern, const CompiledPattern *compiled,
+                                 const CommandLineOptions *options) {
+    if (!options->quiet_mode) {
+        printf("%sGenerating %d passwords from pattern \"%s\"...%s ", 
+               COLOR_BRIGHT_YELLOW, options->count, pattern, COLOR_RESET);
+        fflush(stdout);
+    }
+    
+    PasswordBatch batch;
+    if (!password_batch_init(&batch, (size_t)options->count, compiled->length)) {
+        print_error("Memory allocation failed!");
+        return;
+    }
+    
+    GenerationStats stats = {0};
+    size_t generated = pattern_batch_generate(&batch, compiled, (size_t)options->count,
+                                              (size_t)options->threads, &options->pass_opts,
+                                              &stats);
+    
+    if (!options->quiet_mode && stats.candidates != stats.generated) {
+        display_generation_stats(&stats);
+    }
+    
+    if (generated != (size_t)options->count) {
+        printf("%s❌ Generated only %zu/%d passwords%s\n", 
+               COLOR_BRIGHT_RED, generated, options->count, COLOR_RESET);
+        
+        password_batch_free(&batch);
+        return;
+    }
+    
+    record_history_batch(&batch);
+    
+    if (!options->quiet_mode) {
+        printf("%s✅ Done!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+        display_batch_results(&batch, &ui_config);
+    } else if (!save_password_batch(&batch, "-", EXPORT_FORMAT_PLAIN, false)) {
+        print_error("Failed to write passwords");
+    }
+    
+    /* Save to file if requested */
+    if (options->output_file) {
+        ExportFormat format = options->format_given ? options->output_format :
+                              export_format_from_filename(options->output_file, EXPORT_FORMAT_TEXT);
+        bool saved = save_password_batch(&batch, options->output_file, format, 
+                                         !options->quiet_mode);
+        
+        if (!saved) {
+            print_error("Failed to save file");
+        } else if (!options->quiet_mode) {
+            printf("%s✅ Saved %zu passwords to: %s%s\n", 
+                   COLOR_BRIGHT_GREEN, generated, options->output_file, COLOR_RESET);
+        }
+    }
+    
+    password_batch_free(&batch);
 }
 
 /**
  * @brief Handle pattern-based password generation
+ *
+ * The template is compiled once however many passwords are drawn from it.
  */
 void handle_pattern_password(const char *pattern, const CommandLineOptions *options) {
     if (!pattern || !options) {
         return;
     }
     
-    printf("%sGenerating password from pattern \"%s\"...%s ", 
-           COLOR_BRIGHT_YELLOW, pattern, COLOR_RESET);
-    fflush(stdout);
+    CompiledPattern compiled;
+    if (!compile_pattern(pattern, &compiled)) {
+        fprintf(stderr, "%s❌ Invalid pattern at position %zu: %s%s\n", COLOR_BRIGHT_RED,
+                compiled.error_offset + 1, compiled.error, COLOR_RESET);
+        return;
+    }
     
-    PasswordResult result = generate_password_from_pattern(pattern);
+    if (options->count > 1) {
+        handle_pattern_batch(pattern, &compiled, options);
+        return;
+    }
     
-    if (!result.password) {
-        print_error("Failed to generate password from pattern!");
+    if (!options->quiet_mode) {
+        printf("%sGenerating password from pattern \"%s\"...%s ", 
+               COLOR_BRIGHT_YELLOW, pattern, COLOR_RESET);
+        fflush(stdout);
+    }
+    
+    char *buffer = (char *)calloc(compiled.length + 1, sizeof(char));
+    if (!buffer) {
+        print_error("Memory allocation failed!");
+        return;
+    }
+    
+    RandomSampler sampler;
+    random_sampler_init(&sampler);
+    PasswordResult result;
+    bool drawn = generate_pattern_fresh(&compiled, &sampler, &options->pass_opts, buffer,
+                                        &result, NULL);
+    random_sampler_wipe(&sampler);
+    
+    if (!drawn) {
+        fprintf(stderr, "%s❌ Failed to generate password from pattern: %s%s\n", COLOR_BRIGHT_RED,
+                result.strength ? result.strength : "unknown error", COLOR_RESET);
+        free(buffer);
         return;
     }
     
-    printf("%s✅ Done!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+    record_history(result.password, result.length);
+    
+    if (!options->quiet_mode) {
+        printf("%s✅ Done!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
+    }
     
     /* Display password */
     if (!options->quiet_mode) {
@@ -515,12 +1224,20 @@ void handle_pattern_password(const char *pattern, const CommandLineOptions *opti
     
     /* Copy to clipboard if requested */
     if (options->copy_to_clipboard) {
-        printf("%sCopying to clipboard...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
-        fflush(stdout);
+        if (!options->quiet_mode) {
+            printf("%sCopying to clipboard...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+            fflush(stdout);
+        }
         
-        ClipboardResult clip_result = copy_to_clipboard(result.password);
+        ClipboardResult clip_result = copy_with_autoclear(result.password, options->clear_after);
         
-        if (clip_result == CLIPBOARD_SUCCESS) {
+        if (options->quiet_mode) {
+            if (clip_result != CLIPBOARD_SUCCESS) {
+                print_error(get_clipboard_result_string(clip_result));
+            }
+        } else if (clip_result == CLIPBOARD_SUCCESS && options->clear_after > 0) {
+            printf("%s✅ Copied! (clears in %d s)%s\n", COLOR_BRIGHT_GREEN, options->clear_after, COLOR_RESET);
+        } else if (clip_result == CLIPBOARD_SUCCESS) {
             printf("%s✅ Copied!%s\n", COLOR_BRIGHT_GREEN, COLOR_RESET);
         } else {
             printf("%s❌ Failed: %s%s\n", 
@@ -530,13 +1247,19 @@ void handle_pattern_password(const char *pattern, const CommandLineOptions *opti
     
     /* Save to file if requested */
     if (options->output_file) {
-        printf("%sSaving to file...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
-        fflush(stdout);
+        if (!options->quiet_mode) {
+            printf("%sSaving to file...%s ", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+            fflush(stdout);
+        }
         
         bool saved = save_password_to_file(&result, options->output_file, 
                                           false, !options->quiet_mode);
         
-        if (saved) {
+        if (options->quiet_mode) {
+            if (!saved) {
+                print_error("Failed to save file");
+            }
+        } else if (saved) {
             printf("%s✅ Saved to: %s%s\n", 
                    COLOR_BRIGHT_GREEN, options->output_file, COLOR_RESET);
         } else {
@@ -579,18 +1302,6 @@ void run_interactive_mode(void) {
                     printf("%sGenerating password...%s\n", 
                            COLOR_BRIGHT_YELLOW, COLOR_RESET);
                     
-                    print_progress_bar(0, 40);
-                    fflush(stdout);
-                    
-                    for (int i = 0; i <= 100; i += 10) {
-                        sleep_ms(50);
-                        printf("\r");
-                        print_progress_bar(i, 40);
-                        fflush(stdout);
-                    }
-                    
-                    printf("\n");
-                    
                     PasswordResult result = generate_password(&current_options);
                     
                     if (result.password) {
@@ -643,37 +1354,20 @@ void run_interactive_mode(void) {
                     printf("%sGenerating %d passwords...%s\n", 
                            COLOR_BRIGHT_YELLOW, count, COLOR_RESET);
                     
-                    PasswordResult *results = (PasswordResult *)calloc(count, sizeof(PasswordResult));
-                    if (!results) {
+                    /* Same path as --count: one locked arena, compiled once, on all CPUs */
+                    PasswordBatch batch;
+                    if (!password_batch_init(&batch, (size_t)count, current_options.length)) {
                         print_error("Memory allocation failed!");
                         break;
                     }
                     
-                    print_progress_bar(0, 40);
-                    fflush(stdout);
+                    GenerationStats stats = {0};
+                    size_t generated = password_batch_generate(&batch, &current_options,
+                                                               (size_t)count, 0, &stats);
+                    display_generation_stats(&stats);
                     
-                    for (int i = 0; i < count; i++) {
-                        results[i] = generate_password(&current_options);
-                        
-                        int progress = (i + 1) * 100 / count;
-                        printf("\r");
-                        print_progress_bar(progress, 40);
-                        fflush(stdout);
-                    }
-                    
-                    printf("\n");
-                    
-                    /* Check if all were generated successfully */
-                    bool all_ok = true;
-                    for (int i = 0; i < count; i++) {
-                        if (!results[i].password) {
-                            all_ok = false;
-                            break;
-                        }
-                    }
-                    
-                    if (all_ok) {
-                        display_bulk_results(results, count, &ui_config);
+                    if (generated == (size_t)count) {
+                        display_batch_results(&batch, &ui_config);
                         
                         /* Ask to save to file */
                         if (prompt_yes_no("Save to file?", false)) {
@@ -684,8 +1378,8 @@ void run_interactive_mode(void) {
                             printf("%s", COLOR_RESET);
                             
                             if (strlen(filename) > 0) {
-                                bool saved = save_bulk_passwords_to_file(results, count, 
-                                                                        filename, true);
+                                bool saved = save_password_batch(&batch, filename,
+                                                                 EXPORT_FORMAT_TEXT, true);
                                 if (saved) {
                                     print_success("Passwords saved to file!");
                                 } else {
@@ -697,8 +1391,7 @@ void run_interactive_mode(void) {
                         print_error("Failed to generate some passwords!");
                     }
                     
-                    free_bulk_passwords(results, count);
-                    free(results);
+                    password_batch_free(&batch);
                 }
                 break;
                 
@@ -897,8 +1590,11 @@ void run_interactive_mode(void) {
                             
                             /* Ask about auto-clear */
                             if (prompt_yes_no("Enable auto-clear after 30 seconds?", true)) {
-                                printf("%sNote: Auto-clear requires running timer (not implemented in console)%s\n",
-                                       COLOR_BRIGHT_YELLOW, COLOR_RESET);
+                                if (clipboard_schedule_clear(result.password, DEFAULT_CLIPBOARD_TIMEOUT) == CLIPBOARD_SUCCESS) {
+                                    print_info("Clipboard will be cleared in 30 seconds.");
+                                } else {
+                                    print_warning("Could not start the auto-clear timer.");
+                                }
                             }
                         } else {
                             print_error(get_clipboard_result_string(clip_result));
@@ -929,6 +1625,16 @@ void run_interactive_mode(void) {
     }
 }
 
+/**
+ * @brief Print the --stats report on stderr, if requested
+ */
+static void report_stats(const CommandLineOptions *options) {
+    if (options->show_stats) {
+        fflush(stdout);
+        stats_report(stderr, options->stats_format);
+    }
+}
+
 /**
  * @brief Main program entry point
  */
@@ -947,6 +1653,9 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    /* Scripted runs emit no escape codes at all */
+    color_output = !options.quiet_mode && terminal_supports_color();
+    
     /* Handle help and version requests */
     if (options.show_help) {
         print_help();
@@ -958,8 +1667,114 @@ int main(int argc, char *argv[]) {
         return 0;
     }
     
-    /* Initialize clipboard */
-    if (!clipboard_init()) {
+    /* Timers start before any worker thread does */
+    if (options.show_stats && !stats_enable()) {
+        fprintf(stderr, "Statistics are not available in this build (PASSGEN_NO_STATS)\n");
+        options.show_stats = false;
+    }
+    
+    /* Create a key file and exit */
+    if (options.new_key_file) {
+        if (!encryption_generate_key_file(options.new_key_file)) {
+            fprintf(stderr, "Failed to create key file %s (it must not exist yet)\n",
+                    options.new_key_file);
+            return 1;
+        }
+        
+        if (!options.quiet_mode) {
+            printf("%s✅ New key written to: %s%s\n", COLOR_BRIGHT_GREEN,
+                   options.new_key_file, COLOR_RESET);
+        }
+        return 0;
+    }
+    
+    if (options.key_file && !encryption_load_key_file(options.key_file)) {
+        fprintf(stderr, "Failed to load key file %s (expected 32 bytes or 64 hex digits)\n",
+                options.key_file);
+        return 1;
+    }
+    
+    /* Merge a password history's log into its index and exit */
+    if (options.compact_history) {
+        const char *path = options.history_file ? options.history_file : HISTORY_FILENAME;
+        HistoryStore history;
+        bool compacted = history_open(&history, path) && history_compact(&history);
+        uint64_t entries = history_count(&history);
+        compacted = history_close(&history) && compacted;
+        
+        if (!compacted) {
+            fprintf(stderr, "Failed to compact password history %s\n", path);
+            return 1;
+        }
+        
+        if (!options.quiet_mode) {
+            printf("%s✅ Compacted %llu issued passwords into: %s%s\n", COLOR_BRIGHT_GREEN,
+                   (unsigned long long)entries, path, COLOR_RESET);
+        }
+        return 0;
+    }
+    
+    /* Compile a breach wordlist and exit */
+    if (options.breach_wordlist) {
+        const char *index_path = options.output_file ? options.output_file : "breach.idx";
+        uint64_t entries = 0;
+        
+        if (!breach_index_build(options.breach_wordlist, index_path, &entries)) {
+            fprintf(stderr, "Failed to build breach index from %s\n", options.breach_wordlist);
+            return 1;
+        }
+        
+        if (!options.quiet_mode) {
+            printf("%s✅ Indexed %llu distinct passwords into: %s%s\n", COLOR_BRIGHT_GREEN,
+                   (unsigned long long)entries, index_path, COLOR_RESET);
+        }
+        return 0;
+    }
+    
+    /* Compile a passphrase wordlist and exit */
+    if (options.wordlist_source) {
+        const char *index_path = options.output_file ? options.output_file : DEFAULT_WORDLIST_INDEX;
+        uint64_t words = 0;
+        
+        if (!wordlist_build(options.wordlist_source, index_path, &words)) {
+            fprintf(stderr, "Failed to build wordlist index from %s\n", options.wordlist_source);
+            return 1;
+        }
+        
+        if (!options.quiet_mode) {
+            printf("%s✅ Indexed %llu distinct words into: %s%s\n", COLOR_BRIGHT_GREEN,
+                   (unsigned long long)words, index_path, COLOR_RESET);
+        }
+        return 0;
+    }
+    
+    if (options.breach_index && !breach_set_active_index(options.breach_index)) {
+        fprintf(stderr, "Failed to open breach index: %s\n", options.breach_index);
+        return 1;
+    }
+    
+    /* Audit a password file and exit */
+    if (options.audit_file) {
+        bool audited = handle_audit_file(&options);
+        report_stats(&options);
+        breach_close_active();
+        encryption_clear_key();
+        cleanup_secure_random();
+        return audited ? 0 : 1;
+    }
+    
+    /* Serve generation requests until interrupted */
+    if (options.serve_socket) {
+        bool served = handle_serve(&options);
+        report_stats(&options);
+        breach_close_active();
+        encryption_clear_key();
+        cleanup_secure_random();
+        return served ? 0 : 1;
+    }
+    
+    /* Probe for a clipboard tool only when one will be used (interactive mode probes its own) */
+    if (options.copy_to_clipboard && options.mode != UI_MODE_INTERACTIVE && !clipboard_init()) {
         if (!options.quiet_mode) {
             print_warning("Clipboard may not work properly on this system.");
         }
@@ -971,26 +1786,38 @@ int main(int argc, char *argv[]) {
     } else {
         /* Command line mode */
         
-        /* Check if we have a pattern */
-        for (int i = 1; i < argc; i++) {
-            if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--pattern") == 0) {
-                if (i + 1 < argc) {
-                    handle_pattern_password(argv[i + 1], &options);
-                    return 0;
-                }
-            }
+        /* Uniqueness and history apply to every generation mode */
+        if (!prepare_uniqueness(&options) || !prepare_history(&options)) {
+            release_uniqueness();
+            breach_close_active();
+            encryption_clear_key();
+            clipboard_cleanup();
+            cleanup_secure_random();
+            return 1;
         }
         
-        /* Normal generation */
-        if (options.count == 1) {
+        if (options.pattern) {
+            handle_pattern_password(options.pattern, &options);
+        } else if (options.passphrase_words > 0) {
+            handle_passphrase(&options);
+        } else if (options.stream_output) {
+            handle_stream_passwords(&options);
+        } else if (options.count == 1) {
             handle_single_password(&options);
         } else {
             handle_bulk_passwords(&options);
         }
     }
     
-    /* Cleanup */
+    bool recorded = release_history(&options);
+    report_stats(&options);
+    
+    /* Cleanup; secrets go first, clipboard_cleanup() may fork a process that outlives us */
+    release_uniqueness();
+    breach_close_active();
+    encryption_clear_key();
     clipboard_cleanup();
+    cleanup_secure_random();
     
-    return 0;
+    return recorded ? 0 : 1;
 }
\ No newline at end of file
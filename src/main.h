@@ -10,6 +10,8 @@
 
 #include "password.h"
 #include "ui.h"
+#include "file_ops.h"
+#include "stats.h"
 
 /**
  * @brief Command line options structure
@@ -18,12 +20,35 @@ typedef struct {
     UIMode mode;                /**< UI mode to use */
     PasswordOptions pass_opts;  /**< Password generation options */
     int count;                  /**< Number of passwords to generate */
+    const char *pattern;        /**< Template for pattern mode (NULL = options) */
+    int threads;                /**< Worker threads for bulk generation (0 = auto) */
     const char *output_file;    /**< Output file path */
+    ExportFormat output_format; /**< Output format for saved passwords */
+    bool format_given;          /**< Output format set with --format */
+    bool stream_output;         /**< Generate and write in fixed-size chunks */
+    const char *key_file;       /**< Key for writing and reading encrypted files */
+    const char *new_key_file;   /**< Key file to create */
+    bool unique;                /**< Never repeat a password within the run */
+    const char *unique_against; /**< Password file new passwords must not repeat or resemble */
+    const char *history_file;   /**< History of issued passwords to check and extend */
+    bool compact_history;       /**< Merge the history log into its index and exit */
+    const char *breach_index;   /**< Breach index file to check against */
+    const char *breach_wordlist; /**< Wordlist to compile into a breach index */
+    int passphrase_words;       /**< Words per passphrase (0 = generate passwords) */
+    const char *wordlist_index; /**< Wordlist index for passphrases */
+    const char *wordlist_source; /**< Wordlist to compile into a wordlist index */
+    const char *passphrase_separator; /**< Text between passphrase words (NULL = default) */
+    bool capitalize_words;      /**< Capitalize passphrase words */
+    const char *audit_file;     /**< Password file to audit */
+    const char *serve_socket;   /**< Socket to serve requests on */
     bool copy_to_clipboard;     /**< Copy to clipboard */
+    int clear_after;            /**< Seconds before the copied password is cleared (0 = never) */
     bool show_help;             /**< Show help message */
     bool show_version;          /**< Show version info */
     bool show_entropy;          /**< Show entropy information */
     bool quiet_mode;            /**< Quiet output mode */
+    bool show_stats;            /**< Report stage timings on stderr when done */
+    StatsFormat stats_format;   /**< Format of the --stats report */
 } CommandLineOptions;
 
 /**
@@ -0,0 +1,292 @@
+/**
+ * @file parallel.c
+ * @brief Portable fork-join worker threads implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "parallel.h"
+#include "stats.h"
+#include <stdlib.h>
+
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+
+/**
+ * @brief Per-thread launch record
+ */
+typedef struct {
+    ParallelTask task;
+    void *context;
+    size_t index;
+    size_t count;
+} ParallelWorker;
+
+#ifdef _WIN32
+static DWORD WINAPI parallel_thread_main(LPVOID arg) {
+    ParallelWorker *worker = (ParallelWorker *)arg;
+    worker->task(worker->context, worker->index, worker->count);
+    stats_thread_exit();
+    return 0;
+}
+#else
+static void *parallel_thread_main(void *arg) {
+    ParallelWorker *worker = (ParallelWorker *)arg;
+    worker->task(worker->context, worker->index, worker->count);
+    stats_thread_exit();
+    return NULL;
+}
+#endif
+
+#ifdef _WIN32
+static DWORD WINAPI parallel_background_main(LPVOID arg) {
+    ParallelThread *thread = (ParallelThread *)arg;
+    thread->task(thread->context, 0, 1);
+    stats_thread_exit();
+    return 0;
+}
+#else
+static void *parallel_background_main(void *arg) {
+    ParallelThread *thread = (ParallelThread *)arg;
+    thread->task(thread->context, 0, 1);
+    stats_thread_exit();
+    return NULL;
+}
+#endif
+
+#ifdef _WIN32
+static BOOL CALLBACK parallel_once_main(PINIT_ONCE once, PVOID param, PVOID *context) {
+    (void)once;
+    (void)context;
+    void (*init)(void) = *(void (**)(void))param;
+    init();
+    return TRUE;
+}
+#endif
+
+/**
+ * @brief Run an initializer exactly once
+ */
+void parallel_once(ParallelOnce *once, void (*init)(void)) {
+    if (!once || !init) {
+        return;
+    }
+    
+#ifdef _WIN32
+    InitOnceExecuteOnce(once, parallel_once_main, (PVOID)&init, NULL);
+#else
+    pthread_once(once, init);
+#endif
+}
+
+/**
+ * @brief Start a background thread
+ */
+bool parallel_thread_start(ParallelThread *thread, ParallelTask task, void *context) {
+    if (!thread || !task) {
+        return false;
+    }
+    
+    thread->task = task;
+    thread->context = context;
+    
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, parallel_background_main, thread, 0, NULL);
+    return thread->handle != NULL;
+#else
+    return pthread_create(&thread->handle, NULL, parallel_background_main, thread) == 0;
+#endif
+}
+
+/**
+ * @brief Wait for a background thread to finish
+ */
+void parallel_thread_join(ParallelThread *thread) {
+    if (!thread) {
+        return;
+    }
+    
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    thread->handle = NULL;
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+}
+
+/**
+ * @brief Initialize a mutex
+ */
+void parallel_mutex_init(ParallelMutex *mutex) {
+#ifdef _WIN32
+    InitializeSRWLock(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+/**
+ * @brief Lock a mutex
+ */
+void parallel_mutex_lock(ParallelMutex *mutex) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+/**
+ * @brief Unlock a mutex
+ */
+void parallel_mutex_unlock(ParallelMutex *mutex) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+/**
+ * @brief Release a mutex's resources
+ */
+void parallel_mutex_destroy(ParallelMutex *mutex) {
+#ifdef _WIN32
+    (void)mutex;  /* SRW locks hold no resources */
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+/**
+ * @brief Initialize a condition variable
+ */
+void parallel_cond_init(ParallelCond *cond) {
+#ifdef _WIN32
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+/**
+ * @brief Unlock a mutex and wait for a signal
+ */
+void parallel_cond_wait(ParallelCond *cond, ParallelMutex *mutex) {
+#ifdef _WIN32
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+/**
+ * @brief Wake every waiting thread
+ */
+void parallel_cond_broadcast(ParallelCond *cond) {
+#ifdef _WIN32
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+/**
+ * @brief Release a condition variable's resources
+ */
+void parallel_cond_destroy(ParallelCond *cond) {
+#ifdef _WIN32
+    (void)cond;
+#else
+    pthread_cond_destroy(cond);
+#endif
+}
+
+/**
+ * @brief Get number of online processors
+ */
+size_t parallel_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+#endif
+}
+
+/**
+ * @brief Run a task on several threads and wait for all of them
+ */
+bool parallel_run(size_t threads, ParallelTask task, void *context) {
+    if (!task) {
+        return false;
+    }
+    
+    if (threads == 0) {
+        threads = parallel_cpu_count();
+    }
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    
+    if (threads == 1) {
+        task(context, 0, 1);
+        return true;
+    }
+    
+    ParallelWorker *workers = (ParallelWorker *)calloc(threads, sizeof(ParallelWorker));
+#ifdef _WIN32
+    HANDLE *handles = (HANDLE *)calloc(threads, sizeof(HANDLE));
+#else
+    pthread_t *handles = (pthread_t *)calloc(threads, sizeof(pthread_t));
+#endif
+    bool *started = (bool *)calloc(threads, sizeof(bool));
+    
+    if (!workers || !handles || !started) {
+        free(workers);
+        free(handles);
+        free(started);
+        return false;
+    }
+    
+    for (size_t i = 0; i < threads; i++) {
+        workers[i].task = task;
+        workers[i].context = context;
+        workers[i].index = i;
+        workers[i].count = threads;
+    }
+    
+    for (size_t i = 1; i < threads; i++) {
+#ifdef _WIN32
+        handles[i] = CreateThread(NULL, 0, parallel_thread_main, &workers[i], 0, NULL);
+        started[i] = handles[i] != NULL;
+#else
+        started[i] = pthread_create(&handles[i], NULL, parallel_thread_main, &workers[i]) == 0;
+#endif
+    }
+    
+    task(context, 0, threads);
+    
+    for (size_t i = 1; i < threads; i++) {
+        if (started[i]) {
+#ifdef _WIN32
+            WaitForSingleObject(handles[i], INFINITE);
+            CloseHandle(handles[i]);
+#else
+            pthread_join(handles[i], NULL);
+#endif
+        } else {
+            /* Thread could not be started: do its share here */
+            task(context, i, threads);
+        }
+    }
+    
+    free(workers);
+    free(handles);
+    free(started);
+    return true;
+}
\ No newline at end of file
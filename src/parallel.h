@@ -0,0 +1,145 @@
+/**
+ * @file parallel.h
+ * @brief Portable fork-join worker threads
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    typedef INIT_ONCE ParallelOnce;
+    typedef SRWLOCK ParallelMutex;
+    typedef CONDITION_VARIABLE ParallelCond;
+    #define PARALLEL_ONCE_INIT INIT_ONCE_STATIC_INIT
+#else
+    #include <pthread.h>
+    typedef pthread_once_t ParallelOnce;
+    typedef pthread_mutex_t ParallelMutex;
+    typedef pthread_cond_t ParallelCond;
+    #define PARALLEL_ONCE_INIT PTHREAD_ONCE_INIT
+#endif
+
+/**
+ * @brief Upper bound on worker threads started by parallel_run()
+ */
+#define PARALLEL_MAX_THREADS 256
+
+/**
+ * @brief Worker entry point
+ * @param context Caller-supplied context shared by all workers
+ * @param index Worker index (0 to count - 1)
+ * @param count Total number of workers
+ */
+typedef void (*ParallelTask)(void *context, size_t index, size_t count);
+
+/**
+ * @brief Background thread that runs alongside its creator
+ */
+typedef struct {
+#ifdef _WIN32
+    HANDLE handle;          /**< Thread handle */
+#else
+    pthread_t handle;       /**< Thread handle */
+#endif
+    ParallelTask task;      /**< Entry point (called with index 0 of 1) */
+    void *context;          /**< Context passed to the task */
+} ParallelThread;
+
+/**
+ * @brief Get number of online processors
+ * @return Processor count (at least 1)
+ */
+size_t parallel_cpu_count(void);
+
+/**
+ * @brief Run a task on several threads and wait for all of them
+ * @param threads Number of workers (0 = one per processor)
+ * @param task Worker entry point
+ * @param context Context passed to every worker
+ * @return true if every worker ran, false if threads could not be started
+ *
+ * Worker 0 runs on the calling thread. If a thread cannot be created,
+ * its share is run on the calling thread so the task still completes.
+ */
+bool parallel_run(size_t threads, ParallelTask task, void *context);
+
+/**
+ * @brief Run an initializer exactly once, even when called from many threads
+ * @param once Flag initialized with PARALLEL_ONCE_INIT
+ * @param init Initializer to run
+ */
+void parallel_once(ParallelOnce *once, void (*init)(void));
+
+/**
+ * @brief Start a background thread
+ * @param thread Thread record (must stay valid until parallel_thread_join())
+ * @param task Entry point
+ * @param context Context passed to the task
+ * @return true if the thread started, false otherwise
+ */
+bool parallel_thread_start(ParallelThread *thread, ParallelTask task, void *context);
+
+/**
+ * @brief Wait for a background thread to finish
+ * @param thread Thread started with parallel_thread_start()
+ */
+void parallel_thread_join(ParallelThread *thread);
+
+/**
+ * @brief Initialize a mutex
+ * @param mutex Mutex to initialize
+ */
+void parallel_mutex_init(ParallelMutex *mutex);
+
+/**
+ * @brief Lock a mutex
+ * @param mutex Initialized mutex
+ */
+void parallel_mutex_lock(ParallelMutex *mutex);
+
+/**
+ * @brief Unlock a mutex held by the calling thread
+ * @param mutex Locked mutex
+ */
+void parallel_mutex_unlock(ParallelMutex *mutex);
+
+/**
+ * @brief Release a mutex's resources
+ * @param mutex Unlocked mutex
+ */
+void parallel_mutex_destroy(ParallelMutex *mutex);
+
+/**
+ * @brief Initialize a condition variable
+ * @param cond Condition variable to initialize
+ */
+void parallel_cond_init(ParallelCond *cond);
+
+/**
+ * @brief Atomically unlock a mutex and wait for a signal
+ * @param cond Condition variable
+ * @param mutex Mutex held by the calling thread (held again on return)
+ *
+ * Wakeups may be spurious; callers recheck their condition in a loop.
+ */
+void parallel_cond_wait(ParallelCond *cond, ParallelMutex *mutex);
+
+/**
+ * @brief Wake every thread waiting on a condition variable
+ * @param cond Condition variable
+ */
+void parallel_cond_broadcast(ParallelCond *cond);
+
+/**
+ * @brief Release a condition variable's resources
+ * @param cond Condition variable with no waiters
+ */
+void parallel_cond_destroy(ParallelCond *cond);
+
+#endif /* PARALLEL_H */
\ No newline at end of file
@@ -0,0 +1,625 @@
+/**
+ * @file passphrase.c
+ * @brief Diceware-style passphrases from a memory-mapped wordlist index implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "passphrase.h"
+#include "config.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+/**
+ * @brief Get default passphrase options
+ */
+PassphraseOptions passphrase_options_init(void) {
+    PassphraseOptions options;
+    
+    memset(&options, 0, sizeof(options));
+    options.words = PASSPHRASE_DEFAULT_WORDS;
+    passphrase_set_separator(&options, PASSPHRASE_DEFAULT_SEPARATOR);
+    options.capitalize = false;
+    
+    return options;
+}
+
+/**
+ * @brief Set the separator of passphrase options
+ */
+bool passphrase_set_separator(PassphraseOptions *options, const char *separator) {
+    if (!options || !separator || separator[0] == '\0' ||
+        strlen(separator) >= sizeof(options->separator)) {
+        return false;
+    }
+    
+    strcpy(options->separator, separator);
+    return true;
+}
+
+/**
+ * @brief One word of the builder's text buffer
+ */
+typedef struct {
+    const char *text;
+    uint32_t length;
+} WordEntry;
+
+/**
+ * @brief Order words as capitalized, so words --capitalize would merge compare equal
+ */
+static int compare_word_keys(const WordEntry *x, const WordEntry *y) {
+    int order = toupper((unsigned char)x->text[0]) - toupper((unsigned char)y->text[0]);
+    if (order != 0) {
+        return order;
+    }
+    
+    size_t common = x->length < y->length ? x->length : y->length;
+    order = memcmp(x->text + 1, y->text + 1, common - 1);
+    if (order != 0) {
+        return order;
+    }
+    return (x->length > y->length) - (x->length < y->length);
+}
+
+/**
+ * @brief Sort order of the builder: by capitalized form, lower-case spelling first
+ */
+static int compare_words(const void *a, const void *b) {
+    const WordEntry *x = (const WordEntry *)a;
+    const WordEntry *y = (const WordEntry *)b;
+    
+    int order = compare_word_keys(x, y);
+    if (order != 0) {
+        return order;
+    }
+    return (unsigned char)y->text[0] - (unsigned char)x->text[0];
+}
+
+/**
+ * @brief Mark a byte in a word_bytes bitmap
+ */
+static void mark_byte(unsigned char bitmap[32], unsigned char c) {
+    bitmap[c >> 3] |= (unsigned char)(1u << (c & 7));
+}
+
+/**
+ * @brief Check a byte in a word_bytes bitmap
+ */
+static bool byte_marked(const unsigned char bitmap[32], unsigned char c) {
+    return (bitmap[c >> 3] >> (c & 7)) & 1;
+}
+
+/**
+ * @brief Extract the word of one list line
+ * @return Word length, or 0 if the line holds no usable word
+ */
+static size_t parse_word_line(char *line, size_t length, const char **word) {
+    size_t start = 0;
+    
+    /* Diceware numbering: "11111<TAB>abacus" */
+    while (start < length && isdigit((unsigned char)line[start])) {
+        start++;
+    }
+    if (start == 0 || start == length || !isspace((unsigned char)line[start])) {
+        start = 0;
+    }
+    
+    while (start < length && isspace((unsigned char)line[start])) {
+        start++;
+    }
+    while (length > start && isspace((unsigned char)line[length - 1])) {
+        length--;
+    }
+    
+    if (start == length || line[start] == '#' || length - start > WORDLIST_MAX_WORD_LENGTH) {
+        return 0;
+    }
+    
+    for (size_t i = start; i < length; i++) {
+        unsigned char c = (unsigned char)line[i];
+        if (c < 0x20 || c == 0x7F || isspace(c)) {
+            return 0;
+        }
+    }
+    
+    *word = line + start;
+    return length - start;
+}
+
+/**
+ * @brief Compile a wordlist into an index file
+ */
+bool wordlist_build(const char *list_path, const char *index_path, uint64_t *count) {
+    if (!list_path || !index_path) {
+        return false;
+    }
+    
+    FILE *input = fopen(list_path, "rb");
+    if (!input) {
+        fprintf(stderr, "Error opening file %s: %s\n", list_path, strerror(errno));
+        return false;
+    }
+    
+    /* Words are appended to one buffer; entries are fixed up once it stops moving */
+    size_t text_capacity = 1 << 20;
+    size_t text_used = 0;
+    char *text = (char *)malloc(text_capacity);
+    size_t word_capacity = 1 << 16;
+    size_t words = 0;
+    WordEntry *entries = (WordEntry *)malloc(word_capacity * sizeof(WordEntry));
+    size_t *starts = (size_t *)malloc(word_capacity * sizeof(size_t));
+    bool ok = text && entries && starts;
+    char line[1024];
+    bool skipping = false;
+    bool too_large = false;
+    
+    while (ok && fgets(line, sizeof(line), input)) {
+        size_t length = strlen(line);
+        bool has_newline = length > 0 && line[length - 1] == '\n';
+        
+        /* Lines longer than the buffer are skipped, not split */
+        if (skipping) {
+            skipping = !has_newline;
+            continue;
+        }
+        if (!has_newline && length == sizeof(line) - 1) {
+            skipping = true;
+            continue;
+        }
+        
+        const char *word = NULL;
+        size_t word_length = parse_word_line(line, length, &word);
+        if (word_length == 0) {
+            continue;
+        }
+        
+        if (text_used + word_length > text_capacity) {
+            char *grown = (char *)realloc(text, 2 * text_capacity);
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            text = grown;
+            text_capacity *= 2;
+        }
+        if (words == word_capacity) {
+            WordEntry *grown_entries = (WordEntry *)realloc(entries, 2 * word_capacity * sizeof(WordEntry));
+            if (grown_entries) {
+                entries = grown_entries;
+            }
+            size_t *grown_starts = grown_entries ?
+                                   (size_t *)realloc(starts, 2 * word_capacity * sizeof(size_t)) : NULL;
+            if (!grown_starts) {
+                ok = false;
+                break;
+            }
+            starts = grown_starts;
+            word_capacity *= 2;
+        }
+        
+        memcpy(text + text_used, word, word_length);
+        starts[words] = text_used;
+        entries[words].length = (uint32_t)word_length;
+        words++;
+        text_used += word_length;
+        
+        if (text_used > UINT32_MAX || words >= UINT32_MAX) {
+            too_large = true;
+            ok = false;
+        }
+    }
+    
+    fclose(input);
+    
+    if (!ok) {
+        free(text);
+        free(entries);
+        free(starts);
+        if (too_large) {
+            fprintf(stderr, "Wordlist too large: %s\n", list_path);
+        } else {
+            fprintf(stderr, "Out of memory building wordlist index\n");
+        }
+        return false;
+    }
+    
+    for (size_t i = 0; i < words; i++) {
+        entries[i].text = text + starts[i];
+    }
+    free(starts);
+    
+    /* Sort and drop duplicates so every word is a distinct outcome, capitalized or not */
+    qsort(entries, words, sizeof(WordEntry), compare_words);
+    
+    size_t distinct = 0;
+    for (size_t i = 0; i < words; i++) {
+        if (distinct == 0 || compare_word_keys(&entries[distinct - 1], &entries[i]) != 0) {
+            entries[distinct++] = entries[i];
+        }
+    }
+    
+    if (distinct < WORDLIST_MIN_WORDS) {
+        fprintf(stderr, "Wordlist %s has fewer than %d distinct words\n", list_path, WORDLIST_MIN_WORDS);
+        free(text);
+        free(entries);
+        return false;
+    }
+    
+    WordlistHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORDLIST_INDEX_MAGIC, sizeof(header.magic));
+    header.byte_order = WORDLIST_INDEX_BYTE_ORDER;
+    header.count = distinct;
+    
+    uint32_t *offsets = (uint32_t *)malloc((distinct + 1) * sizeof(uint32_t));
+    if (!offsets) {
+        free(text);
+        free(entries);
+        return false;
+    }
+    
+    uint32_t offset = 0;
+    for (size_t i = 0; i < distinct; i++) {
+        offsets[i] = offset;
+        offset += entries[i].length;
+        if (entries[i].length > header.max_word_length) {
+            header.max_word_length = entries[i].length;
+        }
+        
+        mark_byte(header.word_bytes, (unsigned char)toupper((unsigned char)entries[i].text[0]));
+        for (uint32_t j = 0; j < entries[i].length; j++) {
+            mark_byte(header.word_bytes, (unsigned char)entries[i].text[j]);
+        }
+    }
+    offsets[distinct] = offset;
+    header.text_size = offset;
+    
+    FILE *output = fopen(index_path, "wb");
+    ok = output != NULL;
+    
+    if (!output) {
+        fprintf(stderr, "Error opening file %s: %s\n", index_path, strerror(errno));
+    } else {
+        ok = fwrite(&header, sizeof(header), 1, output) == 1 &&
+             fwrite(offsets, sizeof(uint32_t), distinct + 1, output) == distinct + 1;
+        for (size_t i = 0; ok && i < distinct; i++) {
+            ok = fwrite(entries[i].text, 1, entries[i].length, output) == entries[i].length;
+        }
+        ok = (fclose(output) == 0) && ok;
+    }
+    
+    free(offsets);
+    free(entries);
+    free(text);
+    
+    if (ok && count) {
+        *count = distinct;
+    }
+    return ok;
+}
+
+/**
+ * @brief Map a wordlist index read-only
+ */
+bool wordlist_open(Wordlist *list, const char *path) {
+    if (!list || !path) {
+        return false;
+    }
+    
+    memset(list, 0, sizeof(Wordlist));
+    
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Error opening file %s\n", path);
+        return false;
+    }
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(WordlistHeader)) {
+        CloseHandle(file);
+        fprintf(stderr, "Invalid wordlist index: %s\n", path);
+        return false;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *map = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!map) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    
+    list->file_handle = file;
+    list->mapping_handle = mapping;
+    list->map_size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error opening file %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(WordlistHeader)) {
+        close(fd);
+        fprintf(stderr, "Invalid wordlist index: %s\n", path);
+        return false;
+    }
+    
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    
+    list->map_size = (size_t)st.st_size;
+#endif
+    
+    list->map = (const unsigned char *)map;
+    
+    /* Validate header and layout; per-word offsets are checked when drawn */
+    const WordlistHeader *header = (const WordlistHeader *)list->map;
+    bool valid = memcmp(header->magic, WORDLIST_INDEX_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->byte_order == WORDLIST_INDEX_BYTE_ORDER &&
+                 header->count >= WORDLIST_MIN_WORDS && header->count < UINT32_MAX &&
+                 header->text_size <= UINT32_MAX &&
+                 header->max_word_length <= WORDLIST_MAX_WORD_LENGTH;
+                 
+    if (valid) {
+        uint64_t expected = sizeof(WordlistHeader) + (header->count + 1) * sizeof(uint32_t) +
+                            header->text_size;
+        valid = expected == list->map_size;
+        
+        if (valid) {
+            list->offsets = (const uint32_t *)(list->map + sizeof(WordlistHeader));
+            list->text = (const char *)(list->offsets + header->count + 1);
+            list->count = (uint32_t)header->count;
+            list->text_size = (uint32_t)header->text_size;
+            list->max_word_length = header->max_word_length;
+            memcpy(list->word_bytes, header->word_bytes, sizeof(list->word_bytes));
+            valid = list->offsets[0] == 0 && list->offsets[list->count] == list->text_size;
+        }
+    }
+    
+    if (!valid) {
+        fprintf(stderr, "Invalid wordlist index: %s\n", path);
+        wordlist_close(list);
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Get one word of a wordlist
+ */
+const char *wordlist_word(const Wordlist *list, uint32_t index, size_t *length) {
+    if (!list || !list->map || index >= list->count || !length) {
+        return NULL;
+    }
+    
+    uint32_t start = list->offsets[index];
+    uint32_t end = list->offsets[index + 1];
+    if (start > end || end > list->text_size || end - start > list->max_word_length ||
+        start == end) {
+        return NULL;
+    }
+    
+    *length = end - start;
+    return list->text + start;
+}
+
+/**
+ * @brief Unmap a wordlist
+ */
+void wordlist_close(Wordlist *list) {
+    if (!list || !list->map) {
+        return;
+    }
+    
+#ifdef _WIN32
+    UnmapViewOfFile((LPCVOID)list->map);
+    CloseHandle((HANDLE)list->mapping_handle);
+    CloseHandle((HANDLE)list->file_handle);
+#else
+    munmap((void *)list->map, list->map_size);
+#endif
+    
+    memset(list, 0, sizeof(Wordlist));
+}
+
+/**
+ * @brief Check passphrase options against a wordlist
+ */
+const char *passphrase_check_options(const Wordlist *list, const PassphraseOptions *options) {
+    if (!list || !list->map || !options || options->words == 0 ||
+        options->words > PASSPHRASE_MAX_WORDS) {
+        return "Invalid options";
+    }
+    if (options->separator[0] == '\0') {
+        return "Separator must not be empty";
+    }
+    
+    for (const char *c = options->separator; *c; c++) {
+        if (byte_marked(list->word_bytes, (unsigned char)*c)) {
+            return "Separator contains a character that occurs in wordlist words";
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get the entropy of a passphrase
+ */
+double passphrase_entropy(const Wordlist *list, size_t words) {
+    if (!list || list->count < WORDLIST_MIN_WORDS) {
+        return 0.0;
+    }
+    
+    /* Words stay distinct when capitalized and separators are fixed, so only the draws count */
+    return (double)words * log2((double)list->count);
+}
+
+/**
+ * @brief Get the buffer size generate_passphrase_into() needs
+ */
+size_t passphrase_buffer_size(const Wordlist *list, const PassphraseOptions *options) {
+    if (!list || !list->map || !options || options->words == 0 ||
+        options->words > PASSPHRASE_MAX_WORDS) {
+        return 0;
+    }
+    
+    size_t separator = strlen(options->separator);
+    return options->words * list->max_word_length + (options->words - 1) * separator + 1;
+}
+
+/**
+ * @brief Generate a passphrase into a caller-supplied buffer
+ */
+bool generate_passphrase_into(const Wordlist *list, const PassphraseOptions *options,
+                              RandomSampler *sampler, char *buffer, size_t buffer_size,
+                              PasswordResult *result) {
+    if (!result) {
+        return false;
+    }
+    
+    memset(result, 0, sizeof(PasswordResult));
+    
+    const char *error = passphrase_check_options(list, options);
+    if (error) {
+        result->strength = error;
+        return false;
+    }
+    
+    size_t needed = passphrase_buffer_size(list, options);
+    if (!sampler || !buffer || needed == 0 || buffer_size < needed) {
+        result->strength = "Invalid options";
+        return false;
+    }
+    
+    size_t separator = strlen(options->separator);
+    size_t used = 0;
+    
+    for (size_t i = 0; i < options->words; i++) {
+        uint32_t index;
+        if (!random_sampler_uniform(sampler, list->count, &index)) {
+            secure_clear(buffer, used);
+            result->strength = "Random generator failure";
+            return false;
+        }
+        
+        size_t length = 0;
+        const char *word = wordlist_word(list, index, &length);
+        if (!word) {
+            secure_clear(buffer, used);
+            result->strength = "Corrupt wordlist";
+            return false;
+        }
+        
+        if (i > 0) {
+            memcpy(buffer + used, options->separator, separator);
+            used += separator;
+        }
+        
+        memcpy(buffer + used, word, length);
+        if (options->capitalize) {
+            buffer[used] = (char)toupper((unsigned char)buffer[used]);
+        }
+        used += length;
+    }
+    buffer[used] = '\0';
+    
+    result->password = buffer;
+    result->length = used;
+    result->entropy = passphrase_entropy(list, options->words);
+    result->strength_score = (int)((result->entropy / 128.0) * 100);
+    if (result->strength_score > 100) result->strength_score = 100;
+    if (result->strength_score < 0) result->strength_score = 0;
+    result->strength = get_strength_category(result->strength_score);
+    
+    return true;
+}
+
+/**
+ * @brief Generate a passphrase
+ */
+PasswordResult generate_passphrase(const Wordlist *list, const PassphraseOptions *options,
+                                   RandomSampler *sampler) {
+    PasswordResult result = {0};
+    
+    size_t size = passphrase_buffer_size(list, options);
+    if (size == 0) {
+        result.strength = "Invalid options";
+        return result;
+    }
+    
+    char *buffer = (char *)calloc(size, 1);
+    if (!buffer) {
+        result.strength = "Memory error";
+        return result;
+    }
+    
+    RandomSampler local;
+    if (!sampler) {
+        random_sampler_init(&local);
+        sampler = &local;
+    }
+    
+    if (!generate_passphrase_into(list, options, sampler, buffer, size, &result)) {
+        free(buffer);
+    }
+    
+    if (sampler == &local) {
+        random_sampler_wipe(&local);
+    }
+    return result;
+}
+
+/**
+ * @brief Generate a passphrase that passes a run's uniqueness checks
+ */
+PasswordResult generate_passphrase_fresh(const Wordlist *list, const PassphraseOptions *options,
+                                         RandomSampler *sampler, const PasswordOptions *policy,
+                                         GenerationStats *stats) {
+    GenerationStats local = {0};
+    if (!stats) {
+        stats = &local;
+    }
+    
+    size_t budget = policy->max_attempts > 0 ? policy->max_attempts : DEFAULT_MAX_ATTEMPTS;
+    for (size_t attempt = 0; attempt < budget; attempt++) {
+        stats->candidates++;
+        PasswordResult result = generate_passphrase(list, options, sampler);
+        if (!result.password) {
+            return result;
+        }
+        
+        if (password_is_fresh(policy, result.password, result.length, stats)) {
+            stats->generated++;
+            return result;
+        }
+        free_password_result(&result);
+    }
+    
+    stats->failures++;
+    PasswordResult rejected = {0};
+    rejected.strength = "Policy rejected every candidate";
+    return rejected;
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+/**
+ * @file passphrase.h
+ * @brief Diceware-style passphrases from a memory-mapped wordlist index
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef PASSPHRASE_H
+#define PASSPHRASE_H
+
+#include "password.h"
+#include "sampler.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define WORDLIST_INDEX_MAGIC "SPGWORD2"
+#define WORDLIST_INDEX_BYTE_ORDER 0x01020304u
+
+/**
+ * @brief Limits on wordlists and passphrases
+ */
+#define WORDLIST_MAX_WORD_LENGTH 64     /**< Longer entries are skipped by the builder */
+#define WORDLIST_MIN_WORDS 2            /**< Smallest usable list */
+#define PASSPHRASE_MAX_WORDS 32         /**< Words per passphrase */
+#define PASSPHRASE_SEPARATOR_MAX 8      /**< Separator capacity including the NUL */
+
+/**
+ * @brief On-disk wordlist header (64 bytes)
+ *
+ * The file is the header, then count + 1 uint32_t offsets, then the words
+ * concatenated without separators. Word i is text[offsets[i], offsets[i + 1]).
+ * Words are distinct even when the case of their first letter is ignored,
+ * so every index is an equally likely distinct outcome with or without
+ * capitalization. Values are stored in host byte order.
+ */
+typedef struct {
+    char magic[8];                  /**< WORDLIST_INDEX_MAGIC */
+    uint32_t byte_order;            /**< WORDLIST_INDEX_BYTE_ORDER */
+    uint32_t max_word_length;       /**< Longest word in bytes */
+    uint64_t count;                 /**< Number of words */
+    uint64_t text_size;             /**< Bytes of word text */
+    unsigned char word_bytes[32];   /**< Bitmap of bytes in words, capitalized first letters included */
+} WordlistHeader;
+
+/**
+ * @brief Read-only mapped wordlist
+ */
+typedef struct {
+    const unsigned char *map;   /**< Mapped file */
+    size_t map_size;            /**< Mapped size in bytes */
+    const uint32_t *offsets;    /**< Word start offsets (count + 1) */
+    const char *text;           /**< Word text */
+    uint32_t count;             /**< Number of words */
+    uint32_t text_size;         /**< Bytes of word text */
+    uint32_t max_word_length;   /**< Longest word in bytes */
+    unsigned char word_bytes[32]; /**< Bitmap of bytes in words */
+#ifdef _WIN32
+    void *file_handle;          /**< Windows file handle */
+    void *mapping_handle;       /**< Windows mapping handle */
+#endif
+} Wordlist;
+
+/**
+ * @brief Passphrase options
+ */
+typedef struct {
+    size_t words;                               /**< Number of words */
+    char separator[PASSPHRASE_SEPARATOR_MAX];   /**< Text between words */
+    bool capitalize;                            /**< Upper-case the first letter of each word */
+} PassphraseOptions;
+
+/**
+ * @brief Get default passphrase options
+ * @return PassphraseOptions with defaults from config.h
+ */
+PassphraseOptions passphrase_options_init(void);
+
+/**
+ * @brief Set the separator of passphrase options
+ * @param options Options to update
+ * @param separator Separator text (1 to PASSPHRASE_SEPARATOR_MAX - 1 bytes)
+ * @return true if the separator fits, false otherwise
+ */
+bool passphrase_set_separator(PassphraseOptions *options, const char *separator);
+
+/**
+ * @brief Compile a wordlist into an index file
+ * @param list_path Text file with one word per line
+ * @param index_path Index file to write
+ * @param count Pointer to store the number of distinct words (may be NULL)
+ * @return true if successful, false otherwise
+ *
+ * Diceware lists ("11111<TAB>abacus") are accepted: a leading run of
+ * digits followed by whitespace is dropped. Blank lines, lines starting
+ * with '#', and words containing whitespace or control characters or
+ * longer than WORDLIST_MAX_WORD_LENGTH are skipped. Duplicates are removed,
+ * ignoring the case of the first letter so --capitalize cannot merge words.
+ */
+bool wordlist_build(const char *list_path, const char *index_path, uint64_t *count);
+
+/**
+ * @brief Map a wordlist index read-only
+ * @param list Wordlist to open
+ * @param path Index file to map
+ * @return true if the file is a valid index, false otherwise
+ *
+ * Only the header is checked here, so opening costs the same for any list
+ * size; each word's offsets are checked when it is drawn.
+ */
+bool wordlist_open(Wordlist *list, const char *path);
+
+/**
+ * @brief Get one word of a wordlist
+ * @param list Open wordlist
+ * @param index Word index (0 to count - 1)
+ * @param length Pointer to store the word length
+ * @return Word (not NUL-terminated), or NULL if the index is out of range or corrupt
+ */
+const char *wordlist_word(const Wordlist *list, uint32_t index, size_t *length);
+
+/**
+ * @brief Unmap a wordlist
+ * @param list Wordlist to close
+ */
+void wordlist_close(Wordlist *list);
+
+/**
+ * @brief Check passphrase options against a wordlist
+ * @param list Open wordlist
+ * @param options Passphrase options
+ * @return NULL if passphrases can be split back into their words, otherwise the error message
+ *
+ * The separator must be non-empty and share no character with any word
+ * (capitalized first letters included), so every output is unambiguous.
+ */
+const char *passphrase_check_options(const Wordlist *list, const PassphraseOptions *options);
+
+/**
+ * @brief Get the entropy of a passphrase
+ * @param list Open wordlist
+ * @param words Number of words
+ * @return words * log2(word count) bits, with or without capitalization
+ */
+double passphrase_entropy(const Wordlist *list, size_t words);
+
+/**
+ * @brief Get the buffer size generate_passphrase_into() needs
+ * @param list Open wordlist
+ * @param options Passphrase options
+ * @return Longest possible passphrase plus the NUL, or 0 if the options are invalid
+ */
+size_t passphrase_buffer_size(const Wordlist *list, const PassphraseOptions *options);
+
+/**
+ * @brief Generate a passphrase into a caller-supplied buffer
+ * @param list Open wordlist
+ * @param options Passphrase options
+ * @param sampler Random sampler
+ * @param buffer Output buffer
+ * @param buffer_size Size of buffer (see passphrase_buffer_size())
+ * @param result Pointer to store the result; result->password points into buffer
+ * @return true if successful, false otherwise
+ *
+ * Each word is an independent uniform draw from the whole list.
+ */
+bool generate_passphrase_into(const Wordlist *list, const PassphraseOptions *options,
+                              RandomSampler *sampler, char *buffer, size_t buffer_size,
+                              PasswordResult *result);
+
+/**
+ * @brief Generate a passphrase
+ * @param list Open wordlist
+ * @param options Passphrase options
+ * @param sampler Random sampler (NULL = a private one over get_random_bytes())
+ * @return PasswordResult (free with free_password_result()); password is NULL on error
+ */
+PasswordResult generate_passphrase(const Wordlist *list, const PassphraseOptions *options,
+                                   RandomSampler *sampler);
+
+/**
+ * @brief Generate a passphrase that passes a run's uniqueness checks
+ * @param list Open wordlist
+ * @param options Passphrase options
+ * @param sampler Random sampler (NULL = a private one over get_random_bytes())
+ * @param policy Options whose uniqueness sets apply
+ * @param stats Counters to update (may be NULL)
+ * @return PasswordResult (free with free_password_result()); password is NULL on error
+ *         or when policy->max_attempts draws were all rejected
+ */
+PasswordResult generate_passphrase_fresh(const Wordlist *list, const PassphraseOptions *options,
+                                         RandomSampler *sampler, const PasswordOptions *policy,
+                                         GenerationStats *stats);
+
+#endif /* PASSPHRASE_H */
\ No newline at end of file
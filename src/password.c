@@ -6,14 +6,22 @@
  */
 
 #include "password.h"
+#include "security.h"
+#include "sampler.h"
+#include "pattern.h"
+#include "dedup.h"
+#include "history.h"
+#include "crypto.h"
+#include "parallel.h"
+#include "stats.h"
 #include "utils.h"
 #include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <math.h>
 #include <ctype.h>
-
 /* Internal character sets */
 static const char *lowercase_chars = CHARSET_LOWERCASE;
 static const char *uppercase_chars = CHARSET_UPPERCASE;
@@ -21,12 +29,18 @@ static const char *number_chars = CHARSET_NUMBERS;
 static const char *special_chars = CHARSET_SPECIAL;
 static const char *ambiguous_chars = CHARSET_AMBIGUOUS;
 
+/* Outcome of repairing a candidate's class counts */
+typedef enum {
+    REPAIR_DONE,            /* Every class minimum is now met */
+    REPAIR_IMPOSSIBLE,      /* The minimums do not fit in the length */
+    REPAIR_RANDOM_FAILURE   /* The random source failed */
+} RepairResult;
+
 /* Internal function declarations */
-static char get_random_char_from_set(const char *char_set, size_t set_size);
-static bool contains_char_type(const char *password, const char *char_set);
-static size_t count_char_type(const char *password, const char *char_set);
-static bool meets_minimum_requirements(const char *password, const PasswordOptions *options);
-static void ensure_minimum_requirements(char *password, const PasswordOptions *options);
+static RepairResult repair_requirements(char *password, size_t length,
+                                        const CompiledCharset *charset,
+                                        RandomSampler *sampler,
+                                        size_t counts[CHAR_CLASS_COUNT]);
 
 /**
  * @brief Initialize password generation options with default values
@@ -46,9 +60,105 @@ PasswordOptions password_options_init(void) {
     options.min_numbers = 1;
     options.min_special = 1;
     
+    options.reject_weak = false;
+    options.reject_dictionary = false;
+    options.max_attempts = DEFAULT_MAX_ATTEMPTS;
+    options.unique = NULL;
+    options.near_duplicates = NULL;
+    options.history = NULL;
+    options.metadata = PASSWORD_META_ALL;
+    
     return options;
 }
 
+/**
+ * @brief Compile character set tables from password options
+ */
+bool compile_charset(const PasswordOptions *options, CompiledCharset *charset) {
+    if (!options || !charset) {
+        return false;
+    }
+    
+    StatsTimer timer = stats_begin();
+    memset(charset, 0, sizeof(CompiledCharset));
+    memset(charset->class_of, CHAR_CLASS_NONE, sizeof(charset->class_of));
+    
+    const char *class_sources[CHAR_CLASS_COUNT] = {
+        lowercase_chars, uppercase_chars, number_chars, special_chars
+    };
+    const bool class_enabled[CHAR_CLASS_COUNT] = {
+        options->charset.lowercase, options->charset.uppercase,
+        options->charset.numbers, options->charset.special
+    };
+    
+    for (int cls = 0; cls < CHAR_CLASS_COUNT; cls++) {
+        /* Class membership is by source set, independent of filtering */
+        for (const char *c = class_sources[cls]; *c; c++) {
+            charset->class_of[(unsigned char)*c] = (unsigned char)cls;
+        }
+        
+        if (!class_enabled[cls]) {
+            continue;
+        }
+        
+        for (const char *c = class_sources[cls]; *c; c++) {
+            if (options->charset.avoid_ambiguous && strchr(ambiguous_chars, *c)) {
+                continue;
+            }
+            if (charset->class_size[cls] < CHARSET_CLASS_MAX - 1) {
+                charset->class_chars[cls][charset->class_size[cls]++] = *c;
+            }
+            if (charset->size < CHARSET_ALPHABET_MAX - 1) {
+                charset->alphabet_class[charset->size] = (unsigned char)cls;
+                charset->alphabet[charset->size++] = *c;
+            }
+        }
+    }
+    
+    if (charset->size == 0) {
+        stats_end(STATS_CHARSET, &timer, 0);
+        return false;
+    }
+    
+    /* Requirements as per-class minimums, checked in O(1) per candidate */
+    for (int cls = 0; cls < CHAR_CLASS_COUNT; cls++) {
+        if (charset->class_size[cls] > 0 && options->require_all_types) {
+            charset->class_min[cls] = 1;
+        }
+    }
+    if (charset->class_size[CHAR_CLASS_NUMBER] > 0 && 
+        options->min_numbers > charset->class_min[CHAR_CLASS_NUMBER]) {
+        charset->class_min[CHAR_CLASS_NUMBER] = options->min_numbers;
+    }
+    if (charset->class_size[CHAR_CLASS_SPECIAL] > 0 && 
+        options->min_special > charset->class_min[CHAR_CLASS_SPECIAL]) {
+        charset->class_min[CHAR_CLASS_SPECIAL] = options->min_special;
+    }
+    
+    size_t required = 0;
+    for (int cls = 0; cls < CHAR_CLASS_COUNT; cls++) {
+        required += charset->class_min[cls];
+    }
+    if (required > options->length) {
+        stats_end(STATS_CHARSET, &timer, 0);
+        return false;
+    }
+    
+    /* Entropy formula: log2(pool_size^length) = length * log2(pool_size) */
+    charset->bits_per_char = log2((double)charset->size);
+    
+    /* Every password of these options shares the same metadata */
+    charset->metadata_length = options->length;
+    charset->entropy = calculate_entropy_compiled(options->length, charset);
+    charset->strength_score = (int)((charset->entropy / 128.0) * 100);
+    if (charset->strength_score > 100) charset->strength_score = 100;
+    if (charset->strength_score < 0) charset->strength_score = 0;
+    charset->strength_level = get_strength_level(charset->strength_score);
+    
+    stats_end(STATS_CHARSET, &timer, 0);
+    return true;
+}
+
 /**
  * @brief Generate a single password based on options
  */
@@ -60,91 +170,291 @@ PasswordResult generate_password(const PasswordOptions *options) {
         return result;
     }
     
-    /* Build character set based on options */
-    SecureString char_set;
-    if (!secure_string_init(&char_set, 256)) {
-        result.strength = "Memory error";
+    CompiledCharset charset;
+    if (!compile_charset(options, &charset)) {
+        result.strength = "No character set selected";
         return result;
     }
     
-    if (options->charset.lowercase) {
-        secure_string_append_cstr(&char_set, lowercase_chars);
+    RandomSampler sampler;
+    random_sampler_init(&sampler);
+    
+    result = generate_password_compiled(options, &charset, &sampler);
+    
+    random_sampler_wipe(&sampler);
+    return result;
+}
+
+/**
+ * @brief Draw one candidate, counting characters per class as they are drawn
+ */
+static bool draw_candidate(RandomSampler *sampler, const CompiledCharset *charset,
+                           char *buffer, size_t length, size_t counts[CHAR_CLASS_COUNT]) {
+    for (int cls = 0; cls < CHAR_CLASS_COUNT; cls++) {
+        counts[cls] = 0;
     }
-    if (options->charset.uppercase) {
-        secure_string_append_cstr(&char_set, uppercase_chars);
+    
+    for (size_t i = 0; i < length; i++) {
+        uint32_t index;
+        if (!random_sampler_uniform(sampler, (uint32_t)charset->size, &index)) {
+            return false;
+        }
+        buffer[i] = charset->alphabet[index];
+        counts[charset->alphabet_class[index]]++;
     }
-    if (options->charset.numbers) {
-        secure_string_append_cstr(&char_set, number_chars);
+    
+    return true;
+}
+
+/**
+ * @brief Check per-class counts against the compiled minimums
+ */
+static bool meets_class_minimums(const CompiledCharset *charset, 
+                                 const size_t counts[CHAR_CLASS_COUNT]) {
+    return counts[CHAR_CLASS_LOWER] >= charset->class_min[CHAR_CLASS_LOWER] &&
+           counts[CHAR_CLASS_UPPER] >= charset->class_min[CHAR_CLASS_UPPER] &&
+           counts[CHAR_CLASS_NUMBER] >= charset->class_min[CHAR_CLASS_NUMBER] &&
+           counts[CHAR_CLASS_SPECIAL] >= charset->class_min[CHAR_CLASS_SPECIAL];
+}
+
+/**
+ * @brief Apply the weak-pattern, dictionary, history and uniqueness filters to a candidate
+ * @return true if the candidate passes
+ *
+ * The unique set is checked last so only accepted candidates are added.
+ */
+static bool passes_policy(const PasswordOptions *options, const char *password,
+                          size_t length, GenerationStats *stats) {
+    if (options->reject_weak || options->reject_dictionary) {
+        PatternMatch match = scan_password_patterns(password, length);
+        
+        if (options->reject_weak && match.has_weak_pattern) {
+            stats->rejected_weak++;
+            return false;
+        }
+        if (options->reject_dictionary && match.has_dictionary_word) {
+            stats->rejected_dictionary++;
+            return false;
+        }
     }
-    if (options->charset.special) {
-        secure_string_append_cstr(&char_set, special_chars);
+    
+    return password_is_fresh(options, password, length, stats);
+}
+
+/**
+ * @brief Check a candidate against the uniqueness sets of a run
+ */
+bool password_is_fresh(const PasswordOptions *options, const char *password,
+                       size_t length, GenerationStats *stats) {
+    GenerationStats local = {0};
+    if (!stats) {
+        stats = &local;
+    }
+    
+    if (options->history && history_contains(options->history, password, length)) {
+        stats->rejected_history++;
+        return false;
+    }
+    
+    if (options->near_duplicates &&
+        near_duplicate_find(options->near_duplicates, password, length) != SIZE_MAX) {
+        stats->rejected_similar++;
+        return false;
+    }
+    
+    if (options->unique && unique_set_insert(options->unique, password, length) != UNIQUE_INSERTED) {
+        stats->rejected_duplicates++;
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Add one set of generation counters to another
+ */
+void generation_stats_merge(GenerationStats *total, const GenerationStats *part) {
+    if (!total || !part) {
+        return;
+    }
+    
+    total->generated += part->generated;
+    total->candidates += part->candidates;
+    total->rejected_requirements += part->rejected_requirements;
+    total->rejected_weak += part->rejected_weak;
+    total->rejected_dictionary += part->rejected_dictionary;
+    total->rejected_duplicates += part->rejected_duplicates;
+    total->rejected_similar += part->rejected_similar;
+    total->rejected_history += part->rejected_history;
+    total->fallback_repairs += part->fallback_repairs;
+    total->failures += part->failures;
+}
+
+/**
+ * @brief Fill the requested metadata fields of a result from the charset cache
+ */
+static void set_result_metadata(PasswordResult *result, unsigned fields,
+                                const CompiledCharset *charset) {
+    double entropy = charset->entropy;
+    int score = charset->strength_score;
+    
+    /* Tables compiled for another length: derive the figures directly */
+    if ((fields & PASSWORD_META_ALL) && charset->metadata_length != result->length) {
+        entropy = calculate_entropy_compiled(result->length, charset);
+        score = (int)((entropy / 128.0) * 100);
+        if (score > 100) score = 100;
+        if (score < 0) score = 0;
+    }
+    
+    if (fields & PASSWORD_META_ENTROPY) {
+        result->entropy = entropy;
+    }
+    
+    if (fields & PASSWORD_META_STRENGTH) {
+        result->strength_score = score;
+        result->strength = get_strength_category(score);
+    } else {
+        result->strength = get_strength_level_label(STRENGTH_LEVEL_UNKNOWN);
+    }
+}
+
+/**
+ * @brief Generate a password into a caller-supplied buffer
+ */
+bool generate_password_into(const PasswordOptions *options,
+                            const CompiledCharset *charset,
+                            RandomSampler *sampler,
+                            char *buffer,
+                            PasswordResult *result,
+                            GenerationStats *stats) {
+    if (!result) {
+        return false;
+    }
+    
+    memset(result, 0, sizeof(PasswordResult));
+    
+    if (!options || !charset || !sampler || !buffer || charset->size == 0) {
+        result->strength = "Invalid options";
+        return false;
+    }
+    
+    GenerationStats local = {0};
+    if (!stats) {
+        stats = &local;
     }
     
-    /* Remove ambiguous characters if requested */
-    if (options->charset.avoid_ambiguous && char_set.length > 0) {
-        SecureString filtered_set;
-        if (!secure_string_init(&filtered_set, char_set.capacity)) {
-            secure_string_free(&char_set);
-            result.strength = "Memory error";
-            return result;
+    size_t length = options->length;
+    size_t budget = options->max_attempts > 0 ? options->max_attempts : DEFAULT_MAX_ATTEMPTS;
+    size_t counts[CHAR_CLASS_COUNT];
+    bool accepted = false;
+    
+    /* Rejection sampling keeps accepted passwords uniform */
+    for (size_t attempt = 0; attempt < budget && !accepted; attempt++) {
+        stats->candidates++;
+        
+        StatsTimer timer = stats_begin();
+        bool drawn = draw_candidate(sampler, charset, buffer, length, counts);
+        stats_end(STATS_SAMPLING, &timer, 0);
+        if (!drawn) {
+            secure_clear(buffer, length);
+            result->strength = "Random generator failure";
+            return false;
         }
+        buffer[length] = '\0';
         
-        for (size_t i = 0; i < char_set.length; i++) {
-            if (strchr(ambiguous_chars, char_set.data[i]) == NULL) {
-                secure_string_append(&filtered_set, char_set.data[i]);
+        if (!meets_class_minimums(charset, counts)) {
+            stats->rejected_requirements++;
+            continue;
+        }
+        
+        accepted = passes_policy(options, buffer, length, stats);
+    }
+    
+    /* Budget exhausted: repair candidates at random positions instead */
+    if (!accepted) {
+        stats->fallback_repairs++;
+        
+        for (size_t attempt = 0; attempt < budget && !accepted; attempt++) {
+            if (attempt > 0) {
+                stats->candidates++;
+                StatsTimer timer = stats_begin();
+                bool drawn = draw_candidate(sampler, charset, buffer, length, counts);
+                stats_end(STATS_SAMPLING, &timer, 0);
+                if (!drawn) {
+                    secure_clear(buffer, length);
+                    result->strength = "Random generator failure";
+                    return false;
+                }
             }
+            
+            if (meets_class_minimums(charset, counts)) {
+                /* The last candidate of the first loop was already rejected by the policy */
+                if (attempt == 0) {
+                    continue;
+                }
+            } else {
+                StatsTimer timer = stats_begin();
+                RepairResult repaired = repair_requirements(buffer, length, charset,
+                                                            sampler, counts);
+                stats_end(STATS_REPAIR, &timer, 0);
+                if (repaired == REPAIR_RANDOM_FAILURE) {
+                    secure_clear(buffer, length);
+                    result->strength = "Random generator failure";
+                    return false;
+                }
+                if (repaired == REPAIR_IMPOSSIBLE || !meets_class_minimums(charset, counts)) {
+                    stats->failures++;
+                    secure_clear(buffer, length);
+                    result->strength = "Requirements do not fit the length";
+                    return false;
+                }
+            }
+            
+            accepted = passes_policy(options, buffer, length, stats);
         }
         
-        secure_string_free(&char_set);
-        char_set = filtered_set;
+        if (!accepted) {
+            stats->failures++;
+            secure_clear(buffer, length);
+            result->strength = "Policy rejected every candidate";
+            return false;
+        }
     }
     
-    /* Check if we have any characters to choose from */
-    if (char_set.length == 0) {
-        secure_string_free(&char_set);
-        result.strength = "No character set selected";
+    stats->generated++;
+    
+    /* Metadata comes from the charset, computed once per compile */
+    result->password = buffer;
+    result->length = options->length;
+    set_result_metadata(result, options->metadata, charset);
+    
+    return true;
+}
+
+/**
+ * @brief Generate a password from precompiled character set tables
+ */
+PasswordResult generate_password_compiled(const PasswordOptions *options,
+                                          const CompiledCharset *charset,
+                                          RandomSampler *sampler) {
+    PasswordResult result = {0};
+    
+    if (!options || !charset || !sampler || charset->size == 0) {
+        result.strength = "Invalid options";
         return result;
     }
     
     /* Allocate memory for password */
-    result.password = (char *)calloc(options->length + 1, sizeof(char));
-    if (!result.password) {
-        secure_string_free(&char_set);
+    char *password = (char *)calloc(options->length + 1, sizeof(char));
+    if (!password) {
         result.strength = "Memory error";
         return result;
     }
     
-    result.length = options->length;
-    
-    /* Generate password with secure random */
-    for (size_t i = 0; i < options->length; i++) {
-        unsigned char random_byte;
-        if (!get_random_bytes(&random_byte, 1)) {
-            /* Fallback to less secure random if needed */
-            random_byte = (unsigned char)random_range(0, 255);
-        }
-        
-        size_t index = random_byte % char_set.length;
-        result.password[i] = char_set.data[index];
-    }
-    result.password[options->length] = '\0';
-    
-    /* Ensure minimum requirements are met */
-    if (options->require_all_types || options->min_numbers > 0 || options->min_special > 0) {
-        ensure_minimum_requirements(result.password, options);
+    if (!generate_password_into(options, charset, sampler, password, &result, NULL)) {
+        free(password);
     }
     
-    /* Calculate metadata */
-    result.entropy = calculate_entropy(result.password, options);
-    result.strength_score = (int)((result.entropy / 128.0) * 100);
-    if (result.strength_score > 100) result.strength_score = 100;
-    if (result.strength_score < 0) result.strength_score = 0;
-    
-    result.strength = get_strength_category(result.strength_score);
-    
-    /* Cleanup */
-    secure_string_free(&char_set);
-    
     return result;
 }
 
@@ -162,10 +472,20 @@ size_t generate_bulk_passwords(const PasswordOptions *options,
         return 0;
     }
     
+    /* Character set tables are built once for the whole batch */
+    CompiledCharset charset;
+    if (!compile_charset(options, &charset)) {
+        return 0;
+    }
+    
     size_t successful = 0;
     
+    /* One sampler for the whole batch: random bytes are fetched in blocks */
+    RandomSampler sampler;
+    random_sampler_init(&sampler);
+    
     for (size_t i = 0; i < count; i++) {
-        results[i] = generate_password(options);
+        results[i] = generate_password_compiled(options, &charset, &sampler);
         
         if (results[i].password != NULL) {
             successful++;
@@ -175,9 +495,317 @@ size_t generate_bulk_passwords(const PasswordOptions *options,
         }
     }
     
+    random_sampler_wipe(&sampler);
     return successful;
 }
 
+/**
+ * @brief Shared description of a parallel bulk job
+ */
+typedef struct {
+    const PasswordOptions *options;
+    const CompiledCharset *charset;
+    PasswordResult *results;
+    size_t count;
+    PasswordBatch *batch;   /**< Batch to fill (NULL = heap-allocated results) */
+    size_t *generated;      /**< Passwords generated by each worker */
+    GenerationStats *stats; /**< Counters of each worker */
+} BulkJob;
+
+/**
+ * @brief First result index owned by a worker
+ */
+static size_t bulk_range_begin(size_t count, size_t index, size_t workers) {
+    size_t share = count / workers;
+    size_t extra = count % workers;
+    return index * share + (index < extra ? index : extra);
+}
+
+/**
+ * @brief Generate one contiguous share of a parallel bulk job
+ */
+static void bulk_worker(void *context, size_t index, size_t workers) {
+    BulkJob *job = (BulkJob *)context;
+    size_t begin = bulk_range_begin(job->count, index, workers);
+    size_t end = bulk_range_begin(job->count, index + 1, workers);
+    
+    job->generated[index] = 0;
+    
+    /* Private stream: no locks taken while generating */
+    ChaChaDrbg drbg;
+    if (!chacha_drbg_seed(&drbg)) {
+        return;
+    }
+    
+    RandomSampler sampler;
+    random_sampler_init_source(&sampler, chacha_drbg_fill, &drbg);
+    
+    for (size_t i = begin; i < end; i++) {
+        if (job->batch) {
+            PasswordBatch *batch = job->batch;
+            PasswordResult result;
+            if (!generate_password_into(job->options, job->charset, &sampler,
+                                        batch->chars + i * batch->stride, &result,
+                                        &job->stats[index])) {
+                break;
+            }
+            batch->lengths[i] = (uint16_t)result.length;
+            batch->entropy[i] = result.entropy;
+            batch->scores[i] = (uint8_t)result.strength_score;
+            batch->levels[i] = (job->options->metadata & PASSWORD_META_STRENGTH) ?
+                               job->charset->strength_level : STRENGTH_LEVEL_UNKNOWN;
+        } else {
+            char *password = (char *)calloc(job->options->length + 1, sizeof(char));
+            if (!password) {
+                break;
+            }
+            if (!generate_password_into(job->options, job->charset, &sampler, password,
+                                        &job->results[i], &job->stats[index])) {
+                free(password);
+                break;
+            }
+        }
+        job->generated[index]++;
+    }
+    
+    random_sampler_wipe(&sampler);
+    chacha_drbg_wipe(&drbg);
+}
+
+/**
+ * @brief Run a bulk job on worker threads
+ * @return Length of the leading run of generated results
+ */
+static size_t run_bulk_job(const PasswordOptions *options, size_t count,
+                           PasswordResult *results, PasswordBatch *batch,
+                           size_t threads, GenerationStats *stats) {
+    if (!validate_options(options)) {
+        return 0;
+    }
+    
+    CompiledCharset charset;
+    if (!compile_charset(options, &charset)) {
+        return 0;
+    }
+    
+    if (threads == 0) {
+        threads = parallel_cpu_count();
+    }
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    
+    /* Small batches are not worth the thread start-up cost */
+    size_t useful = (count + BULK_MIN_PER_THREAD - 1) / BULK_MIN_PER_THREAD;
+    if (threads > useful) {
+        threads = useful;
+    }
+    
+    size_t *generated = (size_t *)calloc(threads, sizeof(size_t));
+    GenerationStats *worker_stats = (GenerationStats *)calloc(threads, sizeof(GenerationStats));
+    if (!generated || !worker_stats) {
+        free(generated);
+        free(worker_stats);
+        return 0;
+    }
+    
+    BulkJob job = { options, &charset, results, count, batch, generated, worker_stats };
+    
+    if (!parallel_run(threads, bulk_worker, &job)) {
+        free(generated);
+        free(worker_stats);
+        return 0;
+    }
+    
+    for (size_t i = 0; i < threads; i++) {
+        generation_stats_merge(stats, &worker_stats[i]);
+    }
+    free(worker_stats);
+    
+    /* Keep the leading run of complete shares, drop anything after a gap */
+    size_t successful = 0;
+    bool complete = true;
+    
+    for (size_t i = 0; i < threads; i++) {
+        size_t begin = bulk_range_begin(count, i, threads);
+        size_t share = bulk_range_begin(count, i + 1, threads) - begin;
+        
+        if (complete) {
+            successful += generated[i];
+            complete = generated[i] == share;
+        } else if (batch) {
+            secure_clear(batch->chars + begin * batch->stride, generated[i] * batch->stride);
+        } else {
+            free_bulk_passwords(results + begin, generated[i]);
+        }
+    }
+    
+    free(generated);
+    return successful;
+}
+
+/**
+ * @brief Generate multiple passwords in bulk on several threads
+ */
+size_t generate_bulk_passwords_parallel(const PasswordOptions *options,
+                                        size_t count,
+                                        PasswordResult *results,
+                                        size_t threads,
+                                        GenerationStats *stats) {
+    if (!options || !results || count == 0 || count > MAX_BULK_GENERATE) {
+        return 0;
+    }
+    
+    return run_bulk_job(options, count, results, NULL, threads, stats);
+}
+
+/**
+ * @brief Create an empty password batch
+ */
+bool password_batch_init(PasswordBatch *batch, size_t capacity, size_t max_length) {
+    if (!batch) {
+        return false;
+    }
+    
+    memset(batch, 0, sizeof(PasswordBatch));
+    
+    if (capacity == 0 || capacity > MAX_BULK_GENERATE || max_length == 0 ||
+        max_length > MAX_INPUT_LENGTH) {
+        return false;
+    }
+    
+    size_t stride = max_length + 1;
+    size_t per_entry = stride + sizeof(uint16_t) + sizeof(double) + 2 * sizeof(uint8_t);
+    if (capacity > (SIZE_MAX - 4 * sizeof(double)) / per_entry) {
+        return false;
+    }
+    
+    /* Widest columns first; the slack covers alignment padding */
+    if (!secure_arena_init(&batch->arena, capacity * per_entry + 4 * sizeof(double))) {
+        return false;
+    }
+    
+    SecureArena *arena = &batch->arena;
+    batch->entropy = (double *)secure_arena_alloc(arena, capacity * sizeof(double), sizeof(double));
+    batch->lengths = (uint16_t *)secure_arena_alloc(arena, capacity * sizeof(uint16_t), sizeof(uint16_t));
+    batch->scores = (uint8_t *)secure_arena_alloc(arena, capacity, 1);
+    batch->levels = (uint8_t *)secure_arena_alloc(arena, capacity, 1);
+    batch->chars = (char *)secure_arena_alloc(arena, capacity * stride, 1);
+    
+    if (!batch->entropy || !batch->lengths || !batch->scores || 
+        !batch->levels || !batch->chars) {
+        secure_arena_destroy(arena);
+        memset(batch, 0, sizeof(PasswordBatch));
+        return false;
+    }
+    
+    batch->stride = stride;
+    batch->capacity = capacity;
+    batch->count = 0;
+    return true;
+}
+
+/**
+ * @brief Fill a batch with generated passwords
+ */
+size_t password_batch_generate(PasswordBatch *batch, const PasswordOptions *options,
+                               size_t count, size_t threads, GenerationStats *stats) {
+    if (!batch || !batch->chars || !options || count == 0 || 
+        count > batch->capacity || options->length >= batch->stride) {
+        return 0;
+    }
+    
+    password_batch_clear(batch);
+    batch->count = run_bulk_job(options, count, NULL, batch, threads, stats);
+    return batch->count;
+}
+
+/**
+ * @brief Append a copy of a password to a batch
+ */
+bool password_batch_append(PasswordBatch *batch, const char *password, size_t length) {
+    if (!batch || !batch->chars || !password || 
+        batch->count >= batch->capacity || length >= batch->stride) {
+        return false;
+    }
+    
+    size_t index = batch->count++;
+    char *slot = batch->chars + index * batch->stride;
+    memcpy(slot, password, length);
+    slot[length] = '\0';
+    
+    batch->lengths[index] = (uint16_t)length;
+    batch->entropy[index] = 0.0;
+    batch->scores[index] = 0;
+    batch->levels[index] = STRENGTH_LEVEL_UNKNOWN;
+    return true;
+}
+
+/**
+ * @brief Get a batch entry as a non-owning PasswordResult
+ */
+PasswordResult password_batch_view(const PasswordBatch *batch, size_t index) {
+    PasswordResult result = {0};
+    
+    if (batch && index < batch->count) {
+        result.password = batch->chars + index * batch->stride;
+        result.length = batch->lengths[index];
+        result.entropy = batch->entropy[index];
+        result.strength_score = batch->scores[index];
+        result.strength = get_strength_level_label(batch->levels[index]);
+    }
+    
+    return result;
+}
+
+/**
+ * @brief Compute average entropy and score over a batch
+ */
+void password_batch_summary(const PasswordBatch *batch, double *avg_entropy, int *avg_score) {
+    double entropy_sum = 0.0;
+    uint64_t score_sum = 0;
+    size_t count = batch ? batch->count : 0;
+    
+    /* Column loops: no pointer chasing, easy for the compiler to vectorize */
+    for (size_t i = 0; i < count; i++) {
+        entropy_sum += batch->entropy[i];
+    }
+    for (size_t i = 0; i < count; i++) {
+        score_sum += batch->scores[i];
+    }
+    
+    if (avg_entropy) {
+        *avg_entropy = count > 0 ? entropy_sum / (double)count : 0.0;
+    }
+    if (avg_score) {
+        *avg_score = count > 0 ? (int)(score_sum / count) : 0;
+    }
+}
+
+/**
+ * @brief Wipe every entry and reset a batch to empty
+ */
+void password_batch_clear(PasswordBatch *batch) {
+    if (batch && batch->chars && batch->count > 0) {
+        secure_clear(batch->chars, batch->count * batch->stride);
+        memset(batch->lengths, 0, batch->count * sizeof(uint16_t));
+        memset(batch->entropy, 0, batch->count * sizeof(double));
+        memset(batch->scores, 0, batch->count);
+        memset(batch->levels, 0, batch->count);
+        batch->count = 0;
+    }
+}
+
+/**
+ * @brief Wipe and release a password batch
+ */
+void password_batch_free(PasswordBatch *batch) {
+    if (batch) {
+        secure_arena_destroy(&batch->arena);
+        memset(batch, 0, sizeof(PasswordBatch));
+    }
+}
+
 /**
  * @brief Validate password options
  */
@@ -227,8 +855,20 @@ bool validate_options(const PasswordOptions *options) {
         return false;
     }
     
-    /* Check if combined minimums exceed password length */
-    if ((options->min_numbers + options->min_special) > options->length) {
+    /* Check if the per-class minimums fit in the password length */
+    size_t type_min = options->require_all_types ? 1 : 0;
+    size_t required = 0;
+    
+    if (options->charset.lowercase) required += type_min;
+    if (options->charset.uppercase) required += type_min;
+    if (options->charset.numbers) {
+        required += options->min_numbers > type_min ? options->min_numbers : type_min;
+    }
+    if (options->charset.special) {
+        required += options->min_special > type_min ? options->min_special : type_min;
+    }
+    
+    if (required > options->length) {
         return false;
     }
     
@@ -243,76 +883,68 @@ double calculate_entropy(const char *password, const PasswordOptions *options) {
         return 0.0;
     }
     
-    size_t pool_size = 0;
-    
-    if (options->charset.lowercase) {
-        pool_size += strlen(lowercase_chars);
-        if (options->charset.avoid_ambiguous) {
-            /* Subtract ambiguous lowercase letters */
-            for (const char *c = ambiguous_chars; *c; c++) {
-                if (strchr(lowercase_chars, *c)) {
-                    pool_size--;
-                }
-            }
-        }
-    }
-    
-    if (options->charset.uppercase) {
-        pool_size += strlen(uppercase_chars);
-        if (options->charset.avoid_ambiguous) {
-            /* Subtract ambiguous uppercase letters */
-            for (const char *c = ambiguous_chars; *c; c++) {
-                if (strchr(uppercase_chars, *c)) {
-                    pool_size--;
-                }
-            }
-        }
-    }
-    
-    if (options->charset.numbers) {
-        pool_size += strlen(number_chars);
-        if (options->charset.avoid_ambiguous) {
-            /* Subtract ambiguous numbers */
-            for (const char *c = ambiguous_chars; *c; c++) {
-                if (strchr(number_chars, *c)) {
-                    pool_size--;
-                }
-            }
-        }
-    }
-    
-    if (options->charset.special) {
-        pool_size += strlen(special_chars);
+    CompiledCharset charset;
+    if (!compile_charset(options, &charset)) {
+        return 0.0;
     }
     
-    if (pool_size == 0) {
+    return calculate_entropy_compiled(strlen(password), &charset);
+}
+
+/**
+ * @brief Calculate entropy of a password generated from compiled tables
+ */
+double calculate_entropy_compiled(size_t length, const CompiledCharset *charset) {
+    if (!charset || charset->size == 0) {
         return 0.0;
     }
     
-    /* Entropy formula: log2(pool_size^length) = length * log2(pool_size) */
-    double entropy_per_char = log2((double)pool_size);
-    return (double)strlen(password) * entropy_per_char;
+    return (double)length * charset->bits_per_char;
 }
 
 /**
- * @brief Get strength category based on score
+ * @brief Strength labels indexed by strength level
  */
-const char *get_strength_category(int score) {
+static const char *const strength_labels[] = {
+    "Very Weak", "Weak", "Fair", "Good", "Strong", "Very Strong"
+};
+
+/**
+ * @brief Get strength level based on score
+ */
+uint8_t get_strength_level(int score) {
     if (score < STRENGTH_THRESHOLD_VERY_WEAK) {
-        return "Very Weak";
+        return 0;
     } else if (score < STRENGTH_THRESHOLD_WEAK) {
-        return "Weak";
+        return 1;
     } else if (score < STRENGTH_THRESHOLD_FAIR) {
-        return "Fair";
+        return 2;
     } else if (score < STRENGTH_THRESHOLD_GOOD) {
-        return "Good";
+        return 3;
     } else if (score < STRENGTH_THRESHOLD_STRONG) {
-        return "Strong";
+        return 4;
     } else {
-        return "Very Strong";
+        return 5;
     }
 }
 
+/**
+ * @brief Get string representation of a strength level
+ */
+const char *get_strength_level_label(uint8_t level) {
+    if (level < sizeof(strength_labels) / sizeof(strength_labels[0])) {
+        return strength_labels[level];
+    }
+    return "Unknown";
+}
+
+/**
+ * @brief Get strength category based on score
+ */
+const char *get_strength_category(int score) {
+    return strength_labels[get_strength_level(score)];
+}
+
 /**
  * @brief Free memory allocated for PasswordResult
  */
@@ -344,299 +976,85 @@ void free_bulk_passwords(PasswordResult *results, size_t count) {
 /* Internal helper functions */
 
 /**
- * @brief Get random character from character set
- */
-static char get_random_char_from_set(const char *char_set, size_t set_size) {
-    if (!char_set || set_size == 0) {
-        return '\0';
-    }
-    
-    unsigned char random_byte;
-    if (!get_random_bytes(&random_byte, 1)) {
-        random_byte = (unsigned char)random_range(0, 255);
-    }
-    
-    size_t index = random_byte % set_size;
-    return char_set[index];
-}
-
-/**
- * @brief Check if password contains characters from specific set
+ * @brief Bring per-class counts up to the compiled minimums
+ * @return REPAIR_DONE, REPAIR_IMPOSSIBLE if the minimums do not fit in
+ *         the length, or REPAIR_RANDOM_FAILURE
+ *
+ * Each missing character goes to a uniformly chosen position that is not
+ * already fixed and whose current class has more than it needs, so the
+ * repair neither favours the start of the password nor undoes itself.
  */
-static bool contains_char_type(const char *password, const char *char_set) {
-    if (!password || !char_set) {
-        return false;
-    }
+static RepairResult repair_requirements(char *password, size_t length,
+                                        const CompiledCharset *charset,
+                                        RandomSampler *sampler,
+                                        size_t counts[CHAR_CLASS_COUNT]) {
+    unsigned char fixed[MAX_PASSWORD_LENGTH] = {0};
     
-    for (size_t i = 0; password[i] != '\0'; i++) {
-        if (strchr(char_set, password[i]) != NULL) {
-            return true;
-        }
-    }
-    
-    return false;
-}
-
-/**
- * @brief Count characters from specific set in password
- */
-static size_t count_char_type(const char *password, const char *char_set) {
-    if (!password || !char_set) {
-        return 0;
-    }
-    
-    size_t count = 0;
-    for (size_t i = 0; password[i] != '\0'; i++) {
-        if (strchr(char_set, password[i]) != NULL) {
-            count++;
-        }
-    }
-    
-    return count;
-}
-
-/**
- * @brief Check if password meets minimum requirements
- */
-static bool meets_minimum_requirements(const char *password, const PasswordOptions *options) {
-    if (!password || !options) {
-        return false;
-    }
-    
-    /* Check require all types */
-    if (options->require_all_types) {
-        if (options->charset.lowercase && 
-            !contains_char_type(password, lowercase_chars)) {
-            return false;
-        }
-        if (options->charset.uppercase && 
-            !contains_char_type(password, uppercase_chars)) {
-            return false;
-        }
-        if (options->charset.numbers && 
-            !contains_char_type(password, number_chars)) {
-            return false;
-        }
-        if (options->charset.special && 
-            !contains_char_type(password, special_chars)) {
-            return false;
-        }
-    }
-    
-    /* Check minimum numbers */
-    if (options->min_numbers > 0) {
-        size_t num_count = count_char_type(password, number_chars);
-        if (num_count < options->min_numbers) {
-            return false;
-        }
-    }
-    
-    /* Check minimum special characters */
-    if (options->min_special > 0) {
-        size_t special_count = count_char_type(password, special_chars);
-        if (special_count < options->min_special) {
-            return false;
-        }
-    }
-    
-    return true;
-}
-
-/**
- * @brief Ensure password meets minimum requirements by modifying it
- */
-static void ensure_minimum_requirements(char *password, const PasswordOptions *options) {
-    if (!password || !options) {
-        return;
-    }
-    
-    size_t length = strlen(password);
-    if (length == 0) {
-        return;
+    if (length > MAX_PASSWORD_LENGTH) {
+        return REPAIR_IMPOSSIBLE;
     }
     
-    /* Array to track which positions we can modify */
-    int *modifiable = (int *)calloc(length, sizeof(int));
-    if (!modifiable) {
-        return;
-    }
-    
-    /* Initially, all positions are modifiable */
-    for (size_t i = 0; i < length; i++) {
-        modifiable[i] = 1;
-    }
-    
-    /* Ensure required character types */
-    if (options->require_all_types) {
-        if (options->charset.lowercase && 
-            !contains_char_type(password, lowercase_chars)) {
-            /* Find a modifiable position and put a lowercase letter */
+    for (int cls = 0; cls < CHAR_CLASS_COUNT; cls++) {
+        while (counts[cls] < charset->class_min[cls]) {
+            /* Count positions that can give up their character */
+            uint32_t candidates = 0;
             for (size_t i = 0; i < length; i++) {
-                if (modifiable[i]) {
-                    password[i] = get_random_char_from_set(lowercase_chars, 
-                                                          strlen(lowercase_chars));
-                    modifiable[i] = 0;
-                    break;
-                }
-            }
-        }
-        
-        if (options->charset.uppercase && 
-            !contains_char_type(password, uppercase_chars)) {
-            for (size_t i = 0; i < length; i++) {
-                if (modifiable[i]) {
-                    password[i] = get_random_char_from_set(uppercase_chars, 
-                                                          strlen(uppercase_chars));
-                    modifiable[i] = 0;
-                    break;
+                unsigned char old_cls = charset->class_of[(unsigned char)password[i]];
+                if (!fixed[i] && counts[old_cls] > charset->class_min[old_cls]) {
+                    candidates++;
                 }
             }
-        }
-        
-        if (options->charset.numbers && 
-            !contains_char_type(password, number_chars)) {
-            for (size_t i = 0; i < length; i++) {
-                if (modifiable[i]) {
-                    password[i] = get_random_char_from_set(number_chars, 
-                                                          strlen(number_chars));
-                    modifiable[i] = 0;
-                    break;
-                }
+            
+            if (candidates == 0) {
+                return REPAIR_IMPOSSIBLE;
             }
-        }
-        
-        if (options->charset.special && 
-            !contains_char_type(password, special_chars)) {
-            for (size_t i = 0; i < length; i++) {
-                if (modifiable[i]) {
-                    password[i] = get_random_char_from_set(special_chars, 
-                                                          strlen(special_chars));
-                    modifiable[i] = 0;
-                    break;
-                }
+            
+            uint32_t pick;
+            if (!random_sampler_uniform(sampler, candidates, &pick)) {
+                return REPAIR_RANDOM_FAILURE;
             }
-        }
-    }
-    
-    /* Ensure minimum numbers */
-    if (options->min_numbers > 0) {
-        size_t num_count = count_char_type(password, number_chars);
-        
-        while (num_count < options->min_numbers) {
+            
             for (size_t i = 0; i < length; i++) {
-                if (modifiable[i]) {
-                    password[i] = get_random_char_from_set(number_chars, 
-                                                          strlen(number_chars));
-                    modifiable[i] = 0;
-                    num_count++;
-                    break;
+                unsigned char old_cls = charset->class_of[(unsigned char)password[i]];
+                if (fixed[i] || counts[old_cls] <= charset->class_min[old_cls]) {
+                    continue;
                 }
-            }
-        }
-    }
-    
-    /* Ensure minimum special characters */
-    if (options->min_special > 0) {
-        size_t special_count = count_char_type(password, special_chars);
-        
-        while (special_count < options->min_special) {
-            for (size_t i = 0; i < length; i++) {
-                if (modifiable[i]) {
-                    password[i] = get_random_char_from_set(special_chars, 
-                                                          strlen(special_chars));
-                    modifiable[i] = 0;
-                    special_count++;
+                if (pick-- == 0) {
+                    if (!random_sampler_pick(sampler, charset->class_chars[cls],
+                                             charset->class_size[cls], &password[i])) {
+                        return REPAIR_RANDOM_FAILURE;
+                    }
+                    counts[old_cls]--;
+                    counts[cls]++;
+                    fixed[i] = 1;
                     break;
                 }
             }
         }
     }
     
-    free(modifiable);
+    return REPAIR_DONE;
 }
 
 /**
  * @brief Generate password from pattern
  * 
- * Pattern format: "llUnss" where:
- * l = lowercase, U = uppercase, n = number, s = special
+ * The pattern is compiled on every call; compile it once with
+ * compile_pattern() when generating many passwords.
  */
 PasswordResult generate_password_from_pattern(const char *pattern) {
     PasswordResult result = {0};
     
-    if (!pattern || strlen(pattern) == 0) {
-        result.strength = "Invalid pattern";
+    CompiledPattern compiled;
+    if (!compile_pattern(pattern, &compiled)) {
+        result.strength = compiled.error;
         return result;
     }
     
-    size_t length = strlen(pattern);
-    result.password = (char *)calloc(length + 1, sizeof(char));
-    if (!result.password) {
-        result.strength = "Memory error";
-        return result;
-    }
-    
-    result.length = length;
-    
-    for (size_t i = 0; i < length; i++) {
-        char pattern_char = pattern[i];
-        char generated_char = '\0';
-        
-        switch (pattern_char) {
-            case 'l':  /* lowercase */
-                generated_char = get_random_char_from_set(lowercase_chars, 
-                                                         strlen(lowercase_chars));
-                break;
-                
-            case 'U':  /* uppercase */
-                generated_char = get_random_char_from_set(uppercase_chars, 
-                                                         strlen(uppercase_chars));
-                break;
-                
-            case 'n':  /* number */
-                generated_char = get_random_char_from_set(number_chars, 
-                                                         strlen(number_chars));
-                break;
-                
-            case 's':  /* special */
-                generated_char = get_random_char_from_set(special_chars, 
-                                                         strlen(special_chars));
-                break;
-                
-            default:
-                /* Invalid pattern character */
-                free_password_result(&result);
-                result.strength = "Invalid pattern character";
-                return result;
-        }
-        
-        if (generated_char == '\0') {
-            free_password_result(&result);
-            result.strength = "Failed to generate character";
-            return result;
-        }
-        
-        result.password[i] = generated_char;
-    }
-    
-    result.password[length] = '\0';
-    
-    /* Calculate metadata */
-    PasswordOptions options = password_options_init();
-    options.length = length;
-    
-    /* Determine character sets from pattern */
-    options.charset.lowercase = (strchr(pattern, 'l') != NULL);
-    options.charset.uppercase = (strchr(pattern, 'U') != NULL);
-    options.charset.numbers = (strchr(pattern, 'n') != NULL);
-    options.charset.special = (strchr(pattern, 's') != NULL);
-    
-    result.entropy = calculate_entropy(result.password, &options);
-    result.strength_score = (int)((result.entropy / 128.0) * 100);
-    if (result.strength_score > 100) result.strength_score = 100;
-    if (result.strength_score < 0) result.strength_score = 0;
-    
-    result.strength = get_strength_category(result.strength_score);
+    RandomSampler sampler;
+    random_sampler_init(&sampler);
+    result = generate_pattern_compiled(&compiled, &sampler);
+    random_sampler_wipe(&sampler);
     
     return result;
 }
\ No newline at end of file
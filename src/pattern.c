@@ -0,0 +1,617 @@
+/**
+ * @file pattern.c
+ * @brief Compiled password templates implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "pattern.h"
+#include "crypto.h"
+#include "parallel.h"
+#include "stats.h"
+#include "utils.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Printable ASCII range accepted in templates */
+#define PATTERN_FIRST_PRINTABLE 0x20
+#define PATTERN_LAST_PRINTABLE 0x7E
+
+/**
+ * @brief Compiler state for the item a {N} repeat applies to
+ */
+typedef struct {
+    bool present;       /**< An item precedes the current position */
+    bool repeated;      /**< The item already has a repeat count */
+    bool literal;       /**< The item is a literal character */
+    char character;     /**< Literal character */
+    uint16_t offset;    /**< Alphabet offset of a class item */
+    uint16_t size;      /**< Alphabet size of a class item */
+} PatternItem;
+
+/**
+ * @brief Record a compile error
+ */
+static bool pattern_fail(CompiledPattern *compiled, const char *error, size_t offset) {
+    compiled->error = error;
+    compiled->error_offset = offset;
+    return false;
+}
+
+/**
+ * @brief Check that count more characters fit in the output
+ */
+static bool pattern_reserve(CompiledPattern *compiled, size_t count, size_t position) {
+    if (count > PATTERN_MAX_LENGTH - compiled->length) {
+        return pattern_fail(compiled, "Pattern produces too many characters", position);
+    }
+    return true;
+}
+
+/**
+ * @brief Append literal characters, extending the previous literal run
+ */
+static bool emit_literal(CompiledPattern *compiled, char character, size_t count,
+                         size_t position) {
+    if (!pattern_reserve(compiled, count, position)) {
+        return false;
+    }
+    if (count > PATTERN_POOL_SIZE - compiled->pool_used) {
+        return pattern_fail(compiled, "Pattern is too complex", position);
+    }
+    
+    PatternOp *last = compiled->op_count > 0 ? &compiled->ops[compiled->op_count - 1] : NULL;
+    
+    if (!last || last->size != 0 || last->offset + last->repeat != compiled->pool_used) {
+        if (compiled->op_count >= PATTERN_MAX_OPS) {
+            return pattern_fail(compiled, "Pattern is too complex", position);
+        }
+        last = &compiled->ops[compiled->op_count++];
+        last->offset = (uint16_t)compiled->pool_used;
+        last->size = 0;
+        last->repeat = 0;
+    }
+    
+    memset(compiled->pool + compiled->pool_used, character, count);
+    compiled->pool_used += count;
+    last->repeat = (uint16_t)(last->repeat + count);
+    compiled->length += count;
+    return true;
+}
+
+/**
+ * @brief Append random characters, extending a previous run of the same class
+ */
+static bool emit_class(CompiledPattern *compiled, uint16_t offset, uint16_t size,
+                       size_t count, size_t position) {
+    if (!pattern_reserve(compiled, count, position)) {
+        return false;
+    }
+    
+    PatternOp *last = compiled->op_count > 0 ? &compiled->ops[compiled->op_count - 1] : NULL;
+    
+    if (!last || last->size != size || last->offset != offset) {
+        if (compiled->op_count >= PATTERN_MAX_OPS) {
+            return pattern_fail(compiled, "Pattern is too complex", position);
+        }
+        last = &compiled->ops[compiled->op_count++];
+        last->offset = offset;
+        last->size = size;
+        last->repeat = 0;
+    }
+    
+    last->repeat = (uint16_t)(last->repeat + count);
+    compiled->length += count;
+    return true;
+}
+
+/**
+ * @brief Store an alphabet in the pool, reusing an identical one
+ */
+static bool intern_alphabet(CompiledPattern *compiled, const char *chars, size_t size,
+                            uint16_t *offset, size_t position) {
+    for (size_t i = 0; i < compiled->op_count; i++) {
+        const PatternOp *op = &compiled->ops[i];
+        if (op->size == size && memcmp(compiled->pool + op->offset, chars, size) == 0) {
+            *offset = op->offset;
+            return true;
+        }
+    }
+    
+    if (size > PATTERN_POOL_SIZE - compiled->pool_used) {
+        return pattern_fail(compiled, "Pattern is too complex", position);
+    }
+    
+    *offset = (uint16_t)compiled->pool_used;
+    memcpy(compiled->pool + compiled->pool_used, chars, size);
+    compiled->pool_used += size;
+    return true;
+}
+
+/**
+ * @brief Check for a character allowed in templates
+ */
+static bool is_pattern_printable(char character) {
+    unsigned char value = (unsigned char)character;
+    return value >= PATTERN_FIRST_PRINTABLE && value <= PATTERN_LAST_PRINTABLE;
+}
+
+/**
+ * @brief Read one class member, handling escapes
+ */
+static bool read_class_char(CompiledPattern *compiled, const char *pattern, size_t *position,
+                            char *character) {
+    if (pattern[*position] == '\\') {
+        (*position)++;
+    }
+    if (pattern[*position] == '\0') {
+        return pattern_fail(compiled, "Unterminated character class", *position);
+    }
+    if (!is_pattern_printable(pattern[*position])) {
+        return pattern_fail(compiled, "Non-printable character in pattern", *position);
+    }
+    
+    *character = pattern[(*position)++];
+    return true;
+}
+
+/**
+ * @brief Parse a [...] class into a sorted, duplicate-free alphabet
+ * @return Alphabet size, or 0 on error
+ */
+static size_t parse_class(CompiledPattern *compiled, const char *pattern, size_t *position,
+                          char alphabet[PATTERN_LAST_PRINTABLE + 1]) {
+    bool member[PATTERN_LAST_PRINTABLE + 1] = {false};
+    size_t start = *position;
+    bool negate = false;
+    
+    (*position)++;
+    if (pattern[*position] == '^') {
+        negate = true;
+        (*position)++;
+    }
+    
+    while (pattern[*position] != ']') {
+        char low, high;
+        
+        if (!read_class_char(compiled, pattern, position, &low)) {
+            return 0;
+        }
+        high = low;
+        
+        /* A '-' before the closing bracket is a member, not a range */
+        if (pattern[*position] == '-' && pattern[*position + 1] != ']' &&
+            pattern[*position + 1] != '\0') {
+            size_t range_start = *position;
+            (*position)++;
+            if (!read_class_char(compiled, pattern, position, &high)) {
+                return 0;
+            }
+            if (high < low) {
+                pattern_fail(compiled, "Reversed range in character class", range_start);
+                return 0;
+            }
+        }
+        
+        for (int c = low; c <= high; c++) {
+            member[c] = true;
+        }
+    }
+    (*position)++;
+    
+    /* Negated classes never include the space */
+    size_t size = 0;
+    for (int c = PATTERN_FIRST_PRINTABLE; c <= PATTERN_LAST_PRINTABLE; c++) {
+        bool include = negate ? (c != ' ' && !member[c]) : member[c];
+        if (include) {
+            alphabet[size++] = (char)c;
+        }
+    }
+    
+    if (size == 0) {
+        pattern_fail(compiled, "Empty character class", start);
+    }
+    return size;
+}
+
+/**
+ * @brief Parse a {N} repeat count
+ */
+static bool parse_repeat(CompiledPattern *compiled, const char *pattern, size_t *position,
+                         size_t *count) {
+    size_t start = *position;
+    size_t value = 0;
+    
+    (*position)++;
+    if (pattern[*position] < '0' || pattern[*position] > '9') {
+        return pattern_fail(compiled, "Expected a number after '{'", *position);
+    }
+    
+    while (pattern[*position] >= '0' && pattern[*position] <= '9') {
+        value = value * 10 + (size_t)(pattern[*position] - '0');
+        if (value > PATTERN_MAX_LENGTH) {
+            return pattern_fail(compiled, "Pattern produces too many characters", start);
+        }
+        (*position)++;
+    }
+    
+    if (pattern[*position] != '}') {
+        return pattern_fail(compiled, "Expected '}'", *position);
+    }
+    (*position)++;
+    
+    if (value == 0) {
+        return pattern_fail(compiled, "Repeat count must be at least 1", start);
+    }
+    
+    *count = value;
+    return true;
+}
+
+/**
+ * @brief Get the built-in alphabet of a class letter
+ */
+static const char *builtin_alphabet(char letter) {
+    switch (letter) {
+        case 'l':
+            return CHARSET_LOWERCASE;
+        case 'U':
+            return CHARSET_UPPERCASE;
+        case 'n':
+            return CHARSET_NUMBERS;
+        case 's':
+            return CHARSET_SPECIAL;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Compile a template
+ */
+bool compile_pattern(const char *pattern, CompiledPattern *compiled) {
+    if (!compiled) {
+        return false;
+    }
+    
+    memset(compiled, 0, sizeof(CompiledPattern));
+    
+    if (!pattern || pattern[0] == '\0') {
+        return pattern_fail(compiled, "Empty pattern", 0);
+    }
+    
+    PatternItem item = {0};
+    size_t position = 0;
+    
+    while (pattern[position] != '\0') {
+        size_t start = position;
+        char current = pattern[position];
+        
+        if (current == '{') {
+            size_t count;
+            if (!item.present) {
+                return pattern_fail(compiled, "Repeat count without an item to repeat", start);
+            }
+            if (item.repeated) {
+                return pattern_fail(compiled, "Item already has a repeat count", start);
+            }
+            if (!parse_repeat(compiled, pattern, &position, &count)) {
+                return false;
+            }
+            
+            /* The item itself was already emitted once */
+            if (count > 1) {
+                bool emitted = item.literal ?
+                    emit_literal(compiled, item.character, count - 1, start) :
+                    emit_class(compiled, item.offset, item.size, count - 1, start);
+                if (!emitted) {
+                    return false;
+                }
+            }
+            item.repeated = true;
+            continue;
+        }
+        
+        char alphabet[PATTERN_LAST_PRINTABLE + 1];
+        size_t size = 0;
+        const char *builtin = builtin_alphabet(current);
+        
+        if (builtin) {
+            size = strlen(builtin);
+            memcpy(alphabet, builtin, size);
+            position++;
+        } else if (current == '[') {
+            size = parse_class(compiled, pattern, &position, alphabet);
+            if (size == 0) {
+                return false;
+            }
+        } else if (current == '\\') {
+            position++;
+            if (pattern[position] == '\0' || !is_pattern_printable(pattern[position])) {
+                return pattern_fail(compiled, "Expected a character after '\\'", position);
+            }
+            alphabet[0] = pattern[position++];
+            size = 1;
+        } else if (current == ']' || current == '}') {
+            return pattern_fail(compiled, "Unmatched bracket (escape it with '\\')", start);
+        } else if ((current >= 'a' && current <= 'z') || (current >= 'A' && current <= 'Z') ||
+                   (current >= '0' && current <= '9')) {
+            return pattern_fail(compiled, "Unknown class letter (escape literals with '\\')", start);
+        } else if (!is_pattern_printable(current)) {
+            return pattern_fail(compiled, "Non-printable character in pattern", start);
+        } else {
+            alphabet[0] = current;
+            size = 1;
+            position++;
+        }
+        
+        /* A one-character class is a literal */
+        memset(&item, 0, sizeof(item));
+        item.present = true;
+        
+        if (size == 1) {
+            item.literal = true;
+            item.character = alphabet[0];
+            if (!emit_literal(compiled, item.character, 1, start)) {
+                return false;
+            }
+        } else {
+            item.size = (uint16_t)size;
+            if (!intern_alphabet(compiled, alphabet, size, &item.offset, start) ||
+                !emit_class(compiled, item.offset, item.size, 1, start)) {
+                return false;
+            }
+        }
+    }
+    
+    /* Exact entropy: every random run is an independent uniform draw */
+    double entropy = 0.0;
+    for (size_t i = 0; i < compiled->op_count; i++) {
+        const PatternOp *op = &compiled->ops[i];
+        if (op->size > 0) {
+            entropy += (double)op->repeat * log2((double)op->size);
+        }
+    }
+    
+    compiled->entropy = entropy;
+    compiled->strength_score = (int)((entropy / 128.0) * 100);
+    if (compiled->strength_score > 100) compiled->strength_score = 100;
+    if (compiled->strength_score < 0) compiled->strength_score = 0;
+    
+    return true;
+}
+
+/**
+ * @brief Generate a password from a compiled template into a caller-supplied buffer
+ */
+bool generate_pattern_into(const CompiledPattern *pattern, RandomSampler *sampler,
+                           char *buffer, PasswordResult *result) {
+    if (!result) {
+        return false;
+    }
+    
+    memset(result, 0, sizeof(PasswordResult));
+    
+    if (!pattern || pattern->error || pattern->length == 0 || !sampler || !buffer) {
+        result->strength = "Invalid pattern";
+        return false;
+    }
+    
+    StatsTimer timer = stats_begin();
+    char *out = buffer;
+    
+    for (size_t i = 0; i < pattern->op_count; i++) {
+        const PatternOp *op = &pattern->ops[i];
+        
+        if (op->size == 0) {
+            memcpy(out, pattern->pool + op->offset, op->repeat);
+        } else if (!random_sampler_fill(sampler, pattern->pool + op->offset, op->size,
+                                        out, op->repeat)) {
+            stats_end(STATS_SAMPLING, &timer, 0);
+            secure_clear(buffer, pattern->length);
+            result->strength = "Failed to generate character";
+            return false;
+        }
+        out += op->repeat;
+    }
+    
+    stats_end(STATS_SAMPLING, &timer, 0);
+    buffer[pattern->length] = '\0';
+    
+    result->password = buffer;
+    result->length = pattern->length;
+    result->entropy = pattern->entropy;
+    result->strength_score = pattern->strength_score;
+    result->strength = get_strength_category(pattern->strength_score);
+    
+    return true;
+}
+
+/**
+ * @brief Generate a password from a compiled template that passes a run's uniqueness checks
+ */
+bool generate_pattern_fresh(const CompiledPattern *pattern, RandomSampler *sampler,
+                            const PasswordOptions *policy, char *buffer,
+                            PasswordResult *result, GenerationStats *stats) {
+    GenerationStats local = {0};
+    if (!stats) {
+        stats = &local;
+    }
+    
+    size_t budget = 1;
+    if (policy) {
+        budget = policy->max_attempts > 0 ? policy->max_attempts : DEFAULT_MAX_ATTEMPTS;
+    }
+    
+    for (size_t attempt = 0; attempt < budget; attempt++) {
+        stats->candidates++;
+        if (!generate_pattern_into(pattern, sampler, buffer, result)) {
+            return false;
+        }
+        
+        if (!policy || password_is_fresh(policy, buffer, result->length, stats)) {
+            stats->generated++;
+            return true;
+        }
+    }
+    
+    stats->failures++;
+    secure_clear(buffer, pattern->length);
+    memset(result, 0, sizeof(PasswordResult));
+    result->strength = "Policy rejected every candidate";
+    return false;
+}
+
+/**
+ * @brief Generate a password from a compiled template
+ */
+PasswordResult generate_pattern_compiled(const CompiledPattern *pattern, RandomSampler *sampler) {
+    PasswordResult result = {0};
+    
+    if (!pattern || pattern->error || pattern->length == 0) {
+        result.strength = "Invalid pattern";
+        return result;
+    }
+    
+    char *password = (char *)calloc(pattern->length + 1, sizeof(char));
+    if (!password) {
+        result.strength = "Memory error";
+        return result;
+    }
+    
+    if (!generate_pattern_into(pattern, sampler, password, &result)) {
+        free(password);
+    }
+    
+    return result;
+}
+
+/**
+ * @brief Shared description of a parallel template job
+ */
+typedef struct {
+    const CompiledPattern *pattern;
+    PasswordBatch *batch;
+    size_t count;
+    const PasswordOptions *policy;
+    size_t *generated;      /**< Passwords generated by each worker */
+    GenerationStats *stats; /**< Counters of each worker */
+} PatternJob;
+
+/**
+ * @brief First batch index owned by a worker
+ */
+static size_t pattern_range_begin(size_t count, size_t index, size_t workers) {
+    size_t share = count / workers;
+    size_t extra = count % workers;
+    return index * share + (index < extra ? index : extra);
+}
+
+/**
+ * @brief Fill one contiguous share of a template batch
+ */
+static void pattern_worker(void *context, size_t index, size_t workers) {
+    PatternJob *job = (PatternJob *)context;
+    PasswordBatch *batch = job->batch;
+    size_t begin = pattern_range_begin(job->count, index, workers);
+    size_t end = pattern_range_begin(job->count, index + 1, workers);
+    uint8_t level = get_strength_level(job->pattern->strength_score);
+    
+    job->generated[index] = 0;
+    
+    /* Private stream: no locks taken while generating */
+    ChaChaDrbg drbg;
+    if (!chacha_drbg_seed(&drbg)) {
+        return;
+    }
+    
+    RandomSampler sampler;
+    random_sampler_init_source(&sampler, chacha_drbg_fill, &drbg);
+    
+    for (size_t i = begin; i < end; i++) {
+        PasswordResult result;
+        if (!generate_pattern_fresh(job->pattern, &sampler, job->policy,
+                                    batch->chars + i * batch->stride, &result,
+                                    &job->stats[index])) {
+            break;
+        }
+        batch->lengths[i] = (uint16_t)result.length;
+        batch->entropy[i] = result.entropy;
+        batch->scores[i] = (uint8_t)result.strength_score;
+        batch->levels[i] = level;
+        job->generated[index]++;
+    }
+    
+    random_sampler_wipe(&sampler);
+    chacha_drbg_wipe(&drbg);
+}
+
+/**
+ * @brief Fill a batch with passwords from a compiled template
+ */
+size_t pattern_batch_generate(PasswordBatch *batch, const CompiledPattern *pattern,
+                              size_t count, size_t threads, const PasswordOptions *policy,
+                              GenerationStats *stats) {
+    if (!batch || !batch->chars || !pattern || pattern->error || pattern->length == 0 ||
+        count == 0 || count > batch->capacity || pattern->length >= batch->stride) {
+        return 0;
+    }
+    
+    password_batch_clear(batch);
+    
+    if (threads == 0) {
+        threads = parallel_cpu_count();
+    }
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    
+    /* Small batches are not worth the thread start-up cost */
+    size_t useful = (count + BULK_MIN_PER_THREAD - 1) / BULK_MIN_PER_THREAD;
+    if (threads > useful) {
+        threads = useful;
+    }
+    
+    size_t *generated = (size_t *)calloc(threads, sizeof(size_t));
+    GenerationStats *worker_stats = (GenerationStats *)calloc(threads, sizeof(GenerationStats));
+    if (!generated || !worker_stats) {
+        free(generated);
+        free(worker_stats);
+        return 0;
+    }
+    
+    PatternJob job = { pattern, batch, count, policy, generated, worker_stats };
+    
+    if (!parallel_run(threads, pattern_worker, &job)) {
+        free(generated);
+        free(worker_stats);
+        return 0;
+    }
+    
+    for (size_t i = 0; stats && i < threads; i++) {
+        generation_stats_merge(stats, &worker_stats[i]);
+    }
+    free(worker_stats);
+    
+    /* Keep the leading run of complete shares, wipe anything after a gap */
+    size_t successful = 0;
+    bool complete = true;
+    
+    for (size_t i = 0; i < threads; i++) {
+        size_t begin = pattern_range_begin(count, i, threads);
+        size_t share = pattern_range_begin(count, i + 1, threads) - begin;
+        
+        if (complete) {
+            successful += generated[i];
+            complete = generated[i] == share;
+        } else {
+            secure_clear(batch->chars + begin * batch->stride, generated[i] * batch->stride);
+        }
+    }
+    
+    free(generated);
+    batch->count = successful;
+    return successful;
+}
\ No newline at end of file
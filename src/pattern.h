@@ -0,0 +1,122 @@
+/**
+ * @file pattern.h
+ * @brief Compiled password templates
+ * @version 1.0
+ * @date 2024
+ *
+ * Template syntax:
+ *   l U n s    one lowercase, uppercase, number or special character
+ *   [a-f0-9]   one character from a custom class ([^...] = any printable
+ *              character except those listed)
+ *   {N}        repeat the previous item N times in total
+ *   \c         the literal character c
+ *   other      punctuation and spaces are copied literally; other letters
+ *              and digits are rejected so typos are not silently kept
+ *
+ * "U{4}-U{4}-n{4}" compiles to three random runs and two literals.
+ */
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "password.h"
+#include "sampler.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Template limits
+ */
+#define PATTERN_MAX_LENGTH MAX_PASSWORD_LENGTH  /**< Characters one template may produce */
+#define PATTERN_MAX_OPS 64                      /**< Runs after merging */
+#define PATTERN_POOL_SIZE 1024                  /**< Bytes of alphabets and literal text */
+
+/**
+ * @brief One run of a compiled template
+ *
+ * A run with size 0 copies repeat bytes of literal text from the pool;
+ * otherwise it draws repeat characters uniformly from the size-byte
+ * alphabet at the same offset.
+ */
+typedef struct {
+    uint16_t offset;    /**< Alphabet or literal text in the pool */
+    uint16_t size;      /**< Alphabet size (0 = literal) */
+    uint16_t repeat;    /**< Characters produced */
+} PatternOp;
+
+/**
+ * @brief Compiled template
+ */
+typedef struct {
+    PatternOp ops[PATTERN_MAX_OPS]; /**< Runs in output order */
+    size_t op_count;                /**< Number of runs */
+    char pool[PATTERN_POOL_SIZE];   /**< Alphabets and literal text */
+    size_t pool_used;               /**< Bytes of pool in use */
+    size_t length;                  /**< Characters produced */
+    double entropy;                 /**< Exact entropy in bits */
+    int strength_score;             /**< Strength score (0-100) */
+    const char *error;              /**< Why compiling failed (NULL on success) */
+    size_t error_offset;            /**< Pattern offset of the error */
+} CompiledPattern;
+
+/**
+ * @brief Compile a template
+ * @param pattern Template string
+ * @param compiled Pointer to store the compiled template
+ * @return true if successful, false otherwise (see compiled->error)
+ */
+bool compile_pattern(const char *pattern, CompiledPattern *compiled);
+
+/**
+ * @brief Generate a password from a compiled template into a caller-supplied buffer
+ * @param pattern Compiled template
+ * @param sampler Random sampler to draw from
+ * @param buffer Output buffer of at least pattern->length + 1 bytes
+ * @param result Pointer to store the result; result->password points into buffer
+ * @return true if successful, false otherwise
+ */
+bool generate_pattern_into(const CompiledPattern *pattern, RandomSampler *sampler,
+                           char *buffer, PasswordResult *result);
+
+/**
+ * @brief Generate a password from a compiled template that passes a run's uniqueness checks
+ * @param pattern Compiled template
+ * @param sampler Random sampler to draw from
+ * @param policy Options whose uniqueness sets apply (NULL = accept the first draw)
+ * @param buffer Output buffer of at least pattern->length + 1 bytes
+ * @param result Pointer to store the result; result->password points into buffer
+ * @param stats Counters to update (may be NULL)
+ * @return true if successful, false if the generator failed or policy->max_attempts
+ *         draws were all rejected
+ *
+ * Rejected draws are redrawn whole, so accepted passwords stay uniform
+ * over the template.
+ */
+bool generate_pattern_fresh(const CompiledPattern *pattern, RandomSampler *sampler,
+                            const PasswordOptions *policy, char *buffer,
+                            PasswordResult *result, GenerationStats *stats);
+
+/**
+ * @brief Generate a password from a compiled template
+ * @param pattern Compiled template
+ * @param sampler Random sampler to draw from
+ * @return PasswordResult (free with free_password_result()); password is NULL on error
+ */
+PasswordResult generate_pattern_compiled(const CompiledPattern *pattern, RandomSampler *sampler);
+
+/**
+ * @brief Fill a batch with passwords from a compiled template
+ * @param batch Batch created with a max_length of at least pattern->length
+ * @param pattern Compiled template
+ * @param count Number of passwords (at most the batch capacity)
+ * @param threads Worker threads (0 = one per CPU)
+ * @param policy Options whose uniqueness sets apply (may be NULL)
+ * @param stats Counters to add the run's totals to (may be NULL)
+ * @return Number of passwords generated (batch->count)
+ */
+size_t pattern_batch_generate(PasswordBatch *batch, const CompiledPattern *pattern,
+                              size_t count, size_t threads, const PasswordOptions *policy,
+                              GenerationStats *stats);
+
+#endif /* PATTERN_H */
\ No newline at end of file
@@ -8,13 +8,23 @@
 #ifndef PASSWORD_GENERATOR_H
 #define PASSWORD_GENERATOR_H
 
+#include "sampler.h"
+#include "utils.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define MIN_PASSWORD_LENGTH 8
 #define MAX_PASSWORD_LENGTH 128
 #define DEFAULT_PASSWORD_LENGTH 12
-#define MAX_BULK_GENERATE 100
+
+/* Upper bound on one bulk request; override with -DMAX_BULK_GENERATE=N */
+#ifndef MAX_BULK_GENERATE
+#define MAX_BULK_GENERATE 100000000
+#endif
+
+/* Minimum passwords per worker before another thread is started */
+#define BULK_MIN_PER_THREAD 256
 
 /**
  * @brief Character set configuration structure
@@ -27,6 +37,10 @@ typedef struct {
     bool avoid_ambiguous; /**< Avoid ambiguous characters (l, I, 1, O, 0) */
 } CharSetConfig;
 
+struct UniqueSet;
+struct NearDuplicateIndex;
+struct HistoryStore;
+
 /**
  * @brief Password generation options structure
  */
@@ -36,8 +50,83 @@ typedef struct {
     bool require_all_types;     /**< Require at least one of each selected type */
     size_t min_numbers;         /**< Minimum number of digits required */
     size_t min_special;         /**< Minimum number of special chars required */
+    bool reject_weak;           /**< Regenerate passwords containing weak patterns */
+    bool reject_dictionary;     /**< Regenerate passwords containing dictionary words */
+    size_t max_attempts;        /**< Candidates per password before falling back (0 = default) */
+    struct UniqueSet *unique;   /**< Reject repeats of passwords in this set, adding accepted ones (NULL = off) */
+    const struct NearDuplicateIndex *near_duplicates; /**< Reject passwords similar to an indexed one (NULL = off) */
+    const struct HistoryStore *history; /**< Reject passwords issued in an earlier run (NULL = off) */
+    unsigned metadata;          /**< PASSWORD_META_* fields to fill in results (default: all) */
 } PasswordOptions;
 
+/**
+ * @brief Result metadata fields (PasswordOptions.metadata)
+ *
+ * Fields left out are not computed: entropy stays 0, strength_score 0 and
+ * strength "Unknown", and batch levels are STRENGTH_LEVEL_UNKNOWN.
+ */
+#define PASSWORD_META_NONE 0x00
+#define PASSWORD_META_ENTROPY 0x01      /**< entropy */
+#define PASSWORD_META_STRENGTH 0x02     /**< strength_score and strength */
+#define PASSWORD_META_ALL (PASSWORD_META_ENTROPY | PASSWORD_META_STRENGTH)
+
+/**
+ * @brief Default candidate budget per password
+ */
+#define DEFAULT_MAX_ATTEMPTS 64
+
+/**
+ * @brief Counters describing how passwords were produced
+ */
+typedef struct {
+    uint64_t generated;             /**< Passwords accepted */
+    uint64_t candidates;            /**< Candidates drawn */
+    uint64_t rejected_requirements; /**< Candidates missing required classes */
+    uint64_t rejected_weak;         /**< Candidates with weak patterns */
+    uint64_t rejected_dictionary;   /**< Candidates with dictionary words */
+    uint64_t rejected_duplicates;   /**< Candidates already generated or listed */
+    uint64_t rejected_similar;      /**< Candidates close to an indexed password */
+    uint64_t rejected_history;      /**< Candidates issued in an earlier run */
+    uint64_t fallback_repairs;      /**< Passwords repaired after the budget ran out */
+    uint64_t failures;              /**< Passwords no candidate satisfied */
+} GenerationStats;
+
+/**
+ * @brief Character classes used for generation requirements
+ */
+typedef enum {
+    CHAR_CLASS_LOWER = 0,   /**< Lowercase letters */
+    CHAR_CLASS_UPPER,       /**< Uppercase letters */
+    CHAR_CLASS_NUMBER,      /**< Digits */
+    CHAR_CLASS_SPECIAL,     /**< Special characters */
+    CHAR_CLASS_COUNT
+} CharClass;
+
+#define CHAR_CLASS_NONE 0xFF        /**< class_of[] value for other bytes */
+#define CHARSET_ALPHABET_MAX 128    /**< Capacity of a compiled alphabet */
+#define CHARSET_CLASS_MAX 32        /**< Capacity of one class sub-alphabet */
+
+/**
+ * @brief Character set tables compiled once from PasswordOptions
+ *
+ * Built by compile_charset() and reused for every password generated
+ * with the same options.
+ */
+typedef struct {
+    char alphabet[CHARSET_ALPHABET_MAX];    /**< Flat alphabet of enabled classes */
+    size_t size;                            /**< Number of characters in alphabet */
+    char class_chars[CHAR_CLASS_COUNT][CHARSET_CLASS_MAX]; /**< Per-class sub-alphabets */
+    size_t class_size[CHAR_CLASS_COUNT];    /**< Characters per sub-alphabet */
+    unsigned char class_of[256];            /**< Byte to CharClass (or CHAR_CLASS_NONE) */
+    unsigned char alphabet_class[CHARSET_ALPHABET_MAX]; /**< CharClass of each alphabet entry */
+    size_t class_min[CHAR_CLASS_COUNT];     /**< Required count per class */
+    double bits_per_char;                   /**< log2(size) */
+    size_t metadata_length;                 /**< Password length the cached metadata is for */
+    double entropy;                         /**< Entropy of a metadata_length password */
+    int strength_score;                     /**< Score derived from entropy */
+    uint8_t strength_level;                 /**< Level derived from the score */
+} CompiledCharset;
+
 /**
  * @brief Password with metadata structure
  */
@@ -49,6 +138,32 @@ typedef struct {
     const char *strength;   /**< Strength category */
 } PasswordResult;
 
+/**
+ * @brief Strength level stored in PasswordBatch.levels for unscored entries
+ */
+#define STRENGTH_LEVEL_UNKNOWN 0xFF
+
+/**
+ * @brief Bulk password container backed by one secure arena
+ *
+ * Stored as parallel columns so batch passes (scoring, filtering, export)
+ * run over contiguous arrays. Password i occupies chars[i * stride] and is
+ * NUL-terminated. The whole arena is wiped once by password_batch_free();
+ * views returned by password_batch_view() must never be passed to
+ * free_password_result().
+ */
+typedef struct {
+    SecureArena arena;          /**< Backing memory for every column */
+    char *chars;                /**< capacity * stride bytes of password text */
+    size_t stride;              /**< Bytes per password (max length + 1) */
+    uint16_t *lengths;          /**< Password lengths */
+    double *entropy;            /**< Entropy in bits */
+    uint8_t *scores;            /**< Strength scores (0-100) */
+    uint8_t *levels;            /**< Strength levels (0-5 or STRENGTH_LEVEL_UNKNOWN) */
+    size_t capacity;            /**< Number of entries the batch can hold */
+    size_t count;               /**< Entries currently in use */
+} PasswordBatch;
+
 /**
  * @brief Initialize password generation options with default values
  * @return PasswordOptions with default settings
@@ -62,10 +177,77 @@ PasswordOptions password_options_init(void);
  */
 PasswordResult generate_password(const PasswordOptions *options);
 
+/**
+ * @brief Build character set tables for a set of options
+ * @param options Password generation options
+ * @param charset Pointer to store the compiled tables
+ * @return true if at least one character is available and the per-class
+ *         minimums fit in the length, false otherwise
+ */
+bool compile_charset(const PasswordOptions *options, CompiledCharset *charset);
+
+/**
+ * @brief Generate a password from precompiled character set tables
+ * @param options Validated password generation options
+ * @param charset Tables compiled from the same options
+ * @param sampler Random sampler to draw from
+ * @return PasswordResult containing the generated password and metadata
+ */
+PasswordResult generate_password_compiled(const PasswordOptions *options,
+                                          const CompiledCharset *charset,
+                                          RandomSampler *sampler);
+
+/**
+ * @brief Generate a password into a caller-supplied buffer
+ * @param options Validated password generation options
+ * @param charset Tables compiled from the same options
+ * @param sampler Random sampler to draw from
+ * @param buffer Buffer of at least options->length + 1 bytes
+ * @param result Pointer to store metadata (password points at buffer)
+ * @param stats Counters to update (may be NULL)
+ * @return true if successful, false otherwise
+ *
+ * Candidates are drawn uniformly and rejected until one meets the class
+ * requirements and the weak/dictionary filters, so accepted passwords are
+ * uniform over everything the policy allows. If max_attempts candidates
+ * all fail, the last one is repaired at random positions.
+ *
+ * The reported entropy is length * log2(charset size), an upper bound:
+ * the requirements and filters remove candidates, so the passwords that
+ * are actually accepted carry somewhat less.
+ */
+bool generate_password_into(const PasswordOptions *options,
+                            const CompiledCharset *charset,
+                            RandomSampler *sampler,
+                            char *buffer,
+                            PasswordResult *result,
+                            GenerationStats *stats);
+
+/**
+ * @brief Check a candidate against the uniqueness sets of a run
+ * @param options Options whose history, unique and near_duplicates sets apply
+ * @param password Candidate (not necessarily NUL-terminated)
+ * @param length Length of the candidate
+ * @param stats Counters to update (may be NULL)
+ * @return true if the candidate may be issued; it is then in options->unique
+ *
+ * Patterns and passphrases do not go through the weak/dictionary filters,
+ * but every generator calls this so --unique and --history hold in every mode.
+ */
+bool password_is_fresh(const PasswordOptions *options, const char *password,
+                       size_t length, GenerationStats *stats);
+
+/**
+ * @brief Add one set of generation counters to another
+ * @param total Counters to add to
+ * @param part Counters to add
+ */
+void generation_stats_merge(GenerationStats *total, const GenerationStats *part);
+
 /**
  * @brief Generate multiple passwords in bulk
  * @param options Password generation options
- * @param count Number of passwords to generate (1-100)
+ * @param count Number of passwords to generate (1-MAX_BULK_GENERATE)
  * @param results Array to store generated passwords
  * @return Number of passwords successfully generated
  */
@@ -73,6 +255,91 @@ size_t generate_bulk_passwords(const PasswordOptions *options,
                               size_t count, 
                               PasswordResult *results);
 
+/**
+ * @brief Generate multiple passwords in bulk on several threads
+ * @param options Password generation options
+ * @param count Number of passwords to generate (1-MAX_BULK_GENERATE)
+ * @param results Array to store generated passwords
+ * @param threads Number of worker threads (0 = one per processor)
+ * @param stats Counters to add to (may be NULL)
+ * @return Number of passwords successfully generated
+ *
+ * Each worker draws from its own ChaCha20 stream seeded from the system
+ * CSPRNG, so workers share no state while generating. As with
+ * generate_bulk_passwords(), results[0..return value) are valid and
+ * nothing past them needs freeing.
+ */
+size_t generate_bulk_passwords_parallel(const PasswordOptions *options,
+                                        size_t count,
+                                        PasswordResult *results,
+                                        size_t threads,
+                                        GenerationStats *stats);
+
+/**
+ * @brief Create an empty password batch
+ * @param batch Batch to initialize
+ * @param capacity Number of passwords the batch can hold
+ * @param max_length Longest password that will be stored
+ * @return true if successful, false otherwise
+ */
+bool password_batch_init(PasswordBatch *batch, size_t capacity, size_t max_length);
+
+/**
+ * @brief Fill a batch with generated passwords
+ * @param batch Initialized batch
+ * @param options Password generation options (length must fit the stride)
+ * @param count Number of passwords to generate (at most the capacity)
+ * @param threads Number of worker threads (0 = one per processor)
+ * @param stats Counters to add to (may be NULL)
+ * @return Number of passwords generated (also stored in batch->count)
+ */
+size_t password_batch_generate(PasswordBatch *batch, const PasswordOptions *options,
+                               size_t count, size_t threads, GenerationStats *stats);
+
+/**
+ * @brief Append a copy of a password to a batch
+ * @param batch Initialized batch
+ * @param password Password text
+ * @param length Password length (must fit the stride)
+ * @return true if stored, false if the batch is full or the password too long
+ */
+bool password_batch_append(PasswordBatch *batch, const char *password, size_t length);
+
+/**
+ * @brief Get a batch entry as a non-owning PasswordResult
+ * @param batch Password batch
+ * @param index Entry index (less than batch->count)
+ * @return PasswordResult whose password points into the batch
+ */
+PasswordResult password_batch_view(const PasswordBatch *batch, size_t index);
+
+/**
+ * @brief Compute average entropy and score over a batch
+ * @param batch Password batch
+ * @param avg_entropy Pointer to store average entropy (may be NULL)
+ * @param avg_score Pointer to store average score (may be NULL)
+ */
+void password_batch_summary(const PasswordBatch *batch, double *avg_entropy, int *avg_score);
+
+/**
+ * @brief Wipe every entry and reset a batch to empty
+ * @param batch Batch to clear
+ */
+void password_batch_clear(PasswordBatch *batch);
+
+/**
+ * @brief Wipe and release a password batch
+ * @param batch Batch to free
+ */
+void password_batch_free(PasswordBatch *batch);
+
+/**
+ * @brief Generate a password from a template
+ * @param pattern Template string (see pattern.h for the syntax)
+ * @return PasswordResult containing the generated password and metadata
+ */
+PasswordResult generate_password_from_pattern(const char *pattern);
+
 /**
  * @brief Validate password options
  * @param options Options to validate
@@ -88,6 +355,14 @@ bool validate_options(const PasswordOptions *options);
  */
 double calculate_entropy(const char *password, const PasswordOptions *options);
 
+/**
+ * @brief Calculate entropy of a password generated from compiled tables
+ * @param length Password length
+ * @param charset Compiled character set tables
+ * @return Entropy in bits
+ */
+double calculate_entropy_compiled(size_t length, const CompiledCharset *charset);
+
 /**
  * @brief Get strength category based on score
  * @param score Strength score (0-100)
@@ -95,6 +370,20 @@ double calculate_entropy(const char *password, const PasswordOptions *options);
  */
 const char *get_strength_category(int score);
 
+/**
+ * @brief Get strength level based on score
+ * @param score Strength score (0-100)
+ * @return Level from 0 (Very Weak) to 5 (Very Strong)
+ */
+uint8_t get_strength_level(int score);
+
+/**
+ * @brief Get string representation of a strength level
+ * @param level Strength level (0-5 or STRENGTH_LEVEL_UNKNOWN)
+ * @return Strength category string
+ */
+const char *get_strength_level_label(uint8_t level);
+
 /**
  * @brief Free memory allocated for PasswordResult
  * @param result PasswordResult to free
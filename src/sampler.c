@@ -0,0 +1,144 @@
+/**
+ * @file sampler.c
+ * @brief Unbiased random sampling from character sets implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "sampler.h"
+#include "stats.h"
+#include "utils.h"
+#include <string.h>
+
+/**
+ * @brief Default refill source: the shared CSPRNG pool
+ */
+static bool fill_from_system(void *context, unsigned char *buffer, size_t size) {
+    (void)context;
+    return get_random_bytes(buffer, size);
+}
+
+/**
+ * @brief Fetch the next 32 random bits, refilling the block when empty
+ */
+static bool next_u32(RandomSampler *sampler, uint32_t *value) {
+    if (sampler->position + 4 > RANDOM_SAMPLER_BLOCK_SIZE) {
+        StatsTimer timer = stats_begin();
+        bool filled = sampler->fill(sampler->context, sampler->block, 
+                                    RANDOM_SAMPLER_BLOCK_SIZE);
+        stats_end(STATS_RNG, &timer, RANDOM_SAMPLER_BLOCK_SIZE);
+        if (!filled) {
+            return false;
+        }
+        sampler->position = 0;
+    }
+    
+    const unsigned char *p = sampler->block + sampler->position;
+    *value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | 
+             ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    sampler->position += 4;
+    return true;
+}
+
+/**
+ * @brief Initialize sampler backed by get_random_bytes()
+ */
+void random_sampler_init(RandomSampler *sampler) {
+    random_sampler_init_source(sampler, fill_from_system, NULL);
+}
+
+/**
+ * @brief Initialize sampler backed by a custom random source
+ */
+void random_sampler_init_source(RandomSampler *sampler, RandomFillFunc fill, void *context) {
+    if (!sampler) {
+        return;
+    }
+    
+    sampler->position = RANDOM_SAMPLER_BLOCK_SIZE;  /* Empty until first draw */
+    sampler->fill = fill ? fill : fill_from_system;
+    sampler->context = fill ? context : NULL;
+}
+
+/**
+ * @brief Draw a uniformly distributed integer in [0, bound)
+ *
+ * Lemire's multiply-shift method: the high half of x * bound is the
+ * result, and the low half is rejected when it falls in the short
+ * range that would otherwise make some outcomes more likely.
+ */
+bool random_sampler_uniform(RandomSampler *sampler, uint32_t bound, uint32_t *value) {
+    if (!sampler || !value || bound == 0) {
+        return false;
+    }
+    
+    uint32_t x;
+    if (!next_u32(sampler, &x)) {
+        return false;
+    }
+    
+    uint64_t m = (uint64_t)x * bound;
+    uint32_t low = (uint32_t)m;
+    
+    if (low < bound) {
+        uint32_t threshold = (uint32_t)(-bound) % bound;
+        while (low < threshold) {
+            if (!next_u32(sampler, &x)) {
+                return false;
+            }
+            m = (uint64_t)x * bound;
+            low = (uint32_t)m;
+        }
+    }
+    
+    *value = (uint32_t)(m >> 32);
+    return true;
+}
+
+/**
+ * @brief Pick one character uniformly from an alphabet
+ */
+bool random_sampler_pick(RandomSampler *sampler, const char *alphabet, 
+                         size_t alphabet_size, char *out) {
+    if (!alphabet || !out || alphabet_size == 0 || alphabet_size > UINT32_MAX) {
+        return false;
+    }
+    
+    uint32_t index;
+    if (!random_sampler_uniform(sampler, (uint32_t)alphabet_size, &index)) {
+        return false;
+    }
+    
+    *out = alphabet[index];
+    return true;
+}
+
+/**
+ * @brief Fill a buffer with characters drawn uniformly from an alphabet
+ */
+bool random_sampler_fill(RandomSampler *sampler, const char *alphabet, 
+                         size_t alphabet_size, char *out, size_t count) {
+    if (!alphabet || !out || alphabet_size == 0 || alphabet_size > UINT32_MAX) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        uint32_t index;
+        if (!random_sampler_uniform(sampler, (uint32_t)alphabet_size, &index)) {
+            return false;
+        }
+        out[i] = alphabet[index];
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Wipe buffered random bytes
+ */
+void random_sampler_wipe(RandomSampler *sampler) {
+    if (sampler) {
+        secure_clear(sampler->block, sizeof(sampler->block));
+        sampler->position = RANDOM_SAMPLER_BLOCK_SIZE;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**
+ * @file sampler.h
+ * @brief Unbiased random sampling from character sets
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Bytes pulled from the random source per refill
+ *
+ * Large enough to cover a maximum-length password (4 bytes per draw)
+ * in a single request.
+ */
+#define RANDOM_SAMPLER_BLOCK_SIZE 512
+
+/**
+ * @brief Random byte source used to refill a sampler
+ * @param context Source-specific state
+ * @param buffer Buffer to fill
+ * @param size Number of bytes to generate
+ * @return true if successful, false otherwise
+ */
+typedef bool (*RandomFillFunc)(void *context, unsigned char *buffer, size_t size);
+
+/**
+ * @brief Buffered sampler state
+ */
+typedef struct {
+    unsigned char block[RANDOM_SAMPLER_BLOCK_SIZE]; /**< Buffered random bytes */
+    size_t position;            /**< Next unused byte in block */
+    RandomFillFunc fill;        /**< Refill source */
+    void *context;              /**< Refill source state */
+} RandomSampler;
+
+/**
+ * @brief Initialize sampler backed by get_random_bytes()
+ * @param sampler Sampler to initialize
+ */
+void random_sampler_init(RandomSampler *sampler);
+
+/**
+ * @brief Initialize sampler backed by a custom random source
+ * @param sampler Sampler to initialize
+ * @param fill Refill function
+ * @param context Refill function state
+ */
+void random_sampler_init_source(RandomSampler *sampler, RandomFillFunc fill, void *context);
+
+/**
+ * @brief Draw a uniformly distributed integer in [0, bound)
+ * @param sampler Sampler to draw from
+ * @param bound Exclusive upper bound (must be > 0)
+ * @param value Pointer to store the result
+ * @return true if successful, false if the random source failed
+ */
+bool random_sampler_uniform(RandomSampler *sampler, uint32_t bound, uint32_t *value);
+
+/**
+ * @brief Pick one character uniformly from an alphabet
+ * @param sampler Sampler to draw from
+ * @param alphabet Characters to choose from
+ * @param alphabet_size Number of characters in alphabet
+ * @param out Pointer to store the character
+ * @return true if successful, false otherwise
+ */
+bool random_sampler_pick(RandomSampler *sampler, const char *alphabet, 
+                         size_t alphabet_size, char *out);
+
+/**
+ * @brief Fill a buffer with characters drawn uniformly from an alphabet
+ * @param sampler Sampler to draw from
+ * @param alphabet Characters to choose from
+ * @param alphabet_size Number of characters in alphabet
+ * @param out Buffer to fill (not NUL-terminated)
+ * @param count Number of characters to generate
+ * @return true if successful, false otherwise
+ */
+bool random_sampler_fill(RandomSampler *sampler, const char *alphabet, 
+                         size_t alphabet_size, char *out, size_t count);
+
+/**
+ * @brief Wipe buffered random bytes
+ * @param sampler Sampler to wipe
+ */
+void random_sampler_wipe(RandomSampler *sampler);
+
+#endif /* SAMPLER_H */
\ No newline at end of file
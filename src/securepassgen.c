@@ -0,0 +1,340 @@
+/**
+ * @file securepassgen.c
+ * @brief Embeddable password generation API implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "securepassgen.h"
+#include "password.h"
+#include "security.h"
+#include "sampler.h"
+#include "crypto.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+
+/* Marks a live context so stale or foreign handles are refused */
+#define SPG_CONTEXT_MAGIC 0x53504743u
+
+/**
+ * @brief Generator context
+ */
+struct SpgContext {
+    uint32_t magic;
+    bool owned;                 /* Allocated by spg_context_create() */
+    PasswordOptions options;
+    CompiledCharset charset;
+    ChaChaDrbg drbg;
+    RandomSampler sampler;
+#ifndef _WIN32
+    pid_t pid;                  /* Process the DRBG was seeded in */
+#endif
+};
+
+/**
+ * @brief Fill a policy with the library defaults
+ */
+void spg_policy_init(SpgPolicy *policy) {
+    if (!policy) {
+        return;
+    }
+    
+    PasswordOptions defaults = password_options_init();
+    
+    memset(policy, 0, sizeof(SpgPolicy));
+    policy->length = defaults.length;
+    policy->classes = SPG_CLASS_ALL;
+    policy->require_all = defaults.require_all_types;
+    policy->avoid_ambiguous = defaults.charset.avoid_ambiguous;
+    policy->min_numbers = defaults.min_numbers;
+    policy->min_special = defaults.min_special;
+    policy->reject_weak = defaults.reject_weak;
+    policy->reject_dictionary = defaults.reject_dictionary;
+    policy->max_attempts = defaults.max_attempts;
+}
+
+/**
+ * @brief Translate a public policy into generator options and tables
+ */
+static SpgStatus compile_policy(const SpgPolicy *policy, PasswordOptions *options,
+                                CompiledCharset *charset) {
+    SpgPolicy defaults;
+    if (!policy) {
+        spg_policy_init(&defaults);
+        policy = &defaults;
+    }
+    
+    *options = password_options_init();
+    options->length = policy->length;
+    options->charset.lowercase = (policy->classes & SPG_CLASS_LOWER) != 0;
+    options->charset.uppercase = (policy->classes & SPG_CLASS_UPPER) != 0;
+    options->charset.numbers = (policy->classes & SPG_CLASS_NUMBER) != 0;
+    options->charset.special = (policy->classes & SPG_CLASS_SPECIAL) != 0;
+    options->charset.avoid_ambiguous = policy->avoid_ambiguous;
+    options->require_all_types = policy->require_all;
+    options->min_numbers = options->charset.numbers ? policy->min_numbers : 0;
+    options->min_special = options->charset.special ? policy->min_special : 0;
+    options->reject_weak = policy->reject_weak;
+    options->reject_dictionary = policy->reject_dictionary;
+    options->max_attempts = policy->max_attempts;
+    
+    if (!validate_options(options) || !compile_charset(options, charset)) {
+        return SPG_ERROR_INVALID_POLICY;
+    }
+    return SPG_OK;
+}
+
+/**
+ * @brief Check a context handle
+ */
+static bool context_valid(const SpgContext *context) {
+    return context && context->magic == SPG_CONTEXT_MAGIC;
+}
+
+/**
+ * @brief Seed (or after fork() reseed) the context generator
+ */
+static bool context_seed(SpgContext *context) {
+    if (!chacha_drbg_seed(&context->drbg)) {
+        return false;
+    }
+    random_sampler_init_source(&context->sampler, chacha_drbg_fill, &context->drbg);
+#ifndef _WIN32
+    context->pid = getpid();
+#endif
+    return true;
+}
+
+/**
+ * @brief Get the number of bytes a context needs
+ */
+size_t spg_context_size(void) {
+    return sizeof(SpgContext);
+}
+
+/**
+ * @brief Create a context in caller-provided memory
+ */
+SpgStatus spg_context_init(void *memory, size_t size, const SpgPolicy *policy,
+                           SpgContext **context) {
+    if (!memory || !context || size < sizeof(SpgContext) ||
+        (uintptr_t)memory % _Alignof(max_align_t) != 0) {
+        return SPG_ERROR_INVALID_ARGUMENT;
+    }
+    
+    SpgContext *ctx = (SpgContext *)memory;
+    memset(ctx, 0, sizeof(SpgContext));
+    
+    SpgStatus status = compile_policy(policy, &ctx->options, &ctx->charset);
+    if (status != SPG_OK) {
+        return status;
+    }
+    
+    if (!context_seed(ctx)) {
+        secure_clear(ctx, sizeof(SpgContext));
+        return SPG_ERROR_RANDOM;
+    }
+    
+    ctx->magic = SPG_CONTEXT_MAGIC;
+    *context = ctx;
+    return SPG_OK;
+}
+
+/**
+ * @brief Allocate and create a context
+ */
+SpgStatus spg_context_create(const SpgPolicy *policy, SpgContext **context) {
+    if (!context) {
+        return SPG_ERROR_INVALID_ARGUMENT;
+    }
+    
+    void *memory = malloc(sizeof(SpgContext));
+    if (!memory) {
+        return SPG_ERROR_ALLOCATION;
+    }
+    
+    SpgStatus status = spg_context_init(memory, sizeof(SpgContext), policy, context);
+    if (status != SPG_OK) {
+        free(memory);
+        return status;
+    }
+    
+    (*context)->owned = true;
+    return SPG_OK;
+}
+
+/**
+ * @brief Replace the policy of a context
+ */
+SpgStatus spg_context_set_policy(SpgContext *context, const SpgPolicy *policy) {
+    if (!context_valid(context) || !policy) {
+        return SPG_ERROR_INVALID_ARGUMENT;
+    }
+    
+    PasswordOptions options;
+    CompiledCharset charset;
+    SpgStatus status = compile_policy(policy, &options, &charset);
+    if (status == SPG_OK) {
+        context->options = options;
+        context->charset = charset;
+    }
+    return status;
+}
+
+/**
+ * @brief Generate one password into a buffer known to be large enough
+ */
+static SpgStatus generate_one(SpgContext *context, char *buffer, size_t *length) {
+#ifndef _WIN32
+    /* A forked child must never repeat its parent's stream */
+    if (context->pid != getpid() && !context_seed(context)) {
+        return SPG_ERROR_RANDOM;
+    }
+#endif
+    
+    PasswordResult result;
+    GenerationStats stats = {0};
+    if (!generate_password_into(&context->options, &context->charset, &context->sampler,
+                                buffer, &result, &stats)) {
+        return stats.failures > 0 ? SPG_ERROR_REJECTED : SPG_ERROR_RANDOM;
+    }
+    
+    *length = result.length;
+    return SPG_OK;
+}
+
+/**
+ * @brief Generate one password
+ */
+SpgStatus spg_generate(SpgContext *context, char *buffer, size_t buffer_size, size_t *length) {
+    if (!context_valid(context) || !buffer) {
+        return SPG_ERROR_INVALID_ARGUMENT;
+    }
+    
+    if (buffer_size < context->options.length + 1) {
+        return SPG_ERROR_BUFFER_TOO_SMALL;
+    }
+    
+    size_t generated = 0;
+    SpgStatus status = generate_one(context, buffer, &generated);
+    if (status != SPG_OK) {
+        secure_clear(buffer, context->options.length + 1);
+        return status;
+    }
+    
+    if (length) {
+        *length = generated;
+    }
+    return SPG_OK;
+}
+
+/**
+ * @brief Generate several passwords, one per line
+ */
+SpgStatus spg_generate_many(SpgContext *context, char *buffer, size_t buffer_size,
+                            size_t count, size_t *written) {
+    if (!context_valid(context) || !buffer || count == 0) {
+        return SPG_ERROR_INVALID_ARGUMENT;
+    }
+    
+    size_t line = context->options.length + 1;
+    if (count > (SIZE_MAX - 1) / line || buffer_size < count * line + 1) {
+        return SPG_ERROR_BUFFER_TOO_SMALL;
+    }
+    
+    /* Each password is written at its final position; its NUL becomes the newline */
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = 0;
+        SpgStatus status = generate_one(context, buffer + used, &length);
+        if (status != SPG_OK) {
+            secure_clear(buffer, used + line);
+            return status;
+        }
+        
+        used += length;
+        buffer[used++] = '\n';
+    }
+    
+    buffer[used] = '\0';
+    if (written) {
+        *written = used;
+    }
+    return SPG_OK;
+}
+
+/**
+ * @brief Assess the strength of a password
+ */
+SpgStatus spg_assess(const char *password, size_t length, SpgAssessment *assessment) {
+    if (!password || !assessment || length == 0) {
+        return SPG_ERROR_INVALID_ARGUMENT;
+    }
+    
+    SecurityAssessment result = assess_password_security(password, length);
+    
+    assessment->score = result.score;
+    assessment->level = (int)result.category;
+    assessment->entropy = result.entropy;
+    assessment->weak_pattern = result.has_weak_pattern;
+    assessment->dictionary_word = result.has_dictionary_word;
+    return SPG_OK;
+}
+
+/**
+ * @brief Wipe a context created with spg_context_init()
+ */
+void spg_context_wipe(SpgContext *context) {
+    if (!context_valid(context)) {
+        return;
+    }
+    
+    random_sampler_wipe(&context->sampler);
+    chacha_drbg_wipe(&context->drbg);
+    secure_clear(context, sizeof(SpgContext));
+}
+
+/**
+ * @brief Wipe and free a context created with spg_context_create()
+ */
+void spg_context_destroy(SpgContext *context) {
+    if (!context_valid(context)) {
+        return;
+    }
+    
+    bool owned = context->owned;
+    spg_context_wipe(context);
+    if (owned) {
+        free(context);
+    }
+}
+
+/**
+ * @brief Get a description of a result code
+ */
+const char *spg_status_string(SpgStatus status) {
+    switch (status) {
+        case SPG_OK:
+            return "Success";
+        case SPG_ERROR_INVALID_ARGUMENT:
+            return "Invalid argument";
+        case SPG_ERROR_INVALID_POLICY:
+            return "Policy cannot produce a password";
+        case SPG_ERROR_BUFFER_TOO_SMALL:
+            return "Output buffer too small";
+        case SPG_ERROR_RANDOM:
+            return "Random source failed";
+        case SPG_ERROR_ALLOCATION:
+            return "Memory allocation failed";
+        case SPG_ERROR_REJECTED:
+            return "No candidate satisfied the policy";
+        default:
+            return "Unknown error";
+    }
+}
\ No newline at end of file
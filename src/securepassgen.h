@@ -0,0 +1,183 @@
+/**
+ * @file securepassgen.h
+ * @brief Embeddable password generation API (libsecurepassgen)
+ * @version 1.0
+ * @date 2024
+ *
+ * Self-contained public interface of the static and shared libraries
+ * built by "make lib". Nothing in this API writes to stdout or stderr.
+ *
+ * A context holds the random generator and the compiled policy. Contexts
+ * are independent: use one per thread (or guard a shared one with a lock)
+ * and no other synchronization is needed. Passwords are only ever written
+ * to caller-provided buffers.
+ */
+
+#ifndef SECUREPASSGEN_H
+#define SECUREPASSGEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__) && !defined(_WIN32)
+    #define SPG_API __attribute__((visibility("default")))
+#else
+    #define SPG_API
+#endif
+
+/**
+ * @brief Library result codes
+ */
+typedef enum {
+    SPG_OK = 0,
+    SPG_ERROR_INVALID_ARGUMENT,     /**< NULL pointer, bad size or unusable memory */
+    SPG_ERROR_INVALID_POLICY,       /**< Policy cannot produce any password */
+    SPG_ERROR_BUFFER_TOO_SMALL,     /**< Output buffer cannot hold the result */
+    SPG_ERROR_RANDOM,               /**< Operating system random source failed */
+    SPG_ERROR_ALLOCATION,           /**< Memory allocation failed */
+    SPG_ERROR_REJECTED              /**< No candidate satisfied the policy filters */
+} SpgStatus;
+
+/**
+ * @brief Character classes for SpgPolicy.classes
+ */
+#define SPG_CLASS_LOWER   0x01u     /**< a-z */
+#define SPG_CLASS_UPPER   0x02u     /**< A-Z */
+#define SPG_CLASS_NUMBER  0x04u     /**< 0-9 */
+#define SPG_CLASS_SPECIAL 0x08u     /**< !@#$%^&* */
+#define SPG_CLASS_ALL     0x0Fu
+
+/**
+ * @brief Generation policy
+ */
+typedef struct {
+    size_t length;              /**< Password length (8-128) */
+    unsigned int classes;       /**< SPG_CLASS_* bits to draw from */
+    bool require_all;           /**< At least one character of every selected class */
+    bool avoid_ambiguous;       /**< Leave out l, I, 1, O and 0 */
+    size_t min_numbers;         /**< Minimum digits (ignored without SPG_CLASS_NUMBER) */
+    size_t min_special;         /**< Minimum special characters (ignored without SPG_CLASS_SPECIAL) */
+    bool reject_weak;           /**< Redraw passwords containing weak patterns */
+    bool reject_dictionary;     /**< Redraw passwords containing dictionary words */
+    size_t max_attempts;        /**< Candidates per password before repairing (0 = default) */
+} SpgPolicy;
+
+/**
+ * @brief Strength assessment of one password
+ */
+typedef struct {
+    int score;                  /**< Strength score (0-100) */
+    int level;                  /**< Strength level (0 = very weak ... 5 = very strong) */
+    double entropy;             /**< Entropy estimate in bits */
+    bool weak_pattern;          /**< Contains a weak pattern */
+    bool dictionary_word;       /**< Contains a dictionary word */
+} SpgAssessment;
+
+/**
+ * @brief Opaque generator context
+ */
+typedef struct SpgContext SpgContext;
+
+/**
+ * @brief Fill a policy with the library defaults
+ * @param policy Policy to initialize
+ */
+SPG_API void spg_policy_init(SpgPolicy *policy);
+
+/**
+ * @brief Get the number of bytes a context needs
+ * @return Size for spg_context_init()
+ */
+SPG_API size_t spg_context_size(void);
+
+/**
+ * @brief Create a context in caller-provided memory
+ * @param memory At least spg_context_size() bytes, aligned like malloc() memory
+ * @param size Size of memory
+ * @param policy Generation policy (NULL = defaults)
+ * @param context Pointer to store the context handle
+ * @return SPG_OK or an error code
+ *
+ * Release with spg_context_wipe(); the memory stays the caller's.
+ */
+SPG_API SpgStatus spg_context_init(void *memory, size_t size, const SpgPolicy *policy,
+                                   SpgContext **context);
+
+/**
+ * @brief Allocate and create a context
+ * @param policy Generation policy (NULL = defaults)
+ * @param context Pointer to store the context handle
+ * @return SPG_OK or an error code
+ *
+ * Release with spg_context_destroy().
+ */
+SPG_API SpgStatus spg_context_create(const SpgPolicy *policy, SpgContext **context);
+
+/**
+ * @brief Replace the policy of a context
+ * @param context Context
+ * @param policy New policy
+ * @return SPG_OK or an error code (the old policy stays in effect on error)
+ */
+SPG_API SpgStatus spg_context_set_policy(SpgContext *context, const SpgPolicy *policy);
+
+/**
+ * @brief Generate one password
+ * @param context Context
+ * @param buffer Output buffer of at least policy length + 1 bytes
+ * @param buffer_size Size of buffer
+ * @param length Pointer to store the password length (may be NULL)
+ * @return SPG_OK or an error code
+ */
+SPG_API SpgStatus spg_generate(SpgContext *context, char *buffer, size_t buffer_size,
+                               size_t *length);
+
+/**
+ * @brief Generate several passwords, one per line
+ * @param context Context
+ * @param buffer Output buffer of at least count * (policy length + 1) + 1 bytes
+ * @param buffer_size Size of buffer
+ * @param count Number of passwords
+ * @param written Pointer to store the bytes written, excluding the NUL (may be NULL)
+ * @return SPG_OK or an error code
+ */
+SPG_API SpgStatus spg_generate_many(SpgContext *context, char *buffer, size_t buffer_size,
+                                    size_t count, size_t *written);
+
+/**
+ * @brief Assess the strength of a password
+ * @param password Password (need not be NUL-terminated)
+ * @param length Length of the password
+ * @param assessment Pointer to store the assessment
+ * @return SPG_OK or an error code
+ */
+SPG_API SpgStatus spg_assess(const char *password, size_t length, SpgAssessment *assessment);
+
+/**
+ * @brief Wipe a context created with spg_context_init()
+ * @param context Context (may be NULL)
+ */
+SPG_API void spg_context_wipe(SpgContext *context);
+
+/**
+ * @brief Wipe and free a context created with spg_context_create()
+ * @param context Context (may be NULL)
+ */
+SPG_API void spg_context_destroy(SpgContext *context);
+
+/**
+ * @brief Get a description of a result code
+ * @param status Result code
+ * @return Static string
+ */
+SPG_API const char *spg_status_string(SpgStatus status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SECUREPASSGEN_H */
\ No newline at end of file
@@ -8,11 +8,26 @@
 #include "security.h"
 #include "config.h"
 #include "utils.h"
+#include "parallel.h"
+#include "breach.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define CLASSIFY_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CLASSIFY_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define CLASSIFY_NEON 1
+#endif
 
 /* Weak patterns to check against */
 static const WeakPattern weak_patterns[] = {
@@ -63,6 +78,396 @@ static const char *dictionary_words[] = {
     "asdfgh", "sparky", "cowboy", NULL  /* Terminator */
 };
 
+/* Keyboard rows whose 3-character runs (both directions) are weak */
+static const char *keyboard_rows[] = {
+    "qwertyuiop",
+    "asdfghjkl",
+    "zxcvbnm",
+    "1234567890",
+    NULL
+};
+
+/*
+ * All weak patterns, keyboard trigrams and dictionary words are compiled
+ * once into a single Aho-Corasick automaton with full DFA transitions over
+ * a compressed alphabet. Input bytes are mapped to symbols through three
+ * tables (raw, lowercased, lowercased + leet), so one pass over the
+ * password drives three cursors: raw for weak patterns, lower and leet for
+ * dictionary words.
+ */
+#define AC_MAX_STATES 2048
+#define AC_MAX_SYMBOLS 64
+#define AC_OUTPUT_WEAK 0x01
+#define AC_OUTPUT_DICTIONARY 0x02
+
+static uint16_t ac_next[AC_MAX_STATES][AC_MAX_SYMBOLS];
+static unsigned char ac_output[AC_MAX_STATES];
+static size_t ac_state_count = 1;
+static size_t ac_symbol_count = 1;      /* Symbol 0: byte not in any pattern */
+static unsigned char ac_symbol_raw[256];
+static unsigned char ac_symbol_lower[256];
+static unsigned char ac_symbol_leet[256];
+static bool ac_complete = true;         /* False if a pattern did not fit */
+static ParallelOnce ac_once = PARALLEL_ONCE_INIT;
+
+/**
+ * @brief Map a lowercase character through common leet substitutions
+ */
+static unsigned char leet_normalize(unsigned char c) {
+    switch (c) {
+        case '4': return 'a';
+        case '3': return 'e';
+        case '0': return 'o';
+        case '1': return 'i';
+        case '5': return 's';
+        case '7': return 't';
+        case '@': return 'a';
+        case '$': return 's';
+        case '!': return 'i';
+        default: return c;
+    }
+}
+
+/**
+ * @brief Add a pattern to the automaton trie
+ * @return false if the pattern does not fit in AC_MAX_STATES/AC_MAX_SYMBOLS
+ *
+ * A pattern that does not fit leaves its prefix in the trie without an
+ * output, so it can never match.
+ */
+static bool ac_insert(const char *pattern, size_t length, unsigned char output) {
+    size_t state = 0;
+    
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)pattern[i];
+        
+        if (ac_symbol_raw[c] == 0) {
+            if (ac_symbol_count >= AC_MAX_SYMBOLS) {
+                return false;
+            }
+            ac_symbol_raw[c] = (unsigned char)ac_symbol_count++;
+        }
+        
+        unsigned char symbol = ac_symbol_raw[c];
+        if (ac_next[state][symbol] == 0) {
+            if (ac_state_count >= AC_MAX_STATES) {
+                return false;
+            }
+            ac_next[state][symbol] = (uint16_t)ac_state_count++;
+        }
+        state = ac_next[state][symbol];
+    }
+    
+    ac_output[state] |= output;
+    return true;
+}
+
+/**
+ * @brief Build the pattern automaton (runs once)
+ */
+static void ac_build(void) {
+    bool complete = true;
+    
+    for (int i = 0; weak_patterns[i].pattern != NULL; i++) {
+        complete &= ac_insert(weak_patterns[i].pattern, strlen(weak_patterns[i].pattern),
+                              AC_OUTPUT_WEAK);
+    }
+    
+    for (int r = 0; keyboard_rows[r] != NULL; r++) {
+        const char *row = keyboard_rows[r];
+        size_t row_len = strlen(row);
+        
+        for (size_t i = 0; i + 3 <= row_len; i++) {
+            char reverse[3] = {row[i + 2], row[i + 1], row[i]};
+            complete &= ac_insert(row + i, 3, AC_OUTPUT_WEAK);
+            complete &= ac_insert(reverse, 3, AC_OUTPUT_WEAK);
+        }
+    }
+    
+    for (int i = 0; dictionary_words[i] != NULL; i++) {
+        complete &= ac_insert(dictionary_words[i], strlen(dictionary_words[i]),
+                              AC_OUTPUT_DICTIONARY);
+    }
+    
+    if (!complete) {
+        ac_complete = false;
+        fprintf(stderr, "Warning: pattern table exceeds %d states or %d symbols; "
+                "weak-pattern detection is incomplete\n", AC_MAX_STATES, AC_MAX_SYMBOLS);
+    }
+    
+    /* Input tables: fold case and leet into the symbol lookup */
+    for (int c = 0; c < 256; c++) {
+        unsigned char lower = (unsigned char)tolower(c);
+        ac_symbol_lower[c] = ac_symbol_raw[lower];
+        ac_symbol_leet[c] = ac_symbol_raw[leet_normalize(lower)];
+    }
+    
+    /* Breadth-first: failure links, merged outputs, full DFA rows */
+    static uint16_t queue[AC_MAX_STATES];
+    static uint16_t fail[AC_MAX_STATES];
+    size_t head = 0;
+    size_t tail = 0;
+    
+    for (size_t symbol = 0; symbol < ac_symbol_count; symbol++) {
+        uint16_t child = ac_next[0][symbol];
+        if (child != 0) {
+            fail[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+    
+    while (head < tail) {
+        uint16_t state = queue[head++];
+        
+        for (size_t symbol = 0; symbol < ac_symbol_count; symbol++) {
+            uint16_t child = ac_next[state][symbol];
+            
+            if (child != 0) {
+                fail[child] = ac_next[fail[state]][symbol];
+                ac_output[child] |= ac_output[fail[child]];
+                queue[tail++] = child;
+            } else {
+                ac_next[state][symbol] = ac_next[fail[state]][symbol];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Check that every built-in pattern made it into the automaton
+ */
+bool security_patterns_complete(void) {
+    parallel_once(&ac_once, ac_build);
+    return ac_complete;
+}
+
+/**
+ * @brief Check a 3-character window for sequences and repeats
+ */
+static bool is_weak_trigram(unsigned char c1, unsigned char c2, unsigned char c3) {
+    /* Repeated characters, e.g. aaa, 111 */
+    if (c1 == c2 && c2 == c3) {
+        return true;
+    }
+    
+    /* Numeric sequences, e.g. 123, 654 */
+    if (isdigit(c1) && isdigit(c2) && isdigit(c3)) {
+        return (c1 + 1 == c2 && c2 + 1 == c3) || (c1 - 1 == c2 && c2 - 1 == c3);
+    }
+    
+    /* Alphabetical sequences, e.g. abc, ZYX */
+    if (isalpha(c1) && isalpha(c2) && isalpha(c3)) {
+        int l1 = tolower(c1);
+        int l2 = tolower(c2);
+        int l3 = tolower(c3);
+        return (l1 + 1 == l2 && l2 + 1 == l3) || (l1 - 1 == l2 && l2 - 1 == l3);
+    }
+    
+    return false;
+}
+
+/**
+ * @brief Scan a password once for weak patterns and dictionary words
+ */
+PatternMatch scan_password_patterns(const char *password, size_t length) {
+    PatternMatch match = {false, false};
+    
+    if (!password) {
+        return match;
+    }
+    
+    parallel_once(&ac_once, ac_build);
+    StatsTimer timer = stats_begin();
+    
+    uint16_t raw = 0;
+    uint16_t lower = 0;
+    uint16_t leet = 0;
+    unsigned char found = 0;
+    bool weak_run = false;
+    
+    for (size_t i = 0; i < length && found != (AC_OUTPUT_WEAK | AC_OUTPUT_DICTIONARY); i++) {
+        unsigned char c = (unsigned char)password[i];
+        
+        raw = ac_next[raw][ac_symbol_raw[c]];
+        lower = ac_next[lower][ac_symbol_lower[c]];
+        leet = ac_next[leet][ac_symbol_leet[c]];
+        
+        found |= ac_output[raw] & AC_OUTPUT_WEAK;
+        found |= (ac_output[lower] | ac_output[leet]) & AC_OUTPUT_DICTIONARY;
+        
+        if (!weak_run && i >= 2 &&
+            is_weak_trigram((unsigned char)password[i - 2], 
+                            (unsigned char)password[i - 1], c)) {
+            weak_run = true;
+            found |= AC_OUTPUT_WEAK;
+        }
+    }
+    
+    match.has_weak_pattern = (found & AC_OUTPUT_WEAK) != 0;
+    match.has_dictionary_word = (found & AC_OUTPUT_DICTIONARY) != 0;
+    
+    /* Exact lookup in the external breach list, if one is loaded */
+    if (!match.has_dictionary_word) {
+        match.has_dictionary_word = breach_check_active(password, length);
+    }
+    
+    stats_end(STATS_ASSESS, &timer, 0);
+    return match;
+}
+
+/**
+ * @brief Count set bits in a 32-bit mask
+ */
+static inline uint32_t popcount32(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+    return (x * 0x01010101u) >> 24;
+#endif
+}
+
+/**
+ * @brief Class of one byte (ASCII ranges, everything else special)
+ */
+static inline unsigned classify_byte(unsigned char c) {
+    if ((unsigned char)(c - 'a') < 26) return CHAR_CLASS_LOWER;
+    if ((unsigned char)(c - 'A') < 26) return CHAR_CLASS_UPPER;
+    if ((unsigned char)(c - '0') < 10) return CHAR_CLASS_NUMBER;
+    return CHAR_CLASS_SPECIAL;
+}
+
+/**
+ * @brief Classify every character of a password in one pass
+ */
+void classify_password(const char *password, size_t length, CharClassProfile *profile) {
+    if (!profile) {
+        return;
+    }
+    
+    memset(profile, 0, sizeof(CharClassProfile));
+    
+    if (!password || length == 0) {
+        return;
+    }
+    
+    const unsigned char *p = (const unsigned char *)password;
+    uint32_t lower = 0, upper = 0, digit = 0;
+    size_t i = 0;
+    
+    /* Range tests as (c - base) <= span, done with unsigned min/compare */
+#if defined(CLASSIFY_AVX2)
+    const __m256i base_lower = _mm256_set1_epi8('a');
+    const __m256i base_upper = _mm256_set1_epi8('A');
+    const __m256i base_digit = _mm256_set1_epi8('0');
+    const __m256i span_alpha = _mm256_set1_epi8(25);
+    const __m256i span_digit = _mm256_set1_epi8(9);
+    
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i l = _mm256_sub_epi8(v, base_lower);
+        __m256i u = _mm256_sub_epi8(v, base_upper);
+        __m256i d = _mm256_sub_epi8(v, base_digit);
+        
+        lower += popcount32((uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(l, span_alpha), l)));
+        upper += popcount32((uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(u, span_alpha), u)));
+        digit += popcount32((uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(d, span_digit), d)));
+    }
+#endif
+    
+#if defined(CLASSIFY_AVX2) || defined(CLASSIFY_SSE2)
+    {
+        const __m128i base_lower = _mm_set1_epi8('a');
+        const __m128i base_upper = _mm_set1_epi8('A');
+        const __m128i base_digit = _mm_set1_epi8('0');
+        const __m128i span_alpha = _mm_set1_epi8(25);
+        const __m128i span_digit = _mm_set1_epi8(9);
+        
+        for (; i + 16 <= length; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+            __m128i l = _mm_sub_epi8(v, base_lower);
+            __m128i u = _mm_sub_epi8(v, base_upper);
+            __m128i d = _mm_sub_epi8(v, base_digit);
+            
+            lower += popcount32((uint32_t)_mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_min_epu8(l, span_alpha), l)));
+            upper += popcount32((uint32_t)_mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_min_epu8(u, span_alpha), u)));
+            digit += popcount32((uint32_t)_mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_min_epu8(d, span_digit), d)));
+        }
+    }
+#elif defined(CLASSIFY_NEON)
+    {
+        const uint8x16_t base_lower = vdupq_n_u8('a');
+        const uint8x16_t base_upper = vdupq_n_u8('A');
+        const uint8x16_t base_digit = vdupq_n_u8('0');
+        const uint8x16_t limit_alpha = vdupq_n_u8(26);
+        const uint8x16_t limit_digit = vdupq_n_u8(10);
+        const uint8x16_t one = vdupq_n_u8(1);
+        
+        for (; i + 16 <= length; i += 16) {
+            uint8x16_t v = vld1q_u8(p + i);
+            
+            lower += vaddvq_u8(vandq_u8(vcltq_u8(vsubq_u8(v, base_lower), limit_alpha), one));
+            upper += vaddvq_u8(vandq_u8(vcltq_u8(vsubq_u8(v, base_upper), limit_alpha), one));
+            digit += vaddvq_u8(vandq_u8(vcltq_u8(vsubq_u8(v, base_digit), limit_digit), one));
+        }
+    }
+#endif
+    
+    /* Tail (or the whole password without SIMD) */
+    uint32_t tail[CHAR_CLASS_COUNT] = {0};
+    for (; i < length; i++) {
+        tail[classify_byte(p[i])]++;
+    }
+    
+    profile->counts[CHAR_CLASS_LOWER] = lower + tail[CHAR_CLASS_LOWER];
+    profile->counts[CHAR_CLASS_UPPER] = upper + tail[CHAR_CLASS_UPPER];
+    profile->counts[CHAR_CLASS_NUMBER] = digit + tail[CHAR_CLASS_NUMBER];
+    profile->counts[CHAR_CLASS_SPECIAL] = (uint32_t)length - profile->counts[CHAR_CLASS_LOWER] -
+                                          profile->counts[CHAR_CLASS_UPPER] -
+                                          profile->counts[CHAR_CLASS_NUMBER];
+    
+    for (int cls = 0; cls < CHAR_CLASS_COUNT; cls++) {
+        if (profile->counts[cls] > 0) {
+            profile->present |= (uint8_t)(1u << cls);
+        }
+    }
+    
+    /* Non-letters strictly inside the password, from the totals and both ends */
+    if (length > 2) {
+        uint32_t symbols = profile->counts[CHAR_CLASS_NUMBER] + profile->counts[CHAR_CLASS_SPECIAL];
+        symbols -= classify_byte(p[0]) >= CHAR_CLASS_NUMBER ? 1 : 0;
+        symbols -= classify_byte(p[length - 1]) >= CHAR_CLASS_NUMBER ? 1 : 0;
+        profile->inner_symbols = symbols;
+    }
+}
+
+/**
+ * @brief Classify a range of batch entries
+ */
+void classify_password_batch(const PasswordBatch *batch, size_t begin, size_t end,
+                             CharClassProfile *profiles) {
+    if (!batch || !profiles) {
+        return;
+    }
+    
+    if (end > batch->count) {
+        end = batch->count;
+    }
+    
+    for (size_t i = begin; i < end; i++) {
+        classify_password(batch->chars + i * batch->stride, batch->lengths[i], 
+                          &profiles[i - begin]);
+    }
+}
+
 /**
  * @brief Initialize security assessment with default values
  */
@@ -90,19 +495,26 @@ SecurityAssessment assess_password_security(const char *password, size_t length)
         return assessment;
     }
     
+    StatsTimer timer = stats_begin();
+    
+    /* Classify once for score and entropy */
+    CharClassProfile profile;
+    classify_password(password, length, &profile);
+    
     /* Calculate basic metrics */
-    assessment.score = calculate_strength_score(password, length);
+    assessment.score = calculate_strength_score_profile(&profile, length);
     assessment.category = (StrengthCategory)(assessment.score / 20);
     if (assessment.category > STRENGTH_VERY_STRONG) {
         assessment.category = STRENGTH_VERY_STRONG;
     }
     
     /* Calculate entropy (simplified) */
-    assessment.entropy = calculate_simple_entropy(password, length);
+    assessment.entropy = calculate_simple_entropy_profile(&profile, length);
     
-    /* Check for issues */
-    assessment.has_weak_pattern = check_weak_patterns(password);
-    assessment.has_dictionary_word = check_dictionary_words(password);
+    /* Check for issues in a single pass */
+    PatternMatch match = scan_password_patterns(password, length);
+    assessment.has_weak_pattern = match.has_weak_pattern;
+    assessment.has_dictionary_word = match.has_dictionary_word;
     
     /* Adjust score based on issues found */
     if (assessment.has_weak_pattern) {
@@ -126,9 +538,49 @@ SecurityAssessment assess_password_security(const char *password, size_t length)
     assessment.crack_time_seconds = estimate_crack_time(assessment.entropy, 
                                                        GPU_GUESSES_PER_SECOND);
     
+    stats_end(STATS_ASSESS, &timer, 0);
     return assessment;
 }
 
+/**
+ * @brief Assess a range of batch entries
+ */
+void assess_password_batch(const PasswordBatch *batch, size_t begin, size_t end,
+                           SecurityAssessment *assessments) {
+    if (!batch || !assessments) {
+        return;
+    }
+    
+    if (end > batch->count) {
+        end = batch->count;
+    }
+    
+    for (size_t i = begin; i < end; i++) {
+        assessments[i - begin] = assess_password_security(batch->chars + i * batch->stride,
+                                                          batch->lengths[i]);
+    }
+}
+
+/**
+ * @brief Rescore every batch entry with the full security assessment
+ */
+void score_password_batch(PasswordBatch *batch) {
+    if (!batch) {
+        return;
+    }
+    
+    for (size_t i = 0; i < batch->count; i++) {
+        SecurityAssessment assessment = 
+            assess_password_security(batch->chars + i * batch->stride, batch->lengths[i]);
+        
+        batch->scores[i] = (uint8_t)assessment.score;
+        batch->levels[i] = get_strength_level(assessment.score);
+        if (batch->entropy[i] == 0.0) {
+            batch->entropy[i] = assessment.entropy;
+        }
+    }
+}
+
 /**
  * @brief Calculate strength score (0-100)
  */
@@ -137,6 +589,20 @@ int calculate_strength_score(const char *password, size_t length) {
         return 0;
     }
     
+    CharClassProfile profile;
+    classify_password(password, length, &profile);
+    
+    return calculate_strength_score_profile(&profile, length);
+}
+
+/**
+ * @brief Calculate strength score (0-100) from a class profile
+ */
+int calculate_strength_score_profile(const CharClassProfile *profile, size_t length) {
+    if (!profile || length < MIN_PASSWORD_LENGTH) {
+        return 0;
+    }
+    
     int score = 0;
     
     /* Length score (max 40 points) */
@@ -146,22 +612,7 @@ int calculate_strength_score(const char *password, size_t length) {
     else score += 10;
     
     /* Character variety (max 40 points) */
-    bool has_lower = false;
-    bool has_upper = false;
-    bool has_digit = false;
-    bool has_special = false;
-    
-    for (size_t i = 0; i < length; i++) {
-        char c = password[i];
-        
-        if (islower((unsigned char)c)) has_lower = true;
-        else if (isupper((unsigned char)c)) has_upper = true;
-        else if (isdigit((unsigned char)c)) has_digit = true;
-        else has_special = true;
-    }
-    
-    int variety_count = (has_lower ? 1 : 0) + (has_upper ? 1 : 0) +
-                       (has_digit ? 1 : 0) + (has_special ? 1 : 0);
+    int variety_count = (int)popcount32(profile->present);
     
     switch (variety_count) {
         case 4: score += 40; break;
@@ -172,15 +623,14 @@ int calculate_strength_score(const char *password, size_t length) {
     }
     
     /* Middle numbers/symbols (10 points) */
-    for (size_t i = 1; i < length - 1; i++) {
-        if (!isalpha((unsigned char)password[i])) {
-            score += 10;
-            break;
-        }
+    if (profile->inner_symbols > 0) {
+        score += 10;
     }
     
     /* Requirements (10 points) */
-    if (length >= 8 && has_lower && has_upper && has_digit) {
+    const uint8_t required = (1u << CHAR_CLASS_LOWER) | (1u << CHAR_CLASS_UPPER) | 
+                             (1u << CHAR_CLASS_NUMBER);
+    if (length >= 8 && (profile->present & required) == required) {
         score += 10;
     }
     
@@ -198,80 +648,7 @@ bool check_weak_patterns(const char *password) {
         return false;
     }
     
-    size_t pass_len = strlen(password);
-    
-    /* Check against known weak patterns */
-    for (int i = 0; weak_patterns[i].pattern != NULL; i++) {
-        if (strstr(password, weak_patterns[i].pattern) != NULL) {
-            return true;
-        }
-    }
-    
-    /* Check for sequential characters */
-    for (size_t i = 0; i < pass_len - 2; i++) {
-        char c1 = password[i];
-        char c2 = password[i + 1];
-        char c3 = password[i + 2];
-        
-        /* Check numeric sequences */
-        if (isdigit((unsigned char)c1) && isdigit((unsigned char)c2) && isdigit((unsigned char)c3)) {
-            if (c1 + 1 == c2 && c2 + 1 == c3) {
-                return true;  /* e.g., 123, 456 */
-            }
-            if (c1 - 1 == c2 && c2 - 1 == c3) {
-                return true;  /* e.g., 321, 654 */
-            }
-        }
-        
-        /* Check alphabetical sequences */
-        if (isalpha((unsigned char)c1) && isalpha((unsigned char)c2) && isalpha((unsigned char)c3)) {
-            if (tolower((unsigned char)c1) + 1 == tolower((unsigned char)c2) &&
-                tolower((unsigned char)c2) + 1 == tolower((unsigned char)c3)) {
-                return true;  /* e.g., abc, xyz */
-            }
-            if (tolower((unsigned char)c1) - 1 == tolower((unsigned char)c2) &&
-                tolower((unsigned char)c2) - 1 == tolower((unsigned char)c3)) {
-                return true;  /* e.g., cba, zyx */
-            }
-        }
-    }
-    
-    /* Check for repeated characters */
-    for (size_t i = 0; i < pass_len - 2; i++) {
-        if (password[i] == password[i + 1] && 
-            password[i] == password[i + 2]) {
-            return true;  /* e.g., aaa, 111 */
-        }
-    }
-    
-    /* Check keyboard patterns (simple check) */
-    const char *keyboard_rows[] = {
-        "qwertyuiop",
-        "asdfghjkl",
-        "zxcvbnm",
-        "1234567890",
-        NULL
-    };
-    
-    for (int r = 0; keyboard_rows[r] != NULL; r++) {
-        const char *row = keyboard_rows[r];
-        size_t row_len = strlen(row);
-        
-        for (size_t i = 0; i <= row_len - 3; i++) {
-            char pattern[4] = {row[i], row[i + 1], row[i + 2], '\0'};
-            if (strstr(password, pattern) != NULL) {
-                return true;
-            }
-            
-            /* Also check reverse */
-            char reverse_pattern[4] = {row[i + 2], row[i + 1], row[i], '\0'};
-            if (strstr(password, reverse_pattern) != NULL) {
-                return true;
-            }
-        }
-    }
-    
-    return false;
+    return scan_password_patterns(password, strlen(password)).has_weak_pattern;
 }
 
 /**
@@ -282,57 +659,7 @@ bool check_dictionary_words(const char *password) {
         return false;
     }
     
-    char lower_password[256];
-    size_t pass_len = strlen(password);
-    
-    if (pass_len >= sizeof(lower_password)) {
-        pass_len = sizeof(lower_password) - 1;
-    }
-    
-    /* Convert to lowercase for comparison */
-    for (size_t i = 0; i < pass_len; i++) {
-        lower_password[i] = tolower((unsigned char)password[i]);
-    }
-    lower_password[pass_len] = '\0';
-    
-    /* Check against dictionary words */
-    for (int i = 0; dictionary_words[i] != NULL; i++) {
-        if (strstr(lower_password, dictionary_words[i]) != NULL) {
-            return true;
-        }
-    }
-    
-    /* Check for leet speak substitutions */
-    char *leet_password = strdup(lower_password);
-    if (!leet_password) {
-        return false;
-    }
-    
-    /* Common leet speak substitutions */
-    for (size_t i = 0; leet_password[i] != '\0'; i++) {
-        switch (leet_password[i]) {
-            case '4': leet_password[i] = 'a'; break;
-            case '3': leet_password[i] = 'e'; break;
-            case '0': leet_password[i] = 'o'; break;
-            case '1': leet_password[i] = 'i'; break;
-            case '5': leet_password[i] = 's'; break;
-            case '7': leet_password[i] = 't'; break;
-            case '@': leet_password[i] = 'a'; break;
-            case '$': leet_password[i] = 's'; break;
-            case '!': leet_password[i] = 'i'; break;
-        }
-    }
-    
-    /* Check modified password */
-    for (int i = 0; dictionary_words[i] != NULL; i++) {
-        if (strstr(leet_password, dictionary_words[i]) != NULL) {
-            free(leet_password);
-            return true;
-        }
-    }
-    
-    free(leet_password);
-    return false;
+    return scan_password_patterns(password, strlen(password)).has_dictionary_word;
 }
 
 /**
@@ -343,27 +670,26 @@ double calculate_simple_entropy(const char *password, size_t length) {
         return 0.0;
     }
     
-    bool has_lower = false;
-    bool has_upper = false;
-    bool has_digit = false;
-    bool has_special = false;
+    CharClassProfile profile;
+    classify_password(password, length, &profile);
     
-    /* Determine character set used */
-    for (size_t i = 0; i < length; i++) {
-        char c = password[i];
-        
-        if (islower((unsigned char)c)) has_lower = true;
-        else if (isupper((unsigned char)c)) has_upper = true;
-        else if (isdigit((unsigned char)c)) has_digit = true;
-        else has_special = true;
+    return calculate_simple_entropy_profile(&profile, length);
+}
+
+/**
+ * @brief Calculate entropy from a class profile
+ */
+double calculate_simple_entropy_profile(const CharClassProfile *profile, size_t length) {
+    if (!profile || length == 0) {
+        return 0.0;
     }
     
     /* Calculate pool size */
     size_t pool_size = 0;
-    if (has_lower) pool_size += 26;
-    if (has_upper) pool_size += 26;
-    if (has_digit) pool_size += 10;
-    if (has_special) pool_size += 32;  /* Approximate */
+    if (profile->present & (1u << CHAR_CLASS_LOWER)) pool_size += 26;
+    if (profile->present & (1u << CHAR_CLASS_UPPER)) pool_size += 26;
+    if (profile->present & (1u << CHAR_CLASS_NUMBER)) pool_size += 10;
+    if (profile->present & (1u << CHAR_CLASS_SPECIAL)) pool_size += 32;  /* Approximate */
     
     if (pool_size == 0) {
         return 0.0;
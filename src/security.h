@@ -8,7 +8,10 @@
 #ifndef SECURITY_H
 #define SECURITY_H
 
+#include "password.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief Password strength categories
@@ -35,6 +38,26 @@ typedef struct {
     bool is_duplicate;          /**< Is duplicate of previous passwords */
 } SecurityAssessment;
 
+/**
+ * @brief Result of a single-pass pattern scan
+ */
+typedef struct {
+    bool has_weak_pattern;      /**< Weak pattern, sequence, repeat or keyboard run */
+    bool has_dictionary_word;   /**< Dictionary word, directly or via leet substitution */
+} PatternMatch;
+
+/**
+ * @brief Character class counts of one password
+ *
+ * Classes follow CharClass; every byte that is not an ASCII letter or
+ * digit counts as special.
+ */
+typedef struct {
+    uint32_t counts[CHAR_CLASS_COUNT];  /**< Characters of each class */
+    uint8_t present;                    /**< Bit (1 << CharClass) set for each class seen */
+    uint32_t inner_symbols;             /**< Non-letters excluding the first and last character */
+} CharClassProfile;
+
 /**
  * @brief Common weak patterns to check against
  */
@@ -57,6 +80,44 @@ SecurityAssessment security_assessment_init(void);
  */
 SecurityAssessment assess_password_security(const char *password, size_t length);
 
+/**
+ * @brief Assess a range of batch entries
+ * @param batch Password batch
+ * @param begin First entry to assess
+ * @param end One past the last entry to assess
+ * @param assessments Array of at least end - begin assessments to fill
+ */
+void assess_password_batch(const PasswordBatch *batch, size_t begin, size_t end,
+                           SecurityAssessment *assessments);
+
+/**
+ * @brief Rescore every batch entry with the full security assessment
+ * @param batch Password batch (scores and levels are overwritten; entropy
+ *              is filled in for entries that have none)
+ */
+void score_password_batch(PasswordBatch *batch);
+
+/**
+ * @brief Classify every character of a password in one pass
+ * @param password Password to classify
+ * @param length Length of the password
+ * @param profile Pointer to store the class counts
+ *
+ * Uses SSE2, AVX2 or NEON when the compiler targets them, 16 or 32 bytes
+ * at a time, with a scalar loop for the tail and other targets.
+ */
+void classify_password(const char *password, size_t length, CharClassProfile *profile);
+
+/**
+ * @brief Classify a range of batch entries
+ * @param batch Password batch
+ * @param begin First entry to classify
+ * @param end One past the last entry to classify
+ * @param profiles Array of at least end - begin profiles to fill
+ */
+void classify_password_batch(const PasswordBatch *batch, size_t begin, size_t end,
+                             CharClassProfile *profiles);
+
 /**
  * @brief Calculate strength score (0-100)
  * @param password Password to score
@@ -65,6 +126,53 @@ SecurityAssessment assess_password_security(const char *password, size_t length)
  */
 int calculate_strength_score(const char *password, size_t length);
 
+/**
+ * @brief Calculate strength score (0-100) from a class profile
+ * @param profile Profile from classify_password()
+ * @param length Length of the password
+ * @return Strength score
+ */
+int calculate_strength_score_profile(const CharClassProfile *profile, size_t length);
+
+/**
+ * @brief Calculate entropy from the character pools a password uses
+ * @param password Password to measure
+ * @param length Length of the password
+ * @return Entropy in bits
+ */
+double calculate_simple_entropy(const char *password, size_t length);
+
+/**
+ * @brief Calculate entropy from a class profile
+ * @param profile Profile from classify_password()
+ * @param length Length of the password
+ * @return Entropy in bits
+ */
+double calculate_simple_entropy_profile(const CharClassProfile *profile, size_t length);
+
+/**
+ * @brief Scan a password once for weak patterns and dictionary words
+ * @param password Password to scan
+ * @param length Length of the password
+ * @return Which kinds of pattern were found
+ *
+ * Uses a prebuilt automaton over every weak pattern, keyboard trigram and
+ * dictionary word; case folding and leet substitution are applied in the
+ * input lookup, so the password is read exactly once. Passwords found in
+ * the active breach index (see breach.h) also count as dictionary words.
+ * Thread-safe.
+ */
+PatternMatch scan_password_patterns(const char *password, size_t length);
+
+/**
+ * @brief Check that the built-in pattern tables fit the scan automaton
+ * @return true if every pattern was compiled, false if some were dropped
+ *
+ * Builds the automaton on first use. A false result means the automaton
+ * limits in security.c are too small for the pattern tables.
+ */
+bool security_patterns_complete(void);
+
 /**
  * @brief Check for weak patterns in password
  * @param password Password to check
@@ -101,6 +209,15 @@ const char *get_strength_color(StrengthCategory category);
  */
 const char *get_strength_string(StrengthCategory category);
 
+/**
+ * @brief Check if two passwords are similar
+ * @param pass1 First password
+ * @param pass2 Second password
+ * @param threshold Fraction of equal positions (0.0-1.0) that counts as similar
+ * @return true if the passwords have equal length and enough equal positions
+ */
+bool are_passwords_similar(const char *pass1, const char *pass2, double threshold);
+
 /**
  * @brief Print security assessment in a formatted way
  * @param assessment Security assessment to print
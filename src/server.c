@@ -0,0 +1,586 @@
+/**
+ * @file server.c
+ * @brief Long-running generator service on a local socket implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "server.h"
+#include "password.h"
+#include "sampler.h"
+#include "crypto.h"
+#include "file_ops.h"
+#include "parallel.h"
+#include "stats.h"
+#include "utils.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+    #include <unistd.h>
+    #include <signal.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+#endif
+
+/**
+ * @brief Get default server settings
+ */
+ServerOptions server_options_init(const char *socket_path) {
+    ServerOptions options;
+    
+    options.socket_path = socket_path;
+    options.defaults = password_options_init();
+    options.max_clients = SERVER_MAX_CLIENTS;
+    options.verbose = false;
+    
+    return options;
+}
+
+#ifdef _WIN32
+
+/**
+ * @brief Serve password requests (Unix domain sockets only)
+ */
+bool run_server(const ServerOptions *options) {
+    (void)options;
+    return false;
+}
+
+#else
+
+/* Set by SIGINT/SIGTERM; the accept loop polls it */
+static volatile sig_atomic_t server_stop = 0;
+
+/**
+ * @brief Shared server state
+ */
+typedef struct {
+    const ServerOptions *options;
+    size_t max_clients;
+    ParallelMutex lock;
+    ParallelCond idle;          /* Signalled when a client thread exits */
+    int *client_fds;            /* Open connections (-1 = free slot) */
+    size_t active;
+} Server;
+
+/**
+ * @brief One connection
+ */
+typedef struct {
+    Server *server;
+    int fd;
+} ServerClient;
+
+/**
+ * @brief Per-connection generator: DRBG and charset tables reused across requests
+ */
+typedef struct {
+    ChaChaDrbg drbg;
+    RandomSampler sampler;
+    PasswordOptions compiled_for;
+    CompiledCharset charset;
+    bool compiled;
+} ServerGenerator;
+
+/**
+ * @brief Record a shutdown request
+ */
+static void server_signal_handler(int signal_number) {
+    (void)signal_number;
+    server_stop = 1;
+}
+
+/**
+ * @brief Check whether two option sets compile to the same charset tables
+ */
+static bool same_charset_options(const PasswordOptions *a, const PasswordOptions *b) {
+    return a->length == b->length &&
+           a->charset.lowercase == b->charset.lowercase &&
+           a->charset.uppercase == b->charset.uppercase &&
+           a->charset.numbers == b->charset.numbers &&
+           a->charset.special == b->charset.special &&
+           a->charset.avoid_ambiguous == b->charset.avoid_ambiguous &&
+           a->require_all_types == b->require_all_types &&
+           a->min_numbers == b->min_numbers &&
+           a->min_special == b->min_special;
+}
+
+/**
+ * @brief Parse a 0/1 request value
+ */
+static bool parse_flag(const char *value, bool *flag) {
+    if (strcmp(value, "1") == 0) {
+        *flag = true;
+        return true;
+    }
+    if (strcmp(value, "0") == 0) {
+        *flag = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Apply one key=value request argument
+ * @return NULL if accepted, otherwise the error message
+ */
+static const char *apply_argument(PasswordOptions *options, char *argument) {
+    char *value = strchr(argument, '=');
+    if (!value) {
+        return "Expected key=value";
+    }
+    *value++ = '\0';
+    
+    if (strcmp(argument, "length") == 0) {
+        int length;
+        if (!string_to_int(value, &length, MIN_PASSWORD_LENGTH, MAX_PASSWORD_LENGTH)) {
+            return "Invalid length";
+        }
+        options->length = (size_t)length;
+        return NULL;
+    }
+    
+    bool *flag = NULL;
+    if (strcmp(argument, "uppercase") == 0) {
+        flag = &options->charset.uppercase;
+    } else if (strcmp(argument, "lowercase") == 0) {
+        flag = &options->charset.lowercase;
+    } else if (strcmp(argument, "numbers") == 0) {
+        flag = &options->charset.numbers;
+    } else if (strcmp(argument, "special") == 0) {
+        flag = &options->charset.special;
+    } else if (strcmp(argument, "avoid-ambiguous") == 0) {
+        flag = &options->charset.avoid_ambiguous;
+    } else if (strcmp(argument, "reject-weak") == 0) {
+        flag = &options->reject_weak;
+    } else if (strcmp(argument, "reject-dictionary") == 0) {
+        flag = &options->reject_dictionary;
+    } else {
+        return "Unknown option";
+    }
+    
+    if (!parse_flag(value, flag)) {
+        return "Expected 0 or 1";
+    }
+    
+    /* A class that is switched off cannot have a minimum */
+    if (!options->charset.numbers) {
+        options->min_numbers = 0;
+    }
+    if (!options->charset.special) {
+        options->min_special = 0;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Answer a GEN request
+ * @return false if the connection should be closed
+ */
+static bool handle_generate(const Server *server, ServerGenerator *generator,
+                            OutputBuffer *out, char *arguments) {
+    PasswordOptions options = server->options->defaults;
+    int count = 1;
+    const char *error = NULL;
+    
+    char *save = NULL;
+    for (char *token = strtok_r(arguments, " \t", &save); token && !error;
+         token = strtok_r(NULL, " \t", &save)) {
+        if (token[0] >= '0' && token[0] <= '9') {
+            if (!string_to_int(token, &count, 1, SERVER_MAX_COUNT)) {
+                error = "Invalid count";
+            }
+        } else {
+            error = apply_argument(&options, token);
+        }
+    }
+    
+    if (!error && !validate_options(&options)) {
+        error = "Invalid options";
+    }
+    
+    if (!error && (!generator->compiled || !same_charset_options(&options, &generator->compiled_for))) {
+        generator->compiled = compile_charset(&options, &generator->charset);
+        generator->compiled_for = options;
+        if (!generator->compiled) {
+            error = "Empty character set";
+        }
+    }
+    
+    char password[MAX_PASSWORD_LENGTH + 1];
+    PasswordResult result;
+    
+    /* The first password decides between OK and ERR */
+    if (!error && !generate_password_into(&options, &generator->charset, &generator->sampler,
+                                          password, &result, NULL)) {
+        error = "Policy rejected every candidate";
+    }
+    
+    if (error) {
+        output_buffer_literal(out, "ERR ");
+        output_buffer_puts(out, error);
+        output_buffer_putc(out, '\n');
+        return !out->failed;
+    }
+    
+    output_buffer_literal(out, "OK ");
+    output_buffer_put_uint(out, (uint64_t)count, 1);
+    output_buffer_putc(out, '\n');
+    
+    /* A failure part way through cannot be reported in band, so it closes the connection */
+    bool ok = true;
+    for (int i = 0; i < count && ok && !out->failed; i++) {
+        if (i > 0) {
+            ok = generate_password_into(&options, &generator->charset, &generator->sampler,
+                                        password, &result, NULL);
+        }
+        if (ok) {
+            output_buffer_write(out, password, result.length);
+            output_buffer_putc(out, '\n');
+        }
+    }
+    
+    secure_clear(password, sizeof(password));
+    return ok && !out->failed;
+}
+
+/**
+ * @brief Answer one request line
+ * @return false if the connection should be closed
+ */
+static bool handle_request(const Server *server, ServerGenerator *generator,
+                           OutputBuffer *out, char *line) {
+    char *command = line;
+    char *arguments = line + strcspn(line, " \t");
+    if (*arguments) {
+        *arguments++ = '\0';
+    }
+    
+    if (strcmp(command, "GEN") == 0) {
+        return handle_generate(server, generator, out, arguments);
+    }
+    if (strcmp(command, "PING") == 0) {
+        output_buffer_literal(out, "PONG\n");
+        return !out->failed;
+    }
+    if (strcmp(command, "QUIT") == 0) {
+        return false;
+    }
+    if (command[0] == '\0') {
+        return true;
+    }
+    
+    output_buffer_literal(out, "ERR Unknown command\n");
+    return !out->failed;
+}
+
+/**
+ * @brief Serve one connection until it closes
+ */
+static void serve_client(Server *server, int fd) {
+    FILE *stream = fdopen(fd, "w");
+    if (!stream) {
+        close(fd);
+        return;
+    }
+    
+    OutputBuffer out;
+    ServerGenerator generator;
+    generator.compiled = false;
+    
+    if (!output_buffer_init(&out, stream)) {
+        fclose(stream);
+        return;
+    }
+    if (!chacha_drbg_seed(&generator.drbg)) {
+        output_buffer_literal(&out, "ERR Random source unavailable\n");
+        output_buffer_free(&out);
+        fclose(stream);
+        return;
+    }
+    random_sampler_init_source(&generator.sampler, chacha_drbg_fill, &generator.drbg);
+    
+    char input[SERVER_LINE_MAX];
+    size_t used = 0;
+    bool open = true;
+    
+    while (open) {
+        /* Answer every complete line already received */
+        char *newline;
+        while (open && (newline = memchr(input, '\n', used)) != NULL) {
+            size_t length = (size_t)(newline - input);
+            *newline = '\0';
+            if (length > 0 && input[length - 1] == '\r') {
+                input[length - 1] = '\0';
+            }
+            
+            StatsTimer timer = stats_begin();
+            open = handle_request(server, &generator, &out, input);
+            stats_end(STATS_REQUEST, &timer, 0);
+            used -= length + 1;
+            memmove(input, newline + 1, used);
+        }
+        
+        /* Pipelined requests are answered in one write */
+        if (!open || !output_buffer_flush(&out)) {
+            break;
+        }
+        
+        if (used == sizeof(input)) {
+            output_buffer_literal(&out, "ERR Request too long\n");
+            break;
+        }
+        
+        ssize_t got = recv(fd, input + used, sizeof(input) - used, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        used += (size_t)got;
+    }
+    
+    secure_clear(input, sizeof(input));
+    random_sampler_wipe(&generator.sampler);
+    chacha_drbg_wipe(&generator.drbg);
+    output_buffer_free(&out);
+    
+    /* fclose() closes fd, so drop it from the table first */
+    parallel_mutex_lock(&server->lock);
+    for (size_t i = 0; i < server->max_clients; i++) {
+        if (server->client_fds[i] == fd) {
+            server->client_fds[i] = -1;
+        }
+    }
+    parallel_mutex_unlock(&server->lock);
+    fclose(stream);
+}
+
+/**
+ * @brief Connection thread
+ */
+static void *server_client_thread(void *arg) {
+    ServerClient *client = (ServerClient *)arg;
+    Server *server = client->server;
+    
+    serve_client(server, client->fd);
+    free(client);
+    stats_thread_exit();
+    
+    parallel_mutex_lock(&server->lock);
+    server->active--;
+    parallel_cond_broadcast(&server->idle);
+    parallel_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+/**
+ * @brief Hand a new connection to its own thread (or turn it away)
+ */
+static void server_accept(Server *server, int fd) {
+    parallel_mutex_lock(&server->lock);
+    
+    size_t slot = server->max_clients;
+    for (size_t i = 0; i < server->max_clients; i++) {
+        if (server->client_fds[i] < 0) {
+            slot = i;
+            break;
+        }
+    }
+    
+    if (slot == server->max_clients) {
+        parallel_mutex_unlock(&server->lock);
+        static const char busy[] = "ERR Server busy\n";
+        ssize_t ignored = write(fd, busy, sizeof(busy) - 1);
+        (void)ignored;
+        close(fd);
+        return;
+    }
+    
+    ServerClient *client = (ServerClient *)malloc(sizeof(ServerClient));
+    if (!client) {
+        parallel_mutex_unlock(&server->lock);
+        close(fd);
+        return;
+    }
+    client->server = server;
+    client->fd = fd;
+    
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    
+    /* Registered before the thread starts, since it may finish at once */
+    server->client_fds[slot] = fd;
+    if (pthread_create(&thread, &attr, server_client_thread, client) == 0) {
+        server->active++;
+    } else {
+        server->client_fds[slot] = -1;
+        free(client);
+        close(fd);
+    }
+    
+    pthread_attr_destroy(&attr);
+    parallel_mutex_unlock(&server->lock);
+}
+
+/**
+ * @brief Create the listening socket
+ * @return Socket descriptor, or -1 on error
+ */
+static int server_listen(const char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+    
+    /* Replace a stale socket, never any other kind of file */
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            errno = EEXIST;
+            return -1;
+        }
+        unlink(path);
+    }
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    /* Owner-only from the moment the socket exists */
+    mode_t old_mask = umask(0177);
+    int bound = bind(fd, (struct sockaddr *)&address, sizeof(address));
+    umask(old_mask);
+    
+    if (bound != 0 || listen(fd, SOMAXCONN) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    
+    return fd;
+}
+
+/**
+ * @brief Serve password requests until SIGINT or SIGTERM
+ */
+bool run_server(const ServerOptions *options) {
+    if (!options || !options->socket_path || !validate_options(&options->defaults)) {
+        return false;
+    }
+    
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.options = options;
+    server.max_clients = options->max_clients ? options->max_clients : SERVER_MAX_CLIENTS;
+    server.client_fds = (int *)malloc(server.max_clients * sizeof(int));
+    if (!server.client_fds) {
+        return false;
+    }
+    for (size_t i = 0; i < server.max_clients; i++) {
+        server.client_fds[i] = -1;
+    }
+    
+    int listen_fd = server_listen(options->socket_path);
+    if (listen_fd < 0) {
+        if (options->verbose) {
+            fprintf(stderr, "Cannot listen on %s: %s\n", options->socket_path, strerror(errno));
+        }
+        free(server.client_fds);
+        return false;
+    }
+    
+    parallel_mutex_init(&server.lock);
+    parallel_cond_init(&server.idle);
+    
+    /* Disconnecting clients must not kill the server; stop cleanly on INT/TERM */
+    struct sigaction action, old_int, old_term, old_pipe;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = server_signal_handler;
+    sigaction(SIGINT, &action, &old_int);
+    sigaction(SIGTERM, &action, &old_term);
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, &old_pipe);
+    server_stop = 0;
+    
+    /* Client threads inherit a mask that leaves the signals to this thread */
+    sigset_t stop_signals, old_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    
+    if (options->verbose) {
+        fprintf(stderr, "Serving on %s\n", options->socket_path);
+    }
+    
+    bool ok = true;
+    while (!server_stop) {
+        struct pollfd listener = {listen_fd, POLLIN, 0};
+        int ready = poll(&listener, 1, SERVER_POLL_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR) {
+            ok = false;
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        
+        int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd < 0) {
+            continue;
+        }
+        
+        pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+        server_accept(&server, client_fd);
+        pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    }
+    
+    close(listen_fd);
+    unlink(options->socket_path);
+    
+    /* Wake every client blocked in recv(), or in write() to a peer that
+     * stopped reading, and wait for its thread */
+    parallel_mutex_lock(&server.lock);
+    for (size_t i = 0; i < server.max_clients; i++) {
+        if (server.client_fds[i] >= 0) {
+            shutdown(server.client_fds[i], SHUT_RDWR);
+        }
+    }
+    while (server.active > 0) {
+        parallel_cond_wait(&server.idle, &server.lock);
+    }
+    parallel_mutex_unlock(&server.lock);
+    
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    sigaction(SIGPIPE, &old_pipe, NULL);
+    
+    parallel_cond_destroy(&server.idle);
+    parallel_mutex_destroy(&server.lock);
+    free(server.client_fds);
+    
+    if (options->verbose) {
+        fprintf(stderr, "Server on %s stopped\n", options->socket_path);
+    }
+    return ok;
+}
+
+#endif /* _WIN32 */
\ No newline at end of file
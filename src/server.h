@@ -0,0 +1,53 @@
+/**
+ * @file server.h
+ * @brief Long-running generator service on a local socket
+ * @version 1.0
+ * @date 2024
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "password.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Server settings
+ */
+typedef struct {
+    const char *socket_path;        /**< Unix domain socket to listen on */
+    PasswordOptions defaults;       /**< Options used when a request does not override them */
+    size_t max_clients;             /**< Connections served at once (0 = SERVER_MAX_CLIENTS) */
+    bool verbose;                   /**< Report startup, shutdown and errors on stderr */
+} ServerOptions;
+
+/**
+ * @brief Get default server settings
+ * @param socket_path Socket to listen on
+ * @return ServerOptions with defaults from config.h
+ */
+ServerOptions server_options_init(const char *socket_path);
+
+/**
+ * @brief Serve password requests until SIGINT or SIGTERM
+ * @param options Server settings
+ * @return true if the server started and shut down cleanly, false otherwise
+ *
+ * Each client gets its own thread with a DRBG seeded once at connect and
+ * a compiled charset cache, so a request costs no system calls beyond the
+ * socket I/O. The protocol is line based; every request is one line:
+ *
+ *   GEN [COUNT] [length=N] [uppercase=0|1] [lowercase=0|1] [numbers=0|1]
+ *       [special=0|1] [avoid-ambiguous=0|1] [reject-weak=0|1] [reject-dictionary=0|1]
+ *   PING
+ *   QUIT
+ *
+ * GEN answers "OK COUNT" followed by one password per line; PING answers
+ * "PONG"; errors answer "ERR message". Pipelined requests are answered
+ * in a single write. The socket is created with mode 0600 and removed on
+ * shutdown. Not available on Windows.
+ */
+bool run_server(const ServerOptions *options);
+
+#endif /* SERVER_H */
\ No newline at end of file
@@ -0,0 +1,196 @@
+/**
+ * @file spg_archive.c
+ * @brief SPG binary password archives implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "spg_archive.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* The fixed-width parts of the format */
+#define SPG_ARCHIVE_HEADER_SIZE 64
+#define SPG_ARCHIVE_ENTRY_SIZE 8
+#define SPG_ARCHIVE_FOOTER_SIZE 64
+
+/**
+ * @brief Read a uint64_t from possibly unaligned memory
+ */
+static uint64_t load_u64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Round a blob size up to the table alignment
+ */
+static uint64_t align8(uint64_t value) {
+    return (value + 7) & ~(uint64_t)7;
+}
+
+/**
+ * @brief Check whether data starts with an SPG header
+ */
+bool spg_archive_has_header(const void *data, size_t size) {
+    return data && size >= SPG_ARCHIVE_HEADER_SIZE + SPG_ARCHIVE_FOOTER_SIZE &&
+           memcmp(data, SPG_ARCHIVE_MAGIC, 8) == 0;
+}
+
+/**
+ * @brief Locate the parts of an archive
+ */
+bool spg_archive_parse(SpgArchiveLayout *layout, const void *data, size_t size) {
+    if (!layout) {
+        return false;
+    }
+    
+    memset(layout, 0, sizeof(SpgArchiveLayout));
+    
+    if (!spg_archive_has_header(data, size)) {
+        return false;
+    }
+    
+    SpgArchiveHeader header;
+    SpgArchiveFooter footer;
+    memcpy(&header, data, sizeof(header));
+    memcpy(&footer, (const unsigned char *)data + size - SPG_ARCHIVE_FOOTER_SIZE, sizeof(footer));
+    
+    if (header.byte_order != SPG_ARCHIVE_BYTE_ORDER || header.version != SPG_ARCHIVE_VERSION ||
+        memcmp(footer.magic, SPG_ARCHIVE_FOOTER_MAGIC, 8) != 0) {
+        return false;
+    }
+    
+    /* Every table must sit exactly where the writer puts it */
+    uint64_t available = (uint64_t)size - SPG_ARCHIVE_HEADER_SIZE - SPG_ARCHIVE_FOOTER_SIZE;
+    if (footer.blob_offset != SPG_ARCHIVE_HEADER_SIZE || footer.blob_size > available ||
+        footer.count > available / (2 * SPG_ARCHIVE_ENTRY_SIZE)) {
+        return false;
+    }
+    
+    uint64_t entries_offset = align8(SPG_ARCHIVE_HEADER_SIZE + footer.blob_size);
+    uint64_t index_offset = entries_offset + footer.count * SPG_ARCHIVE_ENTRY_SIZE;
+    if (footer.entries_offset != entries_offset || footer.index_offset != index_offset ||
+        index_offset + (footer.count + 1) * sizeof(uint64_t) + SPG_ARCHIVE_FOOTER_SIZE != size) {
+        return false;
+    }
+    
+    layout->data = (const unsigned char *)data;
+    layout->count = (size_t)footer.count;
+    layout->blob_offset = (size_t)footer.blob_offset;
+    layout->blob_size = (size_t)footer.blob_size;
+    layout->entries_offset = (size_t)entries_offset;
+    layout->index_offset = (size_t)index_offset;
+    return true;
+}
+
+/**
+ * @brief Read one entry of an archive
+ */
+bool spg_archive_entry(const SpgArchiveLayout *layout, size_t index, const char **password,
+                       size_t *length, SpgArchiveEntry *entry) {
+    if (!layout || !layout->data || index >= layout->count) {
+        return false;
+    }
+    
+    const unsigned char *offsets = layout->data + layout->index_offset;
+    uint64_t begin = load_u64(offsets + index * sizeof(uint64_t));
+    uint64_t end = load_u64(offsets + (index + 1) * sizeof(uint64_t));
+    if (begin > end || end > layout->blob_size) {
+        return false;
+    }
+    
+    if (password) {
+        *password = (const char *)layout->data + layout->blob_offset + begin;
+    }
+    if (length) {
+        *length = (size_t)(end - begin);
+    }
+    if (entry) {
+        memcpy(entry, layout->data + layout->entries_offset + index * SPG_ARCHIVE_ENTRY_SIZE,
+               sizeof(SpgArchiveEntry));
+    }
+    return true;
+}
+
+/**
+ * @brief Fill in the header of a new archive
+ */
+void spg_archive_header_init(SpgArchiveHeader *header) {
+    memset(header, 0, sizeof(SpgArchiveHeader));
+    memcpy(header->magic, SPG_ARCHIVE_MAGIC, 8);
+    header->byte_order = SPG_ARCHIVE_BYTE_ORDER;
+    header->version = SPG_ARCHIVE_VERSION;
+}
+
+/**
+ * @brief Record one entry written to the blob
+ */
+bool spg_archive_tables_add(SpgArchiveTables *tables, size_t length, double entropy, int score,
+                            uint8_t level) {
+    if (!tables) {
+        return false;
+    }
+    
+    if (tables->count == tables->capacity) {
+        size_t grown = tables->capacity ? tables->capacity * 2 : 4096;
+        SpgArchiveEntry *entries = (SpgArchiveEntry *)realloc(tables->entries,
+                                                              grown * sizeof(SpgArchiveEntry));
+        if (!entries) {
+            return false;
+        }
+        tables->entries = entries;
+        
+        uint64_t *offsets = (uint64_t *)realloc(tables->offsets, (grown + 1) * sizeof(uint64_t));
+        if (!offsets) {
+            return false;
+        }
+        tables->offsets = offsets;
+        tables->capacity = grown;
+    }
+    
+    SpgArchiveEntry *entry = &tables->entries[tables->count];
+    entry->entropy = (float)entropy;
+    entry->strength_score = (uint8_t)(score < 0 ? 0 : score > 100 ? 100 : score);
+    entry->strength_level = level;
+    entry->reserved = 0;
+    
+    tables->offsets[tables->count] = tables->blob_size;
+    tables->blob_size += length;
+    tables->count++;
+    tables->offsets[tables->count] = tables->blob_size;
+    return true;
+}
+
+/**
+ * @brief Get the zero padding that follows the blob
+ */
+size_t spg_archive_blob_padding(const SpgArchiveTables *tables) {
+    uint64_t end = SPG_ARCHIVE_HEADER_SIZE + tables->blob_size;
+    return (size_t)(align8(end) - end);
+}
+
+/**
+ * @brief Fill in the footer that closes an archive
+ */
+void spg_archive_footer_init(SpgArchiveFooter *footer, const SpgArchiveTables *tables) {
+    memset(footer, 0, sizeof(SpgArchiveFooter));
+    footer->count = tables->count;
+    footer->blob_offset = SPG_ARCHIVE_HEADER_SIZE;
+    footer->blob_size = tables->blob_size;
+    footer->entries_offset = align8(SPG_ARCHIVE_HEADER_SIZE + tables->blob_size);
+    footer->index_offset = footer->entries_offset + tables->count * SPG_ARCHIVE_ENTRY_SIZE;
+    memcpy(footer->magic, SPG_ARCHIVE_FOOTER_MAGIC, 8);
+}
+
+/**
+ * @brief Release collected tables
+ */
+void spg_archive_tables_free(SpgArchiveTables *tables) {
+    if (tables) {
+        free(tables->entries);
+        free(tables->offsets);
+        memset(tables, 0, sizeof(SpgArchiveTables));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+/**
+ * @file spg_archive.h
+ * @brief SPG binary password archives with an offset index
+ * @version 1.0
+ * @date 2024
+ *
+ * Layout (values in host byte order, tables 8-byte aligned):
+ *
+ *     SpgArchiveHeader         64 bytes
+ *     blob                     passwords concatenated, no separators
+ *     padding                  zero bytes up to a multiple of 8
+ *     SpgArchiveEntry[count]   fixed-width metadata, 8 bytes each
+ *     uint64_t[count + 1]      blob offsets; entry i is blob[offsets[i], offsets[i + 1])
+ *     SpgArchiveFooter         64 bytes
+ *
+ * The tables follow the blob so an archive can be written in one pass to
+ * a pipe; readers find them through the footer. Opening checks only the
+ * header and footer, and each entry's offsets are checked when it is read,
+ * so lookup by index costs the same for any archive size.
+ */
+
+#ifndef SPG_ARCHIVE_H
+#define SPG_ARCHIVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPG_ARCHIVE_MAGIC "SPGPASS1"
+#define SPG_ARCHIVE_FOOTER_MAGIC "SPGINDX1"
+#define SPG_ARCHIVE_BYTE_ORDER 0x01020304u
+#define SPG_ARCHIVE_VERSION 1
+
+/**
+ * @brief Archive header (64 bytes)
+ */
+typedef struct {
+    char magic[8];                  /**< SPG_ARCHIVE_MAGIC */
+    uint32_t byte_order;            /**< SPG_ARCHIVE_BYTE_ORDER */
+    uint32_t version;               /**< SPG_ARCHIVE_VERSION */
+    uint64_t reserved[6];           /**< Zero */
+} SpgArchiveHeader;
+
+/**
+ * @brief Fixed-width metadata of one entry (8 bytes)
+ */
+typedef struct {
+    float entropy;                  /**< Entropy in bits */
+    uint8_t strength_score;         /**< Strength score (0-100) */
+    uint8_t strength_level;         /**< Strength level (0-5 or STRENGTH_LEVEL_UNKNOWN) */
+    uint16_t reserved;              /**< Zero */
+} SpgArchiveEntry;
+
+/**
+ * @brief Archive footer (64 bytes)
+ */
+typedef struct {
+    uint64_t count;                 /**< Number of entries */
+    uint64_t blob_offset;           /**< File offset of the blob */
+    uint64_t blob_size;             /**< Bytes of password text */
+    uint64_t entries_offset;        /**< File offset of the SpgArchiveEntry table */
+    uint64_t index_offset;          /**< File offset of the offset table */
+    uint64_t reserved[2];           /**< Zero */
+    char magic[8];                  /**< SPG_ARCHIVE_FOOTER_MAGIC */
+} SpgArchiveFooter;
+
+/**
+ * @brief Validated position of an archive's parts inside its bytes
+ */
+typedef struct {
+    const unsigned char *data;      /**< Archive bytes (borrowed) */
+    size_t count;                   /**< Number of entries */
+    size_t blob_offset;             /**< Offset of the blob */
+    size_t blob_size;               /**< Bytes of password text */
+    size_t entries_offset;          /**< Offset of the SpgArchiveEntry table */
+    size_t index_offset;            /**< Offset of the offset table */
+} SpgArchiveLayout;
+
+/**
+ * @brief Metadata and offsets collected while an archive is written
+ */
+typedef struct SpgArchiveTables {
+    SpgArchiveEntry *entries;              /**< Metadata of each entry */
+    uint64_t *offsets;              /**< Blob offsets (count + 1 in use) */
+    size_t count;                   /**< Entries added */
+    size_t capacity;                /**< Entries allocated */
+    uint64_t blob_size;             /**< Bytes of password text so far */
+} SpgArchiveTables;
+
+/**
+ * @brief Check whether data starts with an SPG header
+ * @param data Archive bytes
+ * @param size Number of bytes
+ * @return true if the magic matches
+ */
+bool spg_archive_has_header(const void *data, size_t size);
+
+/**
+ * @brief Locate the parts of an archive
+ * @param layout Pointer to store the layout
+ * @param data Archive bytes (must outlive the layout)
+ * @param size Number of bytes
+ * @return true if the header, footer and table positions are consistent
+ */
+bool spg_archive_parse(SpgArchiveLayout *layout, const void *data, size_t size);
+
+/**
+ * @brief Read one entry of an archive
+ * @param layout Parsed layout
+ * @param index Entry index (0 to count - 1)
+ * @param password Pointer to store the password (not NUL-terminated; may be NULL)
+ * @param length Pointer to store its length (may be NULL)
+ * @param entry Pointer to store its metadata (may be NULL)
+ * @return true if the entry exists and its offsets are valid, false otherwise
+ */
+bool spg_archive_entry(const SpgArchiveLayout *layout, size_t index, const char **password,
+                       size_t *length, SpgArchiveEntry *entry);
+
+/**
+ * @brief Fill in the header of a new archive
+ * @param header Header to initialize
+ */
+void spg_archive_header_init(SpgArchiveHeader *header);
+
+/**
+ * @brief Record one entry written to the blob
+ * @param tables Tables of the archive being written (zero-initialized before the first call)
+ * @param length Password length in bytes
+ * @param entropy Entropy in bits
+ * @param score Strength score (0-100)
+ * @param level Strength level (0-5 or STRENGTH_LEVEL_UNKNOWN)
+ * @return true if successful, false if out of memory
+ */
+bool spg_archive_tables_add(SpgArchiveTables *tables, size_t length, double entropy, int score,
+                            uint8_t level);
+
+/**
+ * @brief Get the zero padding that follows the blob
+ * @param tables Tables of the archive being written
+ * @return Bytes of padding (0-7)
+ */
+size_t spg_archive_blob_padding(const SpgArchiveTables *tables);
+
+/**
+ * @brief Fill in the footer that closes an archive
+ * @param footer Footer to initialize
+ * @param tables Tables of the archive being written
+ */
+void spg_archive_footer_init(SpgArchiveFooter *footer, const SpgArchiveTables *tables);
+
+/**
+ * @brief Release collected tables
+ * @param tables Tables to free
+ */
+void spg_archive_tables_free(SpgArchiveTables *tables);
+
+#endif /* SPG_ARCHIVE_H */
\ No newline at end of file
@@ -0,0 +1,462 @@
+/**
+ * @file stats.c
+ * @brief Hot-path timers and counters implementation
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "stats.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+/**
+ * @brief Stage names, indexed by StatsStage
+ */
+static const char *const stage_names[STATS_STAGE_COUNT] = {
+    "rng", "charset", "sampling", "repair", "assess", "encode", "io", "request"
+};
+
+/**
+ * @brief Get the name of a stage
+ */
+const char *stats_stage_name(StatsStage stage) {
+    return stage < STATS_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
+
+/**
+ * @brief Determine report format from a name
+ */
+bool stats_format_from_name(const char *name, StatsFormat *format) {
+    if (!name || !format) {
+        return false;
+    }
+    
+    static const struct {
+        const char *name;
+        StatsFormat format;
+    } names[] = {
+        {"table", STATS_FORMAT_TABLE},
+        {"text", STATS_FORMAT_TABLE},
+        {"json", STATS_FORMAT_JSON},
+    };
+    
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        const char *a = name;
+        const char *b = names[i].name;
+        while (*a && tolower((unsigned char)*a) == *b) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && *b == '\0') {
+            *format = names[i].format;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+#ifndef PASSGEN_NO_STATS
+
+#include <stdatomic.h>
+
+/**
+ * @brief Counters of one thread
+ *
+ * Only the owning thread writes them; relaxed atomics let a report read
+ * them while the thread is still running without locking the hot path.
+ */
+typedef struct StatsThread {
+    _Atomic uint64_t calls[STATS_STAGE_COUNT];
+    _Atomic uint64_t total_ns[STATS_STAGE_COUNT];
+    _Atomic uint64_t bytes[STATS_STAGE_COUNT];
+    _Atomic uint64_t max_ns[STATS_STAGE_COUNT];
+    _Atomic uint64_t histogram[STATS_STAGE_COUNT][STATS_HISTOGRAM_BUCKETS];
+    struct StatsThread *next;
+} StatsThread;
+
+bool stats_active = false;
+_Thread_local uint64_t stats_child_ns = 0;
+
+static _Thread_local StatsThread *stats_local = NULL;
+
+/* Live threads and the folded-in counters of threads that have exited */
+static struct {
+    ParallelOnce once;
+    ParallelMutex lock;
+    StatsThread *threads;
+    StatsThread retired;
+    uint64_t start_ns;
+} registry = {PARALLEL_ONCE_INIT};
+
+/**
+ * @brief Set up the registry lock
+ */
+static void registry_init(void) {
+    parallel_mutex_init(&registry.lock);
+}
+
+/**
+ * @brief Read the monotonic clock
+ */
+uint64_t stats_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Single-writer increment (a plain load and store, no lock prefix)
+ */
+static inline void counter_add(_Atomic uint64_t *counter, uint64_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief Read a counter written by another thread
+ */
+static inline uint64_t counter_get(_Atomic uint64_t *counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+/**
+ * @brief Index of the top set bit
+ */
+static inline int highest_bit(uint64_t value) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * @brief Histogram bucket of a duration
+ */
+static size_t bucket_of(uint64_t ns) {
+    if (ns < (1u << STATS_HISTOGRAM_SUB_BITS)) {
+        return (size_t)ns;
+    }
+    
+    int bit = highest_bit(ns);
+    int shift = bit - STATS_HISTOGRAM_SUB_BITS;
+    size_t group = (size_t)(shift + 1) << STATS_HISTOGRAM_SUB_BITS;
+    return group + (size_t)((ns >> shift) & ((1u << STATS_HISTOGRAM_SUB_BITS) - 1));
+}
+
+/**
+ * @brief Largest duration that falls into a bucket
+ */
+static uint64_t bucket_upper(size_t bucket) {
+    size_t sub_count = (size_t)1 << STATS_HISTOGRAM_SUB_BITS;
+    if (bucket < sub_count) {
+        return bucket;
+    }
+    
+    int shift = (int)(bucket >> STATS_HISTOGRAM_SUB_BITS) - 1;
+    uint64_t lower = (uint64_t)(sub_count + (bucket & (sub_count - 1))) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+/**
+ * @brief Give the calling thread its counters
+ */
+static StatsThread *stats_attach(void) {
+    StatsThread *thread = calloc(1, sizeof(StatsThread));
+    if (!thread) {
+        return NULL;
+    }
+    
+    parallel_mutex_lock(&registry.lock);
+    thread->next = registry.threads;
+    registry.threads = thread;
+    parallel_mutex_unlock(&registry.lock);
+    
+    stats_local = thread;
+    return thread;
+}
+
+/**
+ * @brief Charge a finished section to the calling thread's counters
+ */
+void stats_record(StatsStage stage, uint64_t elapsed_ns, uint64_t bytes) {
+    StatsThread *thread = stats_local ? stats_local : stats_attach();
+    if (!thread || stage >= STATS_STAGE_COUNT) {
+        return;
+    }
+    
+    counter_add(&thread->calls[stage], 1);
+    counter_add(&thread->total_ns[stage], elapsed_ns);
+    counter_add(&thread->bytes[stage], bytes);
+    counter_add(&thread->histogram[stage][bucket_of(elapsed_ns)], 1);
+    if (elapsed_ns > counter_get(&thread->max_ns[stage])) {
+        atomic_store_explicit(&thread->max_ns[stage], elapsed_ns, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Turn the timers on and start the wall clock
+ */
+bool stats_enable(void) {
+    parallel_once(&registry.once, registry_init);
+    registry.start_ns = stats_now_ns();
+    stats_active = true;
+    return true;
+}
+
+/**
+ * @brief Check whether the timers are on
+ */
+bool stats_enabled(void) {
+    return stats_active;
+}
+
+/**
+ * @brief Add one thread's counters into another set
+ */
+static void merge_into(StatsThread *total, StatsThread *part) {
+    for (int stage = 0; stage < STATS_STAGE_COUNT; stage++) {
+        counter_add(&total->calls[stage], counter_get(&part->calls[stage]));
+        counter_add(&total->total_ns[stage], counter_get(&part->total_ns[stage]));
+        counter_add(&total->bytes[stage], counter_get(&part->bytes[stage]));
+        
+        uint64_t max = counter_get(&part->max_ns[stage]);
+        if (max > counter_get(&total->max_ns[stage])) {
+            atomic_store_explicit(&total->max_ns[stage], max, memory_order_relaxed);
+        }
+        
+        for (size_t i = 0; i < STATS_HISTOGRAM_BUCKETS; i++) {
+            uint64_t count = counter_get(&part->histogram[stage][i]);
+            if (count) {
+                counter_add(&total->histogram[stage][i], count);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fold the calling thread's counters into the totals
+ */
+void stats_thread_exit(void) {
+    StatsThread *thread = stats_local;
+    if (!thread) {
+        return;
+    }
+    
+    parallel_mutex_lock(&registry.lock);
+    for (StatsThread **link = &registry.threads; *link; link = &(*link)->next) {
+        if (*link == thread) {
+            *link = thread->next;
+            break;
+        }
+    }
+    merge_into(&registry.retired, thread);
+    parallel_mutex_unlock(&registry.lock);
+    
+    stats_local = NULL;
+    free(thread);
+}
+
+/**
+ * @brief Sum the counters of every thread, live or exited
+ */
+static void snapshot(StatsThread *total) {
+    memset(total, 0, sizeof(StatsThread));
+    
+    parallel_mutex_lock(&registry.lock);
+    merge_into(total, &registry.retired);
+    for (StatsThread *thread = registry.threads; thread; thread = thread->next) {
+        merge_into(total, thread);
+    }
+    parallel_mutex_unlock(&registry.lock);
+}
+
+/**
+ * @brief Summarize one stage of a snapshot
+ */
+static void summarize_stage(StatsThread *total, StatsStage stage, StatsStageSummary *summary) {
+    summary->calls = counter_get(&total->calls[stage]);
+    summary->total_ns = counter_get(&total->total_ns[stage]);
+    summary->bytes = counter_get(&total->bytes[stage]);
+    summary->max_ns = counter_get(&total->max_ns[stage]);
+    
+    /* Percentiles are read off the cumulative histogram */
+    const double quantiles[3] = {0.50, 0.90, 0.99};
+    uint64_t *targets[3] = {&summary->p50_ns, &summary->p90_ns, &summary->p99_ns};
+    uint64_t seen = 0;
+    int next = 0;
+    
+    for (size_t i = 0; i < STATS_HISTOGRAM_BUCKETS && next < 3 && summary->calls > 0; i++) {
+        seen += counter_get(&total->histogram[stage][i]);
+        while (next < 3 && (double)seen >= quantiles[next] * (double)summary->calls) {
+            uint64_t upper = bucket_upper(i);
+            *targets[next++] = upper < summary->max_ns ? upper : summary->max_ns;
+        }
+    }
+}
+
+/**
+ * @brief Get a stage summary combining every thread
+ */
+void stats_summarize(StatsStage stage, StatsStageSummary *summary) {
+    if (!summary) {
+        return;
+    }
+    
+    memset(summary, 0, sizeof(StatsStageSummary));
+    if (!stats_active || stage >= STATS_STAGE_COUNT) {
+        return;
+    }
+    
+    StatsThread *total = malloc(sizeof(StatsThread));
+    if (!total) {
+        return;
+    }
+    snapshot(total);
+    summarize_stage(total, stage, summary);
+    free(total);
+}
+
+/**
+ * @brief Write a report of every stage
+ */
+void stats_report(FILE *stream, StatsFormat format) {
+    if (!stream) {
+        return;
+    }
+    
+    StatsStageSummary summaries[STATS_STAGE_COUNT];
+    memset(summaries, 0, sizeof(summaries));
+    
+    StatsThread *total = stats_active ? malloc(sizeof(StatsThread)) : NULL;
+    if (total) {
+        snapshot(total);
+    }
+    
+    uint64_t instrumented = 0;
+    for (int stage = 0; stage < STATS_STAGE_COUNT; stage++) {
+        if (total) {
+            summarize_stage(total, (StatsStage)stage, &summaries[stage]);
+        }
+        if (stage != STATS_REQUEST) {
+            instrumented += summaries[stage].total_ns;
+        }
+    }
+    free(total);
+    uint64_t wall = stats_active ? stats_now_ns() - registry.start_ns : 0;
+    
+    if (format == STATS_FORMAT_JSON) {
+        fprintf(stream, "{\"wall_ns\": %llu, \"instrumented_ns\": %llu, \"stages\": {",
+                (unsigned long long)wall, (unsigned long long)instrumented);
+        for (int stage = 0; stage < STATS_STAGE_COUNT; stage++) {
+            const StatsStageSummary *s = &summaries[stage];
+            fprintf(stream, "%s\"%s\": {\"calls\": %llu, \"total_ns\": %llu, \"mean_ns\": %llu, "
+                    "\"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu, "
+                    "\"bytes\": %llu}",
+                    stage > 0 ? ", " : "", stage_names[stage],
+                    (unsigned long long)s->calls, (unsigned long long)s->total_ns,
+                    (unsigned long long)(s->calls ? s->total_ns / s->calls : 0),
+                    (unsigned long long)s->p50_ns, (unsigned long long)s->p90_ns,
+                    (unsigned long long)s->p99_ns, (unsigned long long)s->max_ns,
+                    (unsigned long long)s->bytes);
+        }
+        fprintf(stream, "}}\n");
+        return;
+    }
+    
+    fprintf(stream, "Wall time %.3f ms, instrumented %.3f ms (%.1f%%)\n",
+            (double)wall / 1e6, (double)instrumented / 1e6,
+            wall ? 100.0 * (double)instrumented / (double)wall : 0.0);
+    fprintf(stream, "%-9s %10s %11s %6s %9s %9s %9s %9s %10s %9s\n", "Stage", "Calls",
+            "Total ms", "Share", "Mean ns", "p50 ns", "p90 ns", "p99 ns", "Max ns", "MB/s");
+            
+    for (int stage = 0; stage < STATS_STAGE_COUNT; stage++) {
+        const StatsStageSummary *s = &summaries[stage];
+        if (s->calls == 0) {
+            continue;
+        }
+        
+        char share[16] = "-";
+        char rate[16] = "-";
+        if (stage != STATS_REQUEST && instrumented > 0) {
+            snprintf(share, sizeof(share), "%.1f%%",
+                     100.0 * (double)s->total_ns / (double)instrumented);
+        }
+        if (s->bytes > 0 && s->total_ns > 0) {
+            snprintf(rate, sizeof(rate), "%.1f", (double)s->bytes * 1e3 / (double)s->total_ns);
+        }
+        
+        fprintf(stream, "%-9s %10llu %11.3f %6s %9llu %9llu %9llu %9llu %10llu %9s\n",
+                stage_names[stage], (unsigned long long)s->calls, (double)s->total_ns / 1e6,
+                share, (unsigned long long)(s->total_ns / s->calls),
+                (unsigned long long)s->p50_ns, (unsigned long long)s->p90_ns,
+                (unsigned long long)s->p99_ns, (unsigned long long)s->max_ns, rate);
+    }
+}
+
+#else
+
+/**
+ * @brief Statistics are compiled out
+ */
+bool stats_enable(void) {
+    return false;
+}
+
+/**
+ * @brief Statistics are compiled out
+ */
+bool stats_enabled(void) {
+    return false;
+}
+
+/**
+ * @brief Statistics are compiled out
+ */
+void stats_thread_exit(void) {
+}
+
+/**
+ * @brief Statistics are compiled out
+ */
+void stats_summarize(StatsStage stage, StatsStageSummary *summary) {
+    (void)stage;
+    if (summary) {
+        memset(summary, 0, sizeof(StatsStageSummary));
+    }
+}
+
+/**
+ * @brief Statistics are compiled out
+ */
+void stats_report(FILE *stream, StatsFormat format) {
+    (void)format;
+    if (stream) {
+        fprintf(stream, "Statistics were compiled out (PASSGEN_NO_STATS)\n");
+    }
+}
+
+#endif /* PASSGEN_NO_STATS */
\ No newline at end of file
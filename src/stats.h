@@ -0,0 +1,190 @@
+/**
+ * @file stats.h
+ * @brief Hot-path timers and counters for --stats
+ * @version 1.0
+ * @date 2024
+ *
+ * Each thread records into its own counters, so timing a section costs two
+ * clock reads and a few uncontended stores; nothing is shared until a
+ * report is taken. Timers do nothing until stats_enable() is called, and
+ * building with -DPASSGEN_NO_STATS removes them entirely.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Instrumented sections
+ */
+typedef enum {
+    STATS_RNG = 0,      /**< Random block fetches */
+    STATS_CHARSET,      /**< Charset compilation */
+    STATS_SAMPLING,     /**< Candidate drawing */
+    STATS_REPAIR,       /**< Requirement repair */
+    STATS_ASSESS,       /**< Pattern checks and strength assessment */
+    STATS_ENCODE,       /**< Export encoding */
+    STATS_IO,           /**< File and socket reads and writes */
+    STATS_REQUEST,      /**< Whole server requests (inclusive latency) */
+    STATS_STAGE_COUNT
+} StatsStage;
+
+/**
+ * @brief Report formats
+ */
+typedef enum {
+    STATS_FORMAT_TABLE,     /**< Aligned human-readable table */
+    STATS_FORMAT_JSON       /**< One JSON object */
+} StatsFormat;
+
+/**
+ * @brief Latency histogram layout: 8 linear buckets per power of two
+ */
+#define STATS_HISTOGRAM_SUB_BITS 3
+#define STATS_HISTOGRAM_BUCKETS 512
+
+/**
+ * @brief A running timer
+ *
+ * Sections nest: time spent in an inner section is charged to the inner
+ * stage only, so stage totals add up to the instrumented wall time.
+ */
+typedef struct {
+    uint64_t start;         /**< Start time in ns (0 = not timing) */
+    uint64_t outer_child;   /**< Inner time of the enclosing section */
+} StatsTimer;
+
+/**
+ * @brief Aggregated figures for one stage
+ */
+typedef struct {
+    uint64_t calls;         /**< Sections recorded */
+    uint64_t total_ns;      /**< Time charged to the stage */
+    uint64_t bytes;         /**< Bytes processed (RNG, I/O) */
+    uint64_t max_ns;        /**< Longest section */
+    uint64_t p50_ns;        /**< Median section (bucket upper bound) */
+    uint64_t p90_ns;        /**< 90th percentile */
+    uint64_t p99_ns;        /**< 99th percentile */
+} StatsStageSummary;
+
+#ifndef PASSGEN_NO_STATS
+
+extern bool stats_active;
+extern _Thread_local uint64_t stats_child_ns;
+
+/**
+ * @brief Read the monotonic clock
+ * @return Nanoseconds since an arbitrary epoch
+ */
+uint64_t stats_now_ns(void);
+
+/**
+ * @brief Charge a finished section to the calling thread's counters
+ * @param stage Stage to charge
+ * @param elapsed_ns Time to charge
+ * @param bytes Bytes processed
+ */
+void stats_record(StatsStage stage, uint64_t elapsed_ns, uint64_t bytes);
+
+/**
+ * @brief Start timing a section
+ * @return Timer to pass to stats_end()
+ */
+static inline StatsTimer stats_begin(void) {
+    StatsTimer timer = {0, 0};
+    if (stats_active) {
+        timer.outer_child = stats_child_ns;
+        stats_child_ns = 0;
+        timer.start = stats_now_ns();
+    }
+    return timer;
+}
+
+/**
+ * @brief Stop timing a section
+ * @param stage Stage to charge
+ * @param timer Timer from stats_begin()
+ * @param bytes Bytes processed by the section (0 if not meaningful)
+ */
+static inline void stats_end(StatsStage stage, const StatsTimer *timer, uint64_t bytes) {
+    if (timer->start == 0) {
+        return;
+    }
+
+    uint64_t elapsed = stats_now_ns() - timer->start;
+    uint64_t own = elapsed > stats_child_ns ? elapsed - stats_child_ns : 0;
+    stats_child_ns = timer->outer_child + elapsed;
+    stats_record(stage, stage == STATS_REQUEST ? elapsed : own, bytes);
+}
+
+#else
+
+static inline StatsTimer stats_begin(void) {
+    StatsTimer timer = {0, 0};
+    return timer;
+}
+
+static inline void stats_end(StatsStage stage, const StatsTimer *timer, uint64_t bytes) {
+    (void)stage;
+    (void)timer;
+    (void)bytes;
+}
+
+#endif /* PASSGEN_NO_STATS */
+
+/**
+ * @brief Turn the timers on and start the wall clock
+ * @return false if statistics were compiled out
+ *
+ * Call before starting worker threads.
+ */
+bool stats_enable(void);
+
+/**
+ * @brief Check whether the timers are on
+ * @return true if stats_enable() succeeded
+ */
+bool stats_enabled(void);
+
+/**
+ * @brief Fold the calling thread's counters into the totals
+ *
+ * Called by every thread that may have recorded anything, just before it
+ * exits.
+ */
+void stats_thread_exit(void);
+
+/**
+ * @brief Get a stage summary combining every thread
+ * @param stage Stage to summarize
+ * @param summary Pointer to store the summary
+ */
+void stats_summarize(StatsStage stage, StatsStageSummary *summary);
+
+/**
+ * @brief Get the name of a stage
+ * @param stage Stage
+ * @return Static string
+ */
+const char *stats_stage_name(StatsStage stage);
+
+/**
+ * @brief Determine report format from a name ("table" or "json")
+ * @param name Format name (case-insensitive)
+ * @param format Pointer to store the format
+ * @return true if the name is known, false otherwise
+ */
+bool stats_format_from_name(const char *name, StatsFormat *format);
+
+/**
+ * @brief Write a report of every stage
+ * @param stream Stream to write to
+ * @param format Report format
+ */
+void stats_report(FILE *stream, StatsFormat format);
+
+#endif /* STATS_H */
\ No newline at end of file
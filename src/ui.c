@@ -7,6 +7,8 @@
 
 #include "ui.h"
 #include "config.h"
+#include "security.h"
+#include "dedup.h"
 #include "utils.h"
 #include "clipboard.h"
 #include <stdio.h>
@@ -17,6 +19,43 @@
 /* Global UI configuration */
 static UIConfig global_ui_config;
 
+/* Bytes one rendered frame may hold */
+#define UI_FRAME_SIZE 1024
+
+/**
+ * @brief Line being rendered, written to the terminal in one call
+ */
+typedef struct {
+    char data[UI_FRAME_SIZE];
+    size_t length;
+} UIFrame;
+
+/* Spinner glyphs, one terminal column each */
+static const char *const spinner_frames[] = {"⣾", "⣽", "⣻", "⢿", "⡿", "⣟", "⣯", "⣷"};
+#define SPINNER_FRAME_COUNT (sizeof(spinner_frames) / sizeof(spinner_frames[0]))
+
+/**
+ * @brief Append text to a frame, truncating at its capacity
+ */
+static void frame_append(UIFrame *frame, const char *text) {
+    size_t length = strlen(text);
+    size_t room = sizeof(frame->data) - frame->length;
+    if (length > room) {
+        length = room;
+    }
+    memcpy(frame->data + frame->length, text, length);
+    frame->length += length;
+}
+
+/**
+ * @brief Write a frame to stdout with one write and one flush
+ */
+static void frame_flush(UIFrame *frame) {
+    fwrite(frame->data, 1, frame->length, stdout);
+    fflush(stdout);
+    frame->length = 0;
+}
+
 /**
  * @brief Initialize UI configuration with defaults
  */
@@ -271,6 +310,183 @@ void display_bulk_results(const PasswordResult *results, size_t count, const UIC
     printf("\n");
 }
 
+/**
+ * @brief Display every entry of a password batch
+ */
+void display_batch_results(const PasswordBatch *batch, const UIConfig *config) {
+    if (!batch || batch->count == 0) {
+        print_error("No passwords to display!");
+        return;
+    }
+    
+    printf("\n");
+    print_separator(config->terminal_width, '═');
+    printf("%s📦 GENERATED %zu PASSWORDS%s\n\n", 
+           COLOR_BRIGHT_CYAN, batch->count, COLOR_RESET);
+    
+    /* Assess in blocks so color lookup stays a linear pass over the batch */
+    SecurityAssessment assessments[256];
+    const size_t block = sizeof(assessments) / sizeof(assessments[0]);
+    
+    /* Repeats within the batch are flagged; without memory for the set they are not */
+    UniqueSet seen;
+    bool check_duplicates = unique_set_init(&seen, batch->count);
+    size_t duplicates = 0;
+    
+    for (size_t begin = 0; begin < batch->count; begin += block) {
+        size_t end = begin + block < batch->count ? begin + block : batch->count;
+        assess_password_batch(batch, begin, end, assessments);
+        if (check_duplicates) {
+            duplicates += unique_set_mark_batch(&seen, batch, begin, end, assessments);
+        }
+        
+        for (size_t i = begin; i < end; i++) {
+            const char *color = get_strength_color(assessments[i - begin].category);
+            
+            printf("%s[%03zu]%s ", COLOR_BRIGHT_BLUE, i + 1, COLOR_RESET);
+            printf("%s%s%s ", color, batch->chars + i * batch->stride, COLOR_RESET);
+            printf("(%s%u chars%s, ", COLOR_CYAN, (unsigned)batch->lengths[i], COLOR_RESET);
+            printf("%s%.1f bits%s)", COLOR_MAGENTA, batch->entropy[i], COLOR_RESET);
+            if (assessments[i - begin].is_duplicate) {
+                printf(" %s⚠️  duplicate%s", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+            }
+            printf("\n");
+        }
+    }
+    
+    if (check_duplicates) {
+        unique_set_destroy(&seen);
+    }
+    
+    double avg_entropy;
+    int avg_strength;
+    password_batch_summary(batch, &avg_entropy, &avg_strength);
+    
+    printf("\n%s📈 Summary:%s\n", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+    printf("  Average Entropy: %s%.1f bits%s\n", 
+           COLOR_CYAN, avg_entropy, COLOR_RESET);
+    printf("  Average Strength: %s%d/100%s\n", 
+           get_strength_color((StrengthCategory)(avg_strength / 20)), 
+           avg_strength, COLOR_RESET);
+    if (duplicates > 0) {
+        printf("  Duplicates: %s%zu%s\n", COLOR_BRIGHT_YELLOW, duplicates, COLOR_RESET);
+    }
+    
+    secure_clear(assessments, sizeof(assessments));
+    print_separator(config->terminal_width, '═');
+    printf("\n");
+}
+
+/**
+ * @brief Report candidate and rejection counts on stderr
+ */
+void display_generation_stats(const GenerationStats *stats) {
+    if (!stats || stats->candidates == 0) {
+        return;
+    }
+    
+    uint64_t rejected = stats->rejected_requirements + stats->rejected_weak + 
+                        stats->rejected_dictionary + stats->rejected_duplicates +
+                        stats->rejected_similar + stats->rejected_history;
+    
+    fprintf(stderr, "%s🔁 Candidates: %llu, rejected: %llu (%.1f%%)%s\n", 
+            COLOR_BRIGHT_YELLOW, (unsigned long long)stats->candidates,
+            (unsigned long long)rejected, 
+            100.0 * (double)rejected / (double)stats->candidates, COLOR_RESET);
+    fprintf(stderr, "  Requirements: %llu, weak patterns: %llu, dictionary: %llu\n",
+            (unsigned long long)stats->rejected_requirements,
+            (unsigned long long)stats->rejected_weak,
+            (unsigned long long)stats->rejected_dictionary);
+    
+    if (stats->rejected_duplicates > 0 || stats->rejected_similar > 0) {
+        fprintf(stderr, "  Duplicates: %llu, near-duplicates: %llu\n",
+                (unsigned long long)stats->rejected_duplicates,
+                (unsigned long long)stats->rejected_similar);
+    }
+    
+    if (stats->rejected_history > 0) {
+        fprintf(stderr, "  Issued before (history): %llu\n",
+                (unsigned long long)stats->rejected_history);
+    }
+    
+    if (stats->fallback_repairs > 0 || stats->failures > 0) {
+        fprintf(stderr, "  %sFallback repairs: %llu, failures: %llu%s\n",
+                COLOR_BRIGHT_RED, (unsigned long long)stats->fallback_repairs,
+                (unsigned long long)stats->failures, COLOR_RESET);
+    }
+}
+
+/**
+ * @brief Print one histogram row with a bar scaled to the largest bucket
+ */
+static void print_histogram_row(const char *label, uint64_t value, uint64_t largest, uint64_t total) {
+    int width = largest > 0 ? (int)(value * PROGRESS_BAR_WIDTH / largest) : 0;
+    
+    fprintf(stderr, "  %-12s %s", label, COLOR_CYAN);
+    for (int i = 0; i < width; i++) {
+        fprintf(stderr, "█");
+    }
+    fprintf(stderr, "%s %llu (%.1f%%)\n", COLOR_RESET, (unsigned long long)value,
+            total > 0 ? 100.0 * (double)value / (double)total : 0.0);
+}
+
+/**
+ * @brief Report audit histograms and counters on stderr
+ */
+void display_audit_summary(const AuditSummary *summary) {
+    if (!summary) {
+        return;
+    }
+    
+    fprintf(stderr, "\n%s🔍 Audited %llu passwords%s\n", COLOR_BRIGHT_CYAN,
+            (unsigned long long)summary->total, COLOR_RESET);
+    if (summary->skipped > 0) {
+        fprintf(stderr, "  %sSkipped (too long): %llu%s\n", COLOR_BRIGHT_RED,
+                (unsigned long long)summary->skipped, COLOR_RESET);
+    }
+    if (summary->total == 0) {
+        return;
+    }
+    
+    fprintf(stderr, "  Average Entropy: %.1f bits, Average Strength: %.0f/100\n",
+            summary->entropy_sum / (double)summary->total,
+            (double)summary->score_sum / (double)summary->total);
+    
+    uint64_t largest = 0;
+    for (int i = 0; i < AUDIT_STRENGTH_BUCKETS; i++) {
+        if (summary->strength[i] > largest) largest = summary->strength[i];
+    }
+    
+    fprintf(stderr, "\n%sStrength:%s\n", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+    for (int i = 0; i < AUDIT_STRENGTH_BUCKETS; i++) {
+        print_histogram_row(get_strength_string((StrengthCategory)i), summary->strength[i],
+                            largest, summary->total);
+    }
+    
+    largest = 0;
+    for (int i = 0; i < AUDIT_ENTROPY_BUCKETS; i++) {
+        if (summary->entropy[i] > largest) largest = summary->entropy[i];
+    }
+    
+    fprintf(stderr, "\n%sEntropy (bits):%s\n", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+    for (int i = 0; i < AUDIT_ENTROPY_BUCKETS; i++) {
+        char label[32];
+        if (i == AUDIT_ENTROPY_BUCKETS - 1) {
+            snprintf(label, sizeof(label), "%d+", i * AUDIT_ENTROPY_BUCKET_BITS);
+        } else {
+            snprintf(label, sizeof(label), "%d-%d", i * AUDIT_ENTROPY_BUCKET_BITS,
+                     (i + 1) * AUDIT_ENTROPY_BUCKET_BITS - 1);
+        }
+        print_histogram_row(label, summary->entropy[i], largest, summary->total);
+    }
+    
+    fprintf(stderr, "\n%sIssues:%s\n", COLOR_BRIGHT_YELLOW, COLOR_RESET);
+    fprintf(stderr, "  Weak patterns:    %llu\n", (unsigned long long)summary->weak);
+    fprintf(stderr, "  Dictionary words: %llu\n", (unsigned long long)summary->dictionary);
+    fprintf(stderr, "  Duplicates:       %llu\n", (unsigned long long)summary->duplicates);
+    fprintf(stderr, "  Similar:          %llu\n", (unsigned long long)summary->similar);
+}
+
 /**
  * @brief Print colored text
  */
@@ -360,30 +576,113 @@ void print_separator(int width, char character) {
 }
 
 /**
- * @brief Print progress bar
+ * @brief Render a progress bar into a frame
  */
-void print_progress_bar(int progress, int width) {
+static void frame_progress_bar(UIFrame *frame, int progress, int width) {
     if (progress < 0) progress = 0;
     if (progress > 100) progress = 100;
     if (width <= 0) width = PROGRESS_BAR_WIDTH;
     
     int filled = (progress * width) / 100;
+    char percent[16];
     
-    printf("%s[", COLOR_BRIGHT_BLUE);
+    frame_append(frame, COLOR_BRIGHT_BLUE);
+    frame_append(frame, "[");
     
     /* Filled portion */
-    printf("%s", COLOR_BRIGHT_GREEN);
+    frame_append(frame, COLOR_BRIGHT_GREEN);
     for (int i = 0; i < filled; i++) {
-        printf("█");
+        frame_append(frame, "█");
     }
     
     /* Remaining portion */
-    printf("%s", COLOR_BRIGHT_BLACK);
+    frame_append(frame, COLOR_BRIGHT_BLACK);
     for (int i = filled; i < width; i++) {
-        printf("░");
+        frame_append(frame, "░");
+    }
+    
+    snprintf(percent, sizeof(percent), "] %3d%%", progress);
+    frame_append(frame, COLOR_BRIGHT_BLUE);
+    frame_append(frame, percent);
+    frame_append(frame, COLOR_RESET);
+}
+
+/**
+ * @brief Print progress bar
+ */
+void print_progress_bar(int progress, int width) {
+    UIFrame frame;
+    frame.length = 0;
+    frame_progress_bar(&frame, progress, width);
+    frame_flush(&frame);
+}
+
+/**
+ * @brief Draw one frame of a progress line
+ */
+static void progress_render(UIProgress *progress, int percent, uint64_t now, bool final) {
+    UIFrame frame;
+    frame.length = 0;
+    
+    frame_append(&frame, "\r");
+    if (progress->label) {
+        frame_append(&frame, COLOR_BRIGHT_YELLOW);
+        frame_append(&frame, progress->label);
+        frame_append(&frame, COLOR_RESET);
+        frame_append(&frame, " ");
     }
+    frame_progress_bar(&frame, percent, PROGRESS_BAR_WIDTH);
+    
+    /* The spinner shows the run is alive while the percentage stands still */
+    frame_append(&frame, " ");
+    frame_append(&frame, final ? " \n" : spinner_frames[progress->frame % SPINNER_FRAME_COUNT]);
+    frame_flush(&frame);
     
-    printf("%s] %3d%%%s", COLOR_BRIGHT_BLUE, progress, COLOR_RESET);
+    progress->drawn_percent = percent;
+    progress->drawn_ms = now;
+    progress->frame++;
+}
+
+/**
+ * @brief Start a progress line and draw its first frame
+ */
+void ui_progress_begin(UIProgress *progress, const char *label, size_t total, bool enabled) {
+    if (!progress) return;
+    
+    memset(progress, 0, sizeof(UIProgress));
+    progress->label = label;
+    progress->total = total;
+    progress->drawn_percent = -1;
+    progress->enabled = enabled && total > 0;
+    
+    if (progress->enabled) {
+        progress_render(progress, 0, get_time_ms(), false);
+    }
+}
+
+/**
+ * @brief Report completed work
+ */
+void ui_progress_update(UIProgress *progress, size_t done) {
+    if (!progress || !progress->enabled) return;
+    
+    progress->done = done < progress->total ? done : progress->total;
+    int percent = (int)(progress->done * 100 / progress->total);
+    uint64_t now = get_time_ms();
+    
+    if (percent != progress->drawn_percent || now - progress->drawn_ms >= UI_FRAME_INTERVAL_MS) {
+        progress_render(progress, percent, now, false);
+    }
+}
+
+/**
+ * @brief Draw the final frame and end the line
+ */
+void ui_progress_end(UIProgress *progress) {
+    if (!progress || !progress->enabled) return;
+    
+    progress_render(progress, (int)(progress->done * 100 / progress->total), get_time_ms(), true);
+    progress->enabled = false;
 }
 
 /**
@@ -482,30 +781,37 @@ bool get_user_input(const char *prompt, char *buffer, size_t buffer_size) {
 
 /**
  * @brief Show loading animation
+ *
+ * Timed against the wall clock, sleeping until each frame is due.
  */
 void show_loading(const char *message, int duration_ms) {
     if (!message) return;
     
-    printf("%s%s ", COLOR_BRIGHT_YELLOW, message);
-    fflush(stdout);
-    
-    const char *spinner[] = {"⣾", "⣽", "⣻", "⢿", "⡿", "⣟", "⣯", "⣷"};
-    int spinner_count = sizeof(spinner) / sizeof(spinner[0]);
-    int start_time = (int)clock();
-    int elapsed = 0;
-    int frame = 0;
-    
-    while (elapsed < duration_ms) {
-        printf("\b%s", spinner[frame % spinner_count]);
-        fflush(stdout);
-        
-        sleep_ms(100);
+    UIFrame frame;
+    frame.length = 0;
+    frame_append(&frame, COLOR_BRIGHT_YELLOW);
+    frame_append(&frame, message);
+    frame_append(&frame, " ");
+    frame_flush(&frame);
+    
+    uint64_t duration = duration_ms > 0 ? (uint64_t)duration_ms : 0;
+    uint64_t start = get_time_ms();
+    uint64_t elapsed = 0;
+    unsigned index = 0;
+    
+    while (elapsed < duration) {
+        frame_append(&frame, "\b");
+        frame_append(&frame, spinner_frames[index++ % SPINNER_FRAME_COUNT]);
+        frame_flush(&frame);
         
-        frame++;
-        elapsed = (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC);
+        uint64_t remaining = duration - elapsed;
+        sleep_ms((unsigned int)(remaining < UI_FRAME_INTERVAL_MS ? remaining : UI_FRAME_INTERVAL_MS));
+        elapsed = get_time_ms() - start;
     }
     
-    printf("\b \b\n%s", COLOR_RESET);
+    frame_append(&frame, "\b \b\n");
+    frame_append(&frame, COLOR_RESET);
+    frame_flush(&frame);
 }
 
 /**
@@ -9,6 +9,7 @@
 #define UI_H
 
 #include "password.h"
+#include "audit.h"
 
 /**
  * @brief UI display modes
@@ -54,6 +55,22 @@ typedef struct {
     int terminal_width;         /**< Terminal width for formatting */
 } UIConfig;
 
+/**
+ * @brief Progress line driven by completed work
+ *
+ * A frame is drawn only when the percentage changes or the spinner is
+ * due to advance, and each frame reaches the terminal in one write.
+ */
+typedef struct {
+    const char *label;          /**< Text before the bar (may be NULL) */
+    size_t total;               /**< Units of work in the run */
+    size_t done;                /**< Units completed so far */
+    int drawn_percent;          /**< Percentage of the last frame */
+    uint64_t drawn_ms;          /**< Time of the last frame (get_time_ms()) */
+    unsigned frame;             /**< Frames drawn, selects the spinner glyph */
+    bool enabled;               /**< Draw anything at all */
+} UIProgress;
+
 /**
  * @brief Initialize UI configuration with defaults
  * @return UIConfig structure
@@ -98,6 +115,25 @@ void display_password_result(const PasswordResult *result, const UIConfig *confi
  */
 void display_bulk_results(const PasswordResult *results, size_t count, const UIConfig *config);
 
+/**
+ * @brief Display every entry of a password batch
+ * @param batch Password batch
+ * @param config UI configuration
+ */
+void display_batch_results(const PasswordBatch *batch, const UIConfig *config);
+
+/**
+ * @brief Report candidate and rejection counts on stderr
+ * @param stats Generation counters
+ */
+void display_generation_stats(const GenerationStats *stats);
+
+/**
+ * @brief Report audit histograms and counters on stderr
+ * @param summary Aggregate audit results
+ */
+void display_audit_summary(const AuditSummary *summary);
+
 /**
  * @brief Print colored text
  * @param text Text to print
@@ -155,4 +191,26 @@ void print_separator(int width, char character);
  */
 void print_progress_bar(int progress, int width);
 
+/**
+ * @brief Start a progress line and draw its first frame
+ * @param progress Progress line to initialize
+ * @param label Text before the bar (may be NULL; must outlive the line)
+ * @param total Units of work in the run
+ * @param enabled false to make every call a no-op (quiet mode)
+ */
+void ui_progress_begin(UIProgress *progress, const char *label, size_t total, bool enabled);
+
+/**
+ * @brief Report completed work
+ * @param progress Progress line
+ * @param done Units completed so far
+ */
+void ui_progress_update(UIProgress *progress, size_t done);
+
+/**
+ * @brief Draw the final frame and end the line
+ * @param progress Progress line
+ */
+void ui_progress_end(UIProgress *progress);
+
 #endif /* UI_H */
\ No newline at end of file
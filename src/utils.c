@@ -13,49 +13,154 @@
 #include <ctype.h>
 #include <time.h>
 #include <errno.h>
+#include <stdint.h>
 
 #ifdef _WIN32
     #include <windows.h>
-    #include <wincrypt.h>
+    #include <bcrypt.h>
+    #include <io.h>
 #else
     #include <unistd.h>
     #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/mman.h>
     #include <sys/ioctl.h>
     #include <termios.h>
+    #if defined(__linux__) && defined(__has_include)
+        #if __has_include(<sys/random.h>)
+            #include <sys/random.h>
+            #define HAVE_GETRANDOM 1
+        #endif
+    #endif
 #endif
 
+/* Whether COLOR_* codes are emitted (see config.h) */
+bool color_output = true;
+
 /* Internal random state */
 static bool random_initialized = false;
 
+/*
+ * Bytes are handed out from a pool that is refilled from the OS source in
+ * RANDOM_POOL_SIZE blocks. Served bytes are wiped from the pool immediately,
+ * and the pool is discarded in a forked child so parent and child never
+ * share output.
+ */
+static unsigned char random_pool[RANDOM_POOL_SIZE];
+static size_t random_pool_pos = RANDOM_POOL_SIZE;
+
+#ifdef _WIN32
+static SRWLOCK random_lock = SRWLOCK_INIT;
+#define RANDOM_LOCK() AcquireSRWLockExclusive(&random_lock)
+#define RANDOM_UNLOCK() ReleaseSRWLockExclusive(&random_lock)
+#else
+static pthread_mutex_t random_lock = PTHREAD_MUTEX_INITIALIZER;
+static int urandom_fd = -1;
+#ifdef HAVE_GETRANDOM
+static bool getrandom_unavailable = false;
+#endif
+#define RANDOM_LOCK() pthread_mutex_lock(&random_lock)
+#define RANDOM_UNLOCK() pthread_mutex_unlock(&random_lock)
+
+/* fork() handlers: hold the lock across fork, drop the pool in the child */
+static void random_atfork_prepare(void) {
+    pthread_mutex_lock(&random_lock);
+}
+
+static void random_atfork_parent(void) {
+    pthread_mutex_unlock(&random_lock);
+}
+
+static void random_atfork_child(void) {
+    secure_clear(random_pool, sizeof(random_pool));
+    random_pool_pos = RANDOM_POOL_SIZE;
+    pthread_mutex_unlock(&random_lock);
+}
+#endif
+
+/**
+ * @brief Read bytes directly from the operating system CSPRNG
+ * @note Caller must hold random_lock
+ */
+static bool read_os_random(unsigned char *buffer, size_t size) {
+#ifdef _WIN32
+    while (size > 0) {
+        ULONG chunk = size > 0x7FFFFFFF ? 0x7FFFFFFF : (ULONG)size;
+        if (BCryptGenRandom(NULL, buffer, chunk, 
+                            BCRYPT_USE_SYSTEM_PREFERRED_RNG) != 0) {
+            return false;
+        }
+        buffer += chunk;
+        size -= chunk;
+    }
+    return true;
+#else
+    while (size > 0) {
+        ssize_t got = -1;
+#ifdef HAVE_GETRANDOM
+        if (!getrandom_unavailable) {
+            got = getrandom(buffer, size, 0);
+            if (got < 0 && errno == ENOSYS) {
+                /* Kernel too old for getrandom(), use the device from now on */
+                getrandom_unavailable = true;
+            }
+        }
+        if (getrandom_unavailable)
+#endif
+        {
+            if (urandom_fd < 0) {
+                urandom_fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+                if (urandom_fd < 0) {
+                    return false;
+                }
+            }
+            got = read(urandom_fd, buffer, size);
+        }
+        
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (got == 0) {
+            return false;
+        }
+        buffer += got;
+        size -= (size_t)got;
+    }
+    return true;
+#endif
+}
+
 /**
  * @brief Initialize secure random number generator
  */
 bool init_secure_random(void) {
+    RANDOM_LOCK();
+    
     if (random_initialized) {
+        RANDOM_UNLOCK();
         return true;
     }
     
-#ifdef _WIN32
-    /* Windows uses CryptGenRandom */
-    HCRYPTPROV hProvider = 0;
-    if (!CryptAcquireContextW(&hProvider, NULL, NULL, PROV_RSA_FULL, 
-                              CRYPT_VERIFYCONTEXT | CRYPT_SILENT)) {
+    /* Prime the pool; this also proves the OS source is usable */
+    if (!read_os_random(random_pool, sizeof(random_pool))) {
+        RANDOM_UNLOCK();
         return false;
     }
-    CryptReleaseContext(hProvider, 0);
-#else
-    /* Linux/Unix uses /dev/urandom */
-    /* Check if /dev/urandom is accessible */
-    FILE *urandom = fopen("/dev/urandom", "rb");
-    if (!urandom) {
-        return false;
-    }
-    fclose(urandom);
+    random_pool_pos = 0;
+    
+#ifndef _WIN32
+    pthread_atfork(random_atfork_prepare, random_atfork_parent, 
+                   random_atfork_child);
 #endif
     
     /* Seed standard random for non-cryptographic uses */
     srand((unsigned int)time(NULL));
     random_initialized = true;
+    
+    RANDOM_UNLOCK();
     return true;
 }
 
@@ -67,31 +172,66 @@ bool get_random_bytes(unsigned char *buffer, size_t size) {
         return false;
     }
     
-    if (!random_initialized && !init_secure_random()) {
-        return false;
+    /* A forked child starts with an empty pool, see random_atfork_child() */
+    RANDOM_LOCK();
+    
+    /* The flag is written under the lock, so it is only read under it */
+    if (!random_initialized) {
+        RANDOM_UNLOCK();
+        if (!init_secure_random()) {
+            return false;
+        }
+        RANDOM_LOCK();
     }
     
-#ifdef _WIN32
-    HCRYPTPROV hProvider = 0;
-    if (!CryptAcquireContextW(&hProvider, NULL, NULL, PROV_RSA_FULL, 
-                              CRYPT_VERIFYCONTEXT | CRYPT_SILENT)) {
-        return false;
+    /* Large requests bypass the pool entirely */
+    if (size >= RANDOM_POOL_SIZE) {
+        bool ok = read_os_random(buffer, size);
+        RANDOM_UNLOCK();
+        return ok;
     }
     
-    BOOL success = CryptGenRandom(hProvider, (DWORD)size, buffer);
-    CryptReleaseContext(hProvider, 0);
-    return success ? true : false;
-#else
-    FILE *urandom = fopen("/dev/urandom", "rb");
-    if (!urandom) {
-        return false;
+    while (size > 0) {
+        if (random_pool_pos >= RANDOM_POOL_SIZE) {
+            if (!read_os_random(random_pool, sizeof(random_pool))) {
+                RANDOM_UNLOCK();
+                return false;
+            }
+            random_pool_pos = 0;
+        }
+        
+        size_t available = RANDOM_POOL_SIZE - random_pool_pos;
+        size_t take = size < available ? size : available;
+        
+        memcpy(buffer, random_pool + random_pool_pos, take);
+        secure_clear(random_pool + random_pool_pos, take);
+        
+        random_pool_pos += take;
+        buffer += take;
+        size -= take;
     }
     
-    size_t bytes_read = fread(buffer, 1, size, urandom);
-    fclose(urandom);
+    RANDOM_UNLOCK();
+    return true;
+}
+
+/**
+ * @brief Release secure random number generator resources
+ */
+void cleanup_secure_random(void) {
+    RANDOM_LOCK();
+    
+    secure_clear(random_pool, sizeof(random_pool));
+    random_pool_pos = RANDOM_POOL_SIZE;
     
-    return bytes_read == size;
+#ifndef _WIN32
+    if (urandom_fd >= 0) {
+        close(urandom_fd);
+        urandom_fd = -1;
+    }
 #endif
+    
+    RANDOM_UNLOCK();
 }
 
 /**
@@ -236,6 +376,105 @@ void secure_clear(void *ptr, size_t size) {
     }
 }
 
+/**
+ * @brief Get the system page size
+ */
+static size_t get_page_size(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize > 0 ? (size_t)info.dwPageSize : 4096;
+#else
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? (size_t)page : 4096;
+#endif
+}
+
+/**
+ * @brief Create a secure arena
+ */
+bool secure_arena_init(SecureArena *arena, size_t size) {
+    if (!arena || size == 0) {
+        return false;
+    }
+    
+    memset(arena, 0, sizeof(SecureArena));
+    
+    /* Whole pages, so locking never touches neighbouring allocations */
+    size_t page = get_page_size();
+    if (size > SIZE_MAX - page) {
+        return false;
+    }
+    size = (size + page - 1) & ~(page - 1);
+    
+#ifdef _WIN32
+    void *base = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!base) {
+        return false;
+    }
+    arena->locked = VirtualLock(base, size) != 0;
+#else
+    void *base = NULL;
+    if (posix_memalign(&base, page, size) != 0) {
+        return false;
+    }
+    memset(base, 0, size);
+    arena->locked = mlock(base, size) == 0;
+#endif
+    
+    arena->base = (unsigned char *)base;
+    arena->size = size;
+    arena->used = 0;
+    return true;
+}
+
+/**
+ * @brief Allocate zeroed memory from a secure arena
+ */
+void *secure_arena_alloc(SecureArena *arena, size_t size, size_t alignment) {
+    if (!arena || !arena->base || size == 0) {
+        return NULL;
+    }
+    
+    if (alignment == 0) {
+        alignment = 1;
+    }
+    
+    size_t offset = (arena->used + alignment - 1) & ~(alignment - 1);
+    if (offset < arena->used || offset > arena->size || size > arena->size - offset) {
+        return NULL;
+    }
+    
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+/**
+ * @brief Wipe, unlock and release a secure arena
+ */
+void secure_arena_destroy(SecureArena *arena) {
+    if (!arena || !arena->base) {
+        return;
+    }
+    
+    /* One pass over everything that was handed out */
+    secure_clear(arena->base, arena->used);
+    
+#ifdef _WIN32
+    if (arena->locked) {
+        VirtualUnlock(arena->base, arena->size);
+    }
+    VirtualFree(arena->base, 0, MEM_RELEASE);
+#else
+    if (arena->locked) {
+        munlock(arena->base, arena->size);
+    }
+    free(arena->base);
+#endif
+    
+    memset(arena, 0, sizeof(SecureArena));
+}
+
 /**
  * @brief Get current timestamp as string
  */
@@ -457,6 +696,35 @@ void sleep_ms(unsigned int milliseconds) {
 #endif
 }
 
+/**
+ * @brief Read a monotonic wall clock (cross-platform)
+ */
+uint64_t get_time_ms(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+#endif
+}
+
+/**
+ * @brief Check whether stdout is a terminal that should get color codes
+ */
+bool terminal_supports_color(void) {
+    const char *no_color = getenv("NO_COLOR");
+    if (no_color && no_color[0] != '\0') {
+        return false;
+    }
+    
+#ifdef _WIN32
+    return _isatty(_fileno(stdout)) != 0;
+#else
+    return isatty(STDOUT_FILENO) != 0;
+#endif
+}
+
 /**
  * @brief Get terminal width (cross-platform)
  */
@@ -10,6 +10,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 /**
@@ -33,6 +34,19 @@ typedef struct {
     size_t capacity;
 } SecureString;
 
+/**
+ * @brief Contiguous, page-locked memory region for secrets
+ *
+ * Allocations are carved out of one block that is locked into RAM where
+ * the platform allows it, and the whole block is wiped once at teardown.
+ */
+typedef struct {
+    unsigned char *base;    /**< Start of the region */
+    size_t size;            /**< Usable size in bytes */
+    size_t used;            /**< Bytes handed out so far */
+    bool locked;            /**< Region is locked into RAM */
+} SecureArena;
+
 /**
  * @brief Initialize secure random number generator
  * @return true if successful, false otherwise
@@ -47,6 +61,14 @@ bool init_secure_random(void);
  */
 bool get_random_bytes(unsigned char *buffer, size_t size);
 
+/**
+ * @brief Release secure random number generator resources
+ *
+ * Wipes the internal random pool and closes the OS random source.
+ * The generator re-initializes itself on the next request.
+ */
+void cleanup_secure_random(void);
+
 /**
  * @brief Generate secure random number in range
  * @param min Minimum value (inclusive)
@@ -98,6 +120,32 @@ void secure_string_free(SecureString *str);
  */
 void secure_clear(void *ptr, size_t size);
 
+/**
+ * @brief Create a secure arena
+ * @param arena Arena to initialize
+ * @param size Minimum usable size in bytes
+ * @return true if successful, false otherwise
+ *
+ * Locking the region (mlock/VirtualLock) is best effort: if it fails the
+ * arena is still usable and arena->locked is false.
+ */
+bool secure_arena_init(SecureArena *arena, size_t size);
+
+/**
+ * @brief Allocate zeroed memory from a secure arena
+ * @param arena Initialized arena
+ * @param size Number of bytes
+ * @param alignment Required alignment (power of two)
+ * @return Pointer into the arena, or NULL if it is exhausted
+ */
+void *secure_arena_alloc(SecureArena *arena, size_t size, size_t alignment);
+
+/**
+ * @brief Wipe, unlock and release a secure arena
+ * @param arena Arena to destroy
+ */
+void secure_arena_destroy(SecureArena *arena);
+
 /**
  * @brief Get current timestamp as string
  * @param buffer Buffer to store timestamp
@@ -170,4 +218,16 @@ long get_file_size(const char *filename);
  */
 void sleep_ms(unsigned int milliseconds);
 
+/**
+ * @brief Read a monotonic wall clock (cross-platform)
+ * @return Milliseconds since an arbitrary epoch
+ */
+uint64_t get_time_ms(void);
+
+/**
+ * @brief Check whether stdout is a terminal that should get color codes
+ * @return true if stdout is a terminal and NO_COLOR is not set
+ */
+bool terminal_supports_color(void);
+
 #endif /* UTILS_H */
\ No newline at end of file